@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+Arena::Arena(
+        std::size_t block_size)
+    : _block_size(block_size)
+    , _block(0)
+    , _offset(0)
+{
+    // Do nothing
+}
+
+//==============================================================================
+void* Arena::allocate(
+        std::size_t size,
+        std::size_t alignment)
+{
+    while (true)
+    {
+        // Look for room in the current block, and then in the ones after it,
+        // which are free since the last rewind.
+        for (; _block < _blocks.size(); ++_block, _offset = 0)
+        {
+            Block& block = _blocks[_block];
+            const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data.get());
+            const std::size_t start = static_cast<std::size_t>(
+                ((base + _offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) - base);
+            if (start + size <= block.size)
+            {
+                _offset = start + size;
+                return block.data.get() + start;
+            }
+        }
+
+        const std::size_t block_size = std::max(_block_size, size + alignment);
+        _blocks.push_back({std::unique_ptr<char[]>(new char[block_size]), block_size});
+    }
+}
+
+//==============================================================================
+std::size_t Arena::capacity() const
+{
+    std::size_t capacity = 0;
+    for (const Block& block : _blocks)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+//==============================================================================
+Arena& Arena::local()
+{
+    thread_local Arena arena;
+    return arena;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
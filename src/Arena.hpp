@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__ARENA_HPP_
+#define _WEBSOCKET_IS_SH__SRC__ARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class Arena
+ * @brief Monotonic allocator for the temporary objects needed while a message is
+ *        decoded or encoded.
+ *
+ *        Memory is handed out from a list of blocks, moving forward, and is never freed
+ *        one allocation at a time: instead, the arena is rewound to a mark taken before,
+ *        in constant time, and the memory allocated since then is reused. Blocks are kept
+ *        until the arena is destroyed, so once they have grown to what a message needs,
+ *        handling further messages does not allocate.
+ *
+ *        Each thread has its own arena, returned by local(). It is not thread safe.
+ */
+class Arena
+{
+public:
+
+    /**
+     * @brief A position in the arena, to rewind it to.
+     */
+    struct Mark
+    {
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] block_size Size of the blocks, unless a larger one is needed
+     *            for a single allocation.
+     */
+    explicit Arena(
+            std::size_t block_size = 16 * 1024);
+
+    Arena(
+            const Arena& other) = delete;
+
+    Arena& operator =(
+            const Arena& other) = delete;
+
+    /**
+     * @brief Allocate memory from the arena.
+     *
+     * @param[in] size The number of bytes.
+     *
+     * @param[in] alignment The alignment of the memory, which must be a power of two.
+     *
+     * @returns The memory, valid until the arena is rewound to a mark taken before.
+     */
+    void* allocate(
+            std::size_t size,
+            std::size_t alignment);
+
+    /**
+     * @returns The current position of the arena.
+     */
+    Mark mark() const
+    {
+        return {_block, _offset};
+    }
+
+    /**
+     * @brief Release everything allocated since a mark was taken.
+     */
+    void rewind(
+            const Mark& mark)
+    {
+        _block = mark.block;
+        _offset = mark.offset;
+    }
+
+    /**
+     * @brief Release everything allocated from the arena.
+     */
+    void reset()
+    {
+        rewind({0, 0});
+    }
+
+    /**
+     * @returns The number of bytes held by the blocks of the arena.
+     */
+    std::size_t capacity() const;
+
+    /**
+     * @returns The arena of the calling thread.
+     */
+    static Arena& local();
+
+private:
+
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    std::size_t _block_size;
+    std::vector<Block> _blocks;
+
+    /**
+     * The block allocations are taken from, and the offset of the first free byte in it.
+     */
+    std::size_t _block;
+    std::size_t _offset;
+};
+
+/**
+ * @class ArenaScope
+ * @brief Releases everything allocated from an arena during its lifetime when it is destroyed.
+ *
+ *        Scopes can be nested, as when a reassembled message is handled while its last
+ *        fragment is: each one releases only what was allocated since it was created.
+ */
+class ArenaScope
+{
+public:
+
+    explicit ArenaScope(
+            Arena& arena = Arena::local())
+        : _arena(arena)
+        , _mark(arena.mark())
+    {
+        // Do nothing
+    }
+
+    ArenaScope(
+            const ArenaScope& other) = delete;
+
+    ArenaScope& operator =(
+            const ArenaScope& other) = delete;
+
+    ~ArenaScope()
+    {
+        _arena.rewind(_mark);
+    }
+
+private:
+
+    Arena& _arena;
+    const Arena::Mark _mark;
+};
+
+/**
+ * @class ArenaAllocator
+ * @brief Standard allocator drawing from an arena, so that containers can be used
+ *        as temporaries without allocating. Deallocation does nothing: the memory is
+ *        released when the arena is rewound, which the containers must not outlive.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+
+    using value_type = T;
+
+    explicit ArenaAllocator(
+            Arena& arena = Arena::local()) noexcept
+        : _arena(&arena)
+    {
+        // Do nothing
+    }
+
+    template<typename U>
+    ArenaAllocator(
+            const ArenaAllocator<U>& other) noexcept
+        : _arena(other.arena())
+    {
+        // Do nothing
+    }
+
+    T* allocate(
+            std::size_t n)
+    {
+        return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(
+            T* /*pointer*/,
+            std::size_t /*n*/) noexcept
+    {
+        // Do nothing
+    }
+
+    Arena* arena() const noexcept
+    {
+        return _arena;
+    }
+
+private:
+
+    Arena* _arena;
+};
+
+template<typename T, typename U>
+bool operator ==(
+        const ArenaAllocator<T>& a,
+        const ArenaAllocator<U>& b) noexcept
+{
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator !=(
+        const ArenaAllocator<T>& a,
+        const ArenaAllocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__ARENA_HPP_
@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Base64.hpp"
+
+#include <array>
+#include <cstring>
+
+// SSSE3 is not part of x86-64, so both SSSE3 and AVX2 are used only if the processor
+// supports them, which is checked with the builtins of GCC and Clang.
+#if !defined(IS_WEBSOCKET_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+#define IS_WEBSOCKET_BASE64_SIMD
+#include <immintrin.h>
+#endif // if !defined(IS_WEBSOCKET_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+const char Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+using EncodeFunction = void (*)(
+    const uint8_t*,
+    std::size_t,
+    char*);
+
+using DecodeFunction = bool (*)(
+    const char*,
+    std::size_t,
+    uint8_t*,
+    std::size_t&);
+
+//==============================================================================
+/**
+ * @brief The value of each character in the alphabet, or -1 for any other character.
+ */
+const std::array<int8_t, 256>& decoding_table()
+{
+    static const std::array<int8_t, 256> table = []()
+            {
+                std::array<int8_t, 256> values;
+                values.fill(-1);
+                for (int8_t i = 0; i < 64; ++i)
+                {
+                    values[static_cast<unsigned char>(Alphabet[i])] = i;
+                }
+                return values;
+            }();
+    return table;
+}
+
+#if defined(IS_WEBSOCKET_BASE64_SIMD)
+// The encoding and decoding of blocks follow the algorithms by Wojciech Muła,
+// as described in http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+// and http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html.
+// Each 128 bit lane encodes 12 bytes into 16 characters, or decodes them back.
+
+//==============================================================================
+__attribute__((target("ssse3")))
+__m128i encode_block_ssse3(
+        __m128i input)
+{
+    // Spread every 3 bytes into 4, and move each group of 6 bits to a byte of its own.
+    input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i high = _mm_mulhi_epu16(
+        _mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    const __m128i low = _mm_mullo_epi16(
+        _mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(high, low);
+
+    // Turn the indices into characters adding the offset of the range each one belongs to.
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+}
+
+//==============================================================================
+/**
+ * @returns `false` if any of the characters is not in the alphabet.
+ */
+__attribute__((target("ssse3")))
+bool decode_block_ssse3(
+        __m128i input,
+        __m128i& output)
+{
+    const __m128i mask_2f = _mm_set1_epi8(0x2F);
+    const __m128i high_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask_2f);
+    const __m128i low_nibbles = _mm_and_si128(input, mask_2f);
+
+    // A character is valid if the classes of its high and low nibbles do not intersect.
+    const __m128i low_classes = _mm_shuffle_epi8(_mm_setr_epi8(
+                        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A), low_nibbles);
+    const __m128i high_classes = _mm_shuffle_epi8(_mm_setr_epi8(
+                        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10), high_nibbles);
+    const __m128i invalid = _mm_and_si128(low_classes, high_classes);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF)
+    {
+        return false;
+    }
+
+    // Turn the characters into their values, adding the offset of their range,
+    // which is told by the high nibble, except for '/'.
+    const __m128i offsets = _mm_shuffle_epi8(
+        _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0),
+        _mm_add_epi8(_mm_cmpeq_epi8(input, mask_2f), high_nibbles));
+    const __m128i values = _mm_add_epi8(input, offsets);
+
+    // Join every 4 values of 6 bits into 3 bytes.
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    output = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return true;
+}
+
+//==============================================================================
+__attribute__((target("ssse3")))
+void encode_ssse3(
+        const uint8_t* data,
+        std::size_t size,
+        char* output)
+{
+    std::size_t offset = 0;
+    // Blocks are loaded 16 bytes at a time, of which 12 are encoded.
+    for (; size - offset >= 16; offset += 12, output += 16)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+            encode_block_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset))));
+    }
+    base64_encode_scalar(data + offset, size - offset, output);
+}
+
+//==============================================================================
+__attribute__((target("ssse3")))
+bool decode_ssse3(
+        const char* text,
+        std::size_t size,
+        uint8_t* output,
+        std::size_t& decoded)
+{
+    std::size_t offset = 0;
+    decoded = 0;
+    // The last group, which may be padded, is always left to the scalar code.
+    for (; size - offset >= 20; offset += 16, decoded += 12)
+    {
+        __m128i bytes;
+        if (!decode_block_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset)), bytes))
+        {
+            return false;
+        }
+        // Only 12 of the 16 bytes are decoded, so they are not stored as a whole,
+        // which could write past the end of the output.
+        std::memcpy(output + decoded, &bytes, 12);
+    }
+
+    std::size_t tail = 0;
+    const bool valid = base64_decode_scalar(text + offset, size - offset, output + decoded, tail);
+    decoded += tail;
+    return valid;
+}
+
+//==============================================================================
+__attribute__((target("avx2")))
+void encode_avx2(
+        const uint8_t* data,
+        std::size_t size,
+        char* output)
+{
+    std::size_t offset = 0;
+    // Each lane encodes its own 12 bytes, loaded 16 at a time.
+    for (; size - offset >= 28; offset += 24, output += 32)
+    {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset + 12));
+        const __m256i input = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+
+        const __m256i spread = _mm256_shuffle_epi8(input, _mm256_setr_epi8(
+                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        const __m256i high = _mm256_mulhi_epu16(
+            _mm256_and_si256(spread, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+        const __m256i low = _mm256_mullo_epi16(
+            _mm256_and_si256(spread, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(high, low);
+
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_or_si256(range,
+                _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        const __m256i offsets = _mm256_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output),
+            _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range)));
+    }
+    encode_ssse3(data + offset, size - offset, output);
+}
+
+//==============================================================================
+__attribute__((target("avx2")))
+bool decode_avx2(
+        const char* text,
+        std::size_t size,
+        uint8_t* output,
+        std::size_t& decoded)
+{
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    const __m256i low_table = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i high_table = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i offset_table = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    std::size_t offset = 0;
+    decoded = 0;
+    for (; size - offset >= 36; offset += 32, decoded += 24)
+    {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + offset));
+        const __m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask_2f);
+        const __m256i low_nibbles = _mm256_and_si256(input, mask_2f);
+
+        const __m256i invalid = _mm256_and_si256(
+            _mm256_shuffle_epi8(low_table, low_nibbles), _mm256_shuffle_epi8(high_table, high_nibbles));
+        if (!_mm256_testz_si256(invalid, invalid))
+        {
+            return false;
+        }
+
+        const __m256i values = _mm256_add_epi8(input, _mm256_shuffle_epi8(
+                    offset_table, _mm256_add_epi8(_mm256_cmpeq_epi8(input, mask_2f), high_nibbles)));
+        const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i bytes = _mm256_shuffle_epi8(
+            _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000)), pack);
+
+        const __m128i first = _mm256_castsi256_si128(bytes);
+        const __m128i second = _mm256_extracti128_si256(bytes, 1);
+        std::memcpy(output + decoded, &first, 12);
+        std::memcpy(output + decoded + 12, &second, 12);
+    }
+
+    std::size_t tail = 0;
+    const bool valid = decode_ssse3(text + offset, size - offset, output + decoded, tail);
+    decoded += tail;
+    return valid;
+}
+
+#endif // if defined(IS_WEBSOCKET_BASE64_SIMD)
+
+//==============================================================================
+struct Backend
+{
+    EncodeFunction encode;
+    DecodeFunction decode;
+    const char* name;
+};
+
+//==============================================================================
+Backend select_backend()
+{
+#if defined(IS_WEBSOCKET_BASE64_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {&encode_avx2, &decode_avx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        return {&encode_ssse3, &decode_ssse3, "ssse3"};
+    }
+#endif // if defined(IS_WEBSOCKET_BASE64_SIMD)
+    return {&base64_encode_scalar, &base64_decode_scalar, "scalar"};
+}
+
+//==============================================================================
+/**
+ * @brief The implementation for this processor, chosen the first time it is needed.
+ */
+const Backend& backend()
+{
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+void base64_encode(
+        const uint8_t* data,
+        std::size_t size,
+        char* output)
+{
+    backend().encode(data, size, output);
+}
+
+//==============================================================================
+bool base64_decode(
+        const char* text,
+        std::size_t size,
+        uint8_t* output,
+        std::size_t& decoded)
+{
+    return backend().decode(text, size, output, decoded);
+}
+
+//==============================================================================
+void base64_encode_scalar(
+        const uint8_t* data,
+        std::size_t size,
+        char* output)
+{
+    std::size_t offset = 0;
+    for (; size - offset >= 3; offset += 3, output += 4)
+    {
+        const uint32_t group = (uint32_t(data[offset]) << 16) | (uint32_t(data[offset + 1]) << 8)
+                | uint32_t(data[offset + 2]);
+        output[0] = Alphabet[group >> 18];
+        output[1] = Alphabet[(group >> 12) & 0x3F];
+        output[2] = Alphabet[(group >> 6) & 0x3F];
+        output[3] = Alphabet[group & 0x3F];
+    }
+
+    if (size - offset == 1)
+    {
+        const uint32_t group = uint32_t(data[offset]) << 16;
+        output[0] = Alphabet[group >> 18];
+        output[1] = Alphabet[(group >> 12) & 0x3F];
+        output[2] = '=';
+        output[3] = '=';
+    }
+    else if (size - offset == 2)
+    {
+        const uint32_t group = (uint32_t(data[offset]) << 16) | (uint32_t(data[offset + 1]) << 8);
+        output[0] = Alphabet[group >> 18];
+        output[1] = Alphabet[(group >> 12) & 0x3F];
+        output[2] = Alphabet[(group >> 6) & 0x3F];
+        output[3] = '=';
+    }
+}
+
+//==============================================================================
+bool base64_decode_scalar(
+        const char* text,
+        std::size_t size,
+        uint8_t* output,
+        std::size_t& decoded)
+{
+    const std::array<int8_t, 256>& table = decoding_table();
+    decoded = 0;
+
+    // Padding is only allowed to complete the last group of 4 characters.
+    std::size_t padding = 0;
+    while (padding < 2 && size > 0 && text[size - 1] == '=')
+    {
+        --size;
+        ++padding;
+    }
+    if ((padding > 0 && (size + padding) % 4 != 0) || size % 4 == 1)
+    {
+        return false;
+    }
+
+    uint32_t group = 0;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const int8_t value = table[static_cast<unsigned char>(text[i])];
+        if (value < 0)
+        {
+            return false;
+        }
+        group = (group << 6) | static_cast<uint32_t>(value);
+        if (++count == 4)
+        {
+            output[decoded++] = static_cast<uint8_t>(group >> 16);
+            output[decoded++] = static_cast<uint8_t>(group >> 8);
+            output[decoded++] = static_cast<uint8_t>(group);
+            group = 0;
+            count = 0;
+        }
+    }
+
+    if (count == 2)
+    {
+        output[decoded++] = static_cast<uint8_t>(group >> 4);
+    }
+    else if (count == 3)
+    {
+        output[decoded++] = static_cast<uint8_t>(group >> 10);
+        output[decoded++] = static_cast<uint8_t>(group >> 2);
+    }
+    return true;
+}
+
+//==============================================================================
+const char* base64_backend()
+{
+    return backend().name;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
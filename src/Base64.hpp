@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__BASE64_HPP_
+#define _WEBSOCKET_IS_SH__SRC__BASE64_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @returns The number of characters of the padded base64 text of `size` bytes.
+ */
+inline std::size_t base64_encoded_size(
+        std::size_t size)
+{
+    return (size + 2) / 3 * 4;
+}
+
+/**
+ * @returns The maximum number of bytes that `size` characters of base64 text decode to.
+ */
+inline std::size_t base64_decoded_size(
+        std::size_t size)
+{
+    return (size + 3) / 4 * 3;
+}
+
+/**
+ * @brief Encode bytes as base64 text, with the standard alphabet and padding.
+ *
+ * @details Like scan_json_string(), it encodes 24 or 12 bytes at once with AVX2
+ *          or SSSE3 instructions if the processor supports them.
+ *
+ * @param[in] data The bytes to encode.
+ *
+ * @param[in] size The number of bytes.
+ *
+ * @param[out] output Where the text is written. It must have room for
+ *             base64_encoded_size() characters.
+ */
+void base64_encode(
+        const uint8_t* data,
+        std::size_t size,
+        char* output);
+
+/**
+ * @brief Decode base64 text, with the standard alphabet. The padding may be omitted.
+ *
+ * @param[in] text The text to decode.
+ *
+ * @param[in] size The number of characters of the text.
+ *
+ * @param[out] output Where the bytes are written. It must have room for
+ *             base64_decoded_size() bytes.
+ *
+ * @param[out] decoded The number of bytes written.
+ *
+ * @returns `false` if the text is not valid base64, in which case the contents
+ *          of the output are unspecified.
+ */
+bool base64_decode(
+        const char* text,
+        std::size_t size,
+        uint8_t* output,
+        std::size_t& decoded);
+
+/**
+ * @brief The same as base64_encode(), encoding the bytes one group at a time.
+ */
+void base64_encode_scalar(
+        const uint8_t* data,
+        std::size_t size,
+        char* output);
+
+/**
+ * @brief The same as base64_decode(), decoding the characters one group at a time.
+ */
+bool base64_decode_scalar(
+        const char* text,
+        std::size_t size,
+        uint8_t* output,
+        std::size_t& decoded);
+
+/**
+ * @returns The name of the instructions base64_encode() and base64_decode() use
+ *          in this processor: `"avx2"`, `"ssse3"` or `"scalar"`.
+ */
+const char* base64_backend();
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__BASE64_HPP_
@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Cbor.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+// Additional information values of the initial byte.
+const uint8_t AdditionalUint8 = 24;
+const uint8_t AdditionalUint16 = 25;
+const uint8_t AdditionalUint32 = 26;
+const uint8_t AdditionalUint64 = 27;
+const uint8_t AdditionalIndefinite = 31;
+
+// Simple values and floating point numbers, within the SIMPLE major type.
+const uint8_t SimpleFalse = 0xF4;
+const uint8_t SimpleTrue = 0xF5;
+const uint8_t SimpleNull = 0xF6;
+const uint8_t SimpleHalf = 0xF9;
+const uint8_t SimpleFloat = 0xFA;
+const uint8_t SimpleDouble = 0xFB;
+
+/**
+ * Items cannot be nested deeper than this, so that malicious messages cannot exhaust the stack.
+ */
+const std::size_t MaxNestingDepth = 256;
+
+//==============================================================================
+double half_to_double(
+        uint16_t half)
+{
+    const int exponent = (half >> 10) & 0x1F;
+    const int mantissa = half & 0x3FF;
+
+    double value;
+    if (exponent == 0)
+    {
+        value = std::ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = mantissa == 0 ?
+                std::numeric_limits<double>::infinity() :
+                std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return (half & 0x8000) ? -value : value;
+}
+
+//==============================================================================
+void skip_item(
+        CborReader& reader,
+        std::size_t depth)
+{
+    if (depth > MaxNestingDepth)
+    {
+        throw CborError("items are nested too deep");
+    }
+
+    switch (reader.peek_type())
+    {
+        case CborType::UNSIGNED:
+        case CborType::NEGATIVE:
+            reader.read_int();
+            break;
+        case CborType::BYTES:
+            reader.read_bytes();
+            break;
+        case CborType::TEXT:
+            reader.read_text();
+            break;
+        case CborType::ARRAY:
+        {
+            const std::size_t count = reader.read_array_header();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                skip_item(reader, depth + 1);
+            }
+            break;
+        }
+        case CborType::MAP:
+        {
+            const std::size_t count = reader.read_map_header();
+            for (std::size_t i = 0; i < 2 * count; ++i)
+            {
+                skip_item(reader, depth + 1);
+            }
+            break;
+        }
+        case CborType::TAG:
+            reader.read_tag();
+            skip_item(reader, depth + 1);
+            break;
+        case CborType::SIMPLE:
+            if (reader.is_null())
+            {
+                reader.read_null();
+            }
+            else
+            {
+                try
+                {
+                    reader.read_double();
+                }
+                catch (const CborError&)
+                {
+                    reader.read_bool();
+                }
+            }
+            break;
+    }
+}
+
+} // anonymous namespace
+
+//==============================================================================
+CborWriter::CborWriter(
+        std::string& buffer)
+    : _buffer(buffer)
+{
+    // Do nothing
+}
+
+//==============================================================================
+void CborWriter::write_null()
+{
+    _buffer.push_back(static_cast<char>(SimpleNull));
+}
+
+//==============================================================================
+void CborWriter::write_bool(
+        bool value)
+{
+    _buffer.push_back(static_cast<char>(value ? SimpleTrue : SimpleFalse));
+}
+
+//==============================================================================
+void CborWriter::write_uint(
+        uint64_t value)
+{
+    write_head(CborType::UNSIGNED, value);
+}
+
+//==============================================================================
+void CborWriter::write_int(
+        int64_t value)
+{
+    if (value >= 0)
+    {
+        write_head(CborType::UNSIGNED, static_cast<uint64_t>(value));
+    }
+    else
+    {
+        // -1 - value, computed without overflowing for the lowest int64_t.
+        write_head(CborType::NEGATIVE, ~static_cast<uint64_t>(value));
+    }
+}
+
+//==============================================================================
+void CborWriter::write_float(
+        float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    _buffer.push_back(static_cast<char>(SimpleFloat));
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        _buffer.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+//==============================================================================
+void CborWriter::write_double(
+        double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    _buffer.push_back(static_cast<char>(SimpleDouble));
+    for (int shift = 56; shift >= 0; shift -= 8)
+    {
+        _buffer.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+//==============================================================================
+void CborWriter::write_text(
+        const std::string& value)
+{
+    write_text(value.data(), value.size());
+}
+
+//==============================================================================
+void CborWriter::write_text(
+        const char* data,
+        std::size_t size)
+{
+    write_head(CborType::TEXT, size);
+    _buffer.append(data, size);
+}
+
+//==============================================================================
+void CborWriter::write_bytes(
+        const void* data,
+        std::size_t size)
+{
+    write_head(CborType::BYTES, size);
+    _buffer.append(static_cast<const char*>(data), size);
+}
+
+//==============================================================================
+void CborWriter::begin_array(
+        std::size_t size)
+{
+    write_head(CborType::ARRAY, size);
+}
+
+//==============================================================================
+void CborWriter::begin_map(
+        std::size_t size)
+{
+    write_head(CborType::MAP, size);
+}
+
+//==============================================================================
+void CborWriter::write_tag(
+        uint64_t tag)
+{
+    write_head(CborType::TAG, tag);
+}
+
+//==============================================================================
+void CborWriter::write_head(
+        CborType type,
+        uint64_t value)
+{
+    const uint8_t major = static_cast<uint8_t>(static_cast<uint8_t>(type) << 5);
+
+    int bytes;
+    if (value < AdditionalUint8)
+    {
+        _buffer.push_back(static_cast<char>(major | value));
+        return;
+    }
+    else if (value <= std::numeric_limits<uint8_t>::max())
+    {
+        _buffer.push_back(static_cast<char>(major | AdditionalUint8));
+        bytes = 1;
+    }
+    else if (value <= std::numeric_limits<uint16_t>::max())
+    {
+        _buffer.push_back(static_cast<char>(major | AdditionalUint16));
+        bytes = 2;
+    }
+    else if (value <= std::numeric_limits<uint32_t>::max())
+    {
+        _buffer.push_back(static_cast<char>(major | AdditionalUint32));
+        bytes = 4;
+    }
+    else
+    {
+        _buffer.push_back(static_cast<char>(major | AdditionalUint64));
+        bytes = 8;
+    }
+
+    for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8)
+    {
+        _buffer.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+//==============================================================================
+CborReader::CborReader(
+        const char* data,
+        std::size_t size,
+        std::size_t position)
+    : _data(reinterpret_cast<const uint8_t*>(data))
+    , _size(size)
+    , _position(position)
+{
+    // Do nothing
+}
+
+//==============================================================================
+CborType CborReader::peek_type() const
+{
+    return static_cast<CborType>(peek_byte() >> 5);
+}
+
+//==============================================================================
+bool CborReader::is_null() const
+{
+    return !at_end() && _data[_position] == SimpleNull;
+}
+
+//==============================================================================
+void CborReader::read_null()
+{
+    if (peek_byte() != SimpleNull)
+    {
+        throw CborError("expected null");
+    }
+    ++_position;
+}
+
+//==============================================================================
+bool CborReader::read_bool()
+{
+    const uint8_t byte = peek_byte();
+    if (byte != SimpleTrue && byte != SimpleFalse)
+    {
+        throw CborError("expected a boolean");
+    }
+    ++_position;
+    return byte == SimpleTrue;
+}
+
+//==============================================================================
+uint64_t CborReader::read_uint()
+{
+    return read_head(CborType::UNSIGNED);
+}
+
+//==============================================================================
+int64_t CborReader::read_int()
+{
+    const bool negative = peek_type() == CborType::NEGATIVE;
+    const uint64_t value = read_head(negative ? CborType::NEGATIVE : CborType::UNSIGNED);
+
+    if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+    {
+        throw CborError("integer out of range");
+    }
+
+    return negative ? -1 - static_cast<int64_t>(value) : static_cast<int64_t>(value);
+}
+
+//==============================================================================
+double CborReader::read_double()
+{
+    const CborType type = peek_type();
+    if (type == CborType::UNSIGNED || type == CborType::NEGATIVE)
+    {
+        return static_cast<double>(read_int());
+    }
+
+    const uint8_t byte = peek_byte();
+    std::size_t bytes;
+    switch (byte)
+    {
+        case SimpleHalf:
+            bytes = 2;
+            break;
+        case SimpleFloat:
+            bytes = 4;
+            break;
+        case SimpleDouble:
+            bytes = 8;
+            break;
+        default:
+            throw CborError("expected a number");
+    }
+
+    if (_size - _position < 1 + bytes)
+    {
+        throw CborError("truncated number");
+    }
+
+    uint64_t bits = 0;
+    for (std::size_t i = 1; i <= bytes; ++i)
+    {
+        bits = (bits << 8) | _data[_position + i];
+    }
+    _position += 1 + bytes;
+
+    if (bytes == 2)
+    {
+        return half_to_double(static_cast<uint16_t>(bits));
+    }
+    else if (bytes == 4)
+    {
+        const uint32_t bits32 = static_cast<uint32_t>(bits);
+        float value;
+        std::memcpy(&value, &bits32, sizeof(value));
+        return value;
+    }
+
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//==============================================================================
+std::string CborReader::read_text()
+{
+    const std::pair<const char*, std::size_t> text = read_string_view(CborType::TEXT);
+    return std::string(text.first, text.second);
+}
+
+//==============================================================================
+std::string CborReader::read_bytes()
+{
+    const std::pair<const char*, std::size_t> bytes = read_bytes_view();
+    return std::string(bytes.first, bytes.second);
+}
+
+//==============================================================================
+std::size_t CborReader::read_array_header()
+{
+    const uint64_t count = read_head(CborType::ARRAY);
+
+    // Every item takes at least one byte.
+    if (count > _size - _position)
+    {
+        throw CborError("array longer than the message");
+    }
+    return static_cast<std::size_t>(count);
+}
+
+//==============================================================================
+std::size_t CborReader::read_map_header()
+{
+    const uint64_t count = read_head(CborType::MAP);
+
+    // Every pair takes at least two bytes.
+    if (count > (_size - _position) / 2)
+    {
+        throw CborError("map longer than the message");
+    }
+    return static_cast<std::size_t>(count);
+}
+
+//==============================================================================
+uint64_t CborReader::read_tag()
+{
+    return read_head(CborType::TAG);
+}
+
+//==============================================================================
+void CborReader::skip()
+{
+    skip_item(*this, 0);
+}
+
+//==============================================================================
+uint64_t CborReader::read_head(
+        CborType expected)
+{
+    const uint8_t byte = peek_byte();
+    if (static_cast<CborType>(byte >> 5) != expected)
+    {
+        throw CborError("unexpected item of major type " + std::to_string(byte >> 5)
+                      + ", expected " + std::to_string(static_cast<int>(expected)));
+    }
+
+    const uint8_t additional = byte & 0x1F;
+    if (additional < AdditionalUint8)
+    {
+        ++_position;
+        return additional;
+    }
+
+    std::size_t bytes;
+    switch (additional)
+    {
+        case AdditionalUint8:
+            bytes = 1;
+            break;
+        case AdditionalUint16:
+            bytes = 2;
+            break;
+        case AdditionalUint32:
+            bytes = 4;
+            break;
+        case AdditionalUint64:
+            bytes = 8;
+            break;
+        case AdditionalIndefinite:
+            throw CborError("indefinite length items are not supported");
+        default:
+            throw CborError("reserved additional information");
+    }
+
+    if (_size - _position < 1 + bytes)
+    {
+        throw CborError("truncated item");
+    }
+
+    uint64_t value = 0;
+    for (std::size_t i = 1; i <= bytes; ++i)
+    {
+        value = (value << 8) | _data[_position + i];
+    }
+    _position += 1 + bytes;
+
+    return value;
+}
+
+//==============================================================================
+std::pair<const char*, std::size_t> CborReader::read_bytes_view()
+{
+    return read_string_view(CborType::BYTES);
+}
+
+//==============================================================================
+std::pair<const char*, std::size_t> CborReader::read_string_view(
+        CborType expected)
+{
+    const uint64_t length = read_head(expected);
+    if (length > _size - _position)
+    {
+        throw CborError("string longer than the message");
+    }
+
+    const char* begin = reinterpret_cast<const char*>(_data + _position);
+    _position += static_cast<std::size_t>(length);
+
+    return {begin, static_cast<std::size_t>(length)};
+}
+
+//==============================================================================
+uint8_t CborReader::peek_byte() const
+{
+    if (at_end())
+    {
+        throw CborError("unexpected end of message");
+    }
+    return _data[_position];
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,387 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__CBOR_HPP_
+#define _WEBSOCKET_IS_SH__SRC__CBOR_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Exception thrown when a *CBOR* item is malformed or is not of the expected kind.
+ */
+class CborError : public std::runtime_error
+{
+public:
+
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Major types of the *CBOR* data items, as defined by RFC 8949.
+ */
+enum class CborType : uint8_t
+{
+    UNSIGNED = 0,
+    NEGATIVE = 1,
+    BYTES = 2,
+    TEXT = 3,
+    ARRAY = 4,
+    MAP = 5,
+    TAG = 6,
+    SIMPLE = 7  ///< Booleans, null and floating point numbers.
+};
+
+/**
+ * @brief Tags of the little endian typed arrays defined by RFC 8746.
+ *        The big endian tag of each element type is the little endian one minus four.
+ *
+ * @tparam T The element type.
+ */
+template<typename T>
+struct CborTypedArrayTag;
+
+template<> struct CborTypedArrayTag<uint8_t>
+{
+    static constexpr uint64_t value = 64;
+};
+template<> struct CborTypedArrayTag<uint16_t>
+{
+    static constexpr uint64_t value = 69;
+};
+template<> struct CborTypedArrayTag<uint32_t>
+{
+    static constexpr uint64_t value = 70;
+};
+template<> struct CborTypedArrayTag<uint64_t>
+{
+    static constexpr uint64_t value = 71;
+};
+template<> struct CborTypedArrayTag<int8_t>
+{
+    static constexpr uint64_t value = 72;
+};
+template<> struct CborTypedArrayTag<int16_t>
+{
+    static constexpr uint64_t value = 77;
+};
+template<> struct CborTypedArrayTag<int32_t>
+{
+    static constexpr uint64_t value = 78;
+};
+template<> struct CborTypedArrayTag<int64_t>
+{
+    static constexpr uint64_t value = 79;
+};
+template<> struct CborTypedArrayTag<float>
+{
+    static constexpr uint64_t value = 85;
+};
+template<> struct CborTypedArrayTag<double>
+{
+    static constexpr uint64_t value = 86;
+};
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool CborHostIsLittleEndian = false;
+#else
+constexpr bool CborHostIsLittleEndian = true;
+#endif // if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+
+/**
+ * @class CborWriter
+ *        Appends *CBOR* data items to a buffer.
+ *
+ *        Only definite length items are written, and integers and lengths always use
+ *        their shortest encoding.
+ */
+class CborWriter
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] buffer The buffer the items will be appended to.
+     *            It must outlive the writer.
+     */
+    explicit CborWriter(
+            std::string& buffer);
+
+    void write_null();
+
+    void write_bool(
+            bool value);
+
+    void write_uint(
+            uint64_t value);
+
+    void write_int(
+            int64_t value);
+
+    void write_float(
+            float value);
+
+    void write_double(
+            double value);
+
+    void write_text(
+            const std::string& value);
+
+    void write_text(
+            const char* data,
+            std::size_t size);
+
+    void write_bytes(
+            const void* data,
+            std::size_t size);
+
+    /**
+     * @brief Start an array. It must be followed by `size` items.
+     */
+    void begin_array(
+            std::size_t size);
+
+    /**
+     * @brief Start a map. It must be followed by `size` pairs of key and value items.
+     */
+    void begin_map(
+            std::size_t size);
+
+    void write_tag(
+            uint64_t tag);
+
+    /**
+     * @brief Write a packed typed array (RFC 8746) in the byte order of the host,
+     *        so the elements are copied as they are.
+     *
+     * @param[in] values Pointer to the first element.
+     *
+     * @param[in] count Number of elements.
+     */
+    template<typename T>
+    void write_typed_array(
+            const T* values,
+            std::size_t count)
+    {
+        write_tag(CborHostIsLittleEndian || sizeof(T) == 1 ?
+                CborTypedArrayTag<T>::value : CborTypedArrayTag<T>::value - 4);
+        write_bytes(values, count * sizeof(T));
+    }
+
+private:
+
+    void write_head(
+            CborType type,
+            uint64_t value);
+
+    std::string& _buffer;
+};
+
+/**
+ * @class CborReader
+ *        Reads *CBOR* data items from a buffer, one after another.
+ *
+ *        Indefinite length items are not supported. Every method throws a CborError
+ *        if the next item is malformed or is not of the requested kind.
+ */
+class CborReader
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] data The buffer to read. It must outlive the reader.
+     *
+     * @param[in] size The size of the buffer.
+     *
+     * @param[in] position The offset of the first item to read.
+     */
+    CborReader(
+            const char* data,
+            std::size_t size,
+            std::size_t position = 0);
+
+    /**
+     * @brief Offset of the next item in the buffer.
+     */
+    std::size_t position() const
+    {
+        return _position;
+    }
+
+    bool at_end() const
+    {
+        return _position >= _size;
+    }
+
+    CborType peek_type() const;
+
+    bool is_null() const;
+
+    void read_null();
+
+    bool read_bool();
+
+    uint64_t read_uint();
+
+    int64_t read_int();
+
+    /**
+     * @brief Read a floating point number of any precision, or an integer.
+     */
+    double read_double();
+
+    std::string read_text();
+
+    std::string read_bytes();
+
+    std::size_t read_array_header();
+
+    std::size_t read_map_header();
+
+    uint64_t read_tag();
+
+    /**
+     * @brief Skip the next item, including all of its nested items.
+     */
+    void skip();
+
+    /**
+     * @brief Read a sequence of numbers, written either as a typed array (RFC 8746) of the same
+     *        element type, as a byte string if the elements are bytes, or as an array of numbers.
+     *
+     * @param[out] values The numbers read.
+     */
+    template<typename T>
+    void read_numbers(
+            std::vector<T>& values)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only numbers can be read");
+
+        const CborType type = peek_type();
+        if (type == CborType::TAG || (type == CborType::BYTES && sizeof(T) == 1))
+        {
+            bool swap = false;
+            if (type == CborType::TAG)
+            {
+                const uint64_t tag = read_tag();
+                if (tag == CborTypedArrayTag<T>::value - 4 && sizeof(T) > 1)
+                {
+                    swap = CborHostIsLittleEndian;
+                }
+                else if (tag == CborTypedArrayTag<T>::value)
+                {
+                    swap = !CborHostIsLittleEndian && sizeof(T) > 1;
+                }
+                else
+                {
+                    throw CborError("unexpected typed array tag " + std::to_string(tag));
+                }
+            }
+
+            const std::pair<const char*, std::size_t> bytes = read_bytes_view();
+            if (bytes.second % sizeof(T) != 0)
+            {
+                throw CborError("typed array length is not a multiple of its element size");
+            }
+
+            values.resize(bytes.second / sizeof(T));
+            if (!values.empty())
+            {
+                std::memcpy(values.data(), bytes.first, bytes.second);
+            }
+
+            if (swap)
+            {
+                for (T& value : values)
+                {
+                    char* raw = reinterpret_cast<char*>(&value);
+                    for (std::size_t i = 0; i < sizeof(T) / 2; ++i)
+                    {
+                        std::swap(raw[i], raw[sizeof(T) - 1 - i]);
+                    }
+                }
+            }
+            return;
+        }
+
+        const std::size_t count = read_array_header();
+        values.resize(count);
+        for (T& value : values)
+        {
+            value = read_number<T>();
+        }
+    }
+
+private:
+
+    template<typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, T>::type read_number()
+    {
+        return static_cast<T>(read_double());
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_same<T, bool>::value, T>::type read_number()
+    {
+        return read_bool();
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, T>::type read_number()
+    {
+        return std::is_signed<T>::value ? static_cast<T>(read_int()) : static_cast<T>(read_uint());
+    }
+
+    /**
+     * @brief Read the head of the next item.
+     *
+     * @returns The argument of the head, that is, the value, length or count it carries.
+     */
+    uint64_t read_head(
+            CborType expected);
+
+    std::pair<const char*, std::size_t> read_bytes_view();
+
+    std::pair<const char*, std::size_t> read_string_view(
+            CborType expected);
+
+    uint8_t peek_byte() const;
+
+    const uint8_t* _data;
+    std::size_t _size;
+    std::size_t _position;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__CBOR_HPP_
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Cdr.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+CdrWriter::CdrWriter(
+        std::string& buffer)
+    : _buffer(buffer)
+    , _origin(buffer.size())
+{
+    // Do nothing
+}
+
+//==============================================================================
+void CdrWriter::write_bool(
+        bool value)
+{
+    _buffer.push_back(value ? 1 : 0);
+}
+
+//==============================================================================
+void CdrWriter::write_string(
+        const std::string& value)
+{
+    write(static_cast<uint32_t>(value.size() + 1));
+    _buffer.append(value.data(), value.size());
+    _buffer.push_back('\0');
+}
+
+//==============================================================================
+void CdrWriter::align(
+        std::size_t alignment)
+{
+    const std::size_t offset = (_buffer.size() - _origin) % alignment;
+    if (offset != 0)
+    {
+        _buffer.append(alignment - offset, '\0');
+    }
+}
+
+//==============================================================================
+CdrReader::CdrReader(
+        const char* data,
+        std::size_t size,
+        bool little_endian)
+    : _data(data)
+    , _size(size)
+    , _position(0)
+    , _swap(little_endian != CdrHostIsLittleEndian)
+{
+    // Do nothing
+}
+
+//==============================================================================
+bool CdrReader::read_bool()
+{
+    require(1);
+    return _data[_position++] != 0;
+}
+
+//==============================================================================
+std::string CdrReader::read_string()
+{
+    const uint32_t length = read<uint32_t>();
+    if (length == 0)
+    {
+        // Some implementations write empty strings without the null character.
+        return std::string();
+    }
+
+    require(length);
+    if (_data[_position + length - 1] != '\0')
+    {
+        throw CdrError("string is not null terminated");
+    }
+
+    std::string value(_data + _position, length - 1);
+    _position += length;
+    return value;
+}
+
+//==============================================================================
+void CdrReader::align(
+        std::size_t alignment)
+{
+    const std::size_t offset = _position % alignment;
+    if (offset != 0)
+    {
+        require(alignment - offset);
+        _position += alignment - offset;
+    }
+}
+
+//==============================================================================
+void CdrReader::require(
+        std::size_t size) const
+{
+    if (size > _size - _position)
+    {
+        throw CdrError("unexpected end of stream");
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__CDR_HPP_
+#define _WEBSOCKET_IS_SH__SRC__CDR_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Exception thrown when a *CDR* stream is truncated or malformed.
+ */
+class CdrError : public std::runtime_error
+{
+public:
+
+    using std::runtime_error::runtime_error;
+};
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool CdrHostIsLittleEndian = false;
+#else
+constexpr bool CdrHostIsLittleEndian = true;
+#endif // if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+
+/**
+ * @brief Alignment of a primitive within a version 1 *XCDR* stream: its own size, up to 8 bytes.
+ */
+template<typename T>
+constexpr std::size_t cdr_alignment()
+{
+    return sizeof(T) < 8 ? sizeof(T) : 8;
+}
+
+/**
+ * @class CdrWriter
+ *        Appends primitives to a buffer following the version 1 *XCDR* rules,
+ *        in the byte order of the host.
+ *
+ *        Alignment is relative to the position of the buffer when the writer was created.
+ */
+class CdrWriter
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] buffer The buffer the stream will be appended to.
+     *            It must outlive the writer.
+     */
+    explicit CdrWriter(
+            std::string& buffer);
+
+    template<typename T>
+    void write(
+            T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only primitives can be written");
+
+        align(cdr_alignment<T>());
+        _buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write_bool(
+            bool value);
+
+    /**
+     * @brief Write a string as its length, including the terminating null character,
+     *        followed by its characters and the null character.
+     */
+    void write_string(
+            const std::string& value);
+
+    /**
+     * @brief Write a contiguous block of primitives, aligned as its first element.
+     */
+    template<typename T>
+    void write_array(
+            const T* values,
+            std::size_t count)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only primitives can be written");
+
+        align(cdr_alignment<T>());
+        _buffer.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+    }
+
+private:
+
+    void align(
+            std::size_t alignment);
+
+    std::string& _buffer;
+    const std::size_t _origin;
+};
+
+/**
+ * @class CdrReader
+ *        Reads primitives from a version 1 *XCDR* stream, written in either byte order.
+ *        Every method throws a CdrError if the stream is truncated.
+ */
+class CdrReader
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] data The stream to read. It must outlive the reader.
+     *
+     * @param[in] size The size of the stream.
+     *
+     * @param[in] little_endian Whether the stream was written in little endian byte order.
+     */
+    CdrReader(
+            const char* data,
+            std::size_t size,
+            bool little_endian);
+
+    template<typename T>
+    T read()
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only primitives can be read");
+
+        align(cdr_alignment<T>());
+        require(sizeof(T));
+
+        T value;
+        std::memcpy(&value, _data + _position, sizeof(T));
+        _position += sizeof(T);
+
+        if (_swap)
+        {
+            swap_bytes(value);
+        }
+        return value;
+    }
+
+    bool read_bool();
+
+    std::string read_string();
+
+    /**
+     * @brief Read a contiguous block of primitives.
+     *
+     * @param[out] values The primitives read.
+     *
+     * @param[in] count The number of primitives to read.
+     */
+    template<typename T>
+    void read_array(
+            std::vector<T>& values,
+            std::size_t count)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only primitives can be read");
+
+        align(cdr_alignment<T>());
+        if (count > (_size - _position) / sizeof(T))
+        {
+            throw CdrError("truncated array of " + std::to_string(count) + " elements");
+        }
+
+        values.resize(count);
+        if (count > 0)
+        {
+            std::memcpy(values.data(), _data + _position, count * sizeof(T));
+        }
+        _position += count * sizeof(T);
+
+        if (_swap)
+        {
+            for (T& value : values)
+            {
+                swap_bytes(value);
+            }
+        }
+    }
+
+    /**
+     * @brief Number of bytes left in the stream.
+     */
+    std::size_t remaining() const
+    {
+        return _size - _position;
+    }
+
+private:
+
+    template<typename T>
+    static void swap_bytes(
+            T& value)
+    {
+        char* raw = reinterpret_cast<char*>(&value);
+        for (std::size_t i = 0; i < sizeof(T) / 2; ++i)
+        {
+            std::swap(raw[i], raw[sizeof(T) - 1 - i]);
+        }
+    }
+
+    void align(
+            std::size_t alignment);
+
+    void require(
+            std::size_t size) const;
+
+    const char* _data;
+    std::size_t _size;
+    std::size_t _position;
+    bool _swap;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__CDR_HPP_
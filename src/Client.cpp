@@ -16,7 +16,8 @@
  *
  */
 
-#include "Endpoint.hpp"
+#include "TransportEndpoint.hpp"
+#include "TransportSelector.hpp"
 
 #include <is/core/runtime/Search.hpp>
 
@@ -67,13 +68,24 @@ std::string parse_hostname(
  *        response.
  *
  *        It implements some of the Endpoint class methods.
+ *
+ * @tparam Config The *websocketpp* configuration, either `TlsConfig` or `TcpConfig`.
  */
-class Client : public Endpoint
+template<typename Config>
+class Client : public TransportEndpoint<Config>
 {
 public:
 
+    using Base = TransportEndpoint<Config>;
+    using typename Base::ConnectionPtr;
+    using typename Base::ConfigMessagePtr;
+    using WebsocketClient = websocketpp::client<Config>;
+
+    using Base::Secure;
+    using Base::TransportName;
+
     Client()
-        : Endpoint("is::sh::WebSocket::Client")
+        : Base("is::sh::WebSocket::Client")
         , _host_uri("<undefined>")
         , _closing_down(false)
         , _connection_failed(false)
@@ -81,16 +93,24 @@ public:
         // Do nothing
     }
 
-    TlsEndpoint* configure_tls_endpoint(
+    bool configure_endpoint(
             const core::RequiredTypes& /*types*/,
             const YAML::Node& configuration) override
     {
-        _use_security = true;
-        _tls_client = std::make_shared<TlsClient>(TlsClient());
-        const int32_t port = parse_port(configuration);
+        _logger << utils::Logger::Level::INFO
+                << "Security " << (Secure ? "enabled" : "disabled") << ", creating "
+                << TransportName << " endpoint..." << std::endl;
+
+        _client = std::make_shared<WebsocketClient>();
+        const int32_t port = this->parse_port(configuration);
         if (port < 0)
         {
-            return nullptr;
+            return false;
+        }
+
+        if (!this->configure_outbound_queue(configuration))
+        {
+            return false;
         }
 
         const std::string hostname = parse_hostname(configuration);
@@ -103,6 +123,11 @@ public:
         const std::vector<std::string> extra_ca = [&]()
                 {
                     std::vector<std::string> _extra_ca;
+                    if (!Secure)
+                    {
+                        return _extra_ca;
+                    }
+
                     const YAML::Node cert_authorities_node =
                             configuration[YamlCertAuthoritiesKey];
                     for (const auto node : cert_authorities_node)
@@ -117,55 +142,19 @@ public:
         if (!configure_client(hostname, static_cast<uint16_t>(port), extra_ca))
         {
             _logger << utils::Logger::Level::ERROR
-                    << "The TLS endpoint '" << hostname << ":" << port
+                    << "The " << TransportName << " endpoint '" << hostname << ":" << port
                     << "' could not be configured" << std::endl;
 
-            return nullptr;
-        }
-        else
-        {
-            _logger << utils::Logger::Level::INFO
-                    << "Configured TLS endpoint '" << hostname << ":" << port << "'" << std::endl;
-        }
-
-        return _tls_client.get();
-    }
-
-    TcpEndpoint* configure_tcp_endpoint(
-            const core::RequiredTypes& /*types*/,
-            const YAML::Node& configuration) override
-    {
-        _use_security = false;
-        _tcp_client = std::make_shared<TcpClient>(TcpClient());
-        const int32_t port = parse_port(configuration);
-        if (port < 0)
-        {
-            return nullptr;
-        }
-
-        const std::string hostname = parse_hostname(configuration);
-
-        const YAML::Node auth_node = configuration[YamlAuthKey];
-        if (auth_node)
-        {
-            _load_auth_config(auth_node);
-        }
-
-        if (!configure_client(hostname, static_cast<uint16_t>(port), std::vector<std::string>()))
-        {
-            _logger << utils::Logger::Level::ERROR
-                    << "The TCP endpoint '" << hostname << ":" << port
-                    << "' could not be configured" << std::endl;
-
-            return nullptr;
+            return false;
         }
         else
         {
             _logger << utils::Logger::Level::INFO
-                    << "Configured TCP endpoint '" << hostname << ":" << port << "'" << std::endl;
+                    << "Configured " << TransportName << " endpoint '"
+                    << hostname << ":" << port << "'" << std::endl;
         }
 
-        return _tcp_client.get();
+        return true;
     }
 
     bool configure_client(
@@ -173,7 +162,7 @@ public:
             const uint16_t port,
             const std::vector<std::string>& extra_certificate_authorities)
     {
-        std::string uri_prefix = (_use_security) ? WebsocketTlsUriPrefix : WebsocketTcpUriPrefix;
+        std::string uri_prefix = Secure ? WebsocketTlsUriPrefix : WebsocketTcpUriPrefix;
         _host_uri = uri_prefix + hostname + ":" + std::to_string(port);
 
         _context = std::make_shared<SslContext>(
@@ -262,116 +251,57 @@ public:
             return false;
         }
 
-        if (_use_security)
-        {
-            _logger << utils::Logger::Level::DEBUG
-                    << "Initializing TLS client" << std::endl;
-
-            initialize_tls_client();
-        }
-        else
-        {
-            _logger << utils::Logger::Level::DEBUG
-                    << "Initializing TCP client" << std::endl;
+        _logger << utils::Logger::Level::DEBUG
+                << "Initializing " << TransportName << " client" << std::endl;
 
-            initialize_tcp_client();
-        }
+        initialize_client();
 
         return true;
     }
 
-    void initialize_tls_client()
+    void initialize_client()
     {
-        _tls_client->clear_access_channels(
+        _client->clear_access_channels(
             websocketpp::log::alevel::frame_header |
             websocketpp::log::alevel::frame_payload);
 
-        _tls_client->init_asio();
-        _tls_client->start_perpetual();
+        _client->init_asio();
+        _client->start_perpetual();
 
-        _tls_client->set_message_handler(
-            [&](ConnectionHandlePtr handle, TlsMessagePtr message)
+        _client->set_message_handler(
+            [&](ConnectionHandlePtr handle, ConfigMessagePtr message)
             {
-                this->_handle_tls_message(std::move(handle), std::move(message));
+                this->_handle_message(std::move(handle), std::move(message));
             });
 
-        _tls_client->set_close_handler(
+        _client->set_close_handler(
             [&](ConnectionHandlePtr handle)
             {
                 this->_handle_close(std::move(handle));
             });
 
-        _tls_client->set_open_handler(
+        _client->set_open_handler(
             [&](ConnectionHandlePtr handle)
             {
                 this->_handle_opening(std::move(handle));
             });
 
-        _tls_client->set_fail_handler(
+        _client->set_fail_handler(
             [&](ConnectionHandlePtr handle)
             {
                 this->_handle_failed_connection(std::move(handle));
             });
 
-        _tls_client->set_tls_init_handler(
-            [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-            {
-                return this->_context;
-            });
-
-        _tls_client->set_socket_init_handler(
-            [&](ConnectionHandlePtr handle, auto& /*sock*/)
-            {
-                this->_handle_socket_init(std::move(handle));
-            });
-
-        _client_thread = std::thread(
-            [&]()
-            {
-                this->_tls_client->run();
-            });
-    }
-
-    void initialize_tcp_client()
-    {
-        _tcp_client->clear_access_channels(
-            websocketpp::log::alevel::frame_header |
-            websocketpp::log::alevel::frame_payload);
-
-        _tcp_client->init_asio();
-        _tcp_client->start_perpetual();
-
-        _tcp_client->set_message_handler(
-            [&](ConnectionHandlePtr handle, TcpMessagePtr message)
-            {
-                this->_handle_tcp_message(std::move(handle), std::move(message));
-            });
-
-        _tcp_client->set_close_handler(
-            [&](ConnectionHandlePtr handle)
-            {
-                this->_handle_close(std::move(handle));
-            });
-
-        _tcp_client->set_open_handler(
-            [&](ConnectionHandlePtr handle)
-            {
-                this->_handle_opening(std::move(handle));
-            });
-
-        _tcp_client->set_fail_handler(
-            [&](ConnectionHandlePtr handle)
-            {
-                this->_handle_failed_connection(std::move(handle));
-            });
-
-        _tcp_client->set_tcp_init_handler(
-            [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-            {
-                return this->_context;
-            });
+        if constexpr (Secure)
+        {
+            _client->set_tls_init_handler(
+                [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
+                {
+                    return this->_context;
+                });
+        }
 
-        _tcp_client->set_socket_init_handler(
+        _client->set_socket_init_handler(
             [&](ConnectionHandlePtr handle, auto& /*sock*/)
             {
                 this->_handle_socket_init(std::move(handle));
@@ -380,7 +310,7 @@ public:
         _client_thread = std::thread(
             [&]()
             {
-                this->_tcp_client->run();
+                this->_client->run();
             });
     }
 
@@ -388,38 +318,15 @@ public:
     {
         _closing_down = true;
 
-        if (_use_security && _tls_connection && _tls_connection->get_state() == websocketpp::session::state::open)
-        {
-            _tls_connection->close(websocketpp::close::status::normal, "shutdown");
-
-            // TODO(MXG) Make these timeout parameters something that can be
-            // configured by users
-            using namespace std::chrono_literals;
-            const auto start_time = std::chrono::steady_clock::now();
-            while (_tls_connection->get_state() != websocketpp::session::state::closed)
-            {
-                // Check for an update every 1/5 of a second
-                std::this_thread::sleep_for(200ms);
-
-                // Wait no more than 10 seconds total.
-                if (std::chrono::steady_clock::now() - start_time > 10s)
-                {
-                    _logger << utils::Logger::Level::WARN
-                            << " Timed out while waiting for the remote server to "
-                            << "acknowledge the connection shutdown request" << std::endl;
-                    break;
-                }
-            }
-        }
-        else if (!_use_security && _tcp_connection && _tcp_connection->get_state() == websocketpp::session::state::open)
+        if (_connection && _connection->get_state() == websocketpp::session::state::open)
         {
-            _tcp_connection->close(websocketpp::close::status::normal, "shutdown");
+            _connection->close(websocketpp::close::status::normal, "shutdown");
 
             // TODO(MXG) Make these timeout parameters something that can be
             // configured by users
             using namespace std::chrono_literals;
             const auto start_time = std::chrono::steady_clock::now();
-            while (_tcp_connection->get_state() != websocketpp::session::state::closed)
+            while (_connection->get_state() != websocketpp::session::state::closed)
             {
                 // Check for an update every 1/5 of a second
                 std::this_thread::sleep_for(200ms);
@@ -437,31 +344,21 @@ public:
 
         if (_client_thread.joinable())
         {
-            if (_use_security)
-            {
-                _tls_client->stop_perpetual();
-                _tls_client->stop();
-            }
-            else
-            {
-                _tcp_client->stop_perpetual();
-                _tcp_client->stop();
-            }
+            _client->stop_perpetual();
+            _client->stop();
             _client_thread.join();
         }
     }
 
     bool okay() const override
     {
-        return (_use_security) ? (_tls_connection != nullptr) : (_tcp_connection != nullptr);
+        return _connection != nullptr;
     }
 
     bool spin_once() override
     {
-        const bool attempt_reconnect = ((_use_security && !_tls_connection) ||
-                (!_use_security && !_tcp_connection) || (_use_security &&
-                _tls_connection->get_state() == websocketpp::session::state::closed)
-                || (!_use_security && _tcp_connection->get_state() == websocketpp::session::state::closed))
+        const bool attempt_reconnect =
+                (!_connection || _connection->get_state() == websocketpp::session::state::closed)
                 && (std::chrono::steady_clock::now() - _last_connection_attempt > 2s);
 
         if (!_has_spun_once || attempt_reconnect)
@@ -469,14 +366,7 @@ public:
             _has_spun_once = true;
 
             websocketpp::lib::error_code ec;
-            if (_use_security)
-            {
-                _tls_connection = _tls_client->get_connection(_host_uri, ec);
-            }
-            else
-            {
-                _tcp_connection = _tcp_client->get_connection(_host_uri, ec);
-            }
+            _connection = _client->get_connection(_host_uri, ec);
 
             if (ec)
             {
@@ -485,29 +375,26 @@ public:
             }
             else
             {
-                _logger << utils::Logger::Level::DEBUG;
-                _logger << (_has_spun_once ? "Re" : "") << "connecting with ";
+                _request_encoding();
 
-                if (_use_security)
-                {
-                    _logger << "TLS";
-                    _tls_client->connect(_tls_connection);
-                }
-                else
-                {
-                    _logger << "TCP";
-                    _tcp_client->connect(_tcp_connection);
-                }
+                _logger << utils::Logger::Level::DEBUG
+                        << (_has_spun_once ? "Re" : "") << "connecting with "
+                        << TransportName << " client" << std::endl;
 
-                _logger << " client" << std::endl;
+                _client->connect(_connection);
             }
 
             _last_connection_attempt = std::chrono::steady_clock::now();
         }
 
+        this->flush_outbound_queues();
+        this->report_publication_drops();
+        this->report_input_errors();
+        this->evict_expired_fragments();
+
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
-        return (_use_security) ? (_tls_connection != nullptr) : (_tcp_connection != nullptr);
+        return _connection != nullptr;
     }
 
     void runtime_advertisement(
@@ -516,150 +403,89 @@ public:
             const std::string& id,
             const YAML::Node& configuration) override
     {
-        if (_use_security && _tls_connection)
+        if (_connection)
         {
-            _tls_connection->send(
-                get_encoding().encode_advertise_msg(
-                    topic, message_type.name(), id, configuration));
-        }
-        else if (!_use_security && _tcp_connection)
-        {
-            _tcp_connection->send(
-                get_encoding().encode_advertise_msg(
-                    topic, message_type.name(), id, configuration));
+            _connection->send(
+                this->get_encoding().encode_advertise_msg(
+                    topic, message_type.name(), id, configuration),
+                this->frame_opcode(this->get_encoding()));
         }
     }
 
 private:
 
-    void _handle_tls_message(
-            const ConnectionHandlePtr& handle,
-            const TlsMessagePtr& message)
-    {
-        auto incoming_handle = _tls_client->get_con_from_hdl(handle);
-        if (incoming_handle != _tls_connection)
-        {
-            _logger << utils::Logger::Level::ERROR
-                    << "Handle TLS message: unexpected connection is sending messages: '"
-                    << incoming_handle.get() << "' vs '" << _tls_connection.get() << "'" << std::endl;
-            return;
-        }
-        else
-        {
-            _logger << utils::Logger::Level::INFO
-                    << "Handle TLS message from connection '" << _tls_connection.get() << "': [[ "
-                    << message->get_payload() << " ]]" << std::endl;
-        }
-
-        get_encoding().interpret_websocket_msg(
-            message->get_payload(), *this, _tls_connection);
-    }
+    using Base::_logger;
+    using Base::to_connection;
 
-    void _handle_tcp_message(
+    void _handle_message(
             const ConnectionHandlePtr& handle,
-            const TcpMessagePtr& message)
+            const ConfigMessagePtr& message)
     {
-        auto incoming_handle = _tcp_client->get_con_from_hdl(handle);
-        if (incoming_handle != _tcp_connection)
+        auto incoming_handle = to_connection(handle);
+        if (incoming_handle != _connection)
         {
             _logger << utils::Logger::Level::ERROR
-                    << "Handle TCP message: unexpected connection is sending messages: '"
-                    << incoming_handle.get() << "' vs '" << _tcp_connection.get() << "'" << std::endl;
+                    << "Handle " << TransportName << " message: unexpected connection is sending messages: '"
+                    << incoming_handle.get() << "' vs '" << _connection.get() << "'" << std::endl;
             return;
         }
-        else
-        {
-            _logger << utils::Logger::Level::INFO
-                    << "Handle TCP message from connection '" << _tcp_connection.get() << "': [[ "
-                    << message->get_payload() << " ]]" << std::endl;
-        }
 
-        get_encoding().interpret_websocket_msg(
-            message->get_payload(), *this, _tcp_connection);
+        IS_WEBSOCKET_LOG(_logger, TRACE)
+            << "Handle " << TransportName << " message from connection '"
+            << _connection.get() << "': [[ " << message->get_payload() << " ]]" << std::endl;
+
+        this->get_encoding().interpret_websocket_msg(
+            message->get_payload(), *this, _connection);
     }
 
     void _handle_close(
             const ConnectionHandlePtr& handle)
     {
-        if (_use_security)
-        {
-            auto closing_connection = _tls_client->get_con_from_hdl(handle);
+        auto closing_connection = to_connection(handle);
 
-            if (_closing_down)
-            {
-                _logger << utils::Logger::Level::INFO << "Closing connection to server." << std::endl;
-            }
-            else
-            {
-                _logger << utils::Logger::Level::WARN
-                        << "The connection to the server is closing early. [code "
-                        << closing_connection->get_remote_close_code() << "] reason: "
-                        << closing_connection->get_remote_close_reason() << std::endl;
-            }
-
-            notify_connection_closed(closing_connection);
+        if (_closing_down)
+        {
+            _logger << utils::Logger::Level::INFO << "Closing connection to server." << std::endl;
         }
         else
         {
-            auto closing_connection = _tcp_client->get_con_from_hdl(handle);
-
-            if (_closing_down)
-            {
-                _logger << utils::Logger::Level::INFO << "Closing connection to server." << std::endl;
-            }
-            else
-            {
-                _logger << utils::Logger::Level::WARN
-                        << "The connection to the server is closing early. [code "
-                        << closing_connection->get_remote_close_code() << "] reason: "
-                        << closing_connection->get_remote_close_reason() << std::endl;
-            }
-
-            notify_connection_closed(closing_connection);
+            _logger << utils::Logger::Level::WARN
+                    << "The connection to the server is closing early. [code "
+                    << closing_connection->get_remote_close_code() << "] reason: "
+                    << closing_connection->get_remote_close_reason() << std::endl;
         }
+
+        this->notify_connection_closed(closing_connection);
     }
 
     void _handle_opening(
             const ConnectionHandlePtr& handle)
     {
-        if (_use_security)
+        auto opened_connection = to_connection(handle);
+        if (opened_connection != _connection)
         {
-            auto opened_connection = _tls_client->get_con_from_hdl(handle);
-            if (opened_connection != _tls_connection)
-            {
-                _logger << utils::Logger::Level::ERROR
-                        << "Handle opening: unexpected TLS connection opened: '"
-                        << opened_connection.get() << "' vs expected '"
-                        << _tls_connection.get() << "'" << std::endl;
-                return;
-            }
-
-            _connection_failed = false;
-            _logger << utils::Logger::Level::INFO
-                    << "Handle opening: established TLS connection to host '"
-                    << _host_uri << "'." << std::endl;
-
-            notify_connection_opened(opened_connection);
+            _logger << utils::Logger::Level::ERROR
+                    << "Handle opening: unexpected " << TransportName << " connection opened: '"
+                    << opened_connection.get() << "' vs expected '"
+                    << _connection.get() << "'" << std::endl;
+            return;
         }
-        else
-        {
-            auto opened_connection = _tcp_client->get_con_from_hdl(handle);
-            if (opened_connection != _tcp_connection)
-            {
-                _logger << utils::Logger::Level::ERROR
-                        << "Handle opening: unexpected TCP connection opened: '"
-                        << opened_connection.get() << "' vs expected '"
-                        << _tcp_connection.get() << "'" << std::endl;
-                return;
-            }
 
-            _connection_failed = false;
-            _logger << utils::Logger::Level::INFO
-                    << "Handle opening: established TCP connection to host '"
-                    << _host_uri << "'." << std::endl;
+        _connection_failed = false;
+        _logger << utils::Logger::Level::INFO
+                << "Handle opening: established " << TransportName << " connection to host '"
+                << _host_uri << "'." << std::endl;
 
-            notify_connection_opened(opened_connection);
+        const std::string& encoding = this->get_encoding_name();
+        if (encoding != YamlEncoding_Json && opened_connection->get_subprotocol() != encoding)
+        {
+            _logger << utils::Logger::Level::WARN
+                    << "The host '" << _host_uri << "' did not accept the " << encoding
+                    << " encoding. Unless it is its default encoding, it will reject our messages"
+                    << std::endl;
         }
+
+        this->notify_connection_opened(opened_connection);
     }
 
     void _handle_failed_connection(
@@ -675,6 +501,25 @@ private:
         }
     }
 
+    void _request_encoding()
+    {
+        // Servers use their default encoding with clients that request none, which is json
+        // for every server that does not negotiate it, so only the other encodings are requested.
+        const std::string& encoding = this->get_encoding_name();
+        if (encoding == YamlEncoding_Json)
+        {
+            return;
+        }
+
+        websocketpp::lib::error_code ec;
+        _connection->add_subprotocol(encoding, ec);
+        if (ec)
+        {
+            _logger << utils::Logger::Level::ERROR
+                    << "Failed to request the " << encoding << " encoding: " << ec.message() << std::endl;
+        }
+    }
+
     void _handle_socket_init(
             const ConnectionHandlePtr& handle)
     {
@@ -683,16 +528,7 @@ private:
             // Compose the authorization header
             std::string header = AuthMethod + ' ' + *_jwt_token;
 
-            if (_use_security)
-            {
-                auto connection = _tls_client->get_con_from_hdl(handle);
-                connection->append_header(AuthHeader, header);
-            }
-            else
-            {
-                auto connection = _tcp_client->get_con_from_hdl(handle);
-                connection->append_header(AuthHeader, header);
-            }
+            to_connection(handle)->append_header(AuthHeader, header);
         }
     }
 
@@ -710,11 +546,8 @@ private:
     }
 
     std::string _host_uri;
-    TlsConnectionPtr _tls_connection;
-    TcpConnectionPtr _tcp_connection;
-    std::shared_ptr<TlsClient> _tls_client;
-    std::shared_ptr<TcpClient> _tcp_client;
-    bool _use_security;
+    ConnectionPtr _connection;
+    std::shared_ptr<WebsocketClient> _client;
     std::thread _client_thread;
     std::chrono::steady_clock::time_point _last_connection_attempt;
     bool _has_spun_once = false;
@@ -725,7 +558,9 @@ private:
 
 };
 
-IS_REGISTER_SYSTEM("websocket_client", is::sh::websocket::Client)
+using ClientSystem = TransportSelector<Client>;
+
+IS_REGISTER_SYSTEM("websocket_client", is::sh::websocket::ClientSystem)
 
 } //  namespace websocket
 } //  namespace sh
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "CodecPlan.hpp"
+
+#include "JsonData.hpp"
+#include "JsonWriter.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+//==============================================================================
+const xtypes::DynamicType& resolve_alias(
+        const xtypes::DynamicType& type)
+{
+    if (type.kind() == xtypes::TypeKind::ALIAS_TYPE)
+    {
+        return static_cast<const xtypes::AliasType&>(type).rget();
+    }
+    return type;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::unique_ptr<CodecPlan> CodecPlan::compile(
+        const xtypes::DynamicType& type)
+{
+    const xtypes::DynamicType& resolved = resolve_alias(type);
+    if (resolved.kind() != xtypes::TypeKind::STRUCTURE_TYPE)
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<CodecPlan>(
+        new CodecPlan(static_cast<const xtypes::StructType&>(resolved)));
+}
+
+//==============================================================================
+const CodecField* CodecPlan::find(
+        const std::string& name,
+        std::size_t hint) const
+{
+    if (hint < _fields.size() && _fields[hint].name == name)
+    {
+        return &_fields[hint];
+    }
+
+    auto it = std::lower_bound(_by_name.begin(), _by_name.end(), name,
+        [this](std::size_t index, const std::string& key)
+        {
+            return _fields[index].name < key;
+        });
+    if (it == _by_name.end() || _fields[*it].name != name)
+    {
+        return nullptr;
+    }
+    return &_fields[*it];
+}
+
+//==============================================================================
+CodecPlan::CodecPlan(
+        const xtypes::StructType& type)
+    : _json_size(estimate_json_size(type))
+{
+    const std::vector<xtypes::Member>& members = type.members();
+    _fields.reserve(members.size());
+
+    for (std::size_t i = 0; i < members.size(); ++i)
+    {
+        const xtypes::DynamicType& member_type = resolve_alias(members[i].type());
+
+        CodecField field;
+        field.name = members[i].name();
+        field.index = i;
+        field.kind = member_type.kind();
+        field.element_kind = xtypes::TypeKind::NO_TYPE;
+        field.bounds = 0;
+        field.plan = nullptr;
+
+        JsonWriter key_writer(field.json_key);
+        key_writer.key(field.name);
+
+        std::unique_ptr<CodecPlan> nested;
+        if (field.kind == xtypes::TypeKind::ARRAY_TYPE || field.kind == xtypes::TypeKind::SEQUENCE_TYPE)
+        {
+            const xtypes::DynamicType& content = resolve_alias(
+                static_cast<const xtypes::CollectionType&>(member_type).content_type());
+            field.element_kind = content.kind();
+            if (field.kind == xtypes::TypeKind::SEQUENCE_TYPE)
+            {
+                field.bounds = static_cast<const xtypes::SequenceType&>(member_type).bounds();
+            }
+            nested = compile(content);
+        }
+        else
+        {
+            nested = compile(member_type);
+        }
+
+        if (nested)
+        {
+            field.plan = nested.get();
+            _nested.push_back(std::move(nested));
+        }
+
+        _fields.push_back(std::move(field));
+    }
+
+    _by_name.resize(_fields.size());
+    for (std::size_t i = 0; i < _by_name.size(); ++i)
+    {
+        _by_name[i] = i;
+    }
+    std::sort(_by_name.begin(), _by_name.end(),
+        [this](std::size_t a, std::size_t b)
+        {
+            return _fields[a].name < _fields[b].name;
+        });
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
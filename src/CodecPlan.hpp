@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__CODEC_PLAN_HPP_
+#define _WEBSOCKET_IS_SH__SRC__CODEC_PLAN_HPP_
+
+#include <is/core/Message.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xtypes = eprosima::xtypes;
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+class CodecPlan;
+
+/**
+ * @struct CodecField
+ *         A member of a structure, with everything needed to encode or decode it
+ *         worked out in advance.
+ */
+struct CodecField
+{
+    /**
+     * The name of the member.
+     */
+    std::string name;
+
+    /**
+     * The position of the member in its structure, so that it is accessed
+     * by index instead of looking its name up.
+     */
+    std::size_t index;
+
+    /**
+     * The kind of the member, with any alias resolved.
+     */
+    xtypes::TypeKind kind;
+
+    /**
+     * For arrays and sequences, the kind of their elements, with any alias resolved.
+     * `NO_TYPE` for any other member.
+     */
+    xtypes::TypeKind element_kind;
+
+    /**
+     * For sequences, their bounds, or 0 if they are unbounded.
+     */
+    std::size_t bounds;
+
+    /**
+     * The key of the member in *JSON*, already quoted, escaped and followed by the colon.
+     */
+    std::string json_key;
+
+    /**
+     * For structures, and for arrays and sequences of structures, the plan of the structure.
+     * `nullptr` for any other member.
+     */
+    const CodecPlan* plan;
+};
+
+/**
+ * @class CodecPlan
+ *        The flattened layout of a structure type, compiled once when the type is added,
+ *        so that the encodings can encode and decode its instances in a tight loop,
+ *        without walking the type tree, resolving aliases nor looking members up by name.
+ *
+ *        Members of other kinds than numbers, strings, enumerations, structures, and
+ *        arrays or sequences of them, are encoded and decoded walking their type as usual.
+ */
+class CodecPlan
+{
+public:
+
+    /**
+     * @brief Compile the plan of a type.
+     *
+     * @param[in] type The type. It must outlive the plan.
+     *
+     * @returns The plan, or `nullptr` if the type, once its aliases are resolved,
+     *          is not a structure.
+     */
+    static std::unique_ptr<CodecPlan> compile(
+            const xtypes::DynamicType& type);
+
+    /**
+     * @returns The members of the structure, in the order of the type.
+     */
+    const std::vector<CodecField>& fields() const
+    {
+        return _fields;
+    }
+
+    /**
+     * @brief Find a member by its name.
+     *
+     * @param[in] name The name of the member.
+     *
+     * @param[in] hint The index of the member most likely to have that name,
+     *            such as the one after the last member found. It is checked first,
+     *            so members that come in the order of the type are found at once.
+     *
+     * @returns The member, or `nullptr` if the structure has no member with that name.
+     */
+    const CodecField* find(
+            const std::string& name,
+            std::size_t hint) const;
+
+    /**
+     * @returns An estimation of the size of the *JSON* text of an instance,
+     *          so that buffers can be sized before encoding.
+     */
+    std::size_t json_size() const
+    {
+        return _json_size;
+    }
+
+private:
+
+    CodecPlan(
+            const xtypes::StructType& type);
+
+    std::vector<CodecField> _fields;
+
+    /**
+     * Indexes of the fields, sorted by name, to find the members that are out of order.
+     */
+    std::vector<std::size_t> _by_name;
+
+    /**
+     * Plans of the structures nested in this one, owned by it.
+     */
+    std::vector<std::unique_ptr<CodecPlan>> _nested;
+
+    std::size_t _json_size;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__CODEC_PLAN_HPP_
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "DataPool.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+//==============================================================================
+const xtypes::DynamicType& resolve_alias(
+        const xtypes::DynamicType& type)
+{
+    if (type.kind() == xtypes::TypeKind::ALIAS_TYPE)
+    {
+        return static_cast<const xtypes::AliasType&>(type).rget();
+    }
+    return type;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+DataPool::Lease::Lease(
+        DataPool& pool,
+        const xtypes::DynamicType& type,
+        std::unique_ptr<xtypes::DynamicData> data)
+    : _pool(&pool)
+    , _type(&type)
+    , _data(std::move(data))
+{
+    // Do nothing
+}
+
+//==============================================================================
+DataPool::Lease::~Lease()
+{
+    if (_data)
+    {
+        _pool->_release(*_type, std::move(_data));
+    }
+}
+
+//==============================================================================
+DataPool::DataPool(
+        std::size_t max_idle)
+    : _max_idle(max_idle)
+{
+    // Do nothing
+}
+
+//==============================================================================
+DataPool::Lease DataPool::acquire(
+        const xtypes::DynamicType& type)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _idle.find(&type);
+        if (it != _idle.end() && !it->second.empty())
+        {
+            std::unique_ptr<xtypes::DynamicData> data = std::move(it->second.back());
+            it->second.pop_back();
+            return Lease(*this, type, std::move(data));
+        }
+    }
+
+    return Lease(*this, type, std::unique_ptr<xtypes::DynamicData>(new xtypes::DynamicData(type)));
+}
+
+//==============================================================================
+std::size_t DataPool::idle() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::size_t count = 0;
+    for (const auto& instances : _idle)
+    {
+        count += instances.second.size();
+    }
+    return count;
+}
+
+//==============================================================================
+void DataPool::_release(
+        const xtypes::DynamicType& type,
+        std::unique_ptr<xtypes::DynamicData> data)
+{
+    // The instance is reset before taking the lock, so that other threads are not kept waiting.
+    reset_data(*data);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<std::unique_ptr<xtypes::DynamicData>>& instances = _idle[&type];
+    if (instances.size() < _max_idle)
+    {
+        instances.push_back(std::move(data));
+    }
+}
+
+//==============================================================================
+void reset_data(
+        xtypes::WritableDynamicDataRef data)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            data.value(false);
+            break;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            data.value('\0');
+            break;
+        case xtypes::TypeKind::CHAR_16_TYPE:
+            data.value(L'\0');
+            break;
+        case xtypes::TypeKind::INT_8_TYPE:
+            data.value<int8_t>(0);
+            break;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            data.value<uint8_t>(0);
+            break;
+        case xtypes::TypeKind::INT_16_TYPE:
+            data.value<int16_t>(0);
+            break;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            data.value<uint16_t>(0);
+            break;
+        case xtypes::TypeKind::INT_32_TYPE:
+            data.value<int32_t>(0);
+            break;
+        case xtypes::TypeKind::UINT_32_TYPE:
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            data.value<uint32_t>(0);
+            break;
+        case xtypes::TypeKind::INT_64_TYPE:
+            data.value<int64_t>(0);
+            break;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            data.value<uint64_t>(0);
+            break;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            data.value<float>(0);
+            break;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            data.value<double>(0);
+            break;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            data.value<long double>(0);
+            break;
+        case xtypes::TypeKind::STRING_TYPE:
+        {
+            // Assigning a copy of an empty string keeps the capacity of the current one.
+            static const std::string empty;
+            data.value(empty);
+            break;
+        }
+        case xtypes::TypeKind::ARRAY_TYPE:
+            for (std::size_t i = 0; i < data.size(); ++i)
+            {
+                reset_data(data[i]);
+            }
+            break;
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            // Sequences are emptied keeping their storage, and rebuilt if they cannot be shrunk.
+            if (data.size() > 0)
+            {
+                data.resize(0);
+                if (data.size() > 0)
+                {
+                    data = xtypes::DynamicData(data.type());
+                }
+            }
+            break;
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const std::size_t members = static_cast<const xtypes::StructType&>(type).members().size();
+            for (std::size_t i = 0; i < members; ++i)
+            {
+                reset_data(data[i]);
+            }
+            break;
+        }
+        default:
+            // Wide strings, unions, maps and bitsets are rare enough to be rebuilt.
+            data = xtypes::DynamicData(data.type());
+            break;
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
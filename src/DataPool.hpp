@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__DATAPOOL_HPP_
+#define _WEBSOCKET_IS_SH__SRC__DATAPOOL_HPP_
+
+#include <is/core/Message.hpp>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace xtypes = eprosima::xtypes;
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class DataPool
+ * @brief Keeps the dynamic data instances where the incoming messages are decoded,
+ *        so that they are reused by the next messages of the same type instead of
+ *        building and destroying the whole instance tree for each one.
+ *
+ *        An instance is leased while a message is decoded and handed to its callback,
+ *        which only gets a reference to it for the duration of the call, and is reset
+ *        to its default value when given back. Strings keep their capacity, and sequences
+ *        of primitives their storage, so once the instances of a type have grown to the
+ *        size of its messages, decoding them hardly allocates.
+ *
+ *        Up to `max_idle` instances of each type are kept, enough for the threads that
+ *        decode messages at once. The types must outlive the pool.
+ *
+ *        This class is thread safe.
+ */
+class DataPool
+{
+public:
+
+    /**
+     * @class Lease
+     * @brief An instance taken from the pool, which is given back when the lease is destroyed.
+     */
+    class Lease
+    {
+    public:
+
+        Lease(
+                DataPool& pool,
+                const xtypes::DynamicType& type,
+                std::unique_ptr<xtypes::DynamicData> data);
+
+        Lease(
+                Lease&& other) = default;
+
+        Lease(
+                const Lease& other) = delete;
+
+        Lease& operator =(
+                const Lease& other) = delete;
+
+        ~Lease();
+
+        xtypes::DynamicData& operator *() const
+        {
+            return *_data;
+        }
+
+    private:
+
+        DataPool* _pool;
+
+        /**
+         * The type the instance was leased for, which is the key of its pool.
+         */
+        const xtypes::DynamicType* _type;
+
+        std::unique_ptr<xtypes::DynamicData> _data;
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] max_idle Maximum number of instances of each type kept between messages.
+     */
+    explicit DataPool(
+            std::size_t max_idle = 4);
+
+    /**
+     * @brief Take an instance of a type, with its default value, from the pool,
+     *        or build a new one if there is none left.
+     *
+     * @param[in] type The type of the instance.
+     *
+     * @returns The lease of the instance.
+     */
+    Lease acquire(
+            const xtypes::DynamicType& type);
+
+    /**
+     * @brief Number of instances kept in the pool, among all the types.
+     */
+    std::size_t idle() const;
+
+private:
+
+    void _release(
+            const xtypes::DynamicType& type,
+            std::unique_ptr<xtypes::DynamicData> data);
+
+    std::size_t _max_idle;
+
+    mutable std::mutex _mutex;
+
+    /**
+     * Instances ready to be leased, by the address of their type.
+     */
+    std::unordered_map<const xtypes::DynamicType*, std::vector<std::unique_ptr<xtypes::DynamicData>>> _idle;
+};
+
+/**
+ * @brief Reset a dynamic data instance to the default value of its type,
+ *        keeping the memory held by its strings and sequences of primitives.
+ *
+ * @param[in,out] data The instance to reset.
+ */
+void reset_data(
+        xtypes::WritableDynamicDataRef data);
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__DATAPOOL_HPP_
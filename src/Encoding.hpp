@@ -24,6 +24,8 @@
 #include <yaml-cpp/yaml.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace xtypes = eprosima::xtypes;
 
@@ -230,6 +232,76 @@ public:
         return false;
     }
 
+    /**
+     * @brief Apply the configuration of a service offered to the *WebSocket* clients,
+     *        whose requests and replies are decoded and encoded without it otherwise.
+     *
+     * @param[in] service_name The name of the service.
+     *
+     * @param[in] configuration The configuration of the service.
+     */
+    virtual void configure_service(
+            const std::string& service_name,
+            const YAML::Node& configuration)
+    {
+        (void)service_name;
+        (void)configuration;
+    }
+
+    /**
+     * @brief Whether the encoded messages are binary, and thus must be sent
+     *        using binary *WebSocket* frames instead of text ones.
+     */
+    virtual bool binary() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Split an already encoded message into several fragment messages.
+     *
+     * @param[in] payload The encoded message to be split.
+     *
+     * @param[in] id The identifier shared by all the fragments of the message.
+     *
+     * @param[in] fragment_size Maximum size of the encoded message carried by each fragment.
+     *
+     * @returns The encoded fragment messages, in order, or an empty vector if the
+     *          encoding does not support fragmentation, in which case the message
+     *          must be sent as a whole.
+     */
+    virtual std::vector<std::string> encode_fragments(
+            const std::string& payload,
+            const std::string& id,
+            std::size_t fragment_size) const
+    {
+        (void)payload;
+        (void)id;
+        (void)fragment_size;
+        return {};
+    }
+
+    /**
+     * @brief Discard what is kept for a connection that has been closed,
+     *        such as the fragments of the messages it did not finish sending.
+     *
+     * @param[in] connection Opaque pointer which identifies the connection.
+     */
+    virtual void forget_connection(
+            const void* connection) const
+    {
+        (void)connection;
+    }
+
+    /**
+     * @brief Discard the incoming messages whose fragments stopped arriving.
+     *        It is called periodically by the spinning thread.
+     */
+    virtual void evict_expired_fragments() const
+    {
+        // Do nothing
+    }
+
 };
 
 using EncodingPtr = std::shared_ptr<Encoding>;
@@ -241,6 +313,28 @@ using EncodingPtr = std::shared_ptr<Encoding>;
  */
 EncodingPtr make_json_encoding();
 
+/**
+ * @brief Create the binary encoding, which exchanges the same messages as `json_encoding`
+ *        but serialized using *CBOR*.
+ */
+EncodingPtr make_cbor_encoding();
+
+/**
+ * @brief Create the binary encoding meant for links between *Integration Service* instances,
+ *        which sends the data serialized as *XCDR* and identifies topics by a hash of their name.
+ */
+EncodingPtr make_xcdr_encoding();
+
+/**
+ * @brief Replace the characters that are not admitted in type names, namely '/', with "__".
+ *
+ * @param[in] message_type The type name, as received from a *WebSocket* peer.
+ *
+ * @returns The transformed type name.
+ */
+std::string transform_type(
+        const std::string& message_type);
+
 } //  namespace websocket
 } //  namespace sh
 } //  namespace is
@@ -17,8 +17,11 @@
  */
 
 #include "Endpoint.hpp"
+#include "LogSink.hpp"
 
+#include <algorithm>
 #include <cstdlib>
+#include <map>
 
 #include <is/json-xtypes/conversion.hpp>
 
@@ -53,88 +56,145 @@ inline std::shared_ptr<CallHandle> make_call_handle(
                    std::move(connection_handle)});
 }
 
+//==============================================================================
+inline uint32_t effective_fragment_size(
+        uint32_t lhs,
+        uint32_t rhs)
+{
+    // Zero stands for no fragmentation at all, so it never wins.
+    if (lhs == 0 || rhs == 0)
+    {
+        return std::max(lhs, rhs);
+    }
+    return std::min(lhs, rhs);
+}
+
+//==============================================================================
+EncodingPtr make_encoding(
+        const std::string& name)
+{
+    if (name == YamlEncoding_Json)
+    {
+        return make_json_encoding();
+    }
+    else if (name == YamlEncoding_Cbor)
+    {
+        return make_cbor_encoding();
+    }
+    else if (name == YamlEncoding_Xcdr)
+    {
+        return make_xcdr_encoding();
+    }
+
+    return nullptr;
+}
+
 //==============================================================================
 Endpoint::Endpoint(
         const std::string& name)
     : _logger(name)
     , _next_service_call_id(1)
+    , _next_fragmented_msg_id(1)
 {
     // Do nothing
 }
 
+//==============================================================================
+Endpoint::~Endpoint()
+{
+    if (AsyncLogSink* sink = AsyncLogSink::instance())
+    {
+        sink->flush();
+    }
+}
+
 //==============================================================================
 bool Endpoint::configure(
         const core::RequiredTypes& types,
         const YAML::Node& configuration,
         TypeRegistry& /*type_registry*/)
 {
-    if (const YAML::Node encode_node = configuration[YamlEncodingKey])
-    {
-        const std::string encoding_str = [&]() -> std::string
-                {
-                    std::string encoding = encode_node.as<std::string>("");
-                    std::transform(encoding.begin(), encoding.end(),
-                            encoding.begin(), ::tolower);
-                    return encoding;
-                }
-                ();
-
-        if (encoding_str == YamlEncoding_Json)
-        {
-            _logger << utils::Logger::Level::DEBUG
-                    << "Using JSON encoding" << std::endl;
+    const auto to_lower = [](std::string name) -> std::string
+            {
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                return name;
+            };
 
-            _encoding = make_json_encoding();
-        }
-        else
+    if (const YAML::Node log_level_node = configuration[YamlLogLevelKey])
+    {
+        LogLevel level;
+        if (!parse_log_level(log_level_node.as<std::string>(""), level))
         {
             _logger << utils::Logger::Level::ERROR
-                    << "Unknown encoding type was requested: '"
-                    << _encoding << "'" << std::endl;
+                    << "Unknown log level was requested: '"
+                    << log_level_node.as<std::string>("") << "'" << std::endl;
 
             return false;
         }
+        log_threshold() = level;
     }
-    else
-    {
-        _logger << utils::Logger::Level::DEBUG
-                << "Using JSON encoding" << std::endl;
 
-        _encoding = make_json_encoding();
+    if (configuration[YamlAsyncLogKey].as<bool>(false))
+    {
+        AsyncLogSink::enable();
     }
 
-    if (!_encoding)
+    std::string encoding_str = YamlEncoding_Json;
+    if (const YAML::Node encode_node = configuration[YamlEncodingKey])
     {
-        _logger << utils::Logger::Level::ERROR
-                << "Reached a line '" << __LINE__ << "' that should "
-                << "be impossible. Please report this bug!" << std::endl;
-
-        return false;
+        encoding_str = to_lower(encode_node.as<std::string>(""));
     }
 
-    bool success = false;
-
-    if (configuration["security"] && configuration["security"].as<std::string>() == "none")
+    std::vector<std::string> encoding_names = {encoding_str};
+    if (const YAML::Node encodings_node = configuration[YamlEncodingsKey])
     {
-        _logger << utils::Logger::Level::INFO
-                << "Security disabled, creating TCP endpoint..." << std::endl;
-
-        _use_security = false;
-        _tcp_endpoint = std::make_shared<TcpEndpoint>(configure_tcp_endpoint(types, configuration));
+        if (!encodings_node.IsSequence())
+        {
+            _logger << utils::Logger::Level::ERROR
+                    << "The '" << YamlEncodingsKey << "' setting must be a list of encoding names"
+                    << std::endl;
 
-        success = _tcp_endpoint != nullptr;
+            return false;
+        }
 
+        for (const YAML::Node& name_node : encodings_node)
+        {
+            const std::string name = to_lower(name_node.as<std::string>(""));
+            if (std::find(encoding_names.begin(), encoding_names.end(), name) == encoding_names.end())
+            {
+                encoding_names.push_back(name);
+            }
+        }
     }
-    else
+
+    for (const std::string& name : encoding_names)
     {
-        _logger << utils::Logger::Level::INFO
-                << "Security enabled, creating TLS endpoint..." << std::endl;
+        EncodingPtr encoding = make_encoding(name);
+        if (!encoding)
+        {
+            _logger << utils::Logger::Level::ERROR
+                    << "Unknown encoding type was requested: '"
+                    << name << "'" << std::endl;
+
+            return false;
+        }
 
-        _use_security = true;
-        _tls_endpoint = std::make_shared<TlsEndpoint>(configure_tls_endpoint(types, configuration));
+        _encodings.push_back(EncodingInfo{name, std::move(encoding), {}});
+    }
 
-        success = _tls_endpoint != nullptr;
+    _logger << utils::Logger::Level::DEBUG
+            << "Using " << encoding_str << " encoding";
+    if (_encodings.size() > 1)
+    {
+        _logger << " by default, connections may also negotiate";
+        for (std::size_t i = 1; i < _encodings.size(); ++i)
+        {
+            _logger << " " << _encodings[i].name;
+        }
     }
+    _logger << std::endl;
+
+    const bool success = configure_endpoint(types, configuration);
 
     if (success)
     {
@@ -155,11 +215,22 @@ bool Endpoint::subscribe(
             << "Subscribing to topic '" << topic_name
             << "' with topic type '" << message_type.name() << "'" << std::endl;
 
-    _encoding->add_type(message_type, message_type.name());
+    add_type(message_type);
 
-    _startup_messages.emplace_back(
-        _encoding->encode_subscribe_msg(
-            topic_name, message_type.name(), "", configuration));
+    std::vector<std::string> subscribe_msgs;
+    subscribe_msgs.reserve(_encodings.size());
+    for (const EncodingInfo& info : _encodings)
+    {
+        subscribe_msgs.push_back(info.encoding->encode_subscribe_msg(
+                    topic_name, message_type.name(), "", configuration));
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (std::size_t i = 0; i < _encodings.size(); ++i)
+    {
+        _encodings[i].startup_messages.emplace_back(std::move(subscribe_msgs[i]));
+    }
 
     TopicSubscribeInfo& info = _topic_subscribe_info[topic_name];
     info.type = message_type.name();
@@ -186,7 +257,7 @@ std::shared_ptr<TopicPublisher> Endpoint::advertise(
             << "Advertising topic publisher '" << topic_name
             << "' with topic type '" << message_type.name() << "'" << std::endl;
 
-    _encoding->add_type(message_type, message_type.name());
+    add_type(message_type);
 
     return make_topic_publisher(
         topic_name, message_type, "", configuration, *this);
@@ -205,15 +276,18 @@ bool Endpoint::create_client_proxy(
             << "' with request type '" << request_type.name()
             << "' and reply type '" << reply_type.name() << "'" << std::endl;
 
+    add_type(request_type);
+    add_type(reply_type);
+    configure_service(service_name, configuration);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
     ClientProxyInfo& info = _client_proxy_info[service_name];
     info.req_type = request_type.name();
     info.reply_type = reply_type.name();
     info.callback = callback;
     info.configuration = configuration;
 
-    _encoding->add_type(request_type, request_type.name());
-    _encoding->add_type(reply_type, reply_type.name());
-
     return true;
 }
 
@@ -228,13 +302,16 @@ bool Endpoint::create_client_proxy(
             << "Creating service client proxy for service '" << service_name
             << "' with service type '" << service_type.name() << "'" << std::endl;
 
+    add_type(service_type);
+    configure_service(service_name, configuration);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
     ClientProxyInfo& info = _client_proxy_info[service_name];
     info.req_type = service_type.name();
     info.callback = callback;
     info.configuration = configuration;
 
-    _encoding->add_type(service_type, service_type.name());
-
     return true;
 }
 
@@ -248,9 +325,13 @@ std::shared_ptr<ServiceProvider> Endpoint::create_service_proxy(
             << "Creating service server proxy for service '" << service_name
             << "' with service type '" << service_type.name() << "'" << std::endl;
 
-    ServiceProviderInfo& info = _service_provider_info[service_name];
-    info.req_type = service_type.name();
-    info.configuration = configuration;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        ServiceProviderInfo& info = _service_provider_info[service_name];
+        info.req_type = service_type.name();
+        info.configuration = configuration;
+    }
 
     return make_service_provider(service_name, *this);
 }
@@ -267,13 +348,17 @@ std::shared_ptr<ServiceProvider> Endpoint::create_service_proxy(
             << "' with request type '" << request_type.name()
             << "' and reply type '" << reply_type.name() << "'" << std::endl;
 
-    ServiceProviderInfo& info = _service_provider_info[service_name];
-    info.req_type = request_type.name();
-    info.reply_type = reply_type.name();
-    info.configuration = configuration;
+    add_type(request_type);
+    add_type(reply_type);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
 
-    _encoding->add_type(request_type, request_type.name());
-    _encoding->add_type(reply_type, reply_type.name());
+        ServiceProviderInfo& info = _service_provider_info[service_name];
+        info.req_type = request_type.name();
+        info.reply_type = reply_type.name();
+        info.configuration = configuration;
+    }
 
     return make_service_provider(service_name, *this);
 }
@@ -285,12 +370,41 @@ void Endpoint::startup_advertisement(
         const std::string& id,
         const YAML::Node& configuration)
 {
+    std::vector<std::string> advertise_msgs;
+    advertise_msgs.reserve(_encodings.size());
+    for (const EncodingInfo& encoding : _encodings)
+    {
+        advertise_msgs.push_back(encoding.encoding->encode_advertise_msg(
+                    topic, message_type.name(), id, configuration));
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
     TopicPublishInfo& info = _topic_publish_info[topic];
     info.type = message_type.name();
 
-    _startup_messages.emplace_back(
-        _encoding->encode_advertise_msg(
-            topic, message_type.name(), id, configuration));
+    if (configuration.IsMap())
+    {
+        if (const YAML::Node fragment_node = configuration[YamlFragmentSizeKey])
+        {
+            try
+            {
+                info.fragment_size = fragment_node.as<uint32_t>();
+            }
+            catch (const YAML::Exception& e)
+            {
+                _logger << utils::Logger::Level::WARN
+                        << "Ignoring the '" << YamlFragmentSizeKey << "' setting '" << fragment_node
+                        << "' of topic '" << topic << "', since it is not a non-negative integer: "
+                        << e.what() << std::endl;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < _encodings.size(); ++i)
+    {
+        _encodings[i].startup_messages.emplace_back(std::move(advertise_msgs[i]));
+    }
 }
 
 //==============================================================================
@@ -298,55 +412,188 @@ bool Endpoint::publish(
         const std::string& topic,
         const xtypes::DynamicData& message)
 {
-    const TopicPublishInfo& info = _topic_publish_info.at(topic);
+    std::string type;
+    // Listeners that get the publication right away, grouped by their encoding and fragment size.
+    std::map<std::pair<std::size_t, uint32_t>, std::vector<std::shared_ptr<void> > > due;
+    std::vector<std::shared_ptr<void> > holding_back;
+    // Listeners that are due, but get their oldest held back publication instead.
+    std::vector<std::shared_ptr<void> > releasing;
+    // Whether each encoding is used by any of those listeners.
+    std::vector<bool> in_use(_encodings.size(), false);
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        TopicPublishInfo& info = _topic_publish_info.at(topic);
+
+        // If no one is listening, then don't bother publishing
+        if (info.listeners.empty())
+        {
+            return true;
+        }
+
+        // Decide which listeners will get the publication before encoding it,
+        // so that it is not even encoded if every listener is being throttled.
+        for (auto& entry : info.listeners)
+        {
+            ListenerInfo& listener = entry.second;
+            const std::chrono::milliseconds throttle_rate(listener.options.throttle_rate);
+
+            if (now - listener.last_sent >= throttle_rate)
+            {
+                if (listener.held_back.empty())
+                {
+                    const uint32_t fragment_size =
+                            effective_fragment_size(info.fragment_size, listener.options.fragment_size);
+                    due[std::make_pair(listener.encoding, fragment_size)].push_back(entry.first);
+                }
+                else
+                {
+                    releasing.push_back(entry.first);
+                }
+                in_use[listener.encoding] = true;
+                listener.last_sent = now;
+            }
+            else if (listener.options.queue_length > 0)
+            {
+                holding_back.push_back(entry.first);
+                in_use[listener.encoding] = true;
+            }
+        }
+
+        if (due.empty() && holding_back.empty() && releasing.empty())
+        {
+            return true;
+        }
+
+        type = info.type;
+    }
 
-    // If no one is listening, then don't bother publishing
-    if (info.listeners.empty())
+    // Encode the publication only once per encoding in use, no matter how many
+    // listeners there are. Every connection using the same encoding will be handed
+    // the very same payload buffer.
+    // The encoding takes place without holding the lock, so that it does not
+    // stall the threads handling the incoming messages.
+    bool success = true;
+    std::vector<std::shared_ptr<const std::string> > payloads(_encodings.size());
+    for (std::size_t i = 0; i < _encodings.size(); ++i)
     {
-        return true;
+        if (!in_use[i])
+        {
+            continue;
+        }
+
+        std::string payload = _encodings[i].encoding->encode_publication_msg(topic, type, "", message);
+        if (payload.empty())
+        {
+            success = false;
+            continue;
+        }
+
+        payloads[i] = std::make_shared<const std::string>(std::move(payload));
     }
 
-    for (const auto& v_handle : info.listeners)
+    // Likewise, the publication is split only once for each encoding and fragment size in use.
+    std::map<std::pair<std::size_t, uint32_t>, std::vector<std::string> > fragments;
+    for (const auto& group : due)
     {
-        std::string payload;
-        ErrorCode ec;
+        if (payloads[group.first.first])
+        {
+            fragments[group.first] =
+                    make_fragments(*payloads[group.first.first], group.first.second, group.first.first);
+        }
+    }
 
-        if (_use_security)
+    // Sending only enqueues the payload into each connection, so it can
+    // be safely done while holding the lock.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (const auto& group : due)
+    {
+        const std::shared_ptr<const std::string>& payload = payloads[group.first.first];
+        if (!payload)
         {
-            auto connection_handle = _tls_endpoint->get_con_from_hdl(v_handle.first);
+            continue;
+        }
 
-            payload = _encoding->encode_publication_msg(topic, info.type, "", message);
-            if (!payload.empty())
-            {
-                ec = connection_handle->send(payload);
-            }
+        const Encoding& encoding = *_encodings[group.first.first].encoding;
+        const std::vector<std::string>& group_fragments = fragments[group.first];
+        if (group_fragments.empty())
+        {
+            fan_out(topic, group.second, *payload, encoding);
         }
         else
         {
-            auto connection_handle = _tcp_endpoint->get_con_from_hdl(v_handle.first);
+            fan_out_fragments(topic, group.second, group_fragments, encoding);
+        }
+    }
+
+    if (holding_back.empty() && releasing.empty())
+    {
+        return success;
+    }
+
+    auto it = _topic_publish_info.find(topic);
+    if (it == _topic_publish_info.end())
+    {
+        return success;
+    }
+
+    // The listeners that are due send their oldest held back publication,
+    // and the new one waits in the queue, so that they keep their rate.
+    std::vector<std::shared_ptr<void> > connection(1);
+    for (const std::shared_ptr<void>& connection_handle : releasing)
+    {
+        auto lit = it->second.listeners.find(connection_handle);
+        if (lit == it->second.listeners.end())
+        {
+            continue;
+        }
+
+        ListenerInfo& listener = lit->second;
+        const std::shared_ptr<const std::string>& payload = payloads[listener.encoding];
+        const uint32_t fragment_size =
+                effective_fragment_size(it->second.fragment_size, listener.options.fragment_size);
 
-            payload = _encoding->encode_publication_msg(topic, info.type, "", message);
-            if (!payload.empty())
+        connection[0] = connection_handle;
+        if (listener.held_back.empty())
+        {
+            // A scheduled release got there first.
+            if (payload)
             {
-                ec = connection_handle->send(payload);
+                send_publication(topic, connection, *payload, fragment_size, listener.encoding);
             }
+            continue;
         }
 
-        if (ec)
+        send_publication(topic, connection, *listener.held_back.front(), fragment_size, listener.encoding);
+        listener.held_back.pop_front();
+
+        if (payload)
         {
-            _logger << utils::Logger::Level::ERROR
-                    << "Failed to send publication on topic '" << topic
-                    << "', error: " << ec.message() << std::endl;
+            listener.held_back.push_back(payload);
         }
-        else
+        schedule_release(topic, connection_handle);
+    }
+
+    for (const std::shared_ptr<void>& connection_handle : holding_back)
+    {
+        auto lit = it->second.listeners.find(connection_handle);
+        if (lit == it->second.listeners.end() || !payloads[lit->second.encoding])
         {
-            _logger << utils::Logger::Level::INFO
-                    << "Sent publication on topic '" << topic << "': [[ "
-                    << payload << " ]]" << std::endl;
+            continue;
+        }
+
+        ListenerInfo& listener = lit->second;
+        listener.held_back.push_back(payloads[listener.encoding]);
+        while (listener.held_back.size() > listener.options.queue_length)
+        {
+            listener.held_back.pop_front();
         }
+        schedule_release(topic, connection_handle);
     }
 
-    return true;
+    return success;
 }
 
 //==============================================================================
@@ -356,13 +603,21 @@ void Endpoint::call_service(
         ServiceClient& client,
         std::shared_ptr<void> call_handle)
 {
-    const std::size_t id = _next_service_call_id++;
-    const std::string id_str = std::to_string(id);
-    _service_request_info[id_str] = {&client, std::move(call_handle)};
+    std::string id_str;
+    ServiceProviderInfo provider_info;
+    std::size_t encoding = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const std::size_t id = _next_service_call_id++;
+        id_str = std::to_string(id);
+        _service_request_info[id_str] = {&client, std::move(call_handle)};
 
-    ServiceProviderInfo& provider_info = _service_provider_info.at(service);
+        provider_info = _service_provider_info.at(service);
+        encoding = encoding_index(provider_info.connection_handle);
+    }
 
-    const std::string payload = _encoding->encode_call_service_msg(
+    const std::string payload = _encodings[encoding].encoding->encode_call_service_msg(
         service, provider_info.req_type, request,
         id_str, provider_info.configuration);
 
@@ -371,16 +626,7 @@ void Endpoint::call_service(
         return;
     }
 
-    ErrorCode ec;
-
-    if (_use_security)
-    {
-        ec = _tls_endpoint->get_con_from_hdl(provider_info.connection_handle)->send(payload);
-    }
-    else
-    {
-        ec = _tcp_endpoint->get_con_from_hdl(provider_info.connection_handle)->send(payload);
-    }
+    const ErrorCode ec = send(provider_info.connection_handle, payload);
 
     if (ec)
     {
@@ -390,9 +636,9 @@ void Endpoint::call_service(
     }
     else
     {
-        _logger << utils::Logger::Level::INFO
-                << "Called service '" << service << "' with request type '"
-                << request.type().name() << "', data: [[ " << payload << " ]]" << std::endl;
+        IS_WEBSOCKET_LOG(_logger, TRACE)
+            << "Called service '" << service << "' with request type '"
+            << request.type().name() << "', data: [[ " << payload << " ]]" << std::endl;
     }
 }
 
@@ -404,40 +650,17 @@ void Endpoint::receive_response(
     const auto& call_handle =
             *static_cast<const CallHandle*>(v_call_handle.get());
 
-    std::string payload;
-    ErrorCode ec;
-
-    if (_use_security)
-    {
-        auto connection_handle = _tls_endpoint->get_con_from_hdl(
-            call_handle.connection_handle);
-
-        payload = _encoding->encode_service_response_msg(
-            call_handle.service_name,
-            call_handle.reply_type,
-            call_handle.id,
-            response, true);
+    const Encoding& encoding = get_encoding(call_handle.connection_handle);
+    const std::string payload = encoding.encode_service_response_msg(
+        call_handle.service_name,
+        call_handle.reply_type,
+        call_handle.id,
+        response, true);
 
-        if (!payload.empty())
-        {
-            ec = connection_handle->send(payload);
-        }
-    }
-    else
+    ErrorCode ec;
+    if (!payload.empty())
     {
-        auto connection_handle = _tcp_endpoint->get_con_from_hdl(
-            call_handle.connection_handle);
-
-        payload = _encoding->encode_service_response_msg(
-            call_handle.service_name,
-            call_handle.reply_type,
-            call_handle.id,
-            response, true);
-
-        if (!payload.empty())
-        {
-            ec = connection_handle->send(payload);
-        }
+        ec = send(call_handle.connection_handle, payload);
     }
 
     if (ec)
@@ -448,8 +671,8 @@ void Endpoint::receive_response(
     }
     else
     {
-        _logger << utils::Logger::Level::INFO
-                << "Received response from service: [[ " << payload << " ]]" << std::endl;
+        IS_WEBSOCKET_LOG(_logger, TRACE)
+            << "Received response from service: [[ " << payload << " ]]" << std::endl;
     }
 }
 
@@ -460,6 +683,8 @@ void Endpoint::receive_topic_advertisement_ws(
         const std::string& /*id*/,
         std::shared_ptr<void> connection_handle)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     auto it = _topic_subscribe_info.find(topic_name);
     if (it != _topic_subscribe_info.end())
     {
@@ -501,31 +726,30 @@ void Endpoint::receive_topic_unadvertisement_ws(
 {
 }
 
+//==============================================================================
+Endpoint::SubscriptionCallback* Endpoint::accept_publication_ws(
+        const std::string& topic_name,
+        const std::shared_ptr<void>& connection_handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return find_subscription(topic_name, connection_handle);
+}
+
 //==============================================================================
 void Endpoint::receive_publication_ws(
         const std::string& topic_name,
         const xtypes::DynamicData& message,
-        std::shared_ptr<void> connection_handle)
+        SubscriptionCallback& callback)
 {
     try
     {
-        _logger << utils::Logger::Level::DEBUG
-                << "Received message on subscriber '" << topic_name
-                << "', data: [[ " << json_xtypes::convert(message) << " ]]" << std::endl;
-
-        auto it = _topic_subscribe_info.find(topic_name);
-        if (it == _topic_subscribe_info.end())
-        {
-            return;
-        }
+        IS_WEBSOCKET_LOG(_logger, TRACE)
+            << "Received message on subscriber '" << topic_name
+            << "', data: [[ " << json_xtypes::convert(message) << " ]]" << std::endl;
 
-        TopicSubscribeInfo& info = it->second;
-        if (info.blacklist.count(connection_handle) > 0)
-        {
-            return;
-        }
-
-        (*info.callback)(message, nullptr);
+        // The callbacks of the subscriptions live as long as the Endpoint, so the one found
+        // when the publication was accepted is still valid without looking it up again.
+        callback(message, nullptr);
     }
     catch (const json_xtypes::UnsupportedType& unsupported)
     {
@@ -549,8 +773,11 @@ void Endpoint::receive_subscribe_request_ws(
         const std::string& topic_name,
         const xtypes::DynamicType* message_type,
         const std::string& id,
+        const SubscriptionOptions& options,
         std::shared_ptr<void> connection_handle)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     auto insertion = _topic_publish_info.insert(
         std::make_pair(topic_name, TopicPublishInfo{}));
     const bool inserted = insertion.second;
@@ -579,7 +806,10 @@ void Endpoint::receive_subscribe_request_ws(
                 << "', with message type '" << message_type->name() << "'" << std::endl;
     }
 
-    info.listeners[connection_handle].insert(id);
+    ListenerInfo& listener = info.listeners[connection_handle];
+    listener.encoding = encoding_index(connection_handle);
+    listener.ids[id] = options;
+    listener.merge_options();
 }
 
 //==============================================================================
@@ -588,6 +818,8 @@ void Endpoint::receive_unsubscribe_request_ws(
         const std::string& id,
         std::shared_ptr<void> connection_handle)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     auto it = _topic_publish_info.find(topic_name);
     if (it == _topic_publish_info.end())
     {
@@ -616,15 +848,19 @@ void Endpoint::receive_unsubscribe_request_ws(
         return;
     }
 
-    std::unordered_set<std::string>& listeners = lit->second;
-    listeners.erase(id);
+    ListenerInfo& listener = lit->second;
+    listener.ids.erase(id);
 
-    if (listeners.empty())
+    if (listener.ids.empty())
     {
         // If no more unique ids are listening from this connection, then
         // erase it entirely.
         info.listeners.erase(lit);
     }
+    else
+    {
+        listener.merge_options();
+    }
 }
 
 //==============================================================================
@@ -636,23 +872,27 @@ void Endpoint::receive_service_request_ws(
 {
     try
     {
-        auto it = _client_proxy_info.find(service_name);
-        if (it == _client_proxy_info.end())
+        ClientProxyInfo info;
         {
-            _logger << utils::Logger::Level::ERROR
-                    << "Received a service request for a service '"
-                    << service_name << "' that we are not providing!" << std::endl;
+            std::lock_guard<std::mutex> lock(_mutex);
 
-            return;
-        }
-        else
-        {
-            _logger << utils::Logger::Level::DEBUG
-                    << "Received a service request for service '" << service_name
-                    << "', data: [[ " << json_xtypes::convert(request) << " ]]" << std::endl;
+            auto it = _client_proxy_info.find(service_name);
+            if (it == _client_proxy_info.end())
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "Received a service request for a service '"
+                        << service_name << "' that we are not providing!" << std::endl;
+
+                return;
+            }
+
+            info = it->second;
         }
 
-        ClientProxyInfo& info = it->second;
+        IS_WEBSOCKET_LOG(_logger, TRACE)
+            << "Received a service request for service '" << service_name
+            << "', data: [[ " << json_xtypes::convert(request) << " ]]" << std::endl;
+
         (*info.callback)(request, *this,
                 make_call_handle(service_name, info.req_type, info.reply_type,
                 id, connection_handle));
@@ -686,6 +926,8 @@ void Endpoint::receive_service_advertisement_ws(
             << "' with request type '" << req_type.name() << "', and reply type '"
             << reply_type.name() << "'" << std::endl;
 
+    std::lock_guard<std::mutex> lock(_mutex);
+
     _service_provider_info[service_name] =
             ServiceProviderInfo{req_type.name(), reply_type.name(), connection_handle, YAML::Node{}
     };
@@ -697,6 +939,8 @@ void Endpoint::receive_service_unadvertisement_ws(
         const xtypes::DynamicType* /*service_type*/,
         std::shared_ptr<void> connection_handle)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     auto it = _service_provider_info.find(service_name);
     if (it == _service_provider_info.end())
     {
@@ -724,28 +968,32 @@ void Endpoint::receive_service_response_ws(
 {
     try
     {
-        auto it = _service_request_info.find(id);
-        if (it == _service_request_info.end())
+        ServiceRequestInfo info;
         {
-            _logger << utils::Logger::Level::ERROR
-                    << "A remote connection provided a service response for service '"
-                    << service_name << "' with an unrecognized id '" << id << "'" << std::endl;
+            std::lock_guard<std::mutex> lock(_mutex);
 
-            return;
-        }
+            auto it = _service_request_info.find(id);
+            if (it == _service_request_info.end())
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "A remote connection provided a service response for service '"
+                        << service_name << "' with an unrecognized id '" << id << "'" << std::endl;
 
-        // TODO(MXG): We could use the service_name and connection_handle info to
-        // verify that the service response is coming from the source that we were
-        // expecting.
-        ServiceRequestInfo& info = it->second;
+                return;
+            }
 
-        _logger << utils::Logger::Level::DEBUG
-                << "Receive response for service '" << service_name << "', data: [[ "
-                << json_xtypes::convert(response) << " ]]" << std::endl;
+            // TODO(MXG): We could use the service_name and connection_handle info to
+            // verify that the service response is coming from the source that we were
+            // expecting.
+            info = std::move(it->second);
+            _service_request_info.erase(it);
+        }
 
-        info.client->receive_response(info.call_handle, response);
+        IS_WEBSOCKET_LOG(_logger, TRACE)
+            << "Receive response for service '" << service_name << "', data: [[ "
+            << json_xtypes::convert(response) << " ]]" << std::endl;
 
-        _service_request_info.erase(it);
+        info.client->receive_response(info.call_handle, response);
     }
     catch (const json_xtypes::UnsupportedType& unsupported)
     {
@@ -767,31 +1015,283 @@ void Endpoint::receive_service_response_ws(
 //==============================================================================
 const Encoding& Endpoint::get_encoding() const
 {
-    return *_encoding;
+    return *_encodings.front().encoding;
 }
 
 //==============================================================================
-void Endpoint::notify_connection_opened(
-        const TlsConnectionPtr& connection_handle)
+const std::string& Endpoint::get_encoding_name() const
 {
-    _logger << utils::Logger::Level::DEBUG
-            << "TLS connection " << connection_handle << " opened" << std::endl;
+    return _encodings.front().name;
+}
 
-    for (const std::string& msg : _startup_messages)
+//==============================================================================
+const Encoding& Endpoint::get_encoding(
+        const std::shared_ptr<void>& connection_handle) const
+{
+    return *_encodings[encoding_index(connection_handle)].encoding;
+}
+
+//==============================================================================
+bool Endpoint::accepts_encoding(
+        const std::string& name) const
+{
+    return std::any_of(_encodings.begin(), _encodings.end(),
+                   [&name](const EncodingInfo& info)
+                   {
+                       return info.name == name;
+                   });
+}
+
+//==============================================================================
+void Endpoint::set_connection_encoding(
+        const std::shared_ptr<void>& connection_handle,
+        const std::string& name)
+{
+    if (name.empty())
+    {
+        return;
+    }
+
+    for (std::size_t i = 0; i < _encodings.size(); ++i)
     {
-        connection_handle->send(msg);
+        if (_encodings[i].name != name)
+        {
+            continue;
+        }
+
+        _logger << utils::Logger::Level::DEBUG
+                << "Connection " << connection_handle << " uses " << name << " encoding" << std::endl;
+
+        if (i > 0)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            auto encodings = std::make_shared<ConnectionEncodingTable>(*_connection_encodings);
+            (*encodings)[connection_handle] = i;
+            std::atomic_store(&_connection_encodings,
+                    std::shared_ptr<const ConnectionEncodingTable>(std::move(encodings)));
+        }
+        return;
     }
+
+    _logger << utils::Logger::Level::WARN
+            << "Connection " << connection_handle << " requested the encoding '" << name
+            << "', which is not accepted. Using " << _encodings.front().name << " encoding instead"
+            << std::endl;
 }
 
-void Endpoint::notify_connection_opened(
-        const TcpConnectionPtr& connection_handle)
+//==============================================================================
+std::vector<std::string> Endpoint::startup_messages(
+        const std::shared_ptr<void>& connection_handle) const
 {
-    _logger << utils::Logger::Level::DEBUG
-            << "TCP connection " << connection_handle << " opened" << std::endl;
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    for (const std::string& msg : _startup_messages)
+    return _encodings[encoding_index(connection_handle)].startup_messages;
+}
+
+//==============================================================================
+void Endpoint::report_publication_drops()
+{
+    const uint64_t unsubscribed = _drop_stats.unsubscribed;
+    const uint64_t blacklisted = _drop_stats.blacklisted;
+
+    const uint64_t total = unsubscribed + blacklisted;
+    if (total == _last_reported_drops)
+    {
+        return;
+    }
+    _last_reported_drops = total;
+
+    _logger << utils::Logger::Level::WARN
+            << "Dropped " << unsubscribed << " incoming publications on topics that are not"
+            << " subscribed to and " << blacklisted << " from blacklisted connections so far"
+            << std::endl;
+}
+
+//==============================================================================
+void Endpoint::report_input_errors()
+{
+    _input_errors.sweep(
+        [this](const void* connection, InputError kind, uint64_t suppressed)
+        {
+            _logger << utils::Logger::Level::WARN
+                    << "Suppressed " << suppressed << " similar messages about "
+                    << to_string(kind) << " errors in the messages of connection "
+                    << connection << std::endl;
+        });
+}
+
+//==============================================================================
+void Endpoint::evict_expired_fragments()
+{
+    for (const EncodingInfo& info : _encodings)
     {
-        connection_handle->send(msg);
+        info.encoding->evict_expired_fragments();
+    }
+}
+
+//==============================================================================
+void Endpoint::send_publication(
+        const std::string& topic,
+        const std::vector<std::shared_ptr<void> >& connections,
+        const std::string& payload,
+        uint32_t fragment_size,
+        std::size_t encoding)
+{
+    const std::vector<std::string> fragments = make_fragments(payload, fragment_size, encoding);
+    if (fragments.empty())
+    {
+        fan_out(topic, connections, payload, *_encodings[encoding].encoding);
+    }
+    else
+    {
+        fan_out_fragments(topic, connections, fragments, *_encodings[encoding].encoding);
+    }
+}
+
+//==============================================================================
+void Endpoint::schedule_release(
+        const std::string& topic,
+        const std::shared_ptr<void>& connection_handle)
+{
+    ListenerInfo& listener = _topic_publish_info.at(topic).listeners.at(connection_handle);
+    if (listener.held_back.empty() || listener.release_scheduled)
+    {
+        return;
+    }
+
+    const auto due = listener.last_sent + std::chrono::milliseconds(listener.options.throttle_rate);
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+
+    listener.release_scheduled = true;
+    schedule(connection_handle, std::max(delay, std::chrono::milliseconds::zero()),
+            [this, topic, connection_handle]()
+            {
+                release_held_back(topic, connection_handle);
+            });
+}
+
+//==============================================================================
+void Endpoint::release_held_back(
+        const std::string& topic,
+        const std::shared_ptr<void>& connection_handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _topic_publish_info.find(topic);
+    if (it == _topic_publish_info.end())
+    {
+        return;
+    }
+
+    auto lit = it->second.listeners.find(connection_handle);
+    if (lit == it->second.listeners.end())
+    {
+        return;
+    }
+
+    ListenerInfo& listener = lit->second;
+    listener.release_scheduled = false;
+
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::milliseconds throttle_rate(listener.options.throttle_rate);
+    if (!listener.held_back.empty() && now - listener.last_sent >= throttle_rate)
+    {
+        const std::vector<std::shared_ptr<void> > connection(1, connection_handle);
+        send_publication(topic, connection, *listener.held_back.front(),
+                effective_fragment_size(it->second.fragment_size, listener.options.fragment_size),
+                listener.encoding);
+
+        listener.held_back.pop_front();
+        listener.last_sent = now;
+    }
+
+    schedule_release(topic, connection_handle);
+}
+
+//==============================================================================
+std::vector<std::string> Endpoint::make_fragments(
+        const std::string& payload,
+        uint32_t fragment_size,
+        std::size_t encoding)
+{
+    if (fragment_size == 0 || payload.size() <= fragment_size)
+    {
+        return {};
+    }
+
+    return _encodings[encoding].encoding->encode_fragments(
+        payload, std::to_string(_next_fragmented_msg_id++), fragment_size);
+}
+
+//==============================================================================
+void Endpoint::add_type(
+        const xtypes::DynamicType& type)
+{
+    for (const EncodingInfo& info : _encodings)
+    {
+        info.encoding->add_type(type, type.name());
+    }
+}
+
+//==============================================================================
+void Endpoint::configure_service(
+        const std::string& service_name,
+        const YAML::Node& configuration)
+{
+    for (const EncodingInfo& info : _encodings)
+    {
+        info.encoding->configure_service(service_name, configuration);
+    }
+}
+
+//==============================================================================
+Endpoint::SubscriptionCallback* Endpoint::find_subscription(
+        const std::string& topic_name,
+        const std::shared_ptr<void>& connection_handle)
+{
+    auto it = _topic_subscribe_info.find(topic_name);
+    if (it == _topic_subscribe_info.end())
+    {
+        ++_drop_stats.unsubscribed;
+        return nullptr;
+    }
+
+    const TopicSubscribeInfo& info = it->second;
+    if (info.blacklist.count(connection_handle) > 0)
+    {
+        ++_drop_stats.blacklisted;
+        return nullptr;
+    }
+
+    return info.callback;
+}
+
+//==============================================================================
+std::size_t Endpoint::encoding_index(
+        const std::shared_ptr<void>& connection_handle) const
+{
+    const std::shared_ptr<const ConnectionEncodingTable> encodings = std::atomic_load(&_connection_encodings);
+    auto it = encodings->find(connection_handle);
+    return it != encodings->end() ? it->second : 0;
+}
+
+//==============================================================================
+void Endpoint::ListenerInfo::merge_options()
+{
+    auto it = ids.begin();
+    options = it != ids.end() ? it->second : SubscriptionOptions();
+
+    for (; it != ids.end(); ++it)
+    {
+        options.throttle_rate = std::min(options.throttle_rate, it->second.throttle_rate);
+        options.queue_length = std::max(options.queue_length, it->second.queue_length);
+        options.fragment_size = effective_fragment_size(options.fragment_size, it->second.fragment_size);
+    }
+
+    while (held_back.size() > options.queue_length)
+    {
+        held_back.pop_front();
     }
 }
 
@@ -802,6 +1302,22 @@ void Endpoint::notify_connection_closed(
     _logger << utils::Logger::Level::DEBUG
             << "Connection " << connection_handle << " closed" << std::endl;
 
+    _input_errors.forget(connection_handle.get(),
+        [this](const void* connection, InputError kind, uint64_t suppressed)
+        {
+            _logger << utils::Logger::Level::WARN
+                    << "Suppressed " << suppressed << " similar messages about "
+                    << to_string(kind) << " errors in the messages of connection "
+                    << connection << " before it closed" << std::endl;
+        });
+
+    for (const EncodingInfo& info : _encodings)
+    {
+        info.encoding->forget_connection(connection_handle.get());
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
     for (auto& entry : _topic_subscribe_info)
     {
         entry.second.blacklist.erase(connection_handle);
@@ -812,6 +1328,14 @@ void Endpoint::notify_connection_closed(
         entry.second.listeners.erase(connection_handle);
     }
 
+    if (_connection_encodings->count(connection_handle) != 0)
+    {
+        auto encodings = std::make_shared<ConnectionEncodingTable>(*_connection_encodings);
+        encodings->erase(connection_handle);
+        std::atomic_store(&_connection_encodings,
+                std::shared_ptr<const ConnectionEncodingTable>(std::move(encodings)));
+    }
+
     std::vector<std::string> lost_services;
     lost_services.reserve(_service_provider_info.size());
     for (auto& entry : _service_provider_info)
@@ -20,12 +20,19 @@
 #define _WEBSOCKET_IS_SH__SRC__ENDPOINT_HPP_
 
 #include "Encoding.hpp"
+#include "ErrorRateLimiter.hpp"
+#include "Log.hpp"
 #include "websocket_types.hpp"
 
 #include <is/systemhandle/SystemHandle.hpp>
 #include <is/utils/Log.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -37,14 +44,70 @@ namespace sh {
 namespace websocket {
 
 const std::string YamlEncodingKey = "encoding";
+const std::string YamlEncodingsKey = "encodings";
 const std::string YamlEncoding_Json = "json";
+const std::string YamlEncoding_Cbor = "cbor";
+const std::string YamlEncoding_Xcdr = "xcdr";
 const std::string YamlPortKey = "port";
 const std::string YamlHostKey = "host";
+const std::string YamlFragmentSizeKey = "fragment_size";
+const std::string YamlLogLevelKey = "log_level";
+const std::string YamlAsyncLogKey = "async_log";
+
+/**
+ * @brief Options requested by a remote subscriber, as defined by the *rosbridge* protocol.
+ */
+struct SubscriptionOptions
+{
+    /**
+     * Minimum time, in milliseconds, between two publications sent to the subscriber.
+     */
+    uint32_t throttle_rate = 0;
+
+    /**
+     * Maximum number of publications held back while the subscriber is being throttled.
+     * If zero, the publications received during the throttling period are dropped.
+     */
+    uint32_t queue_length = 0;
+
+    /**
+     * Maximum size of the publications sent to the subscriber. Larger publications
+     * are split into `fragment` messages. If zero, publications are never split.
+     */
+    uint32_t fragment_size = 0;
+};
+
+/**
+ * @brief Counters of the incoming publications dropped by an Endpoint, for each reason.
+ */
+struct PublicationDropStats
+{
+    /**
+     * Publications on topics that are not subscribed to.
+     */
+    std::atomic<uint64_t> unsubscribed{0};
+
+    /**
+     * Publications from connections blacklisted on their topic.
+     */
+    std::atomic<uint64_t> blacklisted{0};
+};
+
+/**
+ * @brief Create one of the built-in encodings.
+ *
+ * @param[in] name The lowercase name of the encoding, as written in the configuration.
+ *
+ * @returns The encoding, or `nullptr` if there is no encoding with that name.
+ */
+EncodingPtr make_encoding(
+        const std::string& name);
 
 /**
  * @class Endpoint
  *        Represents a *WebSocket* endpoint for the *Integration Service*.
-          The Endpoint class will be later specialized for client and server applications.
+          The Endpoint class will be later specialized for each transport
+          (see TransportEndpoint), and then for client and server applications.
  */
 class Endpoint : public is::FullSystem, public ServiceClient
 {
@@ -78,9 +141,10 @@ public:
     virtual bool spin_once() = 0;
 
     /**
-     * @brief Destructor.
+     * @brief Destructor. It waits for the lines logged asynchronously to be written,
+     *        since they refer to the logger of the Endpoint.
      */
-    virtual ~Endpoint() = default;
+    virtual ~Endpoint();
 
 
     /**
@@ -257,19 +321,46 @@ public:
             std::shared_ptr<void> connection_handle);
 
     /**
-     * @brief Process an publication.
+     * @brief Check whether a publication would be delivered, so that the encodings
+     *        can drop it before decoding its data. Dropped publications are counted
+     *        in the publication drop stats.
+     *
+     * @param[in] topic_name The name of the topic the publication is sent to.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the current connection.
+     *
+     * @returns The callback the publication must be handed to through receive_publication_ws(),
+     *          or `nullptr` if the topic is not subscribed to or the connection is
+     *          blacklisted on it, in which case it must be dropped.
+     */
+    SubscriptionCallback* accept_publication_ws(
+            const std::string& topic_name,
+            const std::shared_ptr<void>& connection_handle);
+
+    /**
+     * @brief Getter method for the rate limiter of the errors found in the incoming
+     *        messages. The encodings consult it before logging each of them, and it
+     *        keeps the counters of each kind of error.
+     */
+    ErrorRateLimiter& input_errors()
+    {
+        return _input_errors;
+    }
+
+    /**
+     * @brief Process a publication accepted by accept_publication_ws().
      *
      * @param[in] topic_name The name of the topic
      *            where the message will be published to.
      *
      * @param[in] message The message published.
      *
-     * @param[in] connection_handle Opaque pointer which identifies the current connection.
+     * @param[in] callback The callback returned by accept_publication_ws().
      */
     void receive_publication_ws(
             const std::string& topic_name,
             const xtypes::DynamicData& message,
-            std::shared_ptr<void> connection_handle);
+            SubscriptionCallback& callback);
 
     /**
      * @brief Process a request for subscribing to a certain topic.
@@ -282,12 +373,15 @@ public:
      *
      * @param[in] id The identifier of the message.
      *
+     * @param[in] options The throttling options requested by the subscriber.
+     *
      * @param[in] connection_handle Opaque pointer which identifies the current connection.
      */
     void receive_subscribe_request_ws(
             const std::string& topic_name,
             const xtypes::DynamicType* message_type,
             const std::string& id,
+            const SubscriptionOptions& options,
             std::shared_ptr<void> connection_handle);
 
     /**
@@ -373,29 +467,162 @@ public:
 protected:
 
     /**
-     * @brief Getter method for the Encoding.
+     * @brief Getter method for the default Encoding, set by the `encoding` configuration key.
      *
-     * @returns a const reference to the _encoding attribute.
+     * @returns a const reference to the default encoding.
      */
     const Encoding& get_encoding() const;
 
     /**
-     * @brief Notify when a TLS connection has been opened.
+     * @brief Getter method for the name of the default Encoding.
      *
-     * @param[in] connection_handle The TLS handle used to send
-     *            the notification message.
+     * @returns The lowercase name of the default encoding, such as `json`.
      */
-    void notify_connection_opened(
-            const TlsConnectionPtr& connection_handle);
+    const std::string& get_encoding_name() const;
 
     /**
-     * @brief Notify when a TCP connection has been opened.
+     * @brief Get the Encoding used by a certain connection.
+     *        It does not take the lock, since it is called for every incoming message.
      *
-     * @param[in] connection_handle The TCP handle used to send
-     *            the notification message.
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @returns The encoding negotiated by the connection, or the default one.
+     */
+    const Encoding& get_encoding(
+            const std::shared_ptr<void>& connection_handle) const;
+
+    /**
+     * @brief Check whether connections may negotiate a certain encoding.
+     *
+     * @param[in] name The name of the encoding.
+     *
+     * @returns `true` if the encoding is either the default one or listed
+     *          in the `encodings` configuration key, `false` otherwise.
+     */
+    bool accepts_encoding(
+            const std::string& name) const;
+
+    /**
+     * @brief Set the encoding negotiated by a connection. It must be called
+     *        before the connection is handed any message.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @param[in] name The name of the encoding. If it is empty or not accepted,
+     *            the connection keeps using the default encoding.
+     */
+    void set_connection_encoding(
+            const std::shared_ptr<void>& connection_handle,
+            const std::string& name);
+
+    /**
+     * @brief Getter method for the messages that must be sent
+     *        every time a new connection is opened.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @returns a copy of the startup messages, encoded with the encoding of the
+     *          connection, since they might be modified concurrently once the Endpoint is running.
+     */
+    std::vector<std::string> startup_messages(
+            const std::shared_ptr<void>& connection_handle) const;
+
+    /**
+     * @brief Send a message through a certain connection.
+     *        This method shall be overriden by each transport specialization.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @param[in] payload The encoded message to be sent.
+     *
+     * @returns The error code of the send operation.
+     */
+    virtual ErrorCode send(
+            const std::shared_ptr<void>& connection_handle,
+            const std::string& payload) = 0;
+
+    /**
+     * @brief Send an encoded publication to some of the listeners of a topic.
+     *        This method shall be overriden by each transport specialization.
+     *
+     * @param[in] topic The topic name.
+     *
+     * @param[in] connections The connections the publication must be sent to.
+     *            All of them use the same encoding.
+     *
+     * @param[in] payload The encoded publication.
+     *
+     * @param[in] encoding The encoding of the publication.
+     */
+    virtual void fan_out(
+            const std::string& topic,
+            const std::vector<std::shared_ptr<void> >& connections,
+            const std::string& payload,
+            const Encoding& encoding) = 0;
+
+    /**
+     * @brief Send a publication split into several fragments to some of the listeners of a topic.
+     *        The fragments must not prevent other messages from being sent in between.
+     *        This method shall be overriden by each transport specialization.
+     *
+     * @param[in] topic The topic name.
+     *
+     * @param[in] connections The connections the publication must be sent to.
+     *            All of them use the same encoding.
+     *
+     * @param[in] fragments The encoded fragments, in order.
+     *
+     * @param[in] encoding The encoding of the fragments.
+     */
+    virtual void fan_out_fragments(
+            const std::string& topic,
+            const std::vector<std::shared_ptr<void> >& connections,
+            const std::vector<std::string>& fragments,
+            const Encoding& encoding) = 0;
+
+    /**
+     * @brief Run a callback once a delay has elapsed, in the thread handling a connection.
+     *        This method shall be overriden by each transport specialization.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *            The callback is not run if the connection closes first.
+     *
+     * @param[in] delay The time to wait.
+     *
+     * @param[in] callback The callback to run.
+     */
+    virtual void schedule(
+            const std::shared_ptr<void>& connection_handle,
+            std::chrono::milliseconds delay,
+            std::function<void()> callback) = 0;
+
+    /**
+     * @brief Log the publication drop counters, if they changed since the last report.
+     *        It shall be called periodically by the spinning thread.
+     */
+    void report_publication_drops();
+
+    /**
+     * @brief Log how many errors were suppressed for each connection in the periods
+     *        of the input error rate limiter that have ended.
+     *        It shall be called periodically by the spinning thread.
+     */
+    void report_input_errors();
+
+    /**
+     * @brief Discard the incoming messages whose fragments stopped arriving,
+     *        so that they do not wait for another fragment to be received.
+     *        It shall be called periodically by the spinning thread.
+     */
+    void evict_expired_fragments();
+
+    /**
+     * @brief Getter method for the publication drop counters.
      */
-    void notify_connection_opened(
-            const TcpConnectionPtr& connection_handle);
+    const PublicationDropStats& publication_drop_stats() const
+    {
+        return _drop_stats;
+    }
 
     /**
      * @brief Notify when a connection has been closed.
@@ -423,7 +650,7 @@ protected:
 private:
 
     /**
-     * @brief Configure the TLS Endpoint.
+     * @brief Configure the transport of the Endpoint.
      *        This method shall be overriden for each Endpoint implementation,
      *        namely, Client and Server.
      *
@@ -432,35 +659,142 @@ private:
      * @param[in] configuration Specific configuration to be applied to this *WebSocket*
      *            Endpoint, as specified in the *YAML* file.
      *
-     * @returns A pointer to the configured TLS Endpoint.
+     * @returns `true` if the transport was successfully configured, `false` otherwise.
      */
-    virtual TlsEndpoint* configure_tls_endpoint(
+    virtual bool configure_endpoint(
             const core::RequiredTypes& types,
             const YAML::Node& configuration) = 0;
 
     /**
-     * @brief Configure the TCP Endpoint.
-     *        This method shall be overriden for each Endpoint implementation,
-     *        namely, Client and Server.
+     * @brief Send an encoded publication to some of the listeners of a topic,
+     *        splitting it into fragments if it is larger than the fragment size.
+     *        It must be called while holding the lock.
      *
-     * @param[in] types Set of types that must be present in the Integration Service instance.
+     * @param[in] topic The topic name.
      *
-     * @param[in] configuration Specific configuration to be applied to this *WebSocket*
-     *            Endpoint, as specified in the *YAML* file.
+     * @param[in] connections The connections the publication must be sent to.
      *
-     * @returns A pointer to the configured TCP Endpoint.
+     * @param[in] payload The encoded publication.
+     *
+     * @param[in] fragment_size The maximum size of the fragments, or zero to send it as a whole.
+     *
+     * @param[in] encoding The index of the encoding of the publication.
      */
-    virtual TcpEndpoint* configure_tcp_endpoint(
-            const core::RequiredTypes& types,
-            const YAML::Node& configuration) = 0;
+    void send_publication(
+            const std::string& topic,
+            const std::vector<std::shared_ptr<void> >& connections,
+            const std::string& payload,
+            uint32_t fragment_size,
+            std::size_t encoding);
+
+    /**
+     * @brief Schedule the release of the oldest publication held back for a throttled
+     *        listener, for when its throttling period elapses, unless it is already scheduled.
+     *        It must be called while holding the lock.
+     *
+     * @param[in] topic The topic name.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the listener's connection.
+     */
+    void schedule_release(
+            const std::string& topic,
+            const std::shared_ptr<void>& connection_handle);
+
+    /**
+     * @brief Send the oldest publication held back for a throttled listener,
+     *        if its throttling period has elapsed, and schedule the next one.
+     *
+     * @param[in] topic The topic name.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the listener's connection.
+     */
+    void release_held_back(
+            const std::string& topic,
+            const std::shared_ptr<void>& connection_handle);
+
+    /**
+     * @brief Split an encoded publication into fragments, if required.
+     *
+     * @param[in] payload The encoded publication.
+     *
+     * @param[in] fragment_size The maximum size of the fragments, or zero to send it as a whole.
+     *
+     * @param[in] encoding The index of the encoding of the publication.
+     *
+     * @returns The encoded fragments, or an empty vector if the publication must be sent as a whole.
+     */
+    std::vector<std::string> make_fragments(
+            const std::string& payload,
+            uint32_t fragment_size,
+            std::size_t encoding);
+
+    /**
+     * @brief Add a type to the types database of every encoding.
+     *
+     * @param[in] type The dynamic type to be added.
+     */
+    void add_type(
+            const xtypes::DynamicType& type);
+
+    /**
+     * @brief Pass the configuration of a service offered to the *WebSocket* clients
+     *        to every encoding.
+     *
+     * @param[in] service_name The name of the service.
+     *
+     * @param[in] configuration The configuration of the service.
+     */
+    void configure_service(
+            const std::string& service_name,
+            const YAML::Node& configuration);
+
+    /**
+     * @brief Find the callback a publication must be delivered to, counting it
+     *        as dropped if there is none. It must be called while holding the lock.
+     *
+     * @returns The callback, or `nullptr` if the publication must be dropped.
+     */
+    SubscriptionCallback* find_subscription(
+            const std::string& topic_name,
+            const std::shared_ptr<void>& connection_handle);
+
+    /**
+     * @brief Get the index of the encoding used by a connection.
+     *        It does not take the lock, so it can be called for every incoming message.
+     */
+    std::size_t encoding_index(
+            const std::shared_ptr<void>& connection_handle) const;
 
     /**
      * Class members.
      */
-    EncodingPtr _encoding;
-    std::shared_ptr<TlsEndpoint> _tls_endpoint;
-    std::shared_ptr<TcpEndpoint> _tcp_endpoint;
-    bool _use_security;
+    struct EncodingInfo
+    {
+        std::string name;
+        EncodingPtr encoding;
+
+        /**
+         * Messages that must be sent every time a new connection using this encoding is opened.
+         */
+        std::vector<std::string> startup_messages;
+    };
+
+    /**
+     * Encodings which connections may negotiate. The first one is the default encoding.
+     * The vector is not modified once the Endpoint is configured, only the startup messages are.
+     */
+    std::vector<EncodingInfo> _encodings;
+
+    using ConnectionEncodingTable = std::unordered_map<std::shared_ptr<void>, std::size_t>;
+
+    /**
+     * Index of the encoding negotiated by each connection, if it is not the default one.
+     * It is set when the connection opens, before any of its messages is handled.
+     * The table is immutable: it is replaced as a whole, holding the lock, when a connection
+     * using another encoding opens or closes, and loaded atomically without taking the lock.
+     */
+    std::shared_ptr<const ConnectionEncodingTable> _connection_encodings =
+            std::make_shared<const ConnectionEncodingTable>();
 
     struct TopicSubscribeInfo
     {
@@ -474,16 +808,40 @@ private:
         std::unordered_set<std::shared_ptr<void> > blacklist;
     };
 
+    /**
+     * All the subscriptions made to a topic through the same connection.
+     * They are merged as *rosbridge* does: the connection is throttled using
+     * the lowest requested rate, and holds back up to the longest requested queue.
+     */
+    struct ListenerInfo
+    {
+        std::unordered_map<std::string, SubscriptionOptions> ids;
+        SubscriptionOptions options;
+        std::size_t encoding = 0;
+        std::chrono::steady_clock::time_point last_sent;
+        std::deque<std::shared_ptr<const std::string> > held_back;
+        bool release_scheduled = false;
+
+        void merge_options();
+    };
+
+    /**
+     * Map from connection handle to listeners.
+     */
+    using ListenerMap = std::unordered_map<std::shared_ptr<void>, ListenerInfo>;
+
     struct TopicPublishInfo
     {
         std::string type;
 
-        using ListenerMap = std::unordered_map<
-            std::shared_ptr<void>,
-            std::unordered_set<std::string> >;
+        /**
+         * Maximum size of the publications sent on this topic, or zero if unlimited.
+         * Each listener uses the smallest one among this and the size it requested.
+         */
+        uint32_t fragment_size = 0;
 
         /**
-         * Map from connection handle to listeners ID.
+         * Map from connection handle to listeners.
          */
         ListenerMap listeners;
     };
@@ -510,7 +868,6 @@ private:
         std::shared_ptr<void> call_handle;
     };
 
-    std::vector<std::string> _startup_messages;
     std::unordered_map<std::string, TopicSubscribeInfo> _topic_subscribe_info;
     std::unordered_map<std::string, TopicPublishInfo> _topic_publish_info;
     std::unordered_map<std::string, ClientProxyInfo> _client_proxy_info;
@@ -519,6 +876,20 @@ private:
     std::unordered_map<std::string, xtypes::DynamicType::Ptr> _message_types;
 
     std::size_t _next_service_call_id;
+    std::atomic<uint64_t> _next_fragmented_msg_id;
+
+    PublicationDropStats _drop_stats;
+    uint64_t _last_reported_drops = 0;
+
+    ErrorRateLimiter _input_errors;
+
+    /**
+     * Protects the topic and service tables above. Incoming messages may be
+     * handled by several threads at once, so the tables must never be accessed
+     * without holding it. *Integration Service* callbacks are always invoked
+     * after releasing it, since they may end up calling back into the Endpoint.
+     */
+    mutable std::mutex _mutex;
 };
 
 using EndpointPtr = std::unique_ptr<Endpoint>;
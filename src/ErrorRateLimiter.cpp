@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ErrorRateLimiter.hpp"
+
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+const char* to_string(
+        InputError kind)
+{
+    switch (kind)
+    {
+        case InputError::MALFORMED:
+            return "malformed message";
+        case InputError::MISSING_FIELD:
+            return "missing field";
+        case InputError::UNKNOWN_TYPE:
+            return "unknown type";
+        case InputError::UNKNOWN_OPERATION:
+            return "unknown operation";
+        case InputError::INVALID_DATA:
+            return "invalid data";
+    }
+    return "unknown error";
+}
+
+//==============================================================================
+ErrorRateLimiter::ErrorRateLimiter(
+        uint32_t burst,
+        Clock::duration period)
+    : _burst(burst)
+    , _period(period)
+{
+    for (std::size_t i = 0; i < InputErrorKinds; ++i)
+    {
+        _errors[i] = 0;
+        _suppressed[i] = 0;
+    }
+}
+
+//==============================================================================
+bool ErrorRateLimiter::admit(
+        const void* connection,
+        InputError kind,
+        uint64_t& suppressed,
+        Clock::time_point now)
+{
+    const std::size_t index = static_cast<std::size_t>(kind);
+    _errors[index].fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto insertion = _windows.emplace(Key{connection, kind}, Window{now, 0, 0});
+    Window& window = insertion.first->second;
+    if (now - window.start >= _period)
+    {
+        window.start = now;
+        window.logged = 0;
+    }
+
+    if (window.logged >= _burst)
+    {
+        ++window.suppressed;
+        _suppressed[index].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ++window.logged;
+    suppressed = window.suppressed;
+    window.suppressed = 0;
+    return true;
+}
+
+//==============================================================================
+void ErrorRateLimiter::sweep(
+        const Reporter& reporter,
+        Clock::time_point now)
+{
+    // The reporter is called after releasing the lock, since it may log errors itself.
+    std::vector<std::pair<Key, uint64_t> > reports;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto it = _windows.begin(); it != _windows.end();)
+        {
+            if (now - it->second.start < _period)
+            {
+                ++it;
+                continue;
+            }
+
+            if (it->second.suppressed > 0)
+            {
+                reports.emplace_back(it->first, it->second.suppressed);
+            }
+            it = _windows.erase(it);
+        }
+    }
+
+    for (const auto& report : reports)
+    {
+        reporter(report.first.connection, report.first.kind, report.second);
+    }
+}
+
+//==============================================================================
+void ErrorRateLimiter::forget(
+        const void* connection,
+        const Reporter& reporter)
+{
+    std::vector<std::pair<InputError, uint64_t> > reports;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (std::size_t i = 0; i < InputErrorKinds; ++i)
+        {
+            const InputError kind = static_cast<InputError>(i);
+            auto it = _windows.find(Key{connection, kind});
+            if (it == _windows.end())
+            {
+                continue;
+            }
+
+            if (it->second.suppressed > 0)
+            {
+                reports.emplace_back(kind, it->second.suppressed);
+            }
+            _windows.erase(it);
+        }
+    }
+
+    for (const auto& report : reports)
+    {
+        reporter(connection, report.first, report.second);
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
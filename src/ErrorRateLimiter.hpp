@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__ERROR_RATE_LIMITER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__ERROR_RATE_LIMITER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Kinds of errors found in the messages received from a connection.
+ */
+enum class InputError : uint8_t
+{
+    MALFORMED,          ///< The message could not be parsed.
+    MISSING_FIELD,      ///< A required field of the message is missing.
+    UNKNOWN_TYPE,       ///< The message refers to a type that is not registered.
+    UNKNOWN_OPERATION,  ///< The operation of the message is not recognized.
+    INVALID_DATA        ///< A field of the message has a value that cannot be used.
+};
+
+/**
+ * @brief Number of kinds of InputError.
+ */
+constexpr std::size_t InputErrorKinds = 5;
+
+/**
+ * @returns The name of a kind of error, as used in the logs.
+ */
+const char* to_string(
+        InputError kind);
+
+/**
+ * @class ErrorRateLimiter
+ *        Decides which of the errors found in the incoming messages are logged, so that
+ *        a connection sending a flood of bad messages does not flood the log too.
+ *
+ *        Each connection may log up to `burst` errors of each kind per `period`. The rest
+ *        are suppressed and counted, and the count is reported with the next error logged
+ *        or, if there is none, once the period ends.
+ */
+class ErrorRateLimiter
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Function reporting the errors of a kind suppressed for a connection.
+     */
+    using Reporter = std::function<void (const void* connection, InputError kind, uint64_t suppressed)>;
+
+    static constexpr uint32_t DefaultBurst = 5;
+    static constexpr std::chrono::seconds DefaultPeriod{10};
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] burst The number of errors of a kind logged per connection and period.
+     *
+     * @param[in] period The length of the periods.
+     */
+    ErrorRateLimiter(
+            uint32_t burst = DefaultBurst,
+            Clock::duration period = DefaultPeriod);
+
+    /**
+     * @brief Count an error and decide whether it is logged.
+     *
+     * @param[in] connection The connection the message came from.
+     *
+     * @param[in] kind The kind of error.
+     *
+     * @param[out] suppressed If the error is logged, the number of errors of the same kind
+     *             suppressed for the connection since the last one logged.
+     *
+     * @param[in] now The current time.
+     *
+     * @returns `true` if the error must be logged, `false` if it is suppressed.
+     */
+    bool admit(
+            const void* connection,
+            InputError kind,
+            uint64_t& suppressed,
+            Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Report the errors suppressed in the periods that have ended,
+     *        and forget about those periods. It shall be called periodically.
+     */
+    void sweep(
+            const Reporter& reporter,
+            Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Report the errors suppressed for a connection that has been closed,
+     *        and forget about it.
+     */
+    void forget(
+            const void* connection,
+            const Reporter& reporter);
+
+    /**
+     * @returns The number of errors of a kind found so far, logged or not.
+     */
+    uint64_t errors(
+            InputError kind) const
+    {
+        return _errors[static_cast<std::size_t>(kind)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns The number of errors of a kind suppressed so far.
+     */
+    uint64_t suppressed(
+            InputError kind) const
+    {
+        return _suppressed[static_cast<std::size_t>(kind)].load(std::memory_order_relaxed);
+    }
+
+private:
+
+    struct Key
+    {
+        const void* connection;
+        InputError kind;
+
+        bool operator ==(
+                const Key& other) const
+        {
+            return connection == other.connection && kind == other.kind;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator ()(
+                const Key& key) const
+        {
+            return std::hash<const void*>()(key.connection) * InputErrorKinds
+                   + static_cast<std::size_t>(key.kind);
+        }
+    };
+
+    struct Window
+    {
+        Clock::time_point start;
+        uint32_t logged;
+        uint64_t suppressed;
+    };
+
+    const uint32_t _burst;
+    const Clock::duration _period;
+
+    std::mutex _mutex;
+    std::unordered_map<Key, Window, KeyHash> _windows;
+
+    std::array<std::atomic<uint64_t>, InputErrorKinds> _errors;
+    std::array<std::atomic<uint64_t>, InputErrorKinds> _suppressed;
+};
+
+/**
+ * @brief Stream the number of errors suppressed before one that is logged, if any,
+ *        as in `logger << "..." << SuppressedErrors{suppressed} << std::endl;`
+ */
+struct SuppressedErrors
+{
+    uint64_t count;
+};
+
+inline std::ostream& operator <<(
+        std::ostream& os,
+        const SuppressedErrors& suppressed)
+{
+    if (suppressed.count > 0)
+    {
+        os << " (suppressed " << suppressed.count << " similar messages)";
+    }
+    return os;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__ERROR_RATE_LIMITER_HPP_
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "FragmentBuffer.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+FragmentBuffer::FragmentBuffer(
+        std::size_t max_bytes,
+        Clock::duration timeout)
+    : _max_bytes(max_bytes)
+    , _timeout(timeout)
+    , _bytes(0)
+{
+    // Do nothing
+}
+
+//==============================================================================
+FragmentBuffer::Result FragmentBuffer::add(
+        const void* connection,
+        const std::string& id,
+        int64_t num,
+        int64_t total,
+        std::string data,
+        std::string& message,
+        Clock::time_point now)
+{
+    if (total <= 0 || num < 0 || num >= total)
+    {
+        return Result::REJECTED;
+    }
+
+    // Checked before anything is stored, since the number of fragments comes from the peer.
+    if (static_cast<uint64_t>(total) > _max_bytes / FragmentOverhead)
+    {
+        return Result::REJECTED;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _evict_expired(now);
+
+    Key key(connection, id);
+    auto it = _partials.find(key);
+    if (it != _partials.end() && it->second.total != total)
+    {
+        // The sender restarted the message with a different number of fragments.
+        _erase(it);
+        it = _partials.end();
+    }
+
+    if (it == _partials.end())
+    {
+        if (total == 1)
+        {
+            message = std::move(data);
+            return Result::COMPLETE;
+        }
+
+        Partial partial;
+        partial.total = total;
+        partial.bytes = 0;
+        partial.first_seen = now;
+        it = _partials.emplace(key, std::move(partial)).first;
+    }
+
+    Partial& partial = it->second;
+    if (partial.parts.count(num) != 0)
+    {
+        // Duplicated fragment
+        return Result::INCOMPLETE;
+    }
+
+    const std::size_t size = data.size() + FragmentOverhead + (partial.parts.empty() ? id.size() : 0);
+    if (!_make_room(size, key))
+    {
+        _erase(it);
+        return Result::REJECTED;
+    }
+
+    _bytes += size;
+    partial.bytes += size;
+    partial.parts.emplace(num, std::move(data));
+
+    if (static_cast<int64_t>(partial.parts.size()) < partial.total)
+    {
+        return Result::INCOMPLETE;
+    }
+
+    message.clear();
+    message.reserve(partial.bytes);
+    for (const auto& part : partial.parts)
+    {
+        message += part.second;
+    }
+
+    _erase(it);
+    return Result::COMPLETE;
+}
+
+//==============================================================================
+void FragmentBuffer::evict_expired(
+        Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _evict_expired(now);
+}
+
+//==============================================================================
+void FragmentBuffer::forget(
+        const void* connection)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // The keys are sorted by connection first, so its messages are all together.
+    auto it = _partials.lower_bound(Key(connection, std::string()));
+    while (it != _partials.end() && it->first.first == connection)
+    {
+        _bytes -= it->second.bytes;
+        it = _partials.erase(it);
+    }
+}
+
+//==============================================================================
+std::size_t FragmentBuffer::pending() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _partials.size();
+}
+
+//==============================================================================
+std::size_t FragmentBuffer::bytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+}
+
+//==============================================================================
+void FragmentBuffer::_erase(
+        std::map<Key, Partial>::iterator it)
+{
+    _bytes -= it->second.bytes;
+    _partials.erase(it);
+}
+
+//==============================================================================
+void FragmentBuffer::_evict_expired(
+        Clock::time_point now)
+{
+    for (auto it = _partials.begin(); it != _partials.end();)
+    {
+        if (now - it->second.first_seen > _timeout)
+        {
+            _bytes -= it->second.bytes;
+            it = _partials.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+//==============================================================================
+bool FragmentBuffer::_make_room(
+        std::size_t size,
+        const Key& keep)
+{
+    const auto kept = _partials.find(keep);
+    const std::size_t kept_bytes = kept != _partials.end() ? kept->second.bytes : 0;
+
+    if (kept_bytes + size > _max_bytes)
+    {
+        return false;
+    }
+
+    while (_bytes + size > _max_bytes)
+    {
+        // Discard the message that started the longest time ago.
+        auto oldest = _partials.end();
+        for (auto it = _partials.begin(); it != _partials.end(); ++it)
+        {
+            if (it != kept && (oldest == _partials.end()
+                    || it->second.first_seen < oldest->second.first_seen))
+            {
+                oldest = it;
+            }
+        }
+
+        _erase(oldest);
+    }
+
+    return true;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__FRAGMENTBUFFER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__FRAGMENTBUFFER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Limits used by the encodings to reassemble the incoming fragmented messages.
+ */
+const std::size_t FragmentReassemblyMaxBytes = 64 * 1024 * 1024;
+const std::chrono::seconds FragmentReassemblyTimeout(10);
+
+/**
+ * @class FragmentBuffer
+ * @brief Reassembles the messages received split into several fragments.
+ *
+ *        The fragments of every message being reassembled are kept until the message is
+ *        complete, up to `max_bytes` among all the messages. Besides its contents, each fragment
+ *        is charged FragmentOverhead bytes, and the first one of a message the size of its
+ *        identifier, so that no message can hold more memory than it is charged for.
+ *        When that limit would be exceeded, the oldest messages are discarded to make room
+ *        for the new fragment. Messages with more fragments than would fit are rejected.
+ *        Messages whose fragments stop arriving are discarded once `timeout` elapses
+ *        since their first fragment was received, either when another fragment is added
+ *        or when evict_expired() is called, and those of a connection when it is forgotten.
+ *
+ *        This class is thread safe.
+ */
+class FragmentBuffer
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Bytes charged for each fragment held, besides its contents,
+     *        for the bookkeeping it needs.
+     */
+    static constexpr std::size_t FragmentOverhead = 96;
+
+    /**
+     * @brief Outcome of adding a fragment to the buffer.
+     */
+    enum class Result
+    {
+        INCOMPLETE, ///< The fragment was stored, more fragments are needed.
+        COMPLETE,   ///< The fragment completed its message.
+        REJECTED    ///< The fragment is invalid or does not fit in the buffer.
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] max_bytes Maximum amount of bytes held among all the messages.
+     *
+     * @param[in] timeout Maximum time to wait for all the fragments of a message.
+     */
+    FragmentBuffer(
+            std::size_t max_bytes,
+            Clock::duration timeout);
+
+    /**
+     * @brief Add a fragment to the buffer.
+     *
+     * @param[in] connection Identifies the connection the fragment was received from.
+     *            It is not dereferenced, nor does the buffer keep the connection alive,
+     *            so forget() must be called when the connection closes.
+     *
+     * @param[in] id The identifier of the fragmented message.
+     *
+     * @param[in] num The index of the fragment, starting at zero.
+     *
+     * @param[in] total The number of fragments of the message.
+     *
+     * @param[in] data The contents of the fragment.
+     *
+     * @param[out] message The reassembled message, if the result is Result::COMPLETE.
+     *
+     * @param[in] now The time the fragment was received at.
+     *
+     * @returns The outcome of adding the fragment.
+     */
+    Result add(
+            const void* connection,
+            const std::string& id,
+            int64_t num,
+            int64_t total,
+            std::string data,
+            std::string& message,
+            Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Discard the messages whose fragments stopped arriving.
+     *        It shall be called periodically, so that they are discarded
+     *        even if no more fragments are received.
+     *
+     * @param[in] now The current time.
+     */
+    void evict_expired(
+            Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Discard the messages being reassembled for a connection that has been closed.
+     *
+     * @param[in] connection Identifies the connection.
+     */
+    void forget(
+            const void* connection);
+
+    /**
+     * @brief Number of messages being reassembled.
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief Number of bytes charged for the messages being reassembled.
+     */
+    std::size_t bytes() const;
+
+private:
+
+    using Key = std::pair<const void*, std::string>;
+
+    struct Partial
+    {
+        /**
+         * The fragments received so far, by index, so that only they take up memory,
+         * whatever the number of fragments the sender claims.
+         */
+        std::map<int64_t, std::string> parts;
+        int64_t total;
+        std::size_t bytes;
+        Clock::time_point first_seen;
+    };
+
+    void _erase(
+            std::map<Key, Partial>::iterator it);
+
+    void _evict_expired(
+            Clock::time_point now);
+
+    bool _make_room(
+            std::size_t size,
+            const Key& keep);
+
+    const std::size_t _max_bytes;
+    const Clock::duration _timeout;
+
+    mutable std::mutex _mutex;
+    std::map<Key, Partial> _partials;
+    std::size_t _bytes;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__FRAGMENTBUFFER_HPP_
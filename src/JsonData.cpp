@@ -0,0 +1,1003 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonData.hpp"
+
+#include "Base64.hpp"
+
+#include <is/json-xtypes/conversion.hpp>
+#include <is/json-xtypes/json.hpp>
+
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+//==============================================================================
+const xtypes::DynamicType& resolve_alias(
+        const xtypes::DynamicType& type)
+{
+    if (type.kind() == xtypes::TypeKind::ALIAS_TYPE)
+    {
+        return static_cast<const xtypes::AliasType&>(type).rget();
+    }
+    return type;
+}
+
+//==============================================================================
+template<typename T>
+typename std::enable_if<std::is_signed<T>::value, T>::type read_integer(
+        JsonReader& reader)
+{
+    const int64_t value = reader.read_int();
+    if (value < static_cast<int64_t>(std::numeric_limits<T>::min())
+            || value > static_cast<int64_t>(std::numeric_limits<T>::max()))
+    {
+        throw JsonError("integer " + std::to_string(value) + " out of range");
+    }
+    return static_cast<T>(value);
+}
+
+//==============================================================================
+template<typename T>
+typename std::enable_if<std::is_unsigned<T>::value, T>::type read_integer(
+        JsonReader& reader)
+{
+    const uint64_t value = reader.read_uint();
+    if (value > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+    {
+        throw JsonError("integer " + std::to_string(value) + " out of range");
+    }
+    return static_cast<T>(value);
+}
+
+//==============================================================================
+/**
+ * @brief Read a floating point number. `null` stands for NaN, which is how
+ *        *JSON* encoders, including the one of *json-xtypes*, write it.
+ */
+template<typename T>
+T read_floating_point(
+        JsonReader& reader)
+{
+    if (reader.is_null())
+    {
+        reader.read_null();
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+    return static_cast<T>(reader.read_double());
+}
+
+//==============================================================================
+/**
+ * @brief Read a character, written either as a string of one character or as its code.
+ */
+char read_char(
+        JsonReader& reader)
+{
+    if (reader.peek_type() == JsonType::NUMBER)
+    {
+        return static_cast<char>(read_integer<int8_t>(reader));
+    }
+
+    const std::string value = reader.read_string();
+    if (value.size() != 1)
+    {
+        throw JsonError("expected a single character, got '" + value + "'");
+    }
+    return value[0];
+}
+
+//==============================================================================
+template<typename T>
+struct NumberReader;
+
+template<>
+struct NumberReader<float>
+{
+    static float read(
+            JsonReader& reader)
+    {
+        return read_floating_point<float>(reader);
+    }
+
+};
+
+template<>
+struct NumberReader<double>
+{
+    static double read(
+            JsonReader& reader)
+    {
+        return read_floating_point<double>(reader);
+    }
+
+};
+
+template<>
+struct NumberReader<char>
+{
+    static char read(
+            JsonReader& reader)
+    {
+        return read_char(reader);
+    }
+
+};
+
+template<typename T>
+struct NumberReader
+{
+    static T read(
+            JsonReader& reader)
+    {
+        return read_integer<T>(reader);
+    }
+
+};
+
+//==============================================================================
+/**
+ * @brief Check that a sequence does not exceed its bounds, or that an array has
+ *        exactly its number of elements.
+ */
+void check_collection_size(
+        const xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds,
+        std::size_t size)
+{
+    if (kind == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        if (bounds > 0 && size > bounds)
+        {
+            throw JsonError("sequence of " + std::to_string(size)
+                          + " elements exceeds its bound of " + std::to_string(bounds));
+        }
+    }
+    else if (size != data.size())
+    {
+        throw JsonError("array of " + std::to_string(size) + " elements, expected "
+                      + std::to_string(data.size()));
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read a collection of primitives. Their number is not known until the end
+ *        of the *JSON* array is found, so they are gathered first, and then stored
+ *        in the data with a single resize.
+ */
+template<typename T>
+void read_primitive_collection(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds)
+{
+    thread_local std::vector<T> values;
+    values.clear();
+
+    reader.begin_array();
+    while (reader.next_element())
+    {
+        values.push_back(NumberReader<T>::read(reader));
+    }
+
+    check_collection_size(data, kind, bounds, values.size());
+    if (kind == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        data.resize(values.size());
+    }
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        data[i].value(values[i]);
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read a collection of bytes from either a base64 string or an array of numbers.
+ */
+template<typename T>
+void read_byte_collection(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds)
+{
+    if (reader.peek_type() != JsonType::STRING)
+    {
+        read_primitive_collection<T>(reader, data, kind, bounds);
+        return;
+    }
+
+    thread_local std::string text;
+    reader.read_string(text);
+    thread_local std::vector<uint8_t> bytes;
+    bytes.resize(base64_decoded_size(text.size()));
+
+    std::size_t size = 0;
+    if (!base64_decode(text.data(), text.size(), bytes.data(), size))
+    {
+        throw JsonError("invalid base64 string for a collection of bytes");
+    }
+
+    check_collection_size(data, kind, bounds, size);
+    if (kind == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        data.resize(size);
+    }
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        data[i].value(static_cast<T>(bytes[i]));
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read an array or sequence whose elements are numbers or characters.
+ *
+ * @returns `false`, without reading anything, if the elements are of any other kind.
+ */
+bool read_number_collection(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds,
+        xtypes::TypeKind element_kind)
+{
+    switch (element_kind)
+    {
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            read_primitive_collection<char>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            read_byte_collection<uint8_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_8_TYPE:
+            read_byte_collection<int8_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_16_TYPE:
+            read_primitive_collection<int16_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            read_primitive_collection<uint16_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_32_TYPE:
+            read_primitive_collection<int32_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            read_primitive_collection<uint32_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_64_TYPE:
+            read_primitive_collection<int64_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            read_primitive_collection<uint64_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            read_primitive_collection<float>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            read_primitive_collection<double>(reader, data, kind, bounds);
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read an array or sequence of complex elements, decoding them in place
+ *        and growing the sequence one element at a time.
+ *
+ * @param[in] plan The plan of the elements, if they are structures, or `nullptr`
+ *            to decode them following their type.
+ */
+void read_element_collection(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds,
+        const CodecPlan* plan)
+{
+    std::size_t size = 0;
+    reader.begin_array();
+    while (reader.next_element())
+    {
+        check_collection_size(data, kind, bounds, size + 1);
+        if (kind == xtypes::TypeKind::SEQUENCE_TYPE)
+        {
+            data.resize(size + 1);
+        }
+        else if (size >= data.size())
+        {
+            throw JsonError("array has more than its " + std::to_string(data.size()) + " elements");
+        }
+        if (nullptr != plan)
+        {
+            read_json_data(reader, data[size], *plan);
+        }
+        else
+        {
+            read_json_data(reader, data[size]);
+        }
+        ++size;
+    }
+
+    if (kind == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        data.resize(size);
+    }
+    else
+    {
+        check_collection_size(data, kind, bounds, size);
+    }
+}
+
+//==============================================================================
+void read_collection(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        const xtypes::DynamicType& type)
+{
+    const xtypes::DynamicType& content =
+            resolve_alias(static_cast<const xtypes::CollectionType&>(type).content_type());
+    const std::size_t bounds = type.kind() == xtypes::TypeKind::SEQUENCE_TYPE ?
+            static_cast<const xtypes::SequenceType&>(type).bounds() : 0;
+
+    if (!read_number_collection(reader, data, type.kind(), bounds, content.kind()))
+    {
+        read_element_collection(reader, data, type.kind(), bounds, nullptr);
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Decode a value through a *json-xtypes* document, for the kinds of data
+ *        that are not decoded directly.
+ */
+void read_through_json_xtypes(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data)
+{
+    try
+    {
+        data = json_xtypes::convert(data.type(), json_xtypes::Json::parse(reader.read_raw()));
+    }
+    catch (const json_xtypes::UnsupportedType& e)
+    {
+        throw JsonError(e.what());
+    }
+    catch (const json_xtypes::Json::exception& e)
+    {
+        throw JsonError(e.what());
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Encode a value through a *json-xtypes* document, for the kinds of data
+ *        that are not encoded directly, so that they are written as read_through_json_xtypes()
+ *        reads them.
+ */
+void write_through_json_xtypes(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data)
+{
+    try
+    {
+        // The conversion takes whole instances, so the value is copied into one.
+        writer.write_raw(json_xtypes::convert(xtypes::DynamicData(data, data.type())).dump());
+    }
+    catch (const json_xtypes::UnsupportedType& e)
+    {
+        throw JsonError(e.what());
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Write a wide character as UTF-8, taking its value as a code point.
+ */
+void append_wide_char(
+        std::string& output,
+        wchar_t wide)
+{
+    const uint32_t code_point = static_cast<uint32_t>(wide);
+    if (code_point < 0x80)
+    {
+        output.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        output.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        output.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        output.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+//==============================================================================
+void write_wide_string(
+        JsonWriter& writer,
+        const std::wstring& value)
+{
+    // Wide strings are rare, so the temporary is not worth avoiding.
+    std::string utf8;
+    for (const wchar_t wide : value)
+    {
+        append_wide_char(utf8, wide);
+    }
+    writer.write_string(utf8);
+}
+
+//==============================================================================
+/**
+ * @brief Write the elements of a collection of primitives, one after another.
+ *        They are read one by one, since `as_vector()` would copy them into a new vector.
+ */
+template<typename T, typename Written = T>
+void write_primitive_collection(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        void (JsonWriter::* write)(Written))
+{
+    const std::size_t size = data.size();
+    writer.begin_array();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        (writer.*write)(static_cast<Written>(data[i].value<T>()));
+    }
+    writer.end_array();
+}
+
+//==============================================================================
+/**
+ * @brief Write a collection of bytes as a base64 string. They are gathered first,
+ *        since the elements of the data cannot be accessed as contiguous memory.
+ */
+template<typename T>
+void write_base64_collection(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data)
+{
+    thread_local std::vector<uint8_t> bytes;
+    const std::size_t size = data.size();
+    bytes.resize(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(data[i].value<T>());
+    }
+    writer.write_base64(bytes.data(), size);
+}
+
+//==============================================================================
+/**
+ * @brief Write an array or sequence whose elements are numbers or characters.
+ *
+ * @returns `false`, without writing anything, if the elements are of any other kind.
+ */
+bool write_number_collection(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        xtypes::TypeKind element_kind,
+        ByteEncoding bytes)
+{
+    switch (element_kind)
+    {
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            write_primitive_collection<char, int64_t>(writer, data, &JsonWriter::write_int);
+            return true;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            if (bytes == ByteEncoding::BASE64)
+            {
+                write_base64_collection<uint8_t>(writer, data);
+            }
+            else
+            {
+                write_primitive_collection<uint8_t, uint64_t>(writer, data, &JsonWriter::write_uint);
+            }
+            return true;
+        case xtypes::TypeKind::INT_8_TYPE:
+            if (bytes == ByteEncoding::BASE64)
+            {
+                write_base64_collection<int8_t>(writer, data);
+            }
+            else
+            {
+                write_primitive_collection<int8_t, int64_t>(writer, data, &JsonWriter::write_int);
+            }
+            return true;
+        case xtypes::TypeKind::INT_16_TYPE:
+            write_primitive_collection<int16_t, int64_t>(writer, data, &JsonWriter::write_int);
+            return true;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            write_primitive_collection<uint16_t, uint64_t>(writer, data, &JsonWriter::write_uint);
+            return true;
+        case xtypes::TypeKind::INT_32_TYPE:
+            write_primitive_collection<int32_t, int64_t>(writer, data, &JsonWriter::write_int);
+            return true;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            write_primitive_collection<uint32_t, uint64_t>(writer, data, &JsonWriter::write_uint);
+            return true;
+        case xtypes::TypeKind::INT_64_TYPE:
+            write_primitive_collection<int64_t>(writer, data, &JsonWriter::write_int);
+            return true;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            write_primitive_collection<uint64_t>(writer, data, &JsonWriter::write_uint);
+            return true;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            write_primitive_collection<float>(writer, data, &JsonWriter::write_float);
+            return true;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            write_primitive_collection<double>(writer, data, &JsonWriter::write_double);
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Write an array or sequence of complex elements.
+ *
+ * @param[in] plan The plan of the elements, if they are structures, or `nullptr`
+ *            to encode them following their type.
+ */
+void write_element_collection(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan* plan,
+        ByteEncoding bytes)
+{
+    const std::size_t size = data.size();
+    writer.begin_array();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (nullptr != plan)
+        {
+            write_json_data(writer, data[i], *plan, bytes);
+        }
+        else
+        {
+            write_json_data(writer, data[i], bytes);
+        }
+    }
+    writer.end_array();
+}
+
+//==============================================================================
+/**
+ * @brief Read a value of a kind that maps to a single *JSON* value:
+ *        a boolean, a number, a character, a string or an enumeration.
+ *
+ * @returns `false`, without reading anything, if the data is of any other kind.
+ */
+bool read_primitive(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind)
+{
+    switch (kind)
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            data.value(reader.read_bool());
+            return true;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            data.value(read_char(reader));
+            return true;
+        case xtypes::TypeKind::INT_8_TYPE:
+            data.value(read_integer<int8_t>(reader));
+            return true;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            data.value(read_integer<uint8_t>(reader));
+            return true;
+        case xtypes::TypeKind::INT_16_TYPE:
+            data.value(read_integer<int16_t>(reader));
+            return true;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            data.value(read_integer<uint16_t>(reader));
+            return true;
+        case xtypes::TypeKind::INT_32_TYPE:
+            data.value(read_integer<int32_t>(reader));
+            return true;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            data.value(read_integer<uint32_t>(reader));
+            return true;
+        case xtypes::TypeKind::INT_64_TYPE:
+            data.value(read_integer<int64_t>(reader));
+            return true;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            data.value(read_integer<uint64_t>(reader));
+            return true;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            data.value(read_floating_point<float>(reader));
+            return true;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            data.value(read_floating_point<double>(reader));
+            return true;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            data.value(read_floating_point<long double>(reader));
+            return true;
+        case xtypes::TypeKind::STRING_TYPE:
+        {
+            // Read into a buffer kept by the thread, and copied into the data,
+            // so that neither allocates once they have grown to the size of the string.
+            thread_local std::string value;
+            reader.read_string(value);
+            data.value(value);
+            return true;
+        }
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            data.value(read_integer<uint32_t>(reader));
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Write a value of a kind that maps to a single *JSON* value:
+ *        a boolean, a number, a character, a string or an enumeration.
+ *
+ * @returns `false`, without writing anything, if the data is of any other kind.
+ */
+bool write_primitive(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        xtypes::TypeKind kind)
+{
+    switch (kind)
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            writer.write_bool(data.value<bool>());
+            return true;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            // Characters are numbers for json-xtypes, so they are kept as such.
+            writer.write_int(data.value<char>());
+            return true;
+        case xtypes::TypeKind::CHAR_16_TYPE:
+        {
+            std::string utf8;
+            append_wide_char(utf8, data.value<wchar_t>());
+            writer.write_string(utf8);
+            return true;
+        }
+        case xtypes::TypeKind::INT_8_TYPE:
+            writer.write_int(data.value<int8_t>());
+            return true;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            writer.write_uint(data.value<uint8_t>());
+            return true;
+        case xtypes::TypeKind::INT_16_TYPE:
+            writer.write_int(data.value<int16_t>());
+            return true;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            writer.write_uint(data.value<uint16_t>());
+            return true;
+        case xtypes::TypeKind::INT_32_TYPE:
+            writer.write_int(data.value<int32_t>());
+            return true;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            writer.write_uint(data.value<uint32_t>());
+            return true;
+        case xtypes::TypeKind::INT_64_TYPE:
+            writer.write_int(data.value<int64_t>());
+            return true;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            writer.write_uint(data.value<uint64_t>());
+            return true;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            writer.write_float(data.value<float>());
+            return true;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            writer.write_double(data.value<double>());
+            return true;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            writer.write_double(static_cast<double>(data.value<long double>()));
+            return true;
+        case xtypes::TypeKind::STRING_TYPE:
+            writer.write_string(data.value<std::string>());
+            return true;
+        case xtypes::TypeKind::WSTRING_TYPE:
+            write_wide_string(writer, data.value<std::wstring>());
+            return true;
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            writer.write_uint(data.value<uint32_t>());
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read a member of a structure following its plan, falling back to its type
+ *        for the kinds of data the plan does not handle.
+ */
+void read_field(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef data,
+        const CodecField& field)
+{
+    switch (field.kind)
+    {
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+            read_json_data(reader, data, *field.plan);
+            return;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            if (!read_number_collection(reader, data, field.kind, field.bounds, field.element_kind))
+            {
+                read_element_collection(reader, data, field.kind, field.bounds, field.plan);
+            }
+            return;
+        default:
+            if (!read_primitive(reader, data, field.kind))
+            {
+                read_json_data(reader, data);
+            }
+            return;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Write a member of a structure following its plan, falling back to its type
+ *        for the kinds of data the plan does not handle.
+ */
+void write_field(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecField& field,
+        ByteEncoding bytes)
+{
+    switch (field.kind)
+    {
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+            write_json_data(writer, data, *field.plan, bytes);
+            return;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            if (!write_number_collection(writer, data, field.element_kind, bytes))
+            {
+                write_element_collection(writer, data, field.plan, bytes);
+            }
+            return;
+        default:
+            if (!write_primitive(writer, data, field.kind))
+            {
+                write_json_data(writer, data, bytes);
+            }
+            return;
+    }
+}
+
+/**
+ * Number of elements assumed for sequences, and of characters for strings,
+ * when estimating the encoded size of a type.
+ */
+const std::size_t EstimatedElements = 16;
+
+} // anonymous namespace
+
+//==============================================================================
+void read_json_data(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef data)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+    if (read_primitive(reader, data, type.kind()))
+    {
+        return;
+    }
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            read_collection(reader, data, type);
+            break;
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& structure = static_cast<const xtypes::StructType&>(type);
+            std::string name;
+            reader.begin_object();
+            while (reader.next_key(name))
+            {
+                if (structure.has_member(name))
+                {
+                    read_json_data(reader, data[name]);
+                }
+                else
+                {
+                    reader.skip();
+                }
+            }
+            break;
+        }
+        default:
+            read_through_json_xtypes(reader, data);
+            break;
+    }
+}
+
+//==============================================================================
+void read_json_data(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef data,
+        const CodecPlan& plan)
+{
+    // The key is only needed until its member is found, before nested structures
+    // are read, so they can share the buffer kept by the thread.
+    thread_local std::string name;
+    std::size_t next = 0;
+    reader.begin_object();
+    while (reader.next_key(name))
+    {
+        const CodecField* field = plan.find(name, next);
+        if (nullptr == field)
+        {
+            reader.skip();
+            continue;
+        }
+        read_field(reader, data[field->index], *field);
+        next = field->index + 1;
+    }
+}
+
+//==============================================================================
+void write_json_data(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        ByteEncoding bytes)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+    if (write_primitive(writer, data, type.kind()))
+    {
+        return;
+    }
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+        {
+            const xtypes::DynamicType& content =
+                    resolve_alias(static_cast<const xtypes::CollectionType&>(type).content_type());
+            if (!write_number_collection(writer, data, content.kind(), bytes))
+            {
+                write_element_collection(writer, data, nullptr, bytes);
+            }
+            break;
+        }
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& structure = static_cast<const xtypes::StructType&>(type);
+            writer.begin_object();
+            for (const xtypes::Member& member : structure.members())
+            {
+                writer.key(member.name());
+                write_json_data(writer, data[member.name()], bytes);
+            }
+            writer.end_object();
+            break;
+        }
+        default:
+            write_through_json_xtypes(writer, data);
+            break;
+    }
+}
+
+//==============================================================================
+void write_json_data(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan& plan,
+        ByteEncoding bytes)
+{
+    writer.begin_object();
+    for (const CodecField& field : plan.fields())
+    {
+        writer.prepared_key(field.json_key);
+        write_field(writer, data[field.index], field, bytes);
+    }
+    writer.end_object();
+}
+
+//==============================================================================
+std::size_t estimate_json_size(
+        const xtypes::DynamicType& type)
+{
+    const xtypes::DynamicType& resolved = resolve_alias(type);
+
+    switch (resolved.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            return 5;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+        case xtypes::TypeKind::INT_8_TYPE:
+        case xtypes::TypeKind::UINT_8_TYPE:
+            return 4;
+        case xtypes::TypeKind::INT_16_TYPE:
+        case xtypes::TypeKind::UINT_16_TYPE:
+            return 6;
+        case xtypes::TypeKind::INT_32_TYPE:
+        case xtypes::TypeKind::UINT_32_TYPE:
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            return 11;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            return 15;
+        case xtypes::TypeKind::INT_64_TYPE:
+        case xtypes::TypeKind::UINT_64_TYPE:
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            return 24;
+        case xtypes::TypeKind::STRING_TYPE:
+        case xtypes::TypeKind::WSTRING_TYPE:
+            return 2 + EstimatedElements;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        {
+            const xtypes::ArrayType& array = static_cast<const xtypes::ArrayType&>(resolved);
+            return 2 + array.dimension() * (estimate_json_size(array.content_type()) + 1);
+        }
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+        {
+            const xtypes::SequenceType& sequence = static_cast<const xtypes::SequenceType&>(resolved);
+            const std::size_t elements = sequence.bounds() > 0 && sequence.bounds() < EstimatedElements ?
+                    sequence.bounds() : EstimatedElements;
+            return 2 + elements * (estimate_json_size(sequence.content_type()) + 1);
+        }
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            std::size_t size = 2;
+            for (const xtypes::Member& member : static_cast<const xtypes::StructType&>(resolved).members())
+            {
+                size += member.name().size() + 4 + estimate_json_size(member.type());
+            }
+            return size;
+        }
+        default:
+            return EstimatedElements;
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
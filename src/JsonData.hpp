@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSON_DATA_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSON_DATA_HPP_
+
+#include "CodecPlan.hpp"
+#include "JsonReader.hpp"
+#include "JsonWriter.hpp"
+
+#include <is/core/Message.hpp>
+
+namespace xtypes = eprosima::xtypes;
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief How arrays and sequences of bytes, of type `uint8` or `int8`, are encoded.
+ */
+enum class ByteEncoding
+{
+    /**
+     * As arrays of numbers, as *json-xtypes* does.
+     */
+    ARRAY,
+
+    /**
+     * As base64 strings, as *rosbridge* does, which are several times shorter.
+     */
+    BASE64
+};
+
+/**
+ * @brief Decode the next *JSON* value straight into a dynamic data instance,
+ *        following its type, without building an intermediate *JSON* document.
+ *
+ * @details Members of a structure missing from the value keep their current value,
+ *          and unknown members are skipped without being decoded. Sequences are
+ *          resized to the number of elements read. Arrays and sequences of bytes are read
+ *          from either arrays of numbers or base64 strings, whatever the ByteEncoding
+ *          of the sender. Kinds of data not handled directly, such as wide strings
+ *          or unions, are converted through *json-xtypes*.
+ *
+ * @param[in] reader The reader, positioned at the value to decode.
+ *
+ * @param[out] data The dynamic data where the value is decoded.
+ *
+ * @throws JsonError If the value is malformed or does not match the type of the data.
+ */
+void read_json_data(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef data);
+
+/**
+ * @brief Decode the next *JSON* object straight into a structure, following its
+ *        compiled plan instead of walking its type.
+ *
+ * @param[in] reader The reader, positioned at the object to decode.
+ *
+ * @param[out] data The dynamic data where the object is decoded.
+ *
+ * @param[in] plan The plan of the type of the data.
+ *
+ * @throws JsonError If the object is malformed or does not match the type of the data.
+ */
+void read_json_data(
+        JsonReader& reader,
+        xtypes::WritableDynamicDataRef data,
+        const CodecPlan& plan);
+
+/**
+ * @brief Encode a dynamic data instance straight into *JSON* text,
+ *        without building an intermediate *JSON* document.
+ *
+ * @details The text is the same that *json-xtypes* produces, except for the order
+ *          of the members, which follows the type instead of being alphabetical,
+ *          and for floating point numbers, which are written with the fewest digits
+ *          that read back as the same value. Kinds of data not handled directly,
+ *          such as unions, maps or bitsets, are converted through *json-xtypes*.
+ *
+ * @param[in] writer The writer where the data is appended.
+ *
+ * @param[in] data The dynamic data to encode.
+ *
+ * @param[in] bytes How the arrays and sequences of bytes are encoded.
+ *
+ * @throws JsonError If the data, or any of its members, is of a kind that *json-xtypes*
+ *         cannot encode either.
+ */
+void write_json_data(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        ByteEncoding bytes = ByteEncoding::ARRAY);
+
+/**
+ * @brief Encode a structure straight into *JSON* text, following its compiled plan
+ *        instead of walking its type. The text is the same write_json_data() produces.
+ *
+ * @param[in] writer The writer where the data is appended.
+ *
+ * @param[in] data The dynamic data to encode.
+ *
+ * @param[in] plan The plan of the type of the data.
+ *
+ * @param[in] bytes How the arrays and sequences of bytes are encoded.
+ *
+ * @throws JsonError If any of the members is of a kind that *json-xtypes* cannot encode either.
+ */
+void write_json_data(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan& plan,
+        ByteEncoding bytes = ByteEncoding::ARRAY);
+
+/**
+ * @brief Estimate the size of the *JSON* text of an instance of a type,
+ *        so that buffers can be sized before encoding.
+ *
+ * @details Sequences and strings are assumed to hold a few elements.
+ */
+std::size_t estimate_json_size(
+        const xtypes::DynamicType& type);
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSON_DATA_HPP_
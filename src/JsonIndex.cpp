@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonIndex.hpp"
+
+#include <cstring>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * Number of members expected in an object, which rosbridge messages seldom exceed.
+ */
+static const std::size_t ExpectedMembers = 8;
+
+//==============================================================================
+JsonIndex::JsonIndex(
+        const char* data,
+        std::size_t size,
+        Arena& arena)
+    : _data(data)
+    , _size(size)
+    , _fields(ArenaAllocator<Field>(arena))
+{
+    _fields.reserve(ExpectedMembers);
+
+    // Keys are unescaped into a buffer kept by the thread, and then copied into the arena.
+    thread_local std::string key;
+
+    JsonReader reader(data, size);
+    reader.begin_object();
+    while (reader.next_key(key))
+    {
+        char* stored = static_cast<char*>(arena.allocate(key.size(), 1));
+        std::memcpy(stored, key.data(), key.size());
+        _fields.push_back({stored, key.size(), reader.position()});
+        reader.skip();
+    }
+
+    if (!reader.at_end())
+    {
+        throw JsonError("unexpected text after the message");
+    }
+}
+
+//==============================================================================
+const std::size_t* JsonIndex::find(
+        const std::string& key) const
+{
+    // Messages have a handful of members, so a linear search beats hashing.
+    for (const Field& field : _fields)
+    {
+        if (field.key_size == key.size() && std::memcmp(field.key, key.data(), key.size()) == 0)
+        {
+            return &field.position;
+        }
+    }
+    return nullptr;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
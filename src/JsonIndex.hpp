@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSON_INDEX_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSON_INDEX_HPP_
+
+#include "Arena.hpp"
+#include "JsonReader.hpp"
+
+#include <string>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class JsonIndex
+ *        Records where the value of each member of a *JSON* object starts, walking it once,
+ *        so that the members can then be read in any order.
+ *
+ *        The index is allocated from an arena, so that indexing a message does not allocate
+ *        once the arena has grown. It must not outlive the scope of the arena it was built in.
+ */
+class JsonIndex
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] data The text of the object. It must outlive the index.
+     *
+     * @param[in] size The size of the text.
+     *
+     * @param[in] arena The arena the index is allocated from.
+     *
+     * @throws JsonError If the text is not a single well formed object.
+     */
+    JsonIndex(
+            const char* data,
+            std::size_t size,
+            Arena& arena = Arena::local());
+
+    /**
+     * @brief Find the value of a member.
+     *
+     * @param[in] key The key of the member.
+     *
+     * @returns The offset of the value in the text, or `nullptr` if the object
+     *          has no member with that key.
+     */
+    const std::size_t* find(
+            const std::string& key) const;
+
+    /**
+     * @brief Get a reader positioned at the value of a member, which must exist.
+     */
+    JsonReader at(
+            const std::string& key) const
+    {
+        return JsonReader(_data, _size, *find(key));
+    }
+
+private:
+
+    struct Field
+    {
+        /**
+         * The key of the member, unescaped, copied into the arena.
+         */
+        const char* key;
+        std::size_t key_size;
+
+        std::size_t position;
+    };
+
+    const char* _data;
+    std::size_t _size;
+    std::vector<Field, ArenaAllocator<Field>> _fields;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSON_INDEX_HPP_
@@ -0,0 +1,756 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonReader.hpp"
+
+#include "JsonScan.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+/**
+ * Values cannot be nested deeper than this, so that malicious messages cannot exhaust the stack.
+ */
+const std::size_t MaxNestingDepth = 256;
+
+/**
+ * Significands up to this magnitude are represented exactly in double precision.
+ */
+const uint64_t MaxExactDouble = uint64_t(1) << 53;
+
+//==============================================================================
+bool is_digit(
+        char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+//==============================================================================
+int hex_digit(
+        char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+//==============================================================================
+void append_utf8(
+        std::string& output,
+        uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        output.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        output.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        output.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        output.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+} // anonymous namespace
+
+//==============================================================================
+JsonReader::JsonReader(
+        const char* data,
+        std::size_t size,
+        std::size_t position)
+    : _data(data)
+    , _size(size)
+    , _position(position)
+    , _first(false)
+{
+    // Do nothing
+}
+
+//==============================================================================
+std::size_t JsonReader::position()
+{
+    skip_whitespace();
+    return _position;
+}
+
+//==============================================================================
+bool JsonReader::at_end()
+{
+    skip_whitespace();
+    return _position >= _size;
+}
+
+//==============================================================================
+JsonType JsonReader::peek_type()
+{
+    switch (peek_char())
+    {
+        case 'n':
+            return JsonType::NULL_VALUE;
+        case 't':
+        case 'f':
+            return JsonType::BOOLEAN;
+        case '"':
+            return JsonType::STRING;
+        case '[':
+            return JsonType::ARRAY;
+        case '{':
+            return JsonType::OBJECT;
+        case '-':
+            return JsonType::NUMBER;
+        default:
+            break;
+    }
+
+    if (is_digit(_data[_position]))
+    {
+        return JsonType::NUMBER;
+    }
+    throw JsonError("unexpected character '" + std::string(1, _data[_position])
+                  + "' at offset " + std::to_string(_position));
+}
+
+//==============================================================================
+bool JsonReader::is_null()
+{
+    return peek_char() == 'n';
+}
+
+//==============================================================================
+void JsonReader::read_null()
+{
+    expect_literal("null", 4);
+}
+
+//==============================================================================
+bool JsonReader::read_bool()
+{
+    if (peek_char() == 't')
+    {
+        expect_literal("true", 4);
+        return true;
+    }
+
+    expect_literal("false", 5);
+    return false;
+}
+
+//==============================================================================
+uint64_t JsonReader::read_uint()
+{
+    if (peek_char() == '-')
+    {
+        throw JsonError("expected a non-negative integer at offset " + std::to_string(_position));
+    }
+
+    bool integer;
+    const std::size_t end = scan_number(integer);
+    if (!integer)
+    {
+        throw JsonError("expected an integer at offset " + std::to_string(_position));
+    }
+    return parse_magnitude(end);
+}
+
+//==============================================================================
+int64_t JsonReader::read_int()
+{
+    const bool negative = peek_char() == '-';
+
+    bool integer;
+    const std::size_t end = scan_number(integer);
+    if (!integer)
+    {
+        throw JsonError("expected an integer at offset " + std::to_string(_position));
+    }
+
+    if (negative)
+    {
+        ++_position;
+    }
+    const uint64_t magnitude = parse_magnitude(end);
+
+    if (negative)
+    {
+        // The magnitude of the lowest int64_t does not fit in an int64_t.
+        if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1)
+        {
+            throw JsonError("integer out of range");
+        }
+        return static_cast<int64_t>(~magnitude + 1);
+    }
+
+    if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+    {
+        throw JsonError("integer out of range");
+    }
+    return static_cast<int64_t>(magnitude);
+}
+
+//==============================================================================
+double JsonReader::read_double()
+{
+    const bool negative = peek_char() == '-';
+    const std::size_t start = _position;
+
+    bool integer;
+    const std::size_t end = scan_number(integer);
+
+    // Fast path: when the significant digits fit in 53 bits and the decimal exponent
+    // is small, both are exact doubles and a single multiplication or division
+    // rounds correctly. Otherwise, fall back to strtod.
+    static const double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    std::size_t i = negative ? start + 1 : start;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    for (; i < end && is_digit(_data[i]); ++i)
+    {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(_data[i] - '0');
+        digits += (mantissa != 0);
+    }
+    if (i < end && _data[i] == '.')
+    {
+        for (++i; i < end && is_digit(_data[i]); ++i)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(_data[i] - '0');
+            digits += (mantissa != 0);
+            --exponent;
+        }
+    }
+    if (!integer && i < end && (_data[i] == 'e' || _data[i] == 'E'))
+    {
+        ++i;
+        const bool negative_exponent = _data[i] == '-';
+        if (_data[i] == '+' || _data[i] == '-')
+        {
+            ++i;
+        }
+
+        int explicit_exponent = 0;
+        for (; i < end && explicit_exponent < 10000; ++i)
+        {
+            explicit_exponent = explicit_exponent * 10 + (_data[i] - '0');
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (digits <= 15 && mantissa <= MaxExactDouble && exponent >= -22 && exponent <= 22)
+    {
+        _position = end;
+
+        double value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+        return negative ? -value : value;
+    }
+
+    // strtod needs a null terminated string, which the input is not guaranteed to be.
+    const std::size_t length = end - start;
+    char buffer[64];
+    double value;
+    if (length < sizeof(buffer))
+    {
+        std::memcpy(buffer, _data + start, length);
+        buffer[length] = '\0';
+        value = std::strtod(buffer, nullptr);
+    }
+    else
+    {
+        value = std::strtod(std::string(_data + start, length).c_str(), nullptr);
+    }
+
+    _position = end;
+    return value;
+}
+
+//==============================================================================
+std::string JsonReader::read_string()
+{
+    std::string value;
+    read_string(value);
+    return value;
+}
+
+//==============================================================================
+void JsonReader::read_string(
+        std::string& value)
+{
+    expect('"');
+    value.clear();
+
+    while (true)
+    {
+        // Copy the longest run of characters that need no unescaping at once.
+        const std::size_t start = _position;
+        _position += scan_json_string(_data + _position, _size - _position);
+        value.append(_data + start, _position - start);
+
+        if (_position >= _size)
+        {
+            throw JsonError("unterminated string");
+        }
+
+        const char c = _data[_position++];
+        if (c == '"')
+        {
+            return;
+        }
+        if (c != '\\')
+        {
+            throw JsonError("unescaped control character in string at offset "
+                          + std::to_string(_position - 1));
+        }
+
+        if (_position >= _size)
+        {
+            throw JsonError("unterminated string");
+        }
+
+        switch (_data[_position++])
+        {
+            case '"':
+                value.push_back('"');
+                break;
+            case '\\':
+                value.push_back('\\');
+                break;
+            case '/':
+                value.push_back('/');
+                break;
+            case 'b':
+                value.push_back('\b');
+                break;
+            case 'f':
+                value.push_back('\f');
+                break;
+            case 'n':
+                value.push_back('\n');
+                break;
+            case 'r':
+                value.push_back('\r');
+                break;
+            case 't':
+                value.push_back('\t');
+                break;
+            case 'u':
+            {
+                auto read_hex4 = [this]() -> uint32_t
+                        {
+                            if (_size - _position < 4)
+                            {
+                                throw JsonError("truncated unicode escape");
+                            }
+
+                            uint32_t code_unit = 0;
+                            for (int i = 0; i < 4; ++i)
+                            {
+                                const int digit = hex_digit(_data[_position++]);
+                                if (digit < 0)
+                                {
+                                    throw JsonError("invalid unicode escape");
+                                }
+                                code_unit = (code_unit << 4) | static_cast<uint32_t>(digit);
+                            }
+                            return code_unit;
+                        };
+
+                uint32_t code_point = read_hex4();
+                if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                {
+                    if (_size - _position < 2 || _data[_position] != '\\' || _data[_position + 1] != 'u')
+                    {
+                        throw JsonError("unpaired surrogate in unicode escape");
+                    }
+                    _position += 2;
+
+                    const uint32_t low = read_hex4();
+                    if (low < 0xDC00 || low > 0xDFFF)
+                    {
+                        throw JsonError("unpaired surrogate in unicode escape");
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+                {
+                    throw JsonError("unpaired surrogate in unicode escape");
+                }
+
+                append_utf8(value, code_point);
+                break;
+            }
+            default:
+                throw JsonError("invalid escape sequence at offset " + std::to_string(_position - 1));
+        }
+    }
+}
+
+//==============================================================================
+void JsonReader::begin_object()
+{
+    expect('{');
+    _first = true;
+}
+
+//==============================================================================
+std::string_view JsonReader::read_string_view(
+        std::string& buffer)
+{
+    expect('"');
+
+    // Most strings have no escape sequences, and are found whole by a single scan.
+    const std::size_t start = _position;
+    const std::size_t end = start + scan_json_string(_data + start, _size - start);
+    if (end < _size && _data[end] == '"')
+    {
+        _position = end + 1;
+        return std::string_view(_data + start, end - start);
+    }
+
+    _position = start - 1;
+    read_string(buffer);
+    return buffer;
+}
+
+//==============================================================================
+bool JsonReader::next_key(
+        std::string& key)
+{
+    if (peek_char() == '}')
+    {
+        ++_position;
+        _first = false;
+        return false;
+    }
+
+    if (!_first)
+    {
+        expect(',');
+    }
+
+    read_string(key);
+    expect(':');
+    _first = false;
+    return true;
+}
+
+//==============================================================================
+void JsonReader::begin_array()
+{
+    expect('[');
+    _first = true;
+}
+
+//==============================================================================
+bool JsonReader::next_element()
+{
+    if (peek_char() == ']')
+    {
+        ++_position;
+        _first = false;
+        return false;
+    }
+
+    if (!_first)
+    {
+        expect(',');
+    }
+
+    _first = false;
+    return true;
+}
+
+//==============================================================================
+void JsonReader::skip()
+{
+    skip_value(0);
+}
+
+//==============================================================================
+std::string JsonReader::read_raw()
+{
+    return std::string(read_raw_view());
+}
+
+//==============================================================================
+std::string_view JsonReader::read_raw_view()
+{
+    const std::size_t start = position();
+    skip();
+    return std::string_view(_data + start, _position - start);
+}
+
+//==============================================================================
+void JsonReader::skip_whitespace()
+{
+    while (_position < _size)
+    {
+        const char c = _data[_position];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+        {
+            break;
+        }
+        ++_position;
+    }
+}
+
+//==============================================================================
+char JsonReader::peek_char()
+{
+    skip_whitespace();
+    if (_position >= _size)
+    {
+        throw JsonError("unexpected end of text");
+    }
+    return _data[_position];
+}
+
+//==============================================================================
+void JsonReader::expect(
+        char c)
+{
+    if (peek_char() != c)
+    {
+        throw JsonError("expected '" + std::string(1, c) + "' at offset " + std::to_string(_position)
+                      + ", found '" + std::string(1, _data[_position]) + "'");
+    }
+    ++_position;
+}
+
+//==============================================================================
+void JsonReader::expect_literal(
+        const char* literal,
+        std::size_t size)
+{
+    skip_whitespace();
+    if (_size - _position < size || std::memcmp(_data + _position, literal, size) != 0)
+    {
+        throw JsonError("expected '" + std::string(literal, size) + "' at offset "
+                      + std::to_string(_position));
+    }
+    _position += size;
+}
+
+//==============================================================================
+std::size_t JsonReader::scan_number(
+        bool& integer) const
+{
+    std::size_t end = _position;
+    integer = true;
+
+    if (end < _size && _data[end] == '-')
+    {
+        ++end;
+    }
+
+    if (end >= _size || !is_digit(_data[end]))
+    {
+        throw JsonError("expected a number at offset " + std::to_string(_position));
+    }
+
+    // Leading zeros are not allowed.
+    if (_data[end] == '0')
+    {
+        ++end;
+    }
+    else
+    {
+        while (end < _size && is_digit(_data[end]))
+        {
+            ++end;
+        }
+    }
+
+    if (end < _size && _data[end] == '.')
+    {
+        integer = false;
+        ++end;
+        if (end >= _size || !is_digit(_data[end]))
+        {
+            throw JsonError("expected a digit after the decimal point at offset " + std::to_string(end));
+        }
+        while (end < _size && is_digit(_data[end]))
+        {
+            ++end;
+        }
+    }
+
+    if (end < _size && (_data[end] == 'e' || _data[end] == 'E'))
+    {
+        integer = false;
+        ++end;
+        if (end < _size && (_data[end] == '+' || _data[end] == '-'))
+        {
+            ++end;
+        }
+        if (end >= _size || !is_digit(_data[end]))
+        {
+            throw JsonError("expected a digit in the exponent at offset " + std::to_string(end));
+        }
+        while (end < _size && is_digit(_data[end]))
+        {
+            ++end;
+        }
+    }
+
+    return end;
+}
+
+//==============================================================================
+uint64_t JsonReader::parse_magnitude(
+        std::size_t end)
+{
+    uint64_t value = 0;
+    for (; _position < end; ++_position)
+    {
+        const uint64_t digit = static_cast<uint64_t>(_data[_position] - '0');
+        if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+        {
+            throw JsonError("integer out of range");
+        }
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+//==============================================================================
+void JsonReader::skip_string()
+{
+    expect('"');
+    while (_position < _size)
+    {
+        _position += scan_json_string(_data + _position, _size - _position);
+        if (_position >= _size)
+        {
+            break;
+        }
+
+        const char c = _data[_position++];
+        if (c == '"')
+        {
+            return;
+        }
+        if (c == '\\')
+        {
+            // The escaped character cannot end the string. Unicode escapes need no special
+            // handling, since their digits are never quotes nor backslashes.
+            ++_position;
+        }
+        else
+        {
+            throw JsonError("unescaped control character in string at offset "
+                          + std::to_string(_position - 1));
+        }
+    }
+    throw JsonError("unterminated string");
+}
+
+//==============================================================================
+void JsonReader::skip_value(
+        std::size_t depth)
+{
+    if (depth > MaxNestingDepth)
+    {
+        throw JsonError("values are nested too deep");
+    }
+
+    switch (peek_type())
+    {
+        case JsonType::NULL_VALUE:
+            read_null();
+            break;
+        case JsonType::BOOLEAN:
+            read_bool();
+            break;
+        case JsonType::NUMBER:
+        {
+            bool integer;
+            _position = scan_number(integer);
+            break;
+        }
+        case JsonType::STRING:
+            skip_string();
+            break;
+        case JsonType::ARRAY:
+            begin_array();
+            while (next_element())
+            {
+                skip_value(depth + 1);
+            }
+            break;
+        case JsonType::OBJECT:
+        {
+            begin_object();
+            while (true)
+            {
+                if (peek_char() == '}')
+                {
+                    ++_position;
+                    _first = false;
+                    break;
+                }
+                if (!_first)
+                {
+                    expect(',');
+                }
+                skip_string();
+                expect(':');
+                _first = false;
+                skip_value(depth + 1);
+            }
+            break;
+        }
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
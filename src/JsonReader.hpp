@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSON_READER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSON_READER_HPP_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Exception thrown when a *JSON* text is malformed or a value is not of the expected kind.
+ */
+class JsonError : public std::runtime_error
+{
+public:
+
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Kinds of *JSON* values, as defined by ECMA-404.
+ */
+enum class JsonType : uint8_t
+{
+    NULL_VALUE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT
+};
+
+/**
+ * @class JsonReader
+ *        Pulls the values of a *JSON* text one after another, without building
+ *        any intermediate document.
+ *
+ *        Objects and arrays are walked with begin_object() and next_key(),
+ *        or begin_array() and next_element(). Every method throws a JsonError
+ *        if the next value is malformed or is not of the requested kind.
+ */
+class JsonReader
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] data The text to read. It must outlive the reader.
+     *
+     * @param[in] size The size of the text.
+     *
+     * @param[in] position The offset of the first value to read.
+     */
+    JsonReader(
+            const char* data,
+            std::size_t size,
+            std::size_t position = 0);
+
+    /**
+     * @brief Offset of the next value in the text, once the whitespace before it is skipped.
+     */
+    std::size_t position();
+
+    /**
+     * @brief Whether only whitespace is left in the text.
+     */
+    bool at_end();
+
+    JsonType peek_type();
+
+    bool is_null();
+
+    void read_null();
+
+    bool read_bool();
+
+    /**
+     * @brief Read an integer number. Numbers with a fraction or an exponent are rejected.
+     */
+    uint64_t read_uint();
+
+    int64_t read_int();
+
+    /**
+     * @brief Read any number.
+     */
+    double read_double();
+
+    /**
+     * @brief Read a string, replacing its escape sequences by the characters they stand for.
+     */
+    std::string read_string();
+
+    /**
+     * @brief Read a string into an existing buffer, so that its capacity can be reused.
+     */
+    void read_string(
+            std::string& value);
+
+    /**
+     * @brief Read a string without copying it, if it has no escape sequences.
+     *
+     * @param[out] buffer Where the string is unescaped, only if it has escape sequences.
+     *
+     * @returns A view of the string, either into the text or into the buffer.
+     */
+    std::string_view read_string_view(
+            std::string& buffer);
+
+    /**
+     * @brief Enter an object. Its members are then read calling next_key()
+     *        followed by the reading of the value, until next_key() returns `false`.
+     */
+    void begin_object();
+
+    /**
+     * @brief Read the key of the next member of the current object.
+     *
+     * @param[out] key The key read.
+     *
+     * @returns `true` if a member was found, or `false` if the end of the object was reached,
+     *          in which case the object is left.
+     */
+    bool next_key(
+            std::string& key);
+
+    /**
+     * @brief Enter an array. Its elements are then read calling next_element()
+     *        followed by the reading of the element, until next_element() returns `false`.
+     */
+    void begin_array();
+
+    /**
+     * @returns `true` if there is another element in the current array, or `false`
+     *          if the end of the array was reached, in which case the array is left.
+     */
+    bool next_element();
+
+    /**
+     * @brief Skip the next value, including all of its nested values, without decoding it.
+     */
+    void skip();
+
+    /**
+     * @brief Skip the next value, returning its text as it appears in the input.
+     */
+    std::string read_raw();
+
+    /**
+     * @brief The same as read_raw(), returning a view into the text instead of a copy.
+     */
+    std::string_view read_raw_view();
+
+private:
+
+    void skip_whitespace();
+
+    char peek_char();
+
+    void expect(
+            char c);
+
+    void expect_literal(
+            const char* literal,
+            std::size_t size);
+
+    /**
+     * @brief Find the end of the number at the current position.
+     *
+     * @param[out] integer Whether the number has neither a fraction nor an exponent.
+     *
+     * @returns The offset just past the number.
+     */
+    std::size_t scan_number(
+            bool& integer) const;
+
+    uint64_t parse_magnitude(
+            std::size_t end);
+
+    void skip_string();
+
+    void skip_value(
+            std::size_t depth);
+
+    const char* _data;
+    std::size_t _size;
+    std::size_t _position;
+
+    /**
+     * Whether the next member or element is the first one of its object or array,
+     * and so must not be preceded by a comma.
+     */
+    bool _first;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSON_READER_HPP_
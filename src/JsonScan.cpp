@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonScan.hpp"
+
+// SSE2 is always available in x86-64. AVX2 is used only if the processor supports it,
+// which is checked with the builtins of GCC and Clang.
+#if !defined(IS_WEBSOCKET_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define IS_WEBSOCKET_SCAN_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define IS_WEBSOCKET_SCAN_AVX2
+#include <immintrin.h>
+#endif // if defined(__GNUC__)
+#endif // if !defined(IS_WEBSOCKET_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif // if defined(_MSC_VER)
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+using ScanFunction = std::size_t (*)(
+    const char*,
+    std::size_t);
+
+#if defined(IS_WEBSOCKET_SCAN_SSE2)
+//==============================================================================
+unsigned int first_bit(
+        unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif // if defined(_MSC_VER)
+}
+
+//==============================================================================
+std::size_t scan_sse2(
+        const char* data,
+        std::size_t size)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i last_control = _mm_set1_epi8(0x1F);
+
+    std::size_t offset = 0;
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+        // There is no unsigned comparison: a byte is at most 0x1F if it is its minimum with 0x1F.
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, last_control), chunk));
+
+        const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+        if (mask != 0)
+        {
+            return offset + first_bit(mask);
+        }
+    }
+    return offset + scan_json_string_scalar(data + offset, size - offset);
+}
+
+#endif // if defined(IS_WEBSOCKET_SCAN_SSE2)
+
+#if defined(IS_WEBSOCKET_SCAN_AVX2)
+//==============================================================================
+__attribute__((target("avx2")))
+std::size_t scan_avx2(
+        const char* data,
+        std::size_t size)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i last_control = _mm256_set1_epi8(0x1F);
+
+    std::size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, last_control), chunk));
+
+        const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(special));
+        if (mask != 0)
+        {
+            return offset + first_bit(mask);
+        }
+    }
+    // The tail, shorter than 32 characters, is usually the end of the string.
+    return offset + scan_sse2(data + offset, size - offset);
+}
+
+#endif // if defined(IS_WEBSOCKET_SCAN_AVX2)
+
+//==============================================================================
+struct Backend
+{
+    ScanFunction scan;
+    const char* name;
+};
+
+//==============================================================================
+Backend select_backend()
+{
+#if defined(IS_WEBSOCKET_SCAN_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {&scan_avx2, "avx2"};
+    }
+#endif // if defined(IS_WEBSOCKET_SCAN_AVX2)
+#if defined(IS_WEBSOCKET_SCAN_SSE2)
+    return {&scan_sse2, "sse2"};
+#else
+    return {&scan_json_string_scalar, "scalar"};
+#endif // if defined(IS_WEBSOCKET_SCAN_SSE2)
+}
+
+//==============================================================================
+/**
+ * @brief The implementation for this processor, chosen the first time it is needed.
+ */
+const Backend& backend()
+{
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::size_t scan_json_string(
+        const char* data,
+        std::size_t size)
+{
+    return backend().scan(data, size);
+}
+
+//==============================================================================
+std::size_t scan_json_string_scalar(
+        const char* data,
+        std::size_t size)
+{
+    std::size_t offset = 0;
+    while (offset < size && data[offset] != '"' && data[offset] != '\\'
+            && static_cast<unsigned char>(data[offset]) >= 0x20)
+    {
+        ++offset;
+    }
+    return offset;
+}
+
+//==============================================================================
+const char* json_scan_backend()
+{
+    return backend().name;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
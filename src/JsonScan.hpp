@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSON_SCAN_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSON_SCAN_HPP_
+
+#include <cstddef>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Find the end of the run of characters of a string that can be copied as they
+ *        are between *JSON* text and memory: the first quote, backslash or control character.
+ *
+ * @details It checks 32 or 16 characters at once with AVX2 or SSE2 instructions,
+ *          choosing once the widest ones the processor supports, and falls back to
+ *          checking them one by one elsewhere, or if the library is built without SIMD.
+ *
+ * @param[in] data The characters, either of the *JSON* text, after the opening quote
+ *            or after an escape, or of a string to be written as *JSON*.
+ *
+ * @param[in] size The number of characters that can be read.
+ *
+ * @returns The offset of the first quote, backslash or control character, or `size`
+ *          if there is none.
+ */
+std::size_t scan_json_string(
+        const char* data,
+        std::size_t size);
+
+/**
+ * @brief The same as scan_json_string(), checking the characters one by one.
+ */
+std::size_t scan_json_string_scalar(
+        const char* data,
+        std::size_t size);
+
+/**
+ * @returns The name of the instructions scan_json_string() uses in this processor:
+ *          `"avx2"`, `"sse2"` or `"scalar"`.
+ */
+const char* json_scan_backend();
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSON_SCAN_HPP_
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonWriter.hpp"
+
+#include "Base64.hpp"
+#include "JsonScan.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+#if defined(__cpp_lib_to_chars)
+//==============================================================================
+/**
+ * @brief Print a floating point number with the fewest digits that read back
+ *        as the same value, using the shortest round trip algorithm of the standard library.
+ */
+template<typename T>
+std::size_t format_shortest(
+        T value,
+        char* buffer,
+        std::size_t size)
+{
+    return static_cast<std::size_t>(std::to_chars(buffer, buffer + size, value).ptr - buffer);
+}
+
+#else
+//==============================================================================
+float read_back(
+        const char* text,
+        float)
+{
+    return std::strtof(text, nullptr);
+}
+
+//==============================================================================
+double read_back(
+        const char* text,
+        double)
+{
+    return std::strtod(text, nullptr);
+}
+
+//==============================================================================
+/**
+ * @brief Print a floating point number with increasing precision until it reads back
+ *        as the same value. `%g` drops the trailing zeros, so the first precision
+ *        that round trips gives the shortest text. Used by the standard libraries
+ *        that cannot print floating point numbers with `std::to_chars`.
+ */
+template<typename T>
+std::size_t format_shortest(
+        T value,
+        char* buffer,
+        std::size_t size)
+{
+    int length = 0;
+    for (int precision = std::numeric_limits<T>::digits10;
+            precision <= std::numeric_limits<T>::max_digits10; ++precision)
+    {
+        length = std::snprintf(buffer, size, "%.*g", precision, static_cast<double>(value));
+        if (read_back(buffer, value) == value)
+        {
+            break;
+        }
+    }
+    return static_cast<std::size_t>(length);
+}
+
+#endif // if defined(__cpp_lib_to_chars)
+
+} // anonymous namespace
+
+//==============================================================================
+JsonWriter::JsonWriter(
+        std::string& buffer)
+    : _buffer(buffer)
+    , _needs_comma(false)
+{
+    // Do nothing
+}
+
+//==============================================================================
+void JsonWriter::write_null()
+{
+    separate();
+    _buffer.append("null", 4);
+}
+
+//==============================================================================
+void JsonWriter::write_bool(
+        bool value)
+{
+    separate();
+    if (value)
+    {
+        _buffer.append("true", 4);
+    }
+    else
+    {
+        _buffer.append("false", 5);
+    }
+}
+
+//==============================================================================
+void JsonWriter::write_uint(
+        uint64_t value)
+{
+    separate();
+
+    char digits[20];
+    std::size_t count = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    _buffer.append(digits + sizeof(digits) - count, count);
+}
+
+//==============================================================================
+void JsonWriter::write_int(
+        int64_t value)
+{
+    if (value >= 0)
+    {
+        write_uint(static_cast<uint64_t>(value));
+        return;
+    }
+
+    separate();
+    _buffer.push_back('-');
+    _needs_comma = false;
+    // The magnitude of the lowest int64_t does not fit in an int64_t.
+    write_uint(~static_cast<uint64_t>(value) + 1);
+}
+
+//==============================================================================
+void JsonWriter::write_float(
+        float value)
+{
+    if (!std::isfinite(value))
+    {
+        write_null();
+        return;
+    }
+
+    separate();
+    char text[32];
+    _buffer.append(text, format_shortest(value, text, sizeof(text)));
+}
+
+//==============================================================================
+void JsonWriter::write_double(
+        double value)
+{
+    if (!std::isfinite(value))
+    {
+        write_null();
+        return;
+    }
+
+    separate();
+    char text[32];
+    _buffer.append(text, format_shortest(value, text, sizeof(text)));
+}
+
+//==============================================================================
+void JsonWriter::write_string(
+        const std::string& value)
+{
+    write_string(value.data(), value.size());
+}
+
+//==============================================================================
+void JsonWriter::write_string(
+        const char* data,
+        std::size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    separate();
+    _buffer.push_back('"');
+
+    std::size_t start = 0;
+    while (true)
+    {
+        // Copy the run of characters that need no escaping at once. Most strings
+        // need no escaping at all, and are copied as a whole.
+        const std::size_t i = start + scan_json_string(data + start, size - start);
+        _buffer.append(data + start, i - start);
+        if (i >= size)
+        {
+            break;
+        }
+        start = i + 1;
+
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+        switch (c)
+        {
+            case '"':
+                _buffer.append("\\\"", 2);
+                break;
+            case '\\':
+                _buffer.append("\\\\", 2);
+                break;
+            case '\b':
+                _buffer.append("\\b", 2);
+                break;
+            case '\f':
+                _buffer.append("\\f", 2);
+                break;
+            case '\n':
+                _buffer.append("\\n", 2);
+                break;
+            case '\r':
+                _buffer.append("\\r", 2);
+                break;
+            case '\t':
+                _buffer.append("\\t", 2);
+                break;
+            default:
+            {
+                const char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F]};
+                _buffer.append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+
+    _buffer.push_back('"');
+}
+
+//==============================================================================
+void JsonWriter::write_base64(
+        const uint8_t* data,
+        std::size_t size)
+{
+    separate();
+    _buffer.push_back('"');
+
+    // The alphabet of base64 needs no escaping, so the text is encoded in place.
+    const std::size_t start = _buffer.size();
+    _buffer.resize(start + base64_encoded_size(size));
+    base64_encode(data, size, &_buffer[start]);
+
+    _buffer.push_back('"');
+}
+
+//==============================================================================
+void JsonWriter::write_raw(
+        const std::string& json)
+{
+    separate();
+    _buffer.append(json);
+}
+
+//==============================================================================
+void JsonWriter::key(
+        const std::string& name)
+{
+    write_string(name);
+    _buffer.push_back(':');
+    _needs_comma = false;
+}
+
+//==============================================================================
+void JsonWriter::prepared_key(
+        const std::string& json_key)
+{
+    separate();
+    _buffer.append(json_key);
+    _needs_comma = false;
+}
+
+//==============================================================================
+void JsonWriter::begin_object()
+{
+    separate();
+    _buffer.push_back('{');
+    _needs_comma = false;
+}
+
+//==============================================================================
+void JsonWriter::end_object()
+{
+    _buffer.push_back('}');
+    _needs_comma = true;
+}
+
+//==============================================================================
+void JsonWriter::begin_array()
+{
+    separate();
+    _buffer.push_back('[');
+    _needs_comma = false;
+}
+
+//==============================================================================
+void JsonWriter::end_array()
+{
+    _buffer.push_back(']');
+    _needs_comma = true;
+}
+
+//==============================================================================
+void JsonWriter::separate()
+{
+    if (_needs_comma)
+    {
+        _buffer.push_back(',');
+    }
+    _needs_comma = true;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
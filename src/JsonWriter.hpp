@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSON_WRITER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSON_WRITER_HPP_
+
+#include <cstdint>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class JsonWriter
+ *        Appends compact *JSON* text to a buffer, without building any intermediate document.
+ *
+ *        Commas are inserted automatically: members are written calling key() followed
+ *        by the writing of the value, and elements by writing them one after another.
+ */
+class JsonWriter
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] buffer The buffer the text will be appended to.
+     *            It must outlive the writer.
+     */
+    explicit JsonWriter(
+            std::string& buffer);
+
+    void write_null();
+
+    void write_bool(
+            bool value);
+
+    void write_uint(
+            uint64_t value);
+
+    void write_int(
+            int64_t value);
+
+    /**
+     * @brief Write a number with the fewest digits that read back as the same float.
+     *        Non finite numbers, which *JSON* cannot represent, are written as `null`.
+     */
+    void write_float(
+            float value);
+
+    /**
+     * @brief Write a number with the fewest digits that read back as the same double.
+     *        Non finite numbers, which *JSON* cannot represent, are written as `null`.
+     */
+    void write_double(
+            double value);
+
+    /**
+     * @brief Write a string, escaping the quotes, backslashes and control characters.
+     */
+    void write_string(
+            const std::string& value);
+
+    void write_string(
+            const char* data,
+            std::size_t size);
+
+    /**
+     * @brief Write bytes as a string holding their base64 encoding.
+     */
+    void write_base64(
+            const uint8_t* data,
+            std::size_t size);
+
+    /**
+     * @brief Write a value already encoded as *JSON* text, as it is.
+     */
+    void write_raw(
+            const std::string& json);
+
+    /**
+     * @brief Write the key of the next member of the current object.
+     */
+    void key(
+            const std::string& name);
+
+    /**
+     * @brief Write the key of the next member of the current object, already quoted,
+     *        escaped and followed by the colon, as prepared by CodecPlan.
+     */
+    void prepared_key(
+            const std::string& json_key);
+
+    void begin_object();
+
+    void end_object();
+
+    void begin_array();
+
+    void end_array();
+
+private:
+
+    void separate();
+
+    std::string& _buffer;
+
+    /**
+     * Whether a value was written last in the current object or array,
+     * so that the next member or element must be preceded by a comma.
+     */
+    bool _needs_comma;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSON_WRITER_HPP_
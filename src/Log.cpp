@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Log.hpp"
+#include "LogSink.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <streambuf>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+/**
+ * @class RecordBuffer
+ *        Where the lines handed to the AsyncLogSink are formatted. It holds a single
+ *        record, so whatever does not fit in it is left out.
+ */
+class RecordBuffer : public std::streambuf
+{
+public:
+
+    RecordBuffer()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        setp(_text, _text + LogRecord::TextSize);
+        _truncated = false;
+    }
+
+    const char* data() const
+    {
+        return pbase();
+    }
+
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(pptr() - pbase());
+    }
+
+    bool truncated() const
+    {
+        return _truncated;
+    }
+
+protected:
+
+    int_type overflow(
+            int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            _truncated = true;
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(
+            const char* text,
+            std::streamsize size) override
+    {
+        const std::streamsize count = std::min<std::streamsize>(size, epptr() - pptr());
+        std::memcpy(pptr(), text, static_cast<std::size_t>(count));
+        pbump(static_cast<int>(count));
+        _truncated = _truncated || count < size;
+        return size;
+    }
+
+private:
+
+    char _text[LogRecord::TextSize];
+    bool _truncated;
+};
+
+/**
+ * @brief The buffer of a thread and the stream formatting into it.
+ */
+struct RecordStream
+{
+    RecordBuffer buffer;
+    std::ostream stream{&buffer};
+
+    /**
+     * Whether a line is being formatted, in which case any line logged while streaming
+     * its values is written straight to its logger instead.
+     */
+    bool in_use = false;
+
+    void reset()
+    {
+        buffer.reset();
+        stream.clear();
+        stream.flags(std::ios_base::dec | std::ios_base::skipws);
+        stream.precision(6);
+        stream.width(0);
+        stream.fill(' ');
+    }
+};
+
+//==============================================================================
+RecordStream& record_stream()
+{
+    thread_local RecordStream record;
+    return record;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+LogLine::LogLine(
+        utils::Logger& logger,
+        LogLevel level)
+    : _logger(logger)
+    , _level(level)
+    , _sink(AsyncLogSink::instance())
+    , _record(nullptr)
+{
+    if (nullptr != _sink)
+    {
+        RecordStream& record = record_stream();
+        if (!record.in_use)
+        {
+            record.in_use = true;
+            record.reset();
+            _record = &record.stream;
+            return;
+        }
+    }
+
+    _logger << logger_level(level);
+}
+
+//==============================================================================
+LogLine::~LogLine()
+{
+    if (nullptr == _record)
+    {
+        return;
+    }
+
+    RecordStream& record = record_stream();
+    std::size_t size = record.buffer.size();
+
+    // Lines end with std::endl, but the sink writes each record as a line already.
+    if (size > 0 && record.buffer.data()[size - 1] == '\n')
+    {
+        --size;
+    }
+
+    _sink->push(_logger, _level, record.buffer.data(), size, record.buffer.truncated());
+    record.in_use = false;
+}
+
+//==============================================================================
+bool parse_log_level(
+        const std::string& name,
+        LogLevel& level)
+{
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char c)
+        {
+            return static_cast<char>(std::tolower(c));
+        });
+
+    if (lower == "trace")
+    {
+        level = LogLevel::TRACE;
+    }
+    else if (lower == "debug")
+    {
+        level = LogLevel::DEBUG;
+    }
+    else if (lower == "info")
+    {
+        level = LogLevel::INFO;
+    }
+    else if (lower == "warn" || lower == "warning")
+    {
+        level = LogLevel::WARN;
+    }
+    else if (lower == "error")
+    {
+        level = LogLevel::ERROR;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__LOG_HPP_
+#define _WEBSOCKET_IS_SH__SRC__LOG_HPP_
+
+#include <is/utils/Log.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Severity of the messages logged by the *WebSocket* system handle.
+ */
+enum class LogLevel : uint8_t
+{
+    TRACE,  ///< Every message sent and received, with its payload.
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR
+};
+
+/**
+ * @brief The least severe level that is logged, shared by the whole process.
+ *
+ * @details It defaults to `DEBUG`, so that only the payloads are left out.
+ *          It is set with the `log_level` setting of the system handles.
+ */
+inline std::atomic<LogLevel>& log_threshold()
+{
+    static std::atomic<LogLevel> threshold{LogLevel::DEBUG};
+    return threshold;
+}
+
+/**
+ * @returns Whether messages of a level are logged.
+ */
+inline bool log_enabled(
+        LogLevel level)
+{
+    return level >= log_threshold().load(std::memory_order_relaxed);
+}
+
+/**
+ * @returns The level of the *Integration Service* logger that messages of a level are
+ *          logged with. It has no trace level, so trace messages are logged as debug ones.
+ */
+inline utils::Logger::Level logger_level(
+        LogLevel level)
+{
+    switch (level)
+    {
+        case LogLevel::TRACE:
+        case LogLevel::DEBUG:
+            return utils::Logger::Level::DEBUG;
+        case LogLevel::INFO:
+            return utils::Logger::Level::INFO;
+        case LogLevel::WARN:
+            return utils::Logger::Level::WARN;
+        case LogLevel::ERROR:
+        default:
+            return utils::Logger::Level::ERROR;
+    }
+}
+
+class AsyncLogSink;
+
+/**
+ * @class LogLine
+ *        A message being logged through IS_WEBSOCKET_LOG. It is streamed straight into
+ *        the logger, unless the AsyncLogSink is enabled, in which case it is formatted
+ *        into a per-thread buffer and handed to the sink once the whole line is streamed.
+ */
+class LogLine
+{
+public:
+
+    LogLine(
+            utils::Logger& logger,
+            LogLevel level);
+
+    ~LogLine();
+
+    LogLine(
+            const LogLine&) = delete;
+
+    LogLine& operator =(
+            const LogLine&) = delete;
+
+    template<typename T>
+    LogLine& operator <<(
+            const T& value)
+    {
+        if (nullptr != _record)
+        {
+            *_record << value;
+        }
+        else
+        {
+            _logger << value;
+        }
+        return *this;
+    }
+
+    LogLine& operator <<(
+            std::ostream& (*manipulator)(std::ostream&))
+    {
+        if (nullptr != _record)
+        {
+            *_record << manipulator;
+        }
+        else
+        {
+            _logger << manipulator;
+        }
+        return *this;
+    }
+
+private:
+
+    utils::Logger& _logger;
+    const LogLevel _level;
+    AsyncLogSink* const _sink;
+
+    /**
+     * The stream formatting the record, or `nullptr` if the line is streamed into the logger.
+     */
+    std::ostream* _record;
+};
+
+/**
+ * @brief Parse the name of a level, as written in the configuration.
+ *
+ * @param[in] name The name: `trace`, `debug`, `info`, `warn` (or `warning`) or `error`,
+ *            in any case.
+ *
+ * @param[out] level The level, if the name is valid.
+ *
+ * @returns `true` if the name is valid, `false` otherwise.
+ */
+bool parse_log_level(
+        const std::string& name,
+        LogLevel& level);
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+/**
+ * @brief Start logging a message of a level, which is formatted only if the level
+ *        is logged: neither the streamed values nor the calls that build them are
+ *        evaluated otherwise. Used as `IS_WEBSOCKET_LOG(_logger, DEBUG) << ... << std::endl;`
+ *        The line is written asynchronously if the AsyncLogSink is enabled.
+ */
+#define IS_WEBSOCKET_LOG(logger, level) \
+    if (!::eprosima::is::sh::websocket::log_enabled(::eprosima::is::sh::websocket::LogLevel::level)) \
+    { \
+    } \
+    else \
+        ::eprosima::is::sh::websocket::LogLine((logger), ::eprosima::is::sh::websocket::LogLevel::level)
+
+#endif //  _WEBSOCKET_IS_SH__SRC__LOG_HPP_
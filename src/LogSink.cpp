@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "LogSink.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+/**
+ * Time the background thread sleeps when there are no records to write.
+ */
+const std::chrono::milliseconds IdlePeriod(1);
+
+/**
+ * Minimum time between two reports of the dropped records.
+ */
+const std::chrono::seconds DropReportPeriod(1);
+
+//==============================================================================
+void write_to_logger(
+        const LogRecord& record)
+{
+    *record.logger << logger_level(record.level)
+                   << std::string(record.text, record.size)
+                   << (record.truncated ? " [...]" : "") << std::endl;
+}
+
+//==============================================================================
+uint64_t round_up_to_power_of_two(
+        std::size_t value)
+{
+    uint64_t power = 1;
+    while (power < value)
+    {
+        power <<= 1;
+    }
+    return power;
+}
+
+std::atomic<AsyncLogSink*> enabled_sink{nullptr};
+
+} // anonymous namespace
+
+//==============================================================================
+AsyncLogSink::AsyncLogSink(
+        std::size_t capacity,
+        Writer writer)
+    : _slots(new Slot[round_up_to_power_of_two(capacity)])
+    , _mask(round_up_to_power_of_two(capacity) - 1)
+    , _writer(writer ? std::move(writer) : Writer(&write_to_logger))
+    , _head(0)
+    , _tail(0)
+    , _dropped(0)
+    , _reported_dropped(0)
+    , _running(true)
+    , _logger("is::sh::WebSocket::AsyncLogSink")
+{
+    for (uint64_t i = 0; i <= _mask; ++i)
+    {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    _thread = std::thread(&AsyncLogSink::_run, this);
+}
+
+//==============================================================================
+AsyncLogSink::~AsyncLogSink()
+{
+    AsyncLogSink* self = this;
+    enabled_sink.compare_exchange_strong(self, nullptr);
+
+    _running.store(false, std::memory_order_release);
+    _thread.join();
+}
+
+//==============================================================================
+bool AsyncLogSink::push(
+        utils::Logger& logger,
+        LogLevel level,
+        const char* text,
+        std::size_t size,
+        bool truncated)
+{
+    uint64_t position = _head.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true)
+    {
+        slot = &_slots[position & _mask];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0)
+        {
+            if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The slot still holds the record pushed a lap ago: the ring buffer is full.
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            position = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.logger = &logger;
+    record.level = level;
+    record.truncated = truncated || size > LogRecord::TextSize;
+    record.size = static_cast<uint16_t>(std::min(size, LogRecord::TextSize));
+    std::memcpy(record.text, text, record.size);
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+//==============================================================================
+void AsyncLogSink::flush()
+{
+    const uint64_t target = _head.load(std::memory_order_acquire);
+    while (_tail.load(std::memory_order_acquire) < target)
+    {
+        std::this_thread::sleep_for(IdlePeriod);
+    }
+}
+
+//==============================================================================
+void AsyncLogSink::enable()
+{
+    // The sink lives until the end of the process, since any thread may be logging.
+    static std::once_flag once;
+    std::call_once(once, []()
+        {
+            static AsyncLogSink sink;
+            enabled_sink.store(&sink, std::memory_order_release);
+        });
+}
+
+//==============================================================================
+AsyncLogSink* AsyncLogSink::instance()
+{
+    return enabled_sink.load(std::memory_order_acquire);
+}
+
+//==============================================================================
+void AsyncLogSink::_run()
+{
+    auto last_report = std::chrono::steady_clock::now();
+    while (true)
+    {
+        // Checked before writing, so that the records pushed before stopping are all written.
+        const bool running = _running.load(std::memory_order_acquire);
+
+        bool idle = true;
+        while (_pop())
+        {
+            idle = false;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!running || now - last_report >= DropReportPeriod)
+        {
+            _report_dropped();
+            last_report = now;
+        }
+
+        if (!running)
+        {
+            return;
+        }
+
+        if (idle)
+        {
+            std::this_thread::sleep_for(IdlePeriod);
+        }
+    }
+}
+
+//==============================================================================
+bool AsyncLogSink::_pop()
+{
+    // Only the background thread pops, so the tail is not contended.
+    const uint64_t position = _tail.load(std::memory_order_relaxed);
+    Slot& slot = _slots[position & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+    {
+        return false;
+    }
+
+    _writer(slot.record);
+
+    slot.sequence.store(position + _mask + 1, std::memory_order_release);
+    _tail.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+//==============================================================================
+void AsyncLogSink::_report_dropped()
+{
+    const uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+    if (dropped == _reported_dropped)
+    {
+        return;
+    }
+    _reported_dropped = dropped;
+
+    _logger << utils::Logger::Level::WARN
+            << "Dropped " << dropped << " log records so far, since the log could not"
+            << " keep up with them" << std::endl;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__LOG_SINK_HPP_
+#define _WEBSOCKET_IS_SH__SRC__LOG_SINK_HPP_
+
+#include "Log.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @struct LogRecord
+ *         A message handed to the AsyncLogSink, already formatted.
+ *         Its size is fixed, so longer messages are truncated.
+ */
+struct LogRecord
+{
+    /**
+     * Room for the text of the message, so that a record takes 1 KiB.
+     */
+    static constexpr std::size_t TextSize = 1008;
+
+    utils::Logger* logger;
+    LogLevel level;
+
+    /**
+     * Whether the message did not fit in the record.
+     */
+    bool truncated;
+
+    uint16_t size;
+    char text[TextSize];
+};
+
+/**
+ * @class AsyncLogSink
+ *        Writes the messages logged through IS_WEBSOCKET_LOG from a background thread,
+ *        so that the threads handling the connections never wait for the logger.
+ *
+ *        The messages are formatted into records of a bounded ring buffer, which any
+ *        number of threads push into without locking. When it is full, the records
+ *        are dropped and counted instead of blocking the thread.
+ */
+class AsyncLogSink
+{
+public:
+
+    /**
+     * Function writing a record, called from the background thread.
+     */
+    using Writer = std::function<void (const LogRecord&)>;
+
+    static constexpr std::size_t DefaultCapacity = 4096;
+
+    /**
+     * @brief Constructor. It starts the background thread.
+     *
+     * @param[in] capacity The number of records of the ring buffer,
+     *            rounded up to a power of two.
+     *
+     * @param[in] writer The function writing the records. By default,
+     *            they are written to the logger they were logged with.
+     */
+    AsyncLogSink(
+            std::size_t capacity = DefaultCapacity,
+            Writer writer = Writer());
+
+    /**
+     * @brief Destructor. It writes the pending records and stops the background thread.
+     */
+    ~AsyncLogSink();
+
+    AsyncLogSink(
+            const AsyncLogSink&) = delete;
+
+    AsyncLogSink& operator =(
+            const AsyncLogSink&) = delete;
+
+    /**
+     * @brief Hand a message to the background thread.
+     *
+     * @param[in] logger The logger to write it to. It must outlive the record,
+     *            which can be ensured calling flush().
+     *
+     * @param[in] level The level of the message.
+     *
+     * @param[in] text The text of the message.
+     *
+     * @param[in] size The size of the text.
+     *
+     * @param[in] truncated Whether the text is already truncated.
+     *
+     * @returns `true` if the message was queued, `false` if the ring buffer is full
+     *          and it was dropped.
+     */
+    bool push(
+            utils::Logger& logger,
+            LogLevel level,
+            const char* text,
+            std::size_t size,
+            bool truncated = false);
+
+    /**
+     * @brief Wait until the records pushed before the call are written.
+     */
+    void flush();
+
+    /**
+     * @returns The number of records dropped so far because the ring buffer was full.
+     */
+    uint64_t dropped() const
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns The number of records the ring buffer holds.
+     */
+    std::size_t capacity() const
+    {
+        return _mask + 1;
+    }
+
+    /**
+     * @brief Enable the sink of the process, used by IS_WEBSOCKET_LOG from then on.
+     *        Enabling it again does nothing.
+     */
+    static void enable();
+
+    /**
+     * @returns The sink of the process, or `nullptr` if it is not enabled.
+     */
+    static AsyncLogSink* instance();
+
+private:
+
+    struct Slot
+    {
+        /**
+         * Position the slot can be pushed into when it is equal to it, or popped from
+         * when it is one past it, as in the bounded queue of Dmitry Vyukov.
+         */
+        std::atomic<uint64_t> sequence;
+        LogRecord record;
+    };
+
+    void _run();
+
+    bool _pop();
+
+    void _report_dropped();
+
+    std::unique_ptr<Slot[]> _slots;
+    const uint64_t _mask;
+    const Writer _writer;
+
+    alignas(64) std::atomic<uint64_t> _head;
+    alignas(64) std::atomic<uint64_t> _tail;
+    alignas(64) std::atomic<uint64_t> _dropped;
+
+    uint64_t _reported_dropped;
+    std::atomic<bool> _running;
+    utils::Logger _logger;
+    std::thread _thread;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__LOG_SINK_HPP_
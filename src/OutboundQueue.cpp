@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "OutboundQueue.hpp"
+
+#include <is/utils/Log.hpp>
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlMaxBytesKey = "max_bytes";
+const std::string YamlMaxMessagesKey = "max_messages";
+const std::string YamlHighWaterBytesKey = "high_water_bytes";
+const std::string YamlPolicyKey = "policy";
+const std::string YamlPolicy_DropOldest = "drop_oldest";
+const std::string YamlPolicy_DropNewest = "drop_newest";
+const std::string YamlPolicy_Conflate = "conflate";
+const std::string YamlPolicy_Disconnect = "disconnect";
+
+const std::size_t DefaultMaxBytes = 16 * 1024 * 1024;
+const std::size_t DefaultMaxMessages = 1024;
+
+//==============================================================================
+OutboundQueue::OutboundQueue(
+        const Config& config,
+        OutboundQueueStats& stats)
+    : _config(config)
+    , _stats(stats)
+    , _bytes(0)
+{
+    // Do nothing
+}
+
+//==============================================================================
+bool OutboundQueue::push(
+        const std::string& topic,
+        MessagePtr message,
+        std::size_t buffered_amount)
+{
+    const std::size_t size = message->get_payload().size();
+    const bool is_publication = !topic.empty();
+
+    if (is_publication && _config.policy == SlowConsumerPolicy::CONFLATE)
+    {
+        // Replace the queued publication of the same topic, which keeps its place in the queue.
+        for (Pending& pending : _pending)
+        {
+            if (pending.topic == topic)
+            {
+                _bytes = _bytes - pending.size + size;
+                pending.message = std::move(message);
+                pending.size = size;
+                ++_stats.conflated;
+
+                return true;
+            }
+        }
+    }
+
+    if (_exceeds_limits(size, buffered_amount))
+    {
+        switch (_config.policy)
+        {
+            case SlowConsumerPolicy::DISCONNECT:
+                ++_stats.disconnected;
+                return false;
+
+            case SlowConsumerPolicy::DROP_NEWEST:
+                if (is_publication)
+                {
+                    ++_stats.dropped_newest;
+                    return true;
+                }
+                break;
+
+            case SlowConsumerPolicy::DROP_OLDEST:
+            case SlowConsumerPolicy::CONFLATE:
+                if (is_publication)
+                {
+                    if (!_can_make_room(size, buffered_amount))
+                    {
+                        // Dropping the queued publications would not be enough,
+                        // so only the new one is dropped.
+                        ++_stats.dropped_newest;
+                        return true;
+                    }
+                    _drop_oldest(size, buffered_amount);
+                }
+                break;
+        }
+    }
+
+    _bytes += size;
+    _pending.push_back(Pending{topic, std::move(message), size});
+    ++_stats.queued;
+
+    return true;
+}
+
+//==============================================================================
+bool OutboundQueue::_exceeds_limits(
+        std::size_t size,
+        std::size_t buffered_amount) const
+{
+    return _pending.size() + 1 > _config.max_messages
+           || buffered_amount + _bytes + size > _config.max_bytes;
+}
+
+//==============================================================================
+bool OutboundQueue::_can_make_room(
+        std::size_t size,
+        std::size_t buffered_amount) const
+{
+    if (buffered_amount + size > _config.max_bytes)
+    {
+        return false;
+    }
+
+    // Only the publications can be dropped.
+    std::size_t messages = _pending.size();
+    std::size_t bytes = _bytes;
+    for (const Pending& pending : _pending)
+    {
+        if (!pending.topic.empty())
+        {
+            --messages;
+            bytes -= pending.size;
+        }
+    }
+
+    return messages + 1 <= _config.max_messages
+           && buffered_amount + bytes + size <= _config.max_bytes;
+}
+
+//==============================================================================
+void OutboundQueue::_drop_oldest(
+        std::size_t size,
+        std::size_t buffered_amount)
+{
+    auto it = _pending.begin();
+    while (_exceeds_limits(size, buffered_amount))
+    {
+        while (it->topic.empty())
+        {
+            ++it;
+        }
+
+        _bytes -= it->size;
+        it = _pending.erase(it);
+        ++_stats.dropped_oldest;
+    }
+}
+
+//==============================================================================
+bool OutboundQueue::load_config(
+        const YAML::Node& queue_node,
+        Config& config)
+{
+    utils::Logger logger("is::sh::WebSocket::OutboundQueue");
+
+    config.max_bytes = DefaultMaxBytes;
+    config.max_messages = DefaultMaxMessages;
+    config.policy = SlowConsumerPolicy::DROP_OLDEST;
+
+    try
+    {
+        if (const YAML::Node max_bytes_node = queue_node[YamlMaxBytesKey])
+        {
+            config.max_bytes = max_bytes_node.as<std::size_t>();
+        }
+
+        if (const YAML::Node max_messages_node = queue_node[YamlMaxMessagesKey])
+        {
+            config.max_messages = max_messages_node.as<std::size_t>();
+        }
+
+        // Half of the bytes are left for the queue by default.
+        config.high_water_bytes = std::max<std::size_t>(config.max_bytes / 2, 1);
+        if (const YAML::Node high_water_node = queue_node[YamlHighWaterBytesKey])
+        {
+            config.high_water_bytes = high_water_node.as<std::size_t>();
+        }
+
+        if (const YAML::Node policy_node = queue_node[YamlPolicyKey])
+        {
+            const std::string policy = policy_node.as<std::string>();
+            if (policy == YamlPolicy_DropOldest)
+            {
+                config.policy = SlowConsumerPolicy::DROP_OLDEST;
+            }
+            else if (policy == YamlPolicy_DropNewest)
+            {
+                config.policy = SlowConsumerPolicy::DROP_NEWEST;
+            }
+            else if (policy == YamlPolicy_Conflate)
+            {
+                config.policy = SlowConsumerPolicy::CONFLATE;
+            }
+            else if (policy == YamlPolicy_Disconnect)
+            {
+                config.policy = SlowConsumerPolicy::DISCONNECT;
+            }
+            else
+            {
+                logger << utils::Logger::Level::ERROR
+                       << "Unknown slow consumer policy '" << policy << "'. Valid policies are ["
+                       << YamlPolicy_DropOldest << ", " << YamlPolicy_DropNewest << ", "
+                       << YamlPolicy_Conflate << ", " << YamlPolicy_Disconnect << "]" << std::endl;
+
+                return false;
+            }
+        }
+    }
+    catch (const YAML::Exception& e)
+    {
+        logger << utils::Logger::Level::ERROR
+               << "Could not parse the outbound queue configuration '"
+               << queue_node << "': " << e.what() << std::endl;
+
+        return false;
+    }
+
+    if (config.max_bytes == 0 || config.max_messages == 0)
+    {
+        logger << utils::Logger::Level::ERROR
+               << "The outbound queue limits '" << YamlMaxBytesKey << "' and '"
+               << YamlMaxMessagesKey << "' must be greater than zero" << std::endl;
+
+        return false;
+    }
+
+    if (config.high_water_bytes == 0 || config.high_water_bytes > config.max_bytes)
+    {
+        logger << utils::Logger::Level::ERROR
+               << "The outbound queue setting '" << YamlHighWaterBytesKey << "' must be greater than zero"
+               << " and not greater than '" << YamlMaxBytesKey << "'" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__OUTBOUNDQUEUE_HPP_
+#define _WEBSOCKET_IS_SH__SRC__OUTBOUNDQUEUE_HPP_
+
+#include "SharedFrame.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Action taken when a lagging connection exceeds the limits of its outbound queue.
+ */
+enum class SlowConsumerPolicy
+{
+    DROP_OLDEST,  ///< Drop the oldest queued publications to make room for the new one.
+    DROP_NEWEST,  ///< Drop the new publication.
+    CONFLATE,     ///< Keep only the latest queued publication of each topic.
+    DISCONNECT    ///< Close the connection.
+};
+
+/**
+ * @brief Counters of how many times each SlowConsumerPolicy action took place.
+ *        They are shared by all the queues of an Endpoint.
+ */
+struct OutboundQueueStats
+{
+    std::atomic<uint64_t> queued{0};
+    std::atomic<uint64_t> dropped_oldest{0};
+    std::atomic<uint64_t> dropped_newest{0};
+    std::atomic<uint64_t> conflated{0};
+    std::atomic<uint64_t> disconnected{0};
+};
+
+/**
+ * @class OutboundQueue
+ * @brief Bounded queue holding the messages that could not be handed yet to a lagging
+ *        connection.
+ *
+ *        A connection is lagging when the amount of bytes buffered by *websocketpp*
+ *        reaches `high_water_bytes`. Its messages are then held in this queue until the
+ *        connection catches up. The queue is limited to `max_messages`, and to `max_bytes`
+ *        counting the bytes buffered by *websocketpp* as well, so that no more than
+ *        `max_bytes` are kept in memory for a connection.
+ *        Whenever a new message does not fit, the configured SlowConsumerPolicy is applied.
+ *        If dropping the queued publications would not make room for a new publication,
+ *        the new one is dropped instead.
+ *
+ *        Messages not related to any topic (service calls and responses) are never
+ *        dropped nor conflated, although they count towards the limits.
+ *
+ *        This class is not thread safe.
+ */
+class OutboundQueue
+{
+public:
+
+    /**
+     * @brief Limits of the queue and action to take when they are exceeded.
+     */
+    struct Config
+    {
+        std::size_t max_bytes;
+        std::size_t max_messages;
+        SlowConsumerPolicy policy;
+
+        /**
+         * Bytes buffered by *websocketpp* from which the connection is lagging.
+         * It must not be greater than `max_bytes`.
+         */
+        std::size_t high_water_bytes;
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] config The limits of the queue.
+     *
+     * @param[in] stats The counters to update every time the policy acts.
+     */
+    OutboundQueue(
+            const Config& config,
+            OutboundQueueStats& stats);
+
+    /**
+     * @brief Add a message to the back of the queue, applying the policy if needed.
+     *
+     * @param[in] topic The topic of the publication, or an empty string if the
+     *            message is not a publication.
+     *
+     * @param[in] message The message to queue.
+     *
+     * @param[in] buffered_amount The bytes currently buffered by the connection,
+     *            which count towards `max_bytes` too.
+     *
+     * @returns `false` if the connection must be closed, `true` otherwise.
+     */
+    bool push(
+            const std::string& topic,
+            MessagePtr message,
+            std::size_t buffered_amount);
+
+    /**
+     * @brief Hand the queued messages to the connection while it is not lagging.
+     *
+     * @param[in] buffered_amount The bytes currently buffered by the connection.
+     *
+     * @param[in] send Function sending a message through the connection.
+     */
+    template<typename SendFunction>
+    void flush(
+            std::size_t buffered_amount,
+            SendFunction&& send)
+    {
+        while (!_pending.empty() && buffered_amount < _config.high_water_bytes)
+        {
+            Pending front = std::move(_pending.front());
+            _pending.pop_front();
+            _bytes -= front.size;
+            buffered_amount += front.size;
+
+            send(front.message);
+        }
+    }
+
+    /**
+     * @brief Check whether there are messages waiting in the queue.
+     */
+    inline bool empty() const
+    {
+        return _pending.empty();
+    }
+
+    /**
+     * @brief Number of messages waiting in the queue.
+     */
+    inline std::size_t size() const
+    {
+        return _pending.size();
+    }
+
+    /**
+     * @brief Number of payload bytes waiting in the queue.
+     */
+    inline std::size_t bytes() const
+    {
+        return _bytes;
+    }
+
+    /**
+     * @brief Load the queue configuration from its *YAML* node.
+     *
+     * @param[in] queue_node The *YAML* node with the `max_bytes`, `max_messages`,
+     *            `high_water_bytes` and `policy` keys.
+     *
+     * @param[out] config The loaded configuration.
+     *
+     * @returns `true` if the configuration is valid, `false` otherwise.
+     */
+    static bool load_config(
+            const YAML::Node& queue_node,
+            Config& config);
+
+private:
+
+    struct Pending
+    {
+        std::string topic;
+        MessagePtr message;
+        std::size_t size;
+    };
+
+    bool _exceeds_limits(
+            std::size_t size,
+            std::size_t buffered_amount) const;
+
+    /**
+     * @brief Check whether dropping the queued publications would make room for a new message.
+     */
+    bool _can_make_room(
+            std::size_t size,
+            std::size_t buffered_amount) const;
+
+    /**
+     * @brief Drop the oldest queued publications until a new message fits.
+     *        _can_make_room() must have been checked first.
+     */
+    void _drop_oldest(
+            std::size_t size,
+            std::size_t buffered_amount);
+
+    Config _config;
+    OutboundQueueStats& _stats;
+    std::deque<Pending> _pending;
+    std::size_t _bytes;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__OUTBOUNDQUEUE_HPP_
@@ -16,9 +16,10 @@
 *
 */
 
-#include "Endpoint.hpp"
 #include "Errors.hpp"
 #include "ServerConfig.hpp"
+#include "TransportEndpoint.hpp"
+#include "TransportSelector.hpp"
 #include "websocket_types.hpp"
 #include "JwtValidator.hpp"
 
@@ -26,6 +27,12 @@
 #include <websocketpp/endpoint.hpp>
 #include <websocketpp/http/constants.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 namespace eprosima {
 namespace is {
 namespace sh {
@@ -42,6 +49,9 @@ const std::string YamlFormatAsn1Value = "asn.1";
 
 const std::string YamlAuthKey = "authentication";
 
+const std::string YamlThreadsKey = "threads";
+const std::string YamlShardsKey = "shards";
+
 const std::string AuthHeader = "Authorization";
 const std::string AuthMethod = "Bearer";
 
@@ -137,375 +147,431 @@ throw std::runtime_error(
 }
 
 //==============================================================================
-static bool all_tls_closed(
-    const std::unordered_set<TlsConnectionPtr>& connections)
+static int32_t parse_count(
+    const YAML::Node& configuration,
+    const std::string& config_key)
 {
-for (const auto& connection : connections)
+const YAML::Node count_node = configuration[config_key];
+if (!count_node)
+{
+    return 1;
+}
+
+utils::Logger logger("is::sh::WebSocket::Server");
+
+try
 {
-    if (connection->get_state() != websocketpp::session::state::closed)
+    const int32_t count = count_node.as<int32_t>();
+    if (count < 1)
     {
-        return false;
+        logger << utils::Logger::Level::ERROR
+               << "'websocket_server' requires '" << config_key
+               << "' to be at least 1, but it is set to " << count << std::endl;
+
+        return -1;
     }
+
+    return count;
 }
+catch (const YAML::Exception& e)
+{
+    logger << utils::Logger::Level::ERROR
+           << "Could not parse an unsigned integer value for the '" << config_key
+           << "' setting '" << count_node << "': " << e.what() << std::endl;
 
-return true;
+    return -1;
+}
 }
 
-static bool all_tcp_closed(
-    const std::unordered_set<TcpConnectionPtr>& connections)
-{
-for (const auto& connection : connections)
+//==============================================================================
+template<typename ConnectionPtr>
+static bool all_closed(
+        const std::unordered_set<ConnectionPtr>& connections)
 {
-    if (connection->get_state() != websocketpp::session::state::closed)
+    for (const auto& connection : connections)
     {
-        return false;
+        if (connection->get_state() != websocketpp::session::state::closed)
+        {
+            return false;
+        }
     }
-}
 
-return true;
+    return true;
 }
 
 //==============================================================================
 /**
-* @class Server
-* @brief This class represents a *WebSocket* Server, which can be defined as an
-*        application that listens to a specific port waiting for Client's requests.
-*
-*        It implements some of the Endpoint class methods.
-*/
-class Server : public Endpoint
+ * @class Server
+ * @brief This class represents a *WebSocket* Server, which can be defined as an
+ *        application that listens to a specific port waiting for Client's requests.
+ *
+ *        The server may be split into several shards. Each shard has its own listening
+ *        socket bound to the same port with `SO_REUSEPORT`, its own io_service threads
+ *        and its own set of connections, so that the kernel balances the incoming
+ *        connections among them. The topic and service tables are kept by the Endpoint,
+ *        and therefore shared by every shard.
+ *
+ *        It implements some of the Endpoint class methods.
+ *
+ * @tparam Config The *websocketpp* configuration, either `TlsConfig` or `TcpConfig`.
+ */
+template<typename Config>
+class Server : public TransportEndpoint<Config>
 {
+    // The asio transport wraps every handler of a connection into a strand of
+    // its own when multithreading is enabled, which allows to run the io_service
+    // on several threads while the events of each connection are still handled
+    // one at a time and in order.
+    static_assert(Config::enable_multithreading,
+            "The websocketpp configuration must enable per-connection strands");
+
 public:
 
-Server()
-    : Endpoint("is::sh::WebSocket::Server")
-    , _opened_tls_conn_counter(0)
-    , _opened_tcp_conn_counter(0)
-{
-    // Do nothing
-}
+    using Base = TransportEndpoint<Config>;
+    using typename Base::ConnectionPtr;
+    using typename Base::ConfigMessagePtr;
+    using WebsocketServer = websocketpp::server<Config>;
 
-TlsEndpoint* configure_tls_endpoint(
-        const core::RequiredTypes& /*types*/,
-        const YAML::Node& configuration) override
-{
-    _use_security = true;
-    _tls_server = std::make_shared<TlsServer>(TlsServer());
-    const int32_t port = parse_port(configuration);
-    if (port < 0)
-    {
-        return nullptr;
-    }
-    const uint16_t uport = static_cast<uint16_t>(port);
+    using Base::Secure;
+    using Base::TransportName;
 
-    const std::string cert_file = find_certificate(configuration);
-    if (cert_file.empty())
-    {
-        _logger << utils::Logger::Level::ERROR
-                << "You must specify a certificate file in your "
-                << "'websocket_server' TLS server configuration!" << std::endl;
+private:
 
-        return nullptr;
-    }
-    else
+    /**
+     * @brief A listening socket, together with the threads running its io_service
+     *        and the connections it has accepted.
+     */
+    struct Shard
     {
-        _logger << utils::Logger::Level::DEBUG
-                << "Found certificate file: '" << cert_file << "'" << std::endl;
-    }
+        std::shared_ptr<WebsocketServer> server;
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::unordered_set<ConnectionPtr> open_connections;
+        std::unordered_map<ConnectionPtr, uint16_t> open_conn_to_id;
+    };
 
-    const std::string key_file = find_private_key(configuration);
-    if (key_file.empty())
-    {
-        _logger << utils::Logger::Level::ERROR
-                << "You must specify a private key in your "
-                << "'websocket_server' TLS server configuration!" << std::endl;
+public:
 
-        return nullptr;
-    }
-    else
+    Server()
+        : Base("is::sh::WebSocket::Server")
+        , _opened_conn_counter(0)
     {
-        _logger << utils::Logger::Level::DEBUG
-                << "TLS Server: found private key file: '" << key_file << "'" << std::endl;
+        // Do nothing
     }
 
-    const boost::asio::ssl::context::file_format format =
-            parse_format(configuration);
-
-    const YAML::Node auth_node = configuration[YamlAuthKey];
-    if (auth_node)
+    bool configure_endpoint(
+            const core::RequiredTypes& /*types*/,
+            const YAML::Node& configuration) override
     {
-        _jwt_validator = std::make_unique<JwtValidator>();
-        bool success = ServerConfig::load_auth_policy(*_jwt_validator, auth_node);
-        if (!success)
-        {
-            _logger << utils::Logger::Level::ERROR
-                    << "TLS server: error loading auth policy: " << auth_node << std::endl;
+        _logger << utils::Logger::Level::INFO
+                << "Security " << (Secure ? "enabled" : "disabled") << ", creating "
+                << TransportName << " endpoint..." << std::endl;
 
-            return nullptr;
+        const int32_t port = this->parse_port(configuration);
+        if (port < 0)
+        {
+            return false;
         }
-        else
+
+        if (!this->configure_outbound_queue(configuration))
         {
-            _logger << utils::Logger::Level::DEBUG
-                    << "TLS server: loaded auth policy: " << auth_node << std::endl;
+            return false;
         }
-    }
+        const uint16_t uport = static_cast<uint16_t>(port);
 
-    if (!configure_server(uport, cert_file, key_file, format))
-    {
-        return nullptr;
-    }
+        const int32_t threads = parse_count(configuration, YamlThreadsKey);
+        if (threads < 0)
+        {
+            return false;
+        }
+        _threads = static_cast<std::size_t>(threads);
 
-    return _tls_server.get();
-}
+        const int32_t shards = parse_count(configuration, YamlShardsKey);
+        if (shards < 0)
+        {
+            return false;
+        }
+#ifndef SO_REUSEPORT
+        if (shards > 1)
+        {
+            _logger << utils::Logger::Level::ERROR
+                    << "'" << YamlShardsKey << "' requires SO_REUSEPORT, "
+                    << "which is not supported on this platform" << std::endl;
 
-TcpEndpoint* configure_tcp_endpoint(
-        const core::RequiredTypes& /*types*/,
-        const YAML::Node& configuration) override
-{
-    _use_security = false;
-    _tcp_server = std::make_shared<TcpServer>(TcpServer());
-    const int32_t port = parse_port(configuration);
-    if (port < 0)
-    {
-        return nullptr;
-    }
-    const uint16_t uport = static_cast<uint16_t>(port);
+            return false;
+        }
+#endif // ifndef SO_REUSEPORT
+        _shards_count = static_cast<std::size_t>(shards);
 
-    const boost::asio::ssl::context::file_format format =
-            parse_format(configuration);
+        std::string cert_file;
+        std::string key_file;
 
-    const YAML::Node auth_node = configuration[YamlAuthKey];
-    if (auth_node)
-    {
-        _jwt_validator = std::make_unique<JwtValidator>();
-        bool success = ServerConfig::load_auth_policy(*_jwt_validator, auth_node);
-        if (!success)
+        if (Secure)
         {
-            _logger << utils::Logger::Level::ERROR
-                    << "TCP server: error loading auth policy: " << auth_node << std::endl;
+            cert_file = find_certificate(configuration);
+            if (cert_file.empty())
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "You must specify a certificate file in your "
+                        << "'websocket_server' TLS server configuration!" << std::endl;
+
+                return false;
+            }
+            else
+            {
+                _logger << utils::Logger::Level::DEBUG
+                        << "Found certificate file: '" << cert_file << "'" << std::endl;
+            }
+
+            key_file = find_private_key(configuration);
+            if (key_file.empty())
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "You must specify a private key in your "
+                        << "'websocket_server' TLS server configuration!" << std::endl;
 
-            return nullptr;
+                return false;
+            }
+            else
+            {
+                _logger << utils::Logger::Level::DEBUG
+                        << "TLS Server: found private key file: '" << key_file << "'" << std::endl;
+            }
         }
-        else
+
+        const boost::asio::ssl::context::file_format format =
+                parse_format(configuration);
+
+        const YAML::Node auth_node = configuration[YamlAuthKey];
+        if (auth_node)
         {
-            _logger << utils::Logger::Level::DEBUG
-                    << "TCP server: loaded auth policy: " << auth_node << std::endl;
+            _jwt_validator = std::make_unique<JwtValidator>();
+            bool success = ServerConfig::load_auth_policy(*_jwt_validator, auth_node);
+            if (!success)
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << TransportName << " server: error loading auth policy: "
+                        << auth_node << std::endl;
+
+                return false;
+            }
+            else
+            {
+                _logger << utils::Logger::Level::DEBUG
+                        << TransportName << " server: loaded auth policy: "
+                        << auth_node << std::endl;
+            }
         }
-    }
 
-    if (!configure_server(uport, "", "", format))
-    {
-        return nullptr;
+        return configure_server(uport, cert_file, key_file, format);
     }
 
-    return _tcp_server.get();
-}
-
-bool configure_server(
-        const uint16_t port,
-        const std::string& cert_file,
-        const std::string& key_file,
-        const boost::asio::ssl::context::file_format format)
-{
-    namespace asio = boost::asio;
+    bool configure_server(
+            const uint16_t port,
+            const std::string& cert_file,
+            const std::string& key_file,
+            const boost::asio::ssl::context::file_format format)
+    {
+        namespace asio = boost::asio;
 
-    _context = std::make_shared<SslContext>(asio::ssl::context::tls);
-    _context->set_options(
-        asio::ssl::context::default_workarounds |
-        asio::ssl::context::no_sslv2 |
-        asio::ssl::context::no_sslv3);
+        _context = std::make_shared<SslContext>(asio::ssl::context::tls);
+        _context->set_options(
+            asio::ssl::context::default_workarounds |
+            asio::ssl::context::no_sslv2 |
+            asio::ssl::context::no_sslv3);
 
-    boost::system::error_code ec;
-    if (!cert_file.empty())
-    {
-        _context->use_certificate_file(cert_file, format, ec);
-        if (ec)
+        boost::system::error_code ec;
+        if (!cert_file.empty())
         {
-            _logger << utils::Logger::Level::ERROR
-                    << "Failed to load certificate file '"
-                    << cert_file << "': " << ec.message() << std::endl;
+            _context->use_certificate_file(cert_file, format, ec);
+            if (ec)
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "Failed to load certificate file '"
+                        << cert_file << "': " << ec.message() << std::endl;
 
-            return false;
+                return false;
+            }
+            else
+            {
+                _logger << utils::Logger::Level::DEBUG
+                        << "Loaded certificate file '" << cert_file << "'" << std::endl;
+            }
         }
-        else
+
+        // TODO(MXG): There is an alternative function
+        // _context->use_private_key(key_file, format, ec);
+        // which I guess is supposed to be used for keys that do not label
+        // themselves as rsa private keys? We're currently using rsa private
+        // keys, but this is probably something we should allow users to
+        // configure from the Integration Service config file.
+        if (!key_file.empty())
         {
-            _logger << utils::Logger::Level::DEBUG
-                    << "Loaded certificate file '" << cert_file << "'" << std::endl;
+            _context->use_rsa_private_key_file(key_file, format, ec);
+            if (ec)
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "Failed to load private key file '" << key_file
+                        << "': " << ec.message() << std::endl;
+
+                return false;
+            }
+            else
+            {
+                _logger << utils::Logger::Level::DEBUG
+                        << "Loaded private key file: '" << key_file << "'" << std::endl;
+            }
         }
+
+        return initialize_server(port);
     }
 
-    // TODO(MXG): There is an alternative function
-    // _context->use_private_key(key_file, format, ec);
-    // which I guess is supposed to be used for keys that do not label
-    // themselves as rsa private keys? We're currently using rsa private
-    // keys, but this is probably something we should allow users to
-    // configure from the Integration Service config file.
-    if (!key_file.empty())
+    bool initialize_server(
+            uint16_t port)
     {
-        _context->use_rsa_private_key_file(key_file, format, ec);
-        if (ec)
-        {
-            _logger << utils::Logger::Level::ERROR
-                    << "Failed to load private key file '" << key_file
-                    << "': " << ec.message() << std::endl;
+        _logger << utils::Logger::Level::INFO
+                << "Initializing " << TransportName << " server on port " << port
+                << " with " << _shards_count << " shard(s) of "
+                << _threads << " thread(s) each" << std::endl;
 
-            return false;
-        }
-        else
+        for (std::size_t i = 0; i < _shards_count; ++i)
         {
-            _logger << utils::Logger::Level::DEBUG
-                    << "Loaded private key file: '" << key_file << "'" << std::endl;
+            _shards.emplace_back(std::make_unique<Shard>());
+            if (!initialize_shard(*_shards.back(), port))
+            {
+                return false;
+            }
         }
-    }
-    // TODO(MXG): This helps to rerun Integration Service more quickly if the server fell down
-    // gracelessly. Is this something we really want? Are there any dangers to
-    // using this?
-    if (_use_security)
-    {
-        initialize_tls_server(port);
-    }
-    else
-    {
-        initialize_tcp_server(port);
+
+        return true;
     }
 
-    return true;
-}
+    bool initialize_shard(
+            Shard& shard,
+            uint16_t port)
+    {
+        shard.server = std::make_shared<WebsocketServer>();
+        WebsocketServer& server = *shard.server;
 
-void initialize_tls_server(
-        uint16_t port)
-{
-    _logger << utils::Logger::Level::INFO
-            << "Initializing TLS server on port " << port << std::endl;
+        // TODO(MXG): This helps to rerun Integration Service more quickly if the server fell down
+        // gracelessly. Is this something we really want? Are there any dangers to
+        // using this?
+        server.set_reuse_addr(true);
 
-    _tls_server->set_reuse_addr(true);
+        server.clear_access_channels(
+            websocketpp::log::alevel::frame_header |
+            websocketpp::log::alevel::frame_payload);
 
-    _tls_server->clear_access_channels(
-        websocketpp::log::alevel::frame_header |
-        websocketpp::log::alevel::frame_payload);
+        server.init_asio();
+        server.start_perpetual();
 
-    _tls_server->init_asio();
-    _tls_server->start_perpetual();
+        server.set_message_handler(
+            [this, &shard](ConnectionHandlePtr handle, ConfigMessagePtr message)
+            {
+                this->_handle_message(shard, handle, message);
+            });
 
-    _tls_server->set_message_handler(
-        [&](ConnectionHandlePtr handle, TlsMessagePtr message)
-        {
-            this->_handle_tls_message(handle, message);
-        });
+        server.set_close_handler(
+            [this, &shard](ConnectionHandlePtr handle)
+            {
+                this->_handle_close(shard, std::move(handle));
+            });
 
-    _tls_server->set_close_handler(
-        [&](ConnectionHandlePtr handle)
-        {
-            this->_handle_close(std::move(handle));
-        });
+        server.set_open_handler(
+            [this, &shard](ConnectionHandlePtr handle)
+            {
+                this->_handle_opening(shard, std::move(handle));
+            });
 
-    _tls_server->set_open_handler(
-        [&](ConnectionHandlePtr handle)
-        {
-            this->_handle_opening(std::move(handle));
-        });
+        server.set_fail_handler(
+            [this](ConnectionHandlePtr handle)
+            {
+                this->_handle_failed_connection(std::move(handle));
+            });
 
-    _tls_server->set_fail_handler(
-        [&](ConnectionHandlePtr handle)
+        if constexpr (Secure)
         {
-            this->_handle_failed_connection(std::move(handle));
-        });
+            server.set_tls_init_handler(
+                [this](ConnectionHandlePtr /*handle*/) -> SslContextPtr
+                {
+                    return this->_context;
+                });
+        }
 
-    _tls_server->set_tls_init_handler(
-        [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-        {
-            return _context;
-        });
+        server.set_validate_handler(
+            [this](ConnectionHandlePtr handle) -> bool
+            {
+                return this->_handle_validate(std::move(handle));
+            });
 
-    _tls_server->set_validate_handler(
-        [&](ConnectionHandlePtr handle) -> bool
+#ifdef SO_REUSEPORT
+        if (_shards_count > 1)
         {
-            return this->_handle_validate(std::move(handle));
-        });
-
-    _tls_server->listen(port);
+            // Every shard binds its own acceptor to the same port, and the kernel
+            // balances the incoming connections among them.
+            server.set_tcp_pre_bind_handler(
+                [this](const std::shared_ptr<boost::asio::ip::tcp::acceptor>& acceptor)
+                -> websocketpp::lib::error_code
+                {
+                    using ReusePort =
+                            boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
 
-    _server_thread = std::thread([&]()
+                    boost::system::error_code ec;
+                    acceptor->set_option(ReusePort(true), ec);
+                    if (ec)
                     {
-                        this->_tls_server->run();
-                    });
-
-}
-
-void initialize_tcp_server(
-        uint16_t port)
-{
-    _logger << utils::Logger::Level::INFO
-            << "Initializing TCP server on port " << port << std::endl;
+                        _logger << utils::Logger::Level::ERROR
+                                << "Failed to enable SO_REUSEPORT: " << ec.message() << std::endl;
 
-    _tcp_server->set_reuse_addr(true);
-
-    _tcp_server->clear_access_channels(
-        websocketpp::log::alevel::frame_header |
-        websocketpp::log::alevel::frame_payload);
-
-    _tcp_server->init_asio();
-    _tcp_server->start_perpetual();
-
-    _tcp_server->set_message_handler(
-        [&](ConnectionHandlePtr handle, TlsMessagePtr message)
-        {
-            this->_handle_tcp_message(handle, message);
-        });
-
-    _tcp_server->set_close_handler(
-        [&](ConnectionHandlePtr handle)
-        {
-            this->_handle_close(std::move(handle));
-        });
+                        return websocketpp::transport::asio::error::make_error_code(
+                            websocketpp::transport::asio::error::pass_through);
+                    }
 
-    _tcp_server->set_open_handler(
-        [&](ConnectionHandlePtr handle)
-        {
-            this->_handle_opening(std::move(handle));
-        });
+                    return websocketpp::lib::error_code();
+                });
+        }
+#endif // ifdef SO_REUSEPORT
 
-    _tcp_server->set_fail_handler(
-        [&](ConnectionHandlePtr handle)
+        websocketpp::lib::error_code ec;
+        server.listen(port, ec);
+        if (ec)
         {
-            this->_handle_failed_connection(std::move(handle));
-        });
+            _logger << utils::Logger::Level::ERROR
+                    << "Failed to listen on port " << port << ": " << ec.message() << std::endl;
 
-    _tcp_server->set_tcp_init_handler(
-        [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-        {
-            return _context;
-        });
+            return false;
+        }
 
-    _tcp_server->set_validate_handler(
-        [&](ConnectionHandlePtr handle) -> bool
+        for (std::size_t i = 0; i < _threads; ++i)
         {
-            return this->_handle_validate(std::move(handle));
-        });
-
-    _tcp_server->listen(port);
-
-    _server_thread = std::thread([&]()
+            shard.threads.emplace_back([&server]()
                     {
-                        this->_tcp_server->run();
+                        server.run();
                     });
+        }
 
-}
-
-~Server() override
-{
-    _closing_down = true;
-
-    // NOTE(MXG): _open_connections can get modified in other threads so we'll
-    // make a copy of it here before using it.
-    // TODO(MXG): We should probably be using mutexes to protect the operations
-    // on these connections.
+        return true;
+    }
 
-    // First instruct all connections to close
-    if (_use_security)
+    ~Server() override
     {
-        _mutex.lock();
-        for (const auto& connection : _open_tls_connections)
+        _closing_down = true;
+
+        // NOTE(MXG): _open_connections can get modified in other threads so we'll
+        // make a copy of it here before using it.
+        std::unordered_set<ConnectionPtr> open_connections;
+        std::unordered_map<ConnectionPtr, uint16_t> open_conn_to_id;
+        for (const auto& shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            open_connections.insert(
+                shard->open_connections.begin(), shard->open_connections.end());
+            open_conn_to_id.insert(
+                shard->open_conn_to_id.begin(), shard->open_conn_to_id.end());
+        }
+
+        // First instruct all connections to close
+        for (const auto& connection : open_connections)
         {
             if (connection->get_state() != websocketpp::session::state::closed)
             {
@@ -517,9 +583,9 @@ void initialize_tcp_server(
                 {
                     _logger << utils::Logger::Level::WARN
                             << "Exception ocurred while closing connection";
-                    if (_open_tls_conn_to_id.end() != _open_tls_conn_to_id.find(connection))
+                    if (open_conn_to_id.end() != open_conn_to_id.find(connection))
                     {
-                        _logger << " with ID '" << _open_tls_conn_to_id[connection] << "'";
+                        _logger << " with ID '" << open_conn_to_id[connection] << "'";
                     }
                     _logger << std::endl;
                 }
@@ -532,7 +598,7 @@ void initialize_tcp_server(
         const auto start_time = std::chrono::steady_clock::now();
         // TODO(MXG): Make these timeout parameters something that can be
         // configured by users.
-        while (!all_tls_closed(_open_tls_connections))
+        while (!all_closed(open_connections))
         {
             std::this_thread::sleep_for(200ms);
 
@@ -546,224 +612,148 @@ void initialize_tcp_server(
                 break;
             }
         }
-        _mutex.unlock();
-    }
-    else
-    {
-        _mutex.lock();
-        for (const auto& connection : _open_tcp_connections)
+
+        for (const auto& shard : _shards)
         {
-            if (connection->get_state() != websocketpp::session::state::closed)
+            shard->server->stop();
+            for (std::thread& server_thread : shard->threads)
             {
-                try
+                if (server_thread.joinable())
                 {
-                    connection->close(websocketpp::close::status::normal, "shutdown");
-                }
-                catch (websocketpp::exception& e)
-                {
-                    _logger << utils::Logger::Level::WARN
-                            << "Exception ocurred while closing connection";
-                    if (_open_tcp_conn_to_id.end() != _open_tcp_conn_to_id.find(connection))
-                    {
-                        _logger << " with ID '" << _open_tcp_conn_to_id[connection] << "'";
-                    }
-                    _logger << std::endl;
+                    server_thread.join();
                 }
             }
         }
-        // Then wait for all of them to close
-
-        using namespace std::chrono_literals;
-        const auto start_time = std::chrono::steady_clock::now();
-        // TODO(MXG): Make these timeout parameters something that can be
-        // configured by users.
-        while (!all_tcp_closed(_open_tcp_connections))
-        {
-            std::this_thread::sleep_for(200ms);
-
-            if (std::chrono::steady_clock::now() - start_time > 10s)
-            {
-                _logger << utils::Logger::Level::ERROR
-                        << "Timed out while waiting for "
-                        << "the remote clients to acknowledge the connection "
-                        << "shutdown request" << std::endl;
-
-                break;
-            }
-        }
-        _mutex.unlock();
     }
 
-    if (_server_thread.joinable())
+    bool okay() const override
     {
-        if (_use_security)
-        {
-            _tls_server->stop();
-        }
-        else
-        {
-            _tcp_server->stop();
-        }
-
-        _server_thread.join();
+        // TODO(MXG): How do we know if the server is okay?
+        return true;
     }
-}
 
-bool okay() const override
-{
-    // TODO(MXG): How do we know if the server is okay?
-    return true;
-}
-
-bool spin_once() override
-{
-    if (!_has_spun_once)
+    bool spin_once() override
     {
-        _has_spun_once = true;
-        if (_use_security)
+        if (!_has_spun_once)
         {
-            _tls_server->start_accept();
-        }
-        else
-        {
-            _tcp_server->start_accept();
+            _has_spun_once = true;
+            for (const auto& shard : _shards)
+            {
+                shard->server->start_accept();
+            }
         }
-    }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        this->flush_outbound_queues();
+        this->report_publication_drops();
+        this->report_input_errors();
+        this->evict_expired_fragments();
 
-    // TODO(MXG): How do we know if the server is okay?
-    return true;
-}
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
-void runtime_advertisement(
-        const std::string& topic,
-        const xtypes::DynamicType& message_type,
-        const std::string& id,
-        const YAML::Node& configuration) override
-{
-    const std::string advertise_msg =
-            get_encoding().encode_advertise_msg(
-        topic, message_type.name(), id, configuration);
-
-    if (_use_security)
-    {
-        _mutex.lock();
-        for (const TlsConnectionPtr& connection : _open_tls_connections)
-        {
-            connection->send(advertise_msg);
-        }
-        _mutex.unlock();
+        // TODO(MXG): How do we know if the server is okay?
+        return true;
     }
-    else
+
+    void runtime_advertisement(
+            const std::string& topic,
+            const xtypes::DynamicType& message_type,
+            const std::string& id,
+            const YAML::Node& configuration) override
     {
-        _mutex.lock();
-        for (const TcpConnectionPtr& connection : _open_tcp_connections)
+        // The advertisement is encoded and framed once per encoding in use,
+        // and shared among the connections of every shard.
+        std::unordered_map<const Encoding*, MessagePtr> frames;
+
+        for (const auto& shard : _shards)
         {
-            connection->send(advertise_msg);
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (const ConnectionPtr& connection : shard->open_connections)
+            {
+                const Encoding& encoding = this->get_encoding(connection);
+                MessagePtr& frame = frames[&encoding];
+                if (!frame)
+                {
+                    frame = make_shared_frame(
+                        encoding.encode_advertise_msg(topic, message_type.name(), id, configuration),
+                        this->frame_opcode(encoding));
+                }
+
+                if (accepts_shared_frames(*connection))
+                {
+                    connection->send(frame);
+                }
+                else
+                {
+                    connection->send(frame->get_payload(), frame->get_opcode());
+                }
+            }
         }
-        _mutex.unlock();
     }
-}
 
 private:
 
-void _handle_tls_message(
-        const ConnectionHandlePtr& handle,
-        const TlsMessagePtr& message)
-{
-    auto incoming_handle = _tls_server->get_con_from_hdl(handle);
-
-    _logger << utils::Logger::Level::INFO
-            << "Handle TLS message from connection '"
-            << _open_tls_conn_to_id[incoming_handle] << "': [[ "
-            << message->get_payload() << " ]]" << std::endl;
-
-    get_encoding().interpret_websocket_msg(
-        message->get_payload(), *this, incoming_handle);
-}
+    using Base::_logger;
+    using Base::to_connection;
 
-void _handle_tcp_message(
-        const ConnectionHandlePtr& handle,
-        const TcpMessagePtr& message)
-{
-    auto incoming_handle = _tcp_server->get_con_from_hdl(handle);
-
-    _logger << utils::Logger::Level::INFO
-            << "Handle TCP message from connection '"
-            << _open_tcp_conn_to_id[incoming_handle] << "': [[ "
-            << message->get_payload() << " ]]" << std::endl;
-
-    get_encoding().interpret_websocket_msg(
-        message->get_payload(), *this, incoming_handle);
-}
-
-void _handle_close(
-        const ConnectionHandlePtr& handle)
-{
-    _mutex.lock();
-    if (_use_security)
-    {
-        const auto connection = _tls_server->get_con_from_hdl(handle);
-        const uint16_t connection_id = _open_tls_conn_to_id[connection];
-
-        _open_tls_conn_to_id.erase(connection);
-
-        notify_connection_closed(connection);
-
-        _open_tls_connections.erase(connection);
-
-        _logger << utils::Logger::Level::INFO
-                << "Closed TLS client connection with ID '" << connection_id
-                << "'. Now, " << _open_tls_connections.size()
-                << " TLS connections remain active" << std::endl;
-    }
-    else
+    void _handle_message(
+            Shard& shard,
+            const ConnectionHandlePtr& handle,
+            const ConfigMessagePtr& message)
     {
-        const auto connection = _tcp_server->get_con_from_hdl(handle);
-        const uint16_t connection_id = _open_tcp_conn_to_id[connection];
+        auto incoming_handle = to_connection(handle);
 
-        _open_tcp_conn_to_id.erase(connection);
+        // The connection ID is only needed to trace the message, so the shard is not locked otherwise.
+        if (log_enabled(LogLevel::TRACE))
+        {
+            uint16_t connection_id = 0;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
 
-        notify_connection_closed(connection);
+                auto it = shard.open_conn_to_id.find(incoming_handle);
+                if (it != shard.open_conn_to_id.end())
+                {
+                    connection_id = it->second;
+                }
+            }
 
-        _open_tcp_connections.erase(connection);
+            IS_WEBSOCKET_LOG(_logger, TRACE)
+                << "Handle " << TransportName << " message from connection '"
+                << connection_id << "': [[ "
+                << message->get_payload() << " ]]" << std::endl;
+        }
 
-        _logger << utils::Logger::Level::INFO
-                << "Closed TCP client connection with ID '" << connection_id
-                << "'. Now, " << _open_tcp_connections.size()
-                << " TCP connections remain active" << std::endl;
+        this->get_encoding(incoming_handle).interpret_websocket_msg(
+            message->get_payload(), *this, incoming_handle);
     }
-    _mutex.unlock();
-}
 
-void _handle_opening(
-        const ConnectionHandlePtr& handle)
-{
-    _mutex.lock();
-    if (_use_security)
+    void _handle_close(
+            Shard& shard,
+            const ConnectionHandlePtr& handle)
     {
-        const auto connection = _tls_server->get_con_from_hdl(handle);
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        if (_closing_down)
-        {
-            connection->close(websocketpp::close::status::normal, "shutdown");
-            return;
-        }
+        const auto connection = to_connection(handle);
+        const uint16_t connection_id = shard.open_conn_to_id[connection];
 
-        _open_tls_conn_to_id.insert({connection, ++_opened_tls_conn_counter});
+        shard.open_conn_to_id.erase(connection);
 
-        notify_connection_opened(connection);
+        this->notify_connection_closed(connection);
 
-        _open_tls_connections.insert(connection);
+        shard.open_connections.erase(connection);
 
         _logger << utils::Logger::Level::INFO
-                << "Opened TLS connection with ID '" << _opened_tls_conn_counter << "'. "
-                << "Number of active TLS connections: " << _open_tls_connections.size() << std::endl;
+                << "Closed " << TransportName << " client connection with ID '" << connection_id
+                << "'. Now, " << shard.open_connections.size()
+                << " " << TransportName << " connections remain active in its shard" << std::endl;
     }
-    else
+
+    void _handle_opening(
+            Shard& shard,
+            const ConnectionHandlePtr& handle)
     {
-        const auto connection = _tcp_server->get_con_from_hdl(handle);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto connection = to_connection(handle);
 
         if (_closing_down)
         {
@@ -771,71 +761,52 @@ void _handle_opening(
             return;
         }
 
-        _open_tcp_conn_to_id.insert({connection, ++_opened_tcp_conn_counter});
+        const uint16_t connection_id = ++_opened_conn_counter;
+        shard.open_conn_to_id.insert({connection, connection_id});
 
-        notify_connection_opened(connection);
+        this->notify_connection_opened(connection);
 
-        _open_tcp_connections.insert(connection);
+        shard.open_connections.insert(connection);
 
         _logger << utils::Logger::Level::INFO
-                << "Opened TCP connection with ID '" << _opened_tcp_conn_counter << "'. "
-                << "Number of active TCP connections: " << _open_tcp_connections.size() << std::endl;
+                << "Opened " << TransportName << " connection with ID '" << connection_id << "'. "
+                << "Number of active " << TransportName << " connections in its shard: "
+                << shard.open_connections.size() << std::endl;
     }
-    _mutex.unlock();
-}
 
-void _handle_failed_connection(
-        const ConnectionHandlePtr& /*handle*/)
-{
-    _logger << utils::Logger::Level::WARN
-            << "An incoming client failed to " << "connect." << std::endl;
-}
-
-bool _handle_validate(
-        const ConnectionHandlePtr& handle)
-{
-    if (!_jwt_validator)
+    void _handle_failed_connection(
+            const ConnectionHandlePtr& /*handle*/)
     {
-        return true;
+        _logger << utils::Logger::Level::WARN
+                << "An incoming client failed to " << "connect." << std::endl;
     }
 
-    if (_use_security)
+    bool _handle_validate(
+            const ConnectionHandlePtr& handle)
     {
-        TlsConnectionPtr connection_ptr = _tls_server->get_con_from_hdl(handle);
-        std::string const & authorization = connection_ptr->get_request_header(AuthHeader);
+        const ConnectionPtr connection_ptr = to_connection(handle);
 
-        if (authorization == websocketpp::http::empty_header
-            || authorization.substr(0,6) != AuthMethod )
+        // Negotiate the encoding: the first requested subprotocol naming an accepted encoding wins.
+        for (const std::string& protocol : connection_ptr->get_requested_subprotocols())
         {
-            connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
-            return false; // a valid Integration Service client should always send exactly 1 subprotocols.
+            std::string name = protocol;
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            if (this->accepts_encoding(name))
+            {
+                ErrorCode ec;
+                connection_ptr->select_subprotocol(protocol, ec);
+                break;
+            }
         }
 
-        const std::string token = authorization.substr(7); // jwt token
-
-        try
+        if (!_jwt_validator)
         {
-            _jwt_validator->verify(token);
-        }
-        catch (const jwt::VerificationError& e)
-        {
-            _logger << utils::Logger::Level::ERROR
-                    << "Error while validating token on TLS server'" << token
-                    << "'" << e.what() << std::endl;
-
-            connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
-            return false;
+            return true;
         }
-
-        return true;
-    }
-    else
-    {
-        TcpConnectionPtr connection_ptr = _tcp_server->get_con_from_hdl(handle);
-        std::string const & authorization = connection_ptr->get_request_header(AuthHeader);
+        std::string const& authorization = connection_ptr->get_request_header(AuthHeader);
 
         if (authorization == websocketpp::http::empty_header
-            || authorization.substr(0,6) != AuthMethod )
+                || authorization.substr(0, 6) != AuthMethod )
         {
             connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
             return false; // a valid Integration Service client should always send exactly 1 subprotocols.
@@ -850,7 +821,7 @@ bool _handle_validate(
         catch (const jwt::VerificationError& e)
         {
             _logger << utils::Logger::Level::ERROR
-                    << "Error while validating token on TCP server'" << token
+                    << "Error while validating token on " << TransportName << " server'" << token
                     << "'" << e.what() << std::endl;
 
             connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
@@ -859,28 +830,21 @@ bool _handle_validate(
 
         return true;
     }
-}
 
-std::shared_ptr<TlsServer> _tls_server;
-std::shared_ptr<TcpServer> _tcp_server;
-bool _use_security;
-std::thread _server_thread;
-std::mutex _mutex;
-EncodingPtr _encoding;
-SslContextPtr _context;
-std::unordered_set<TlsConnectionPtr> _open_tls_connections;
-uint16_t _opened_tls_conn_counter;
-std::unordered_map<TlsConnectionPtr, uint16_t> _open_tls_conn_to_id;
-    std::unordered_set<TcpConnectionPtr> _open_tcp_connections;
-    uint16_t _opened_tcp_conn_counter;
-    std::unordered_map<TcpConnectionPtr, uint16_t> _open_tcp_conn_to_id;
+    std::vector<std::unique_ptr<Shard> > _shards;
+    std::size_t _shards_count = 1;
+    std::size_t _threads = 1;
+    SslContextPtr _context;
+    std::atomic<uint16_t> _opened_conn_counter;
     bool _has_spun_once = false;
-    bool _closing_down = false;
+    std::atomic_bool _closing_down{false};
     std::unique_ptr<JwtValidator> _jwt_validator;
 
 };
 
-IS_REGISTER_SYSTEM("websocket_server", is::sh::websocket::Server)
+using ServerSystem = TransportSelector<Server>;
+
+IS_REGISTER_SYSTEM("websocket_server", is::sh::websocket::ServerSystem)
 
 } //  namespace websocket
 } //  namespace sh
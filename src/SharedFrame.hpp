@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__SHAREDFRAME_HPP_
+#define _WEBSOCKET_IS_SH__SRC__SHAREDFRAME_HPP_
+
+#include "websocket_types.hpp"
+
+#include <websocketpp/frame.hpp>
+
+#include <string>
+#include <type_traits>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+static_assert(std::is_same<TlsMessagePtr, TcpMessagePtr>::value,
+        "TLS and TCP connections are expected to share the same message type");
+
+using MessagePtr = TcpMessagePtr;
+using OpCode = websocketpp::frame::opcode::value;
+
+/**
+ * @brief Oldest *WebSocket* protocol version whose framing is the one of RFC 6455,
+ *        namely that of the hybi-07 draft.
+ */
+const int SharedFrameMinVersion = 7;
+
+/**
+ * @brief Check whether the frames built by make_shared_frame can be sent through a connection.
+ *
+ * @details Only server connections using the RFC 6455 framing can take them. *websocketpp*
+ *          also accepts the handshake of the hybi-00 draft, whose framing is different,
+ *          so the version negotiated by the connection must be checked as well.
+ *
+ * @param[in] connection The connection, once its handshake is complete.
+ *
+ * @returns `true` if the connection can be handed a shared frame.
+ */
+template<typename Connection>
+bool accepts_shared_frames(
+        const Connection& connection)
+{
+    return connection.is_server() && connection.get_version() >= SharedFrameMinVersion;
+}
+
+/**
+ * @brief Build a complete, ready to be written, server to client data frame.
+ *
+ * @details Frames sent by a server are never masked, so the framed bytes are the
+ *          same for every connection using the RFC 6455 framing. The returned message
+ *          is flagged as *prepared*, which makes `websocketpp::connection::send` push it
+ *          straight into the connection's send queue without copying the payload
+ *          or building the frame header again. This allows to share a single message
+ *          among all the connections a publication is sent to.
+ *
+ *          TLS encryption takes place below the *WebSocket* framing, so the same frame
+ *          can be shared among TLS connections as well.
+ *
+ *          The frame must never be handed to a client connection, since frames sent by a
+ *          client must be masked with a different key each time, nor to a connection using
+ *          another framing; accepts_shared_frames tells which connections can take it.
+ *
+ * @param[in] payload The payload of the frame. It will be moved into the frame.
+ *
+ * @param[in] opcode The kind of data frame, text by default.
+ *
+ * @returns A shared pointer to the prepared frame.
+ */
+inline MessagePtr make_shared_frame(
+        std::string payload,
+        const OpCode opcode = websocketpp::frame::opcode::text)
+{
+    using Message = MessagePtr::element_type;
+
+    // The frame does not belong to any connection, so it has no message manager
+    // to be recycled into; it will be freed once every connection has written it.
+    MessagePtr frame = std::make_shared<Message>(Message::con_msg_man_ptr(), opcode, 0);
+
+    const websocketpp::frame::basic_header header(opcode, payload.size(), true, false);
+    const websocketpp::frame::extended_header extended_header(payload.size());
+    frame->set_header(websocketpp::frame::prepare_header(header, extended_header));
+
+    frame->get_raw_payload() = std::move(payload);
+    frame->set_prepared(true);
+
+    return frame;
+}
+
+/**
+ * @brief Build a data message which is not framed yet.
+ *
+ * @details Unlike make_shared_frame, the frame header is built by the connection the
+ *          message is sent through, so it can be sent by client connections as well.
+ *
+ * @param[in] payload The payload of the message. It will be moved into the message.
+ *
+ * @param[in] opcode The kind of data message, text by default.
+ *
+ * @returns A shared pointer to the message.
+ */
+inline MessagePtr make_message(
+        std::string payload,
+        const OpCode opcode = websocketpp::frame::opcode::text)
+{
+    using Message = MessagePtr::element_type;
+
+    MessagePtr message = std::make_shared<Message>(Message::con_msg_man_ptr(), opcode, 0);
+    message->get_raw_payload() = std::move(payload);
+
+    return message;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__SHAREDFRAME_HPP_
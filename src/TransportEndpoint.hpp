@@ -0,0 +1,745 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__TRANSPORTENDPOINT_HPP_
+#define _WEBSOCKET_IS_SH__SRC__TRANSPORTENDPOINT_HPP_
+
+#include "Endpoint.hpp"
+#include "OutboundQueue.hpp"
+#include "SharedFrame.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlOutboundQueueKey = "outbound_queue";
+const std::string EncodingQueryKey = "encoding";
+
+/**
+ * @class TransportEndpoint
+ *        Endpoint specialization for a certain *websocketpp* configuration,
+ *        that is, either TLS (`TlsConfig`) or TCP (`TcpConfig`).
+ *
+ *        Every connection handle managed by a TransportEndpoint refers to a connection
+ *        of its own configuration, so the opaque handles used by the Endpoint can be
+ *        converted back into connections without any runtime lookup.
+ *
+ * @tparam Config The *websocketpp* configuration used by the transport.
+ */
+template<typename Config>
+class TransportEndpoint : public Endpoint
+{
+public:
+
+    using Connection = websocketpp::connection<Config>;
+    using ConnectionPtr = typename Connection::ptr;
+    using ConfigMessagePtr = typename Config::message_type::ptr;
+
+    /**
+     * @brief Whether this transport uses TLS or not.
+     */
+    static constexpr bool Secure = std::is_same<Config, TlsConfig>::value;
+
+    /**
+     * @brief Name of the transport, used to identify logging traces.
+     */
+    static constexpr const char* TransportName = Secure ? "TLS" : "TCP";
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] name The name given to this Endpoint instance.
+     *            It will be used to identify logging traces.
+     */
+    TransportEndpoint(
+            const std::string& name)
+        : Endpoint(name)
+    {
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~TransportEndpoint() = default;
+
+protected:
+
+    /**
+     * @brief Get the connection referred by an opaque handle.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @returns The connection.
+     */
+    static Connection* to_connection(
+            const std::shared_ptr<void>& connection_handle)
+    {
+        return static_cast<Connection*>(connection_handle.get());
+    }
+
+    /**
+     * @brief Get the connection referred by a *websocketpp* handle.
+     *        The handle must have been created by an endpoint with the same configuration.
+     *
+     * @param[in] handle The *websocketpp* connection handle.
+     *
+     * @returns The connection, or `nullptr` if it no longer exists.
+     */
+    static ConnectionPtr to_connection(
+            const ConnectionHandlePtr& handle)
+    {
+        return std::static_pointer_cast<Connection>(handle.lock());
+    }
+
+    /**
+     * @brief Get the kind of *WebSocket* frames the messages must be sent in,
+     *        depending on whether the encoding is binary or not.
+     *
+     * @param[in] encoding The encoding of the messages.
+     */
+    static OpCode frame_opcode(
+            const Encoding& encoding)
+    {
+        return encoding.binary() ?
+               websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+    }
+
+    /**
+     * @brief Get the encoding requested by a client while opening a connection, either as
+     *        the *WebSocket* subprotocol selected during the handshake or, failing that,
+     *        as the `encoding` query parameter of the requested resource.
+     *
+     * @param[in] connection The server side connection.
+     *
+     * @returns The lowercase name of the requested encoding, or an empty string if none was requested.
+     */
+    static std::string requested_encoding(
+            const ConnectionPtr& connection)
+    {
+        std::string name = connection->get_subprotocol();
+
+        if (name.empty())
+        {
+            const std::string& resource = connection->get_resource();
+            std::size_t begin = resource.find('?');
+            while (begin != std::string::npos)
+            {
+                ++begin;
+                const std::size_t end = resource.find('&', begin);
+                const std::string parameter = resource.substr(begin, end - begin);
+                if (parameter.compare(0, EncodingQueryKey.size() + 1, EncodingQueryKey + "=") == 0)
+                {
+                    name = parameter.substr(EncodingQueryKey.size() + 1);
+                    break;
+                }
+                begin = end;
+            }
+        }
+
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        return name;
+    }
+
+    /**
+     * @brief Load the outbound queue configuration, if any.
+     *        Without it, messages are handed straight to *websocketpp*,
+     *        whose send queues are unbounded.
+     *
+     * @param[in] configuration The configuration of the *WebSocket* Endpoint.
+     *
+     * @returns `true` if the configuration is valid, `false` otherwise.
+     */
+    bool configure_outbound_queue(
+            const YAML::Node& configuration)
+    {
+        const YAML::Node queue_node = configuration[YamlOutboundQueueKey];
+        if (!queue_node)
+        {
+            return true;
+        }
+
+        OutboundQueue::Config config;
+        if (!OutboundQueue::load_config(queue_node, config))
+        {
+            return false;
+        }
+
+        _logger << utils::Logger::Level::DEBUG
+                << "Using outbound queues of up to " << config.max_messages << " messages and "
+                << config.max_bytes << " bytes per connection, lagging from "
+                << config.high_water_bytes << " buffered bytes" << std::endl;
+
+        _queue_config = std::make_unique<OutboundQueue::Config>(config);
+
+        return true;
+    }
+
+    /**
+     * @brief Inherited from Endpoint.
+     */
+    ErrorCode send(
+            const std::shared_ptr<void>& connection_handle,
+            const std::string& payload) override final
+    {
+        Connection* connection = to_connection(connection_handle);
+
+        const OpCode opcode = frame_opcode(get_encoding(connection_handle));
+
+        if (!_queue_config)
+        {
+            return connection->send(payload, opcode);
+        }
+
+        return deliver(connection_handle, std::string(),
+                       accepts_shared_frames(*connection) ?
+                       make_shared_frame(payload, opcode) : make_message(payload, opcode));
+    }
+
+    /**
+     * @brief Inherited from Endpoint.
+     */
+    void fan_out(
+            const std::string& topic,
+            const std::vector<std::shared_ptr<void> >& connections,
+            const std::string& payload,
+            const Encoding& encoding) override final
+    {
+        // Server connections share a single prepared frame, which is built the first
+        // time it is needed. Client connections mask their frames, so they cannot,
+        // and neither can server connections using the framing of the hybi-00 draft.
+        MessagePtr frame;
+        const OpCode opcode = frame_opcode(encoding);
+
+        for (const std::shared_ptr<void>& connection_handle : connections)
+        {
+            Connection* connection = to_connection(connection_handle);
+            ErrorCode ec;
+
+            if (accepts_shared_frames(*connection))
+            {
+                if (!frame)
+                {
+                    frame = make_shared_frame(payload, opcode);
+                }
+
+                ec = _queue_config ? deliver(connection_handle, topic, frame) : connection->send(frame);
+            }
+            else
+            {
+                ec = _queue_config ?
+                        deliver(connection_handle, topic, make_message(payload, opcode)) :
+                        connection->send(payload, opcode);
+            }
+
+            if (ec)
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "Failed to send publication on topic '" << topic
+                        << "', error: " << ec.message() << std::endl;
+            }
+            else
+            {
+                IS_WEBSOCKET_LOG(_logger, TRACE)
+                    << "Sent publication on topic '" << topic << "': [[ "
+                    << payload << " ]]" << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Inherited from Endpoint.
+     */
+    void fan_out_fragments(
+            const std::string& topic,
+            const std::vector<std::shared_ptr<void> >& connections,
+            const std::vector<std::string>& fragments,
+            const Encoding& encoding) override final
+    {
+        // As in fan_out, server connections share the same prepared frames.
+        std::vector<MessagePtr> frames;
+        const OpCode opcode = frame_opcode(encoding);
+
+        for (const std::shared_ptr<void>& connection_handle : connections)
+        {
+            Connection* connection = to_connection(connection_handle);
+
+            {
+                std::lock_guard<std::mutex> lock(_fragments_mutex);
+
+                FragmentStream& stream = _fragment_streams[connection];
+                stream.connection_handle = connection_handle;
+
+                if (accepts_shared_frames(*connection))
+                {
+                    if (frames.empty())
+                    {
+                        frames.reserve(fragments.size());
+                        for (const std::string& fragment : fragments)
+                        {
+                            frames.push_back(make_shared_frame(fragment, opcode));
+                        }
+                    }
+
+                    stream.pending.insert(stream.pending.end(), frames.begin(), frames.end());
+                }
+                else
+                {
+                    for (const std::string& fragment : fragments)
+                    {
+                        stream.pending.push_back(make_message(fragment, opcode));
+                    }
+                }
+            }
+
+            IS_WEBSOCKET_LOG(_logger, INFO)
+                << "Sending publication on topic '" << topic << "' split into "
+                << fragments.size() << " fragments" << std::endl;
+
+            pump_fragments(connection_handle);
+        }
+    }
+
+    /**
+     * @brief Inherited from Endpoint.
+     */
+    void schedule(
+            const std::shared_ptr<void>& connection_handle,
+            std::chrono::milliseconds delay,
+            std::function<void()> callback) override final
+    {
+        to_connection(connection_handle)->set_timer(
+            static_cast<long>(delay.count()),
+            [connection_handle, callback](const ErrorCode& ec)
+            {
+                // The timers of a connection are cancelled when it closes.
+                if (!ec)
+                {
+                    callback();
+                }
+            });
+    }
+
+    /**
+     * @brief Notify when a connection has been opened.
+     *        Server connections use the encoding requested by the client, if it is accepted.
+     *        All the startup messages will be sent through it.
+     *
+     * @param[in] connection The connection that has been opened.
+     */
+    void notify_connection_opened(
+            const ConnectionPtr& connection)
+    {
+        _logger << utils::Logger::Level::DEBUG
+                << TransportName << " connection " << connection << " opened" << std::endl;
+
+        if (connection->is_server())
+        {
+            set_connection_encoding(connection, requested_encoding(connection));
+        }
+
+        const OpCode opcode = frame_opcode(get_encoding(connection));
+        for (const std::string& msg : startup_messages(connection))
+        {
+            connection->send(msg, opcode);
+        }
+    }
+
+    /**
+     * @brief Notify when a connection has been closed.
+     *        Its outbound queue and pending fragments, if any, will be discarded.
+     *
+     * @param[in] connection The connection that has been closed.
+     */
+    void notify_connection_closed(
+            const ConnectionPtr& connection)
+    {
+        // The connection stops being a listener first, so that no
+        // publication can create its outbound queue again.
+        Endpoint::notify_connection_closed(connection);
+
+        {
+            std::lock_guard<std::mutex> lock(_fragments_mutex);
+            _fragment_streams.erase(connection.get());
+        }
+
+        if (_queue_config)
+        {
+            std::lock_guard<std::mutex> lock(_queues_mutex);
+            _queues.erase(connection.get());
+        }
+    }
+
+    /**
+     * @brief Hand the queued messages and the pending fragments
+     *        to the connections that are no longer lagging.
+     *        Timers of the connections do so as well; this call resumes
+     *        them if they were cancelled, and discards the closed connections.
+     */
+    void flush_outbound_queues()
+    {
+        std::vector<std::shared_ptr<void> > fragmenting;
+        {
+            std::lock_guard<std::mutex> lock(_fragments_mutex);
+            fragmenting.reserve(_fragment_streams.size());
+            for (const auto& entry : _fragment_streams)
+            {
+                fragmenting.push_back(entry.second.connection_handle);
+            }
+        }
+
+        for (const std::shared_ptr<void>& connection_handle : fragmenting)
+        {
+            pump_fragments(connection_handle);
+        }
+
+        if (!_queue_config)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_queues_mutex);
+            for (auto it = _queues.begin(); it != _queues.end();)
+            {
+                Connection* connection = it->first;
+                if (connection->get_state() == websocketpp::session::state::closed)
+                {
+                    it = _queues.erase(it);
+                    continue;
+                }
+
+                drain_queue(it->second.connection_handle);
+                ++it;
+            }
+        }
+
+        report_outbound_queue_stats();
+    }
+
+    /**
+     * @brief Getter method for the slow consumer policy counters.
+     */
+    const OutboundQueueStats& outbound_queue_stats() const
+    {
+        return _queue_stats;
+    }
+
+private:
+
+    /**
+     * @brief Send a message through a connection using its outbound queue.
+     *        While the connection keeps up, the message is handed straight to it.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @param[in] topic The topic of the publication, or an empty string
+     *            if the message is not a publication.
+     *
+     * @param[in] message The message to send.
+     *
+     * @returns The error code of the send operation.
+     */
+    ErrorCode deliver(
+            const std::shared_ptr<void>& connection_handle,
+            const std::string& topic,
+            MessagePtr message)
+    {
+        Connection* connection = to_connection(connection_handle);
+
+        if (connection->get_state() != websocketpp::session::state::open)
+        {
+            return connection->send(message);
+        }
+
+        std::lock_guard<std::mutex> lock(_queues_mutex);
+
+        auto it = _queues.find(connection);
+        if (it != _queues.end() && it->second.closing)
+        {
+            // Nothing else is sent to a connection closed for being a slow consumer.
+            return ErrorCode();
+        }
+
+        const std::size_t buffered_amount = connection->get_buffered_amount();
+        const bool lagging = (it != _queues.end() && !it->second.queue.empty())
+                || buffered_amount >= _queue_config->high_water_bytes;
+
+        if (!lagging)
+        {
+            return connection->send(message);
+        }
+
+        if (it == _queues.end())
+        {
+            it = _queues.emplace(
+                connection,
+                QueueEntry{connection_handle, OutboundQueue(*_queue_config, _queue_stats)}).first;
+        }
+
+        OutboundQueue& queue = it->second.queue;
+        if (!queue.push(topic, std::move(message), buffered_amount))
+        {
+            _logger << utils::Logger::Level::WARN
+                    << "Closing " << TransportName << " connection " << connection
+                    << " because it cannot keep up with the outgoing messages" << std::endl;
+
+            // The caller may hold the lock of the Endpoint as well, so the connection is
+            // closed from its own thread once the locks are released. Meanwhile, the entry
+            // is kept so that nothing else is queued for it.
+            it->second.closing = true;
+            connection->set_timer(
+                0,
+                [this, connection_handle](const ErrorCode& timer_ec)
+                {
+                    if (!timer_ec)
+                    {
+                        ErrorCode ec;
+                        to_connection(connection_handle)->close(
+                            websocketpp::close::status::try_again_later, "slow consumer", ec);
+                    }
+                });
+            return ErrorCode();
+        }
+
+        return drain_queue(connection_handle);
+    }
+
+    /**
+     * @brief Hand the queued messages of a connection to it while it is not lagging.
+     *        The queues mutex must be locked.
+     *
+     * @details While messages remain, a timer of the connection keeps draining them,
+     *          as pump_fragments() does with the pending fragments, so that a connection
+     *          that catches up does not wait for the spinning thread.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     *
+     * @returns The error code of the last send operation.
+     */
+    ErrorCode drain_queue(
+            const std::shared_ptr<void>& connection_handle)
+    {
+        Connection* connection = to_connection(connection_handle);
+
+        auto it = _queues.find(connection);
+        if (it == _queues.end() || it->second.closing)
+        {
+            return ErrorCode();
+        }
+
+        ErrorCode ec;
+        it->second.queue.flush(
+            connection->get_buffered_amount(),
+            [connection, &ec](const MessagePtr& queued)
+            {
+                ec = connection->send(queued);
+            });
+
+        if (!it->second.queue.empty() && !it->second.timer_armed)
+        {
+            it->second.timer_armed = true;
+            connection->set_timer(
+                QueueDrainPeriodMs,
+                [this, connection_handle](const ErrorCode& timer_ec)
+                {
+                    std::lock_guard<std::mutex> timer_lock(_queues_mutex);
+                    auto timer_it = _queues.find(to_connection(connection_handle));
+                    if (timer_it == _queues.end())
+                    {
+                        return;
+                    }
+                    timer_it->second.timer_armed = false;
+
+                    // If the timer was cancelled, the spinning thread will resume draining.
+                    if (!timer_ec
+                            && to_connection(connection_handle)->get_state() == websocketpp::session::state::open)
+                    {
+                        drain_queue(connection_handle);
+                    }
+                });
+        }
+
+        return ec;
+    }
+
+    /**
+     * @brief Hand the pending fragments of a publication to a connection, one at a time.
+     *
+     * @details The next fragment is only handed over once the connection has written most
+     *          of the previous one, so that the messages sent meanwhile through the same
+     *          connection are not stuck behind the whole publication. While fragments
+     *          remain, a timer of the connection keeps pumping them.
+     *
+     * @param[in] connection_handle Opaque pointer which identifies the connection.
+     */
+    void pump_fragments(
+            const std::shared_ptr<void>& connection_handle)
+    {
+        Connection* connection = to_connection(connection_handle);
+
+        std::lock_guard<std::mutex> lock(_fragments_mutex);
+
+        auto it = _fragment_streams.find(connection);
+        if (it == _fragment_streams.end())
+        {
+            return;
+        }
+
+        if (connection->get_state() != websocketpp::session::state::open)
+        {
+            _fragment_streams.erase(it);
+            return;
+        }
+
+        FragmentStream& stream = it->second;
+        while (!stream.pending.empty()
+                && connection->get_buffered_amount() < stream.pending.front()->get_payload().size())
+        {
+            // Fragments are not publications, so outbound queues never drop them.
+            const ErrorCode ec = _queue_config ?
+                    deliver(connection_handle, std::string(), stream.pending.front()) :
+                    connection->send(stream.pending.front());
+
+            if (ec)
+            {
+                _logger << utils::Logger::Level::ERROR
+                        << "Failed to send fragment through " << TransportName << " connection "
+                        << connection << ", error: " << ec.message() << std::endl;
+
+                _fragment_streams.erase(it);
+                return;
+            }
+
+            stream.pending.pop_front();
+        }
+
+        if (stream.pending.empty())
+        {
+            _fragment_streams.erase(it);
+            return;
+        }
+
+        if (!stream.timer_armed)
+        {
+            stream.timer_armed = true;
+            connection->set_timer(
+                FragmentPumpPeriodMs,
+                [this, connection_handle](const ErrorCode& ec)
+                {
+                    {
+                        std::lock_guard<std::mutex> timer_lock(_fragments_mutex);
+                        auto timer_it = _fragment_streams.find(to_connection(connection_handle));
+                        if (timer_it != _fragment_streams.end())
+                        {
+                            timer_it->second.timer_armed = false;
+                        }
+                    }
+
+                    // If the timer was cancelled, the spinning thread will resume pumping.
+                    if (!ec)
+                    {
+                        pump_fragments(connection_handle);
+                    }
+                });
+        }
+    }
+
+    /**
+     * @brief Log the slow consumer policy counters, if they changed since the last report.
+     */
+    void report_outbound_queue_stats()
+    {
+        const uint64_t queued = _queue_stats.queued;
+        const uint64_t dropped_oldest = _queue_stats.dropped_oldest;
+        const uint64_t dropped_newest = _queue_stats.dropped_newest;
+        const uint64_t conflated = _queue_stats.conflated;
+        const uint64_t disconnected = _queue_stats.disconnected;
+
+        // Queuing alone is not worth a report, only the actions taken by the policy are.
+        const uint64_t total = dropped_oldest + dropped_newest + conflated + disconnected;
+        if (total == _last_reported_total)
+        {
+            return;
+        }
+        _last_reported_total = total;
+
+        _logger << utils::Logger::Level::WARN
+                << "Slow consumers: queued " << queued << " messages, dropped " << dropped_oldest
+                << " oldest and " << dropped_newest << " newest publications, conflated "
+                << conflated << " publications and closed " << disconnected
+                << " connections so far" << std::endl;
+    }
+
+    struct QueueEntry
+    {
+        /**
+         * Keeps the connection alive while it has an outbound queue.
+         */
+        std::shared_ptr<void> connection_handle;
+        OutboundQueue queue;
+        bool timer_armed = false;
+
+        /**
+         * Set once the connection is found to be a slow consumer, until it is closed.
+         */
+        bool closing = false;
+    };
+
+    struct FragmentStream
+    {
+        /**
+         * Keeps the connection alive while it has fragments pending.
+         */
+        std::shared_ptr<void> connection_handle;
+        std::deque<MessagePtr> pending;
+        bool timer_armed = false;
+    };
+
+    /**
+     * Period, in milliseconds, at which the pending fragments are pumped.
+     */
+    static constexpr long FragmentPumpPeriodMs = 1;
+
+    /**
+     * Period, in milliseconds, at which the outbound queues of the lagging connections are drained.
+     */
+    static constexpr long QueueDrainPeriodMs = 1;
+
+    std::unique_ptr<OutboundQueue::Config> _queue_config;
+    OutboundQueueStats _queue_stats;
+    std::mutex _queues_mutex;
+    std::unordered_map<Connection*, QueueEntry> _queues;
+    uint64_t _last_reported_total = 0;
+    std::mutex _fragments_mutex;
+    std::unordered_map<Connection*, FragmentStream> _fragment_streams;
+
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__TRANSPORTENDPOINT_HPP_
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__TRANSPORTSELECTOR_HPP_
+#define _WEBSOCKET_IS_SH__SRC__TRANSPORTSELECTOR_HPP_
+
+#include "Endpoint.hpp"
+
+#include <memory>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlSecurityKey = "security";
+const std::string YamlSecurity_None = "none";
+
+/**
+ * @class TransportSelector
+ *        System registered into the *Integration Service* for each kind of *WebSocket* endpoint.
+ *
+ *        Whether TLS or TCP must be used is only known once the *YAML* configuration
+ *        is available, so this class instantiates the endpoint specialization for the
+ *        requested transport during the configuration step and forwards every
+ *        *Integration Service* request to it.
+ *
+ *        Publications, service calls and service responses are delivered straight to the
+ *        selected endpoint, since it is the one creating the publishers and service proxies.
+ *
+ * @tparam EndpointT The endpoint template, which will be instantiated either
+ *         with `TlsConfig` or with `TcpConfig`.
+ */
+template<template<typename> class EndpointT>
+class TransportSelector : public is::FullSystem
+{
+public:
+
+    /**
+     * @brief Inherited from SystemHandle.
+     */
+    bool configure(
+            const core::RequiredTypes& types,
+            const YAML::Node& configuration,
+            TypeRegistry& type_registry) override
+    {
+        const YAML::Node security_node = configuration[YamlSecurityKey];
+        if (security_node && security_node.as<std::string>() == YamlSecurity_None)
+        {
+            _endpoint = std::make_unique<EndpointT<TcpConfig> >();
+        }
+        else
+        {
+            _endpoint = std::make_unique<EndpointT<TlsConfig> >();
+        }
+
+        return _endpoint->configure(types, configuration, type_registry);
+    }
+
+    /**
+     * @brief Inherited from SystemHandle.
+     */
+    bool okay() const override
+    {
+        return _endpoint && _endpoint->okay();
+    }
+
+    /**
+     * @brief Inherited from SystemHandle.
+     */
+    bool spin_once() override
+    {
+        return _endpoint->spin_once();
+    }
+
+    /**
+     * @brief Inherited from TopicSubscriberSystem.
+     */
+    bool subscribe(
+            const std::string& topic_name,
+            const xtypes::DynamicType& message_type,
+            TopicSubscriberSystem::SubscriptionCallback* callback,
+            const YAML::Node& configuration) override
+    {
+        return _endpoint->subscribe(topic_name, message_type, callback, configuration);
+    }
+
+    /**
+     * @brief Inherited from TopicSubscriberSystem.
+     */
+    bool is_internal_message(
+            void* filter_handle) override
+    {
+        return _endpoint->is_internal_message(filter_handle);
+    }
+
+    /**
+     * @brief Inherited from TopicPublisherSystem.
+     */
+    std::shared_ptr<is::TopicPublisher> advertise(
+            const std::string& topic_name,
+            const xtypes::DynamicType& message_type,
+            const YAML::Node& configuration) override
+    {
+        return _endpoint->advertise(topic_name, message_type, configuration);
+    }
+
+    /**
+     * @brief Inherited from ServiceClientSystem.
+     */
+    bool create_client_proxy(
+            const std::string& service_name,
+            const xtypes::DynamicType& service_type,
+            ServiceClientSystem::RequestCallback* callback,
+            const YAML::Node& configuration) override
+    {
+        return _endpoint->create_client_proxy(service_name, service_type, callback, configuration);
+    }
+
+    /**
+     * @brief Inherited from ServiceClientSystem.
+     */
+    bool create_client_proxy(
+            const std::string& service_name,
+            const xtypes::DynamicType& request_type,
+            const xtypes::DynamicType& reply_type,
+            ServiceClientSystem::RequestCallback* callback,
+            const YAML::Node& configuration) override
+    {
+        return _endpoint->create_client_proxy(
+            service_name, request_type, reply_type, callback, configuration);
+    }
+
+    /**
+     * @brief Inherited from ServiceProviderSystem.
+     */
+    std::shared_ptr<is::ServiceProvider> create_service_proxy(
+            const std::string& service_name,
+            const xtypes::DynamicType& service_type,
+            const YAML::Node& configuration) override
+    {
+        return _endpoint->create_service_proxy(service_name, service_type, configuration);
+    }
+
+    /**
+     * @brief Inherited from ServiceProviderSystem.
+     */
+    std::shared_ptr<is::ServiceProvider> create_service_proxy(
+            const std::string& service_name,
+            const xtypes::DynamicType& request_type,
+            const xtypes::DynamicType& reply_type,
+            const YAML::Node& configuration) override
+    {
+        return _endpoint->create_service_proxy(service_name, request_type, reply_type, configuration);
+    }
+
+private:
+
+    std::unique_ptr<Endpoint> _endpoint;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__TRANSPORTSELECTOR_HPP_
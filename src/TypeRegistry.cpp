@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "TypeRegistry.hpp"
+
+#include "Encoding.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+bool TypeRegistry::add_type(
+        const xtypes::DynamicType& type,
+        const std::string& type_name)
+{
+    std::string name = transform_type(type_name.empty() ? type.name() : type_name);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto result = _types.emplace(std::move(name), type);
+    if (result.second)
+    {
+        _compile(*result.first->second.get());
+        _rebind();
+    }
+    return result.second;
+}
+
+//==============================================================================
+const xtypes::DynamicType* TypeRegistry::find_type(
+        const std::string& type_name) const
+{
+    const std::string name = transform_type(type_name);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _types.find(name);
+    return it == _types.end() ? nullptr : it->second.get();
+}
+
+//==============================================================================
+const CodecPlan* TypeRegistry::plan(
+        const xtypes::DynamicType& type) const
+{
+    const std::shared_ptr<const PlanTable> plans = _plans();
+    auto it = plans->find(&type);
+    return it == plans->end() ? nullptr : it->second.get();
+}
+
+//==============================================================================
+void TypeRegistry::register_topic(
+        const std::string& topic_name,
+        const std::string& type_name)
+{
+    {
+        const std::shared_ptr<const TopicTable> topics = _topics();
+        auto it = topics->find(topic_name);
+        if (it != topics->end() && it->second.type_name == type_name)
+        {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto topics = std::make_shared<TopicTable>(*_topic_table);
+    _bind((*topics)[topic_name], type_name);
+    std::atomic_store(&_topic_table, std::shared_ptr<const TopicTable>(std::move(topics)));
+}
+
+//==============================================================================
+const xtypes::DynamicType* TypeRegistry::topic_type(
+        const std::string& topic_name) const
+{
+    const std::shared_ptr<const TopicTable> topics = _topics();
+    auto it = topics->find(topic_name);
+    return it == topics->end() ? nullptr : it->second.type;
+}
+
+//==============================================================================
+std::string TypeRegistry::topic_type_name(
+        const std::string& topic_name) const
+{
+    const std::shared_ptr<const TopicTable> topics = _topics();
+    auto it = topics->find(topic_name);
+    return it == topics->end() ? std::string() : it->second.type_name;
+}
+
+//==============================================================================
+void TypeRegistry::register_service(
+        const std::string& service_name,
+        const std::string& request_type,
+        const std::string& reply_type)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto services = std::make_shared<ServiceTable>(*_service_table);
+    ServiceBinding& binding = (*services)[service_name];
+    _bind(binding.request, request_type);
+    _bind(binding.reply, reply_type);
+    std::atomic_store(&_service_table, std::shared_ptr<const ServiceTable>(std::move(services)));
+}
+
+//==============================================================================
+void TypeRegistry::register_service_type(
+        const std::string& service_name,
+        const std::string& type_name,
+        bool request)
+{
+    {
+        const std::shared_ptr<const ServiceTable> services = _services();
+        auto it = services->find(service_name);
+        if (it != services->end()
+                && (request ? it->second.request : it->second.reply).type_name == type_name)
+        {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto services = std::make_shared<ServiceTable>(*_service_table);
+    ServiceBinding& binding = (*services)[service_name];
+    _bind(request ? binding.request : binding.reply, type_name);
+    std::atomic_store(&_service_table, std::shared_ptr<const ServiceTable>(std::move(services)));
+}
+
+//==============================================================================
+const xtypes::DynamicType* TypeRegistry::service_type(
+        const std::string& service_name,
+        bool request) const
+{
+    const std::shared_ptr<const ServiceTable> services = _services();
+    auto it = services->find(service_name);
+    if (it == services->end())
+    {
+        return nullptr;
+    }
+    return request ? it->second.request.type : it->second.reply.type;
+}
+
+//==============================================================================
+std::string TypeRegistry::service_type_name(
+        const std::string& service_name,
+        bool request) const
+{
+    const std::shared_ptr<const ServiceTable> services = _services();
+    auto it = services->find(service_name);
+    if (it == services->end())
+    {
+        return std::string();
+    }
+    return request ? it->second.request.type_name : it->second.reply.type_name;
+}
+
+//==============================================================================
+void TypeRegistry::_bind(
+        Binding& binding,
+        const std::string& type_name) const
+{
+    binding.type_name = type_name;
+
+    auto it = _types.find(transform_type(type_name));
+    binding.type = it == _types.end() ? nullptr : it->second.get();
+}
+
+//==============================================================================
+void TypeRegistry::_rebind()
+{
+    auto topics = std::make_shared<TopicTable>(*_topic_table);
+    for (auto& topic : *topics)
+    {
+        if (nullptr == topic.second.type)
+        {
+            _bind(topic.second, topic.second.type_name);
+        }
+    }
+    std::atomic_store(&_topic_table, std::shared_ptr<const TopicTable>(std::move(topics)));
+
+    auto services = std::make_shared<ServiceTable>(*_service_table);
+    for (auto& service : *services)
+    {
+        for (Binding* binding : {&service.second.request, &service.second.reply})
+        {
+            if (nullptr == binding->type && !binding->type_name.empty())
+            {
+                _bind(*binding, binding->type_name);
+            }
+        }
+    }
+    std::atomic_store(&_service_table, std::shared_ptr<const ServiceTable>(std::move(services)));
+}
+
+//==============================================================================
+void TypeRegistry::_compile(
+        const xtypes::DynamicType& type)
+{
+    if (_plan_table->count(&type) != 0)
+    {
+        return;
+    }
+
+    // Types that are not structures are recorded too, so that they are not compiled again.
+    const std::shared_ptr<const CodecPlan> compiled = CodecPlan::compile(type);
+
+    auto plans = std::make_shared<PlanTable>(*_plan_table);
+    plans->emplace(&type, compiled);
+    std::atomic_store(&_plan_table, std::shared_ptr<const PlanTable>(std::move(plans)));
+}
+
+//==============================================================================
+std::shared_ptr<const TypeRegistry::TopicTable> TypeRegistry::_topics() const
+{
+    return std::atomic_load(&_topic_table);
+}
+
+//==============================================================================
+std::shared_ptr<const TypeRegistry::ServiceTable> TypeRegistry::_services() const
+{
+    return std::atomic_load(&_service_table);
+}
+
+//==============================================================================
+std::shared_ptr<const TypeRegistry::PlanTable> TypeRegistry::_plans() const
+{
+    return std::atomic_load(&_plan_table);
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
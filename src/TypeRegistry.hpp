@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__TYPEREGISTRY_HPP_
+#define _WEBSOCKET_IS_SH__SRC__TYPEREGISTRY_HPP_
+
+#include "CodecPlan.hpp"
+
+#include <is/core/Message.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace xtypes = eprosima::xtypes;
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class TypeRegistry
+ * @brief Types known by an encoding, and the types of the topics and services it handles.
+ *
+ *        Topics and services are bound to their types when they are registered,
+ *        which happens when they are subscribed to, advertised or first used, so that
+ *        the type of an incoming message is found with a single lookup of its topic
+ *        or service name, without any string manipulation.
+ *
+ *        The codec plan of every structure type is compiled when the type is added.
+ *        Plans are only kept for the added types, which the registry owns, so that a plan
+ *        never outlives its type.
+ *
+ *        The bindings and the plans are kept in immutable tables that are replaced as a whole
+ *        when a binding changes, so looking them up never waits for the registrations,
+ *        which are rare, nor for other lookups.
+ *
+ *        This class is thread safe.
+ */
+class TypeRegistry
+{
+public:
+
+    /**
+     * @brief Add a type.
+     *
+     * @param[in] type The type to be added.
+     *
+     * @param[in] type_name The name of the type, or empty to use the name of `type`.
+     *
+     * @returns `true` if the type was added, or `false` if there was already
+     *          a type with the same name.
+     */
+    bool add_type(
+            const xtypes::DynamicType& type,
+            const std::string& type_name = "");
+
+    /**
+     * @brief Find a type by its name, either as a *WebSocket* peer writes it or
+     *        as transformed by transform_type().
+     *
+     * @returns The type, or `nullptr` if it has not been added.
+     */
+    const xtypes::DynamicType* find_type(
+            const std::string& type_name) const;
+
+    /**
+     * @brief Get the codec plan of a type.
+     *
+     * @param[in] type The type. Types are identified by their address, so only the
+     *            instances held by this registry, as returned by find_type(), topic_type()
+     *            or service_type(), have a plan.
+     *
+     * @returns The plan, or `nullptr` if the type is not a structure or was not added,
+     *          in which case its data must be encoded following the type itself.
+     */
+    const CodecPlan* plan(
+            const xtypes::DynamicType& type) const;
+
+    /**
+     * @brief Bind a topic to a type. Binding it again to the same type name does nothing,
+     *        so it can be called for every message without taking a lock.
+     *
+     * @param[in] topic_name The name of the topic.
+     *
+     * @param[in] type_name The name of the type of the topic. It does not need to be
+     *            added yet, in which case the topic is bound as soon as it is added.
+     */
+    void register_topic(
+            const std::string& topic_name,
+            const std::string& type_name);
+
+    /**
+     * @returns The type of a topic, or `nullptr` if the topic is not registered
+     *          or its type has not been added.
+     */
+    const xtypes::DynamicType* topic_type(
+            const std::string& topic_name) const;
+
+    /**
+     * @returns The name of the type of a topic, as it was registered,
+     *          or an empty string if the topic is not registered.
+     */
+    std::string topic_type_name(
+            const std::string& topic_name) const;
+
+    /**
+     * @brief Bind both the request and the reply of a service to their types.
+     */
+    void register_service(
+            const std::string& service_name,
+            const std::string& request_type,
+            const std::string& reply_type);
+
+    /**
+     * @brief Bind the request, or the reply, of a service to a type, keeping the other one.
+     *        Binding it again to the same type name does nothing, without taking a lock.
+     */
+    void register_service_type(
+            const std::string& service_name,
+            const std::string& type_name,
+            bool request);
+
+    /**
+     * @returns The type of the request, or of the reply, of a service, or `nullptr`
+     *          if it is not registered or its type has not been added.
+     */
+    const xtypes::DynamicType* service_type(
+            const std::string& service_name,
+            bool request) const;
+
+    /**
+     * @returns The name of the type of the request, or of the reply, of a service,
+     *          as it was registered, or an empty string if it is not registered.
+     */
+    std::string service_type_name(
+            const std::string& service_name,
+            bool request) const;
+
+private:
+
+    struct Binding
+    {
+        /**
+         * The name of the type as registered, to detect cheaply whether it changes.
+         */
+        std::string type_name;
+
+        /**
+         * The type, or `nullptr` while no type with that name has been added.
+         */
+        const xtypes::DynamicType* type = nullptr;
+    };
+
+    struct ServiceBinding
+    {
+        Binding request;
+        Binding reply;
+    };
+
+    using TopicTable = std::unordered_map<std::string, Binding>;
+    using ServiceTable = std::unordered_map<std::string, ServiceBinding>;
+    using PlanTable = std::unordered_map<const xtypes::DynamicType*, std::shared_ptr<const CodecPlan>>;
+
+    /**
+     * @brief Fill a binding, resolving its type if it has already been added.
+     *        The mutex must be held.
+     */
+    void _bind(
+            Binding& binding,
+            const std::string& type_name) const;
+
+    /**
+     * @brief Resolve the bindings whose type was missing, after a type was added.
+     *        The mutex must be held.
+     */
+    void _rebind();
+
+    /**
+     * @brief Compile the plan of a type, unless it is already compiled.
+     *        The mutex must be held.
+     */
+    void _compile(
+            const xtypes::DynamicType& type);
+
+    std::shared_ptr<const TopicTable> _topics() const;
+
+    std::shared_ptr<const ServiceTable> _services() const;
+
+    std::shared_ptr<const PlanTable> _plans() const;
+
+    /**
+     * Held by the writers of every table. Lookups of the topic, service and plan tables
+     * do not take it: they load the current table atomically.
+     */
+    mutable std::mutex _mutex;
+
+    std::map<std::string, xtypes::DynamicType::Ptr> _types;
+
+    std::shared_ptr<const TopicTable> _topic_table = std::make_shared<const TopicTable>();
+    std::shared_ptr<const ServiceTable> _service_table = std::make_shared<const ServiceTable>();
+    std::shared_ptr<const PlanTable> _plan_table = std::make_shared<const PlanTable>();
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__TYPEREGISTRY_HPP_
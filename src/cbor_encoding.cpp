@@ -0,0 +1,1442 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Cbor.hpp"
+#include "DataPool.hpp"
+#include "Encoding.hpp"
+#include "Endpoint.hpp"
+#include "FragmentBuffer.hpp"
+#include "TypeRegistry.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+static utils::Logger logger("is::sh::WebSocket::CborEncoding");
+
+//==============================================================================
+// message fields, the same ones used by the JSON encoding
+const std::string CborOpKey = "op";
+const std::string CborIdKey = "id";
+const std::string CborTopicNameKey = "topic";
+const std::string CborTypeNameKey = "type";
+const std::string CborRequestTypeNameKey = "request_type";
+const std::string CborReplyTypeNameKey = "reply_type";
+const std::string CborMsgKey = "msg";
+const std::string CborServiceKey = "service";
+const std::string CborArgsKey = "args";
+const std::string CborValuesKey = "values";
+const std::string CborResultKey = "result";
+const std::string CborThrottleRateKey = "throttle_rate";
+const std::string CborQueueLengthKey = "queue_length";
+const std::string CborFragmentSizeKey = "fragment_size";
+const std::string CborDataKey = "data";
+const std::string CborNumKey = "num";
+const std::string CborTotalKey = "total";
+
+// op codes
+const std::string CborOpAdvertiseTopicKey = "advertise";
+const std::string CborOpUnadvertiseTopicKey = "unadvertise";
+const std::string CborOpPublishKey = "publish";
+const std::string CborOpSubscribeKey = "subscribe";
+const std::string CborOpUnsubscribeKey = "unsubscribe";
+const std::string CborOpServiceRequestKey = "call_service";
+const std::string CborOpAdvertiseServiceKey = "advertise_service";
+const std::string CborOpUnadvertiseServiceKey = "unadvertise_service";
+const std::string CborOpServiceResponseKey = "service_response";
+const std::string CborOpFragmentKey = "fragment";
+
+//==============================================================================
+static const xtypes::DynamicType& resolve_alias(
+        const xtypes::DynamicType& type)
+{
+    if (type.kind() == xtypes::TypeKind::ALIAS_TYPE)
+    {
+        return static_cast<const xtypes::AliasType&>(type).rget();
+    }
+    return type;
+}
+
+//==============================================================================
+template<typename T>
+static T read_integer(
+        CborReader& reader)
+{
+    if (std::is_signed<T>::value)
+    {
+        const int64_t value = reader.read_int();
+        if (value < static_cast<int64_t>(std::numeric_limits<T>::min())
+                || value > static_cast<int64_t>(std::numeric_limits<T>::max()))
+        {
+            throw CborError("integer " + std::to_string(value) + " out of range");
+        }
+        return static_cast<T>(value);
+    }
+
+    const uint64_t value = reader.read_uint();
+    if (value > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+    {
+        throw CborError("integer " + std::to_string(value) + " out of range");
+    }
+    return static_cast<T>(value);
+}
+
+static void write_data(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data);
+
+static void read_data(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef data);
+
+static void write_data(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan& plan);
+
+static void read_data(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef data,
+        const CodecPlan& plan);
+
+//==============================================================================
+template<typename T>
+static void write_typed_array(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data)
+{
+    const std::vector<T> values = data.as_vector<T>();
+    writer.write_typed_array(values.data(), values.size());
+}
+
+//==============================================================================
+/**
+ * @brief Write an array or sequence whose elements are numbers or characters.
+ *        They are packed, instead of writing each element as a separate item.
+ *
+ * @returns `false`, without writing anything, if the elements are of any other kind.
+ */
+static bool write_number_collection(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        xtypes::TypeKind element_kind)
+{
+    switch (element_kind)
+    {
+        case xtypes::TypeKind::CHAR_8_TYPE:
+        {
+            const std::vector<char> values = data.as_vector<char>();
+            writer.write_bytes(values.data(), values.size());
+            return true;
+        }
+        case xtypes::TypeKind::UINT_8_TYPE:
+        {
+            const std::vector<uint8_t> values = data.as_vector<uint8_t>();
+            writer.write_bytes(values.data(), values.size());
+            return true;
+        }
+        case xtypes::TypeKind::INT_8_TYPE:
+            write_typed_array<int8_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::INT_16_TYPE:
+            write_typed_array<int16_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            write_typed_array<uint16_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::INT_32_TYPE:
+            write_typed_array<int32_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            write_typed_array<uint32_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::INT_64_TYPE:
+            write_typed_array<int64_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            write_typed_array<uint64_t>(writer, data);
+            return true;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            write_typed_array<float>(writer, data);
+            return true;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            write_typed_array<double>(writer, data);
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Write an array or sequence of complex elements.
+ *
+ * @param[in] plan The plan of the elements, if they are structures, or `nullptr`
+ *            to encode them following their type.
+ */
+static void write_element_collection(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan* plan)
+{
+    const std::size_t size = data.size();
+    writer.begin_array(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (nullptr != plan)
+        {
+            write_data(writer, data[i], *plan);
+        }
+        else
+        {
+            write_data(writer, data[i]);
+        }
+    }
+}
+
+//==============================================================================
+static void write_collection(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const xtypes::DynamicType& type)
+{
+    const xtypes::DynamicType& content =
+            resolve_alias(static_cast<const xtypes::CollectionType&>(type).content_type());
+
+    if (!write_number_collection(writer, data, content.kind()))
+    {
+        write_element_collection(writer, data, nullptr);
+    }
+}
+
+//==============================================================================
+static void write_data(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            writer.write_bool(data.value<bool>());
+            break;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+        {
+            const char value = data.value<char>();
+            writer.write_text(&value, 1);
+            break;
+        }
+        case xtypes::TypeKind::INT_8_TYPE:
+            writer.write_int(data.value<int8_t>());
+            break;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            writer.write_uint(data.value<uint8_t>());
+            break;
+        case xtypes::TypeKind::INT_16_TYPE:
+            writer.write_int(data.value<int16_t>());
+            break;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            writer.write_uint(data.value<uint16_t>());
+            break;
+        case xtypes::TypeKind::INT_32_TYPE:
+            writer.write_int(data.value<int32_t>());
+            break;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            writer.write_uint(data.value<uint32_t>());
+            break;
+        case xtypes::TypeKind::INT_64_TYPE:
+            writer.write_int(data.value<int64_t>());
+            break;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            writer.write_uint(data.value<uint64_t>());
+            break;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            writer.write_float(data.value<float>());
+            break;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            writer.write_double(data.value<double>());
+            break;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            writer.write_double(static_cast<double>(data.value<long double>()));
+            break;
+        case xtypes::TypeKind::STRING_TYPE:
+            writer.write_text(data.value<std::string>());
+            break;
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            writer.write_uint(data.value<uint32_t>());
+            break;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            write_collection(writer, data, type);
+            break;
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& structure = static_cast<const xtypes::StructType&>(type);
+            writer.begin_map(structure.members().size());
+            for (const xtypes::Member& member : structure.members())
+            {
+                writer.write_text(member.name());
+                write_data(writer, data[member.name()]);
+            }
+            break;
+        }
+        default:
+            throw CborError("type '" + type.name() + "' is not supported");
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Resize a sequence, or check the size of an array, before reading its elements.
+ */
+static void prepare_collection(
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds,
+        std::size_t size)
+{
+    if (kind == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        if (bounds > 0 && size > bounds)
+        {
+            throw CborError("sequence of " + std::to_string(size)
+                          + " elements exceeds its bound of " + std::to_string(bounds));
+        }
+        data.resize(size);
+    }
+    else if (size != data.size())
+    {
+        throw CborError("array of " + std::to_string(size) + " elements, expected "
+                      + std::to_string(data.size()));
+    }
+}
+
+//==============================================================================
+template<typename T, typename Stored = T>
+static void read_typed_array(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds)
+{
+    std::vector<T> values;
+    reader.read_numbers(values);
+
+    prepare_collection(data, kind, bounds, values.size());
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        data[i].value(static_cast<Stored>(values[i]));
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read an array or sequence whose elements are numbers or characters.
+ *
+ * @returns `false`, without reading anything, if the elements are of any other kind.
+ */
+static bool read_number_collection(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds,
+        xtypes::TypeKind element_kind)
+{
+    switch (element_kind)
+    {
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            read_typed_array<uint8_t, char>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            read_typed_array<uint8_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_8_TYPE:
+            read_typed_array<int8_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_16_TYPE:
+            read_typed_array<int16_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            read_typed_array<uint16_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_32_TYPE:
+            read_typed_array<int32_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            read_typed_array<uint32_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::INT_64_TYPE:
+            read_typed_array<int64_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            read_typed_array<uint64_t>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            read_typed_array<float>(reader, data, kind, bounds);
+            return true;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            read_typed_array<double>(reader, data, kind, bounds);
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read an array or sequence of complex elements.
+ *
+ * @param[in] plan The plan of the elements, if they are structures, or `nullptr`
+ *            to decode them following their type.
+ */
+static void read_element_collection(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        xtypes::TypeKind kind,
+        std::size_t bounds,
+        const CodecPlan* plan)
+{
+    const std::size_t size = reader.read_array_header();
+    prepare_collection(data, kind, bounds, size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (nullptr != plan)
+        {
+            read_data(reader, data[i], *plan);
+        }
+        else
+        {
+            read_data(reader, data[i]);
+        }
+    }
+}
+
+//==============================================================================
+static void read_collection(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        const xtypes::DynamicType& type)
+{
+    const xtypes::DynamicType& content =
+            resolve_alias(static_cast<const xtypes::CollectionType&>(type).content_type());
+    const std::size_t bounds = type.kind() == xtypes::TypeKind::SEQUENCE_TYPE ?
+            static_cast<const xtypes::SequenceType&>(type).bounds() : 0;
+
+    if (!read_number_collection(reader, data, type.kind(), bounds, content.kind()))
+    {
+        read_element_collection(reader, data, type.kind(), bounds, nullptr);
+    }
+}
+
+//==============================================================================
+static void read_data(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef data)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            data.value(reader.read_bool());
+            break;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+        {
+            const std::string value = reader.read_text();
+            if (value.size() != 1)
+            {
+                throw CborError("expected a single character, got '" + value + "'");
+            }
+            data.value(value[0]);
+            break;
+        }
+        case xtypes::TypeKind::INT_8_TYPE:
+            data.value(read_integer<int8_t>(reader));
+            break;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            data.value(read_integer<uint8_t>(reader));
+            break;
+        case xtypes::TypeKind::INT_16_TYPE:
+            data.value(read_integer<int16_t>(reader));
+            break;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            data.value(read_integer<uint16_t>(reader));
+            break;
+        case xtypes::TypeKind::INT_32_TYPE:
+            data.value(read_integer<int32_t>(reader));
+            break;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            data.value(read_integer<uint32_t>(reader));
+            break;
+        case xtypes::TypeKind::INT_64_TYPE:
+            data.value(read_integer<int64_t>(reader));
+            break;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            data.value(read_integer<uint64_t>(reader));
+            break;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            data.value(static_cast<float>(reader.read_double()));
+            break;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            data.value(reader.read_double());
+            break;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            data.value(static_cast<long double>(reader.read_double()));
+            break;
+        case xtypes::TypeKind::STRING_TYPE:
+            data.value(reader.read_text());
+            break;
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            data.value(read_integer<uint32_t>(reader));
+            break;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            read_collection(reader, data, type);
+            break;
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            // Members missing from the message keep their default value,
+            // and unknown ones are ignored.
+            const xtypes::StructType& structure = static_cast<const xtypes::StructType&>(type);
+            const std::size_t size = reader.read_map_header();
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const std::string name = reader.read_text();
+                if (structure.has_member(name))
+                {
+                    read_data(reader, data[name]);
+                }
+                else
+                {
+                    reader.skip();
+                }
+            }
+            break;
+        }
+        default:
+            throw CborError("type '" + type.name() + "' is not supported");
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Write a structure following its plan. Members that are neither structures
+ *        nor collections are written following their type, which only costs resolving
+ *        their alias.
+ */
+static void write_data(
+        CborWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan& plan)
+{
+    writer.begin_map(plan.fields().size());
+    for (const CodecField& field : plan.fields())
+    {
+        writer.write_text(field.name);
+        const xtypes::ReadableDynamicDataRef member = data[field.index];
+        switch (field.kind)
+        {
+            case xtypes::TypeKind::STRUCTURE_TYPE:
+                write_data(writer, member, *field.plan);
+                break;
+            case xtypes::TypeKind::ARRAY_TYPE:
+            case xtypes::TypeKind::SEQUENCE_TYPE:
+                if (!write_number_collection(writer, member, field.element_kind))
+                {
+                    write_element_collection(writer, member, field.plan);
+                }
+                break;
+            default:
+                write_data(writer, member);
+                break;
+        }
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Read a structure following its plan. Members missing from the message keep
+ *        their default value, and unknown ones are ignored.
+ */
+static void read_data(
+        CborReader& reader,
+        xtypes::WritableDynamicDataRef data,
+        const CodecPlan& plan)
+{
+    const std::size_t size = reader.read_map_header();
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const CodecField* field = plan.find(reader.read_text(), next);
+        if (nullptr == field)
+        {
+            reader.skip();
+            continue;
+        }
+
+        xtypes::WritableDynamicDataRef member = data[field->index];
+        switch (field->kind)
+        {
+            case xtypes::TypeKind::STRUCTURE_TYPE:
+                read_data(reader, member, *field->plan);
+                break;
+            case xtypes::TypeKind::ARRAY_TYPE:
+            case xtypes::TypeKind::SEQUENCE_TYPE:
+                if (!read_number_collection(reader, member, field->kind, field->bounds, field->element_kind))
+                {
+                    read_element_collection(reader, member, field->kind, field->bounds, field->plan);
+                }
+                break;
+            default:
+                read_data(reader, member);
+                break;
+        }
+        next = field->index + 1;
+    }
+}
+
+//==============================================================================
+/**
+ * @class CborMessage
+ *        Top level map of an incoming *CBOR* message.
+ *
+ *        The message is indexed once, recording where the value of each field starts,
+ *        so that the fields can be read in any order. This allows to decode the
+ *        message data straight into its type, even if the field telling which type it is,
+ *        such as the topic, comes after the data.
+ */
+class CborMessage
+{
+public:
+
+    CborMessage(
+            const std::string& raw)
+        : raw_(raw)
+    {
+        CborReader reader(raw_.data(), raw_.size());
+        const std::size_t size = reader.read_map_header();
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            std::string key = reader.read_text();
+            fields_[std::move(key)] = reader.position();
+            reader.skip();
+        }
+    }
+
+    bool has(
+            const std::string& key) const
+    {
+        return fields_.count(key) > 0;
+    }
+
+    /**
+     * @brief Get a reader positioned at the value of a field, which must exist.
+     */
+    CborReader at(
+            const std::string& key) const
+    {
+        return CborReader(raw_.data(), raw_.size(), fields_.at(key));
+    }
+
+    std::string get_optional_string(
+            const std::string& key) const
+    {
+        if (!has(key))
+        {
+            return std::string();
+        }
+
+        CborReader reader = at(key);
+        switch (reader.peek_type())
+        {
+            case CborType::TEXT:
+                return reader.read_text();
+            case CborType::UNSIGNED:
+            case CborType::NEGATIVE:
+                return std::to_string(reader.read_int());
+            default:
+                throw CborError("field '" + key + "' is not a string");
+        }
+    }
+
+    std::string get_required_string(
+            const std::string& key) const
+    {
+        if (!has(key))
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Incoming WebSocket message with op code '" << get_optional_string(CborOpKey)
+                   << "' is missing the required field '" << key << "'" << std::endl;
+
+            return std::string();
+        }
+
+        return get_optional_string(key);
+    }
+
+    uint32_t get_optional_uint(
+            const std::string& key) const
+    {
+        if (!has(key) || at(key).is_null())
+        {
+            return 0;
+        }
+
+        CborReader reader = at(key);
+        if (reader.peek_type() != CborType::UNSIGNED)
+        {
+            logger << utils::Logger::Level::WARN
+                   << "Ignoring the field '" << key << "' of the incoming WebSocket message, "
+                   << "since it is not a non-negative integer" << std::endl;
+
+            return 0;
+        }
+
+        return static_cast<uint32_t>(std::min<uint64_t>(
+                   reader.read_uint(), std::numeric_limits<uint32_t>::max()));
+    }
+
+    /**
+     * @brief Decode the data of a field into a dynamic data instance.
+     *
+     * @param[in] plan The plan of the type of the data, or `nullptr` if it has none.
+     *
+     * @returns `true` if the data was decoded, `false` otherwise.
+     */
+    bool get_required_data(
+            const std::string& key,
+            xtypes::DynamicData& data,
+            const CodecPlan* plan) const
+    {
+        if (!has(key))
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Incoming WebSocket message with op code '" << get_optional_string(CborOpKey)
+                   << "' is missing the required field '" << key << "'" << std::endl;
+
+            return false;
+        }
+
+        try
+        {
+            CborReader reader = at(key);
+            if (nullptr != plan)
+            {
+                read_data(reader, data, *plan);
+            }
+            else
+            {
+                read_data(reader, data);
+            }
+            return true;
+        }
+        catch (const CborError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to decode the field '" << key << "' as type '"
+                   << data.type().name() << "', reason: [[ " << e.what() << " ]]" << std::endl;
+
+            return false;
+        }
+    }
+
+private:
+
+    const std::string& raw_;
+    std::unordered_map<std::string, std::size_t> fields_;
+};
+
+//==============================================================================
+/**
+ * @brief Encoding implementation for message exchanging using
+ * <a href="https://www.rfc-editor.org/rfc/rfc8949.html">CBOR</a> binary format.
+ *
+ * Messages have the same fields as in the JSON encoding, but the data is encoded
+ * straight from its dynamic type into *CBOR*: collections of numbers are packed
+ * into typed arrays (RFC 8746), and collections of bytes into byte strings.
+ */
+class CborEncoding : public Encoding
+{
+public:
+
+    CborEncoding()
+        : fragments_(FragmentReassemblyMaxBytes, FragmentReassemblyTimeout)
+    {
+    }
+
+    bool binary() const override
+    {
+        return true;
+    }
+
+    void interpret_websocket_msg(
+            const std::string& msg_str,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const override
+    {
+        try
+        {
+            const CborMessage msg(msg_str);
+
+            const std::string op_str = msg.get_optional_string(CborOpKey);
+            if (op_str.empty())
+            {
+                logger << utils::Logger::Level::ERROR
+                       << "Incoming message was missing the required 'op' code" << std::endl;
+                return;
+            }
+
+            interpret(op_str, msg, endpoint, std::move(connection_handle));
+        }
+        catch (const CborError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to parse raw received WebSocket message as CBOR, reason: [[ "
+                   << e.what() << " ]]" << std::endl;
+        }
+    }
+
+    std::string encode_publication_msg(
+            const std::string& topic_name,
+            const std::string& topic_type,
+            const std::string& id,
+            const xtypes::DynamicData& msg) const override
+    {
+        try
+        {
+            std::string output;
+            CborWriter writer(output);
+            writer.begin_map(id.empty() ? 3 : 4);
+            write_field(writer, CborOpKey, CborOpPublishKey);
+            write_field(writer, CborTopicNameKey, topic_name);
+            writer.write_text(CborMsgKey);
+            write_planned_data(writer, msg);
+            if (!id.empty())
+            {
+                write_field(writer, CborIdKey, id);
+            }
+
+            register_topic_type(topic_name, topic_type);
+
+            return output;
+        }
+        catch (const CborError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to encode publication message for topic '" << topic_name
+                   << "' with type '" << topic_type << "', reason: [[ " << e.what()
+                   << " ]]" << std::endl;
+
+            return std::string();
+        }
+    }
+
+    std::string encode_service_response_msg(
+            const std::string& service_name,
+            const std::string& service_type,
+            const std::string& id,
+            const xtypes::DynamicData& response,
+            const bool result) const override
+    {
+        try
+        {
+            std::string output;
+            CborWriter writer(output);
+            writer.begin_map(id.empty() ? 4 : 5);
+            write_field(writer, CborOpKey, CborOpServiceResponseKey);
+            write_field(writer, CborServiceKey, service_name);
+            writer.write_text(CborValuesKey);
+            write_planned_data(writer, response);
+            writer.write_text(CborResultKey);
+            writer.write_bool(result);
+            if (!id.empty())
+            {
+                write_field(writer, CborIdKey, id);
+            }
+
+            types_.register_service_type(service_name, service_type, false);
+
+            return output;
+        }
+        catch (const CborError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to encode service response message for service '" << service_name
+                   << "' with type '" << service_type << "', reason: [[ " << e.what()
+                   << " ]]" << std::endl;
+
+            return std::string();
+        }
+    }
+
+    std::string encode_subscribe_msg(
+            const std::string& topic_name,
+            const std::string& message_type,
+            const std::string& id,
+            const YAML::Node& configuration) const override
+    {
+        std::map<std::string, uint32_t> options;
+        for (const std::string& key : {CborThrottleRateKey, CborQueueLengthKey, CborFragmentSizeKey})
+        {
+            if (!configuration.IsMap())
+            {
+                break;
+            }
+
+            if (const YAML::Node option_node = configuration[key])
+            {
+                try
+                {
+                    options[key] = option_node.as<uint32_t>();
+                }
+                catch (const YAML::Exception& e)
+                {
+                    logger << utils::Logger::Level::WARN
+                           << "Ignoring the '" << key << "' setting '" << option_node
+                           << "' of topic '" << topic_name << "', since it is not a "
+                           << "non-negative integer: " << e.what() << std::endl;
+                }
+            }
+        }
+
+        std::string output;
+        CborWriter writer(output);
+        writer.begin_map((id.empty() ? 3 : 4) + options.size());
+        write_field(writer, CborOpKey, CborOpSubscribeKey);
+        write_field(writer, CborTopicNameKey, topic_name);
+        write_field(writer, CborTypeNameKey, transform_type(message_type));
+        if (!id.empty())
+        {
+            write_field(writer, CborIdKey, id);
+        }
+        for (const auto& option : options)
+        {
+            writer.write_text(option.first);
+            writer.write_uint(option.second);
+        }
+
+        register_topic_type(topic_name, message_type);
+
+        return output;
+    }
+
+    std::string encode_advertise_msg(
+            const std::string& topic_name,
+            const std::string& message_type,
+            const std::string& id,
+            const YAML::Node& /*configuration*/) const override
+    {
+        std::string output;
+        CborWriter writer(output);
+        writer.begin_map(id.empty() ? 3 : 4);
+        write_field(writer, CborOpKey, CborOpAdvertiseTopicKey);
+        write_field(writer, CborTopicNameKey, topic_name);
+        write_field(writer, CborTypeNameKey, transform_type(message_type));
+        if (!id.empty())
+        {
+            write_field(writer, CborIdKey, id);
+        }
+
+        register_topic_type(topic_name, message_type);
+
+        return output;
+    }
+
+    std::string encode_call_service_msg(
+            const std::string& service_name,
+            const std::string& service_type,
+            const xtypes::DynamicData& service_request,
+            const std::string& id,
+            const YAML::Node& /*configuration*/) const override
+    {
+        try
+        {
+            std::string output;
+            CborWriter writer(output);
+            writer.begin_map(id.empty() ? 3 : 4);
+            write_field(writer, CborOpKey, CborOpServiceRequestKey);
+            write_field(writer, CborServiceKey, service_name);
+            writer.write_text(CborArgsKey);
+            write_planned_data(writer, service_request);
+            if (!id.empty())
+            {
+                write_field(writer, CborIdKey, id);
+            }
+
+            types_.register_service_type(service_name, service_type, true);
+
+            return output;
+        }
+        catch (const CborError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to encode service request message for service '" << service_name
+                   << "' with type '" << service_type << "', reason: [[ " << e.what()
+                   << " ]]" << std::endl;
+
+            return std::string();
+        }
+    }
+
+    std::string encode_advertise_service_msg(
+            const std::string& service_name,
+            const std::string& request_type,
+            const std::string& reply_type,
+            const std::string& id,
+            const YAML::Node& /*configuration*/) const override
+    {
+        std::string output;
+        CborWriter writer(output);
+        writer.begin_map(id.empty() ? 4 : 5);
+        write_field(writer, CborOpKey, CborOpAdvertiseServiceKey);
+        write_field(writer, CborRequestTypeNameKey, transform_type(request_type));
+        write_field(writer, CborReplyTypeNameKey, transform_type(reply_type));
+        write_field(writer, CborServiceKey, service_name);
+        if (!id.empty())
+        {
+            write_field(writer, CborIdKey, id);
+        }
+
+        register_service_types(service_name, request_type, reply_type);
+
+        return output;
+    }
+
+    std::vector<std::string> encode_fragments(
+            const std::string& payload,
+            const std::string& id,
+            std::size_t fragment_size) const override
+    {
+        std::vector<std::string> fragments;
+        if (fragment_size == 0)
+        {
+            return fragments;
+        }
+
+        // The data of the fragments are byte strings, so the payload can be split anywhere.
+        const std::size_t total = (payload.size() + fragment_size - 1) / fragment_size;
+        fragments.reserve(total);
+        for (std::size_t num = 0; num < total; ++num)
+        {
+            const std::size_t begin = num * fragment_size;
+            const std::size_t size = std::min(fragment_size, payload.size() - begin);
+
+            std::string output;
+            output.reserve(size + 64);
+            CborWriter writer(output);
+            writer.begin_map(5);
+            write_field(writer, CborOpKey, CborOpFragmentKey);
+            write_field(writer, CborIdKey, id);
+            writer.write_text(CborDataKey);
+            writer.write_bytes(payload.data() + begin, size);
+            writer.write_text(CborNumKey);
+            writer.write_uint(num);
+            writer.write_text(CborTotalKey);
+            writer.write_uint(total);
+
+            fragments.emplace_back(std::move(output));
+        }
+
+        return fragments;
+    }
+
+    void forget_connection(
+            const void* connection) const override
+    {
+        fragments_.forget(connection);
+    }
+
+    void evict_expired_fragments() const override
+    {
+        fragments_.evict_expired();
+    }
+
+    bool add_type(
+            const xtypes::DynamicType& type,
+            const std::string& type_name) override
+    {
+        return types_.add_type(type, type_name);
+    }
+
+protected:
+
+    /**
+     * @brief Encode data following the plan of its type, or its type if it has no plan.
+     */
+    void write_planned_data(
+            CborWriter& writer,
+            const xtypes::DynamicData& data) const
+    {
+        const CodecPlan* plan = types_.plan(data.type());
+        if (nullptr != plan)
+        {
+            write_data(writer, data, *plan);
+        }
+        else
+        {
+            write_data(writer, data);
+        }
+    }
+
+    void interpret(
+            const std::string& op_str,
+            const CborMessage& msg,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const
+    {
+        // Operations are checked in the same order as in the JSON encoding,
+        // from the most to the least frequent one.
+        if (op_str == CborOpPublishKey)
+        {
+            const std::string topic_name = msg.get_required_string(CborTopicNameKey);
+            if (topic_name.empty())
+            {
+                // A missing topic is reported as such, and not counted as a dropped publication too.
+                return;
+            }
+
+            // Publications that would be dropped are not worth decoding.
+            Endpoint::SubscriptionCallback* const callback =
+                    endpoint.accept_publication_ws(topic_name, connection_handle);
+            if (nullptr == callback)
+            {
+                return;
+            }
+
+            const xtypes::DynamicType* dest_type = get_type_by_topic(topic_name);
+            if (nullptr == dest_type)
+            {
+                return;
+            }
+
+            const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+            if (msg.get_required_data(CborMsgKey, *dest_data, types_.plan(*dest_type)))
+            {
+                endpoint.receive_publication_ws(topic_name, *dest_data, *callback);
+            }
+            return;
+        }
+
+        if (op_str == CborOpFragmentKey)
+        {
+            interpret_fragment(msg, endpoint, std::move(connection_handle));
+            return;
+        }
+
+        if (op_str == CborOpServiceRequestKey)
+        {
+            const std::string service_name = msg.get_required_string(CborServiceKey);
+            const xtypes::DynamicType* dest_type = get_service_type(service_name, true);
+            if (nullptr == dest_type)
+            {
+                return;
+            }
+
+            const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+            if (msg.get_required_data(CborArgsKey, *dest_data, types_.plan(*dest_type)))
+            {
+                endpoint.receive_service_request_ws(
+                    service_name,
+                    *dest_data,
+                    msg.get_optional_string(CborIdKey),
+                    std::move(connection_handle));
+            }
+            return;
+        }
+
+        if (op_str == CborOpServiceResponseKey)
+        {
+            const std::string service_name = msg.get_required_string(CborServiceKey);
+            const xtypes::DynamicType* dest_type = get_service_type(service_name, false);
+            if (nullptr == dest_type)
+            {
+                return;
+            }
+
+            const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+            if (msg.get_required_data(CborValuesKey, *dest_data, types_.plan(*dest_type)))
+            {
+                endpoint.receive_service_response_ws(
+                    service_name,
+                    *dest_data,
+                    msg.get_optional_string(CborIdKey),
+                    std::move(connection_handle));
+            }
+            return;
+        }
+
+        if (op_str == CborOpAdvertiseTopicKey)
+        {
+            const xtypes::DynamicType* topic_type = get_type(msg.get_required_string(CborTypeNameKey));
+            if (nullptr == topic_type)
+            {
+                return;
+            }
+
+            endpoint.receive_topic_advertisement_ws(
+                msg.get_required_string(CborTopicNameKey),
+                *topic_type,
+                msg.get_optional_string(CborIdKey),
+                std::move(connection_handle));
+            return;
+        }
+
+        if (op_str == CborOpUnadvertiseTopicKey)
+        {
+            endpoint.receive_topic_unadvertisement_ws(
+                msg.get_required_string(CborTopicNameKey),
+                msg.get_optional_string(CborIdKey),
+                std::move(connection_handle));
+            return;
+        }
+
+        if (op_str == CborOpSubscribeKey)
+        {
+            const xtypes::DynamicType* topic_type = get_type(msg.get_optional_string(CborTypeNameKey));
+            if (nullptr == topic_type)
+            {
+                return;
+            }
+
+            SubscriptionOptions options;
+            options.throttle_rate = msg.get_optional_uint(CborThrottleRateKey);
+            options.queue_length = msg.get_optional_uint(CborQueueLengthKey);
+            options.fragment_size = msg.get_optional_uint(CborFragmentSizeKey);
+
+            endpoint.receive_subscribe_request_ws(
+                msg.get_required_string(CborTopicNameKey),
+                topic_type,
+                msg.get_optional_string(CborIdKey),
+                options,
+                std::move(connection_handle));
+            return;
+        }
+
+        if (op_str == CborOpUnsubscribeKey)
+        {
+            endpoint.receive_unsubscribe_request_ws(
+                msg.get_required_string(CborTopicNameKey),
+                msg.get_optional_string(CborIdKey),
+                std::move(connection_handle));
+            return;
+        }
+
+        if (op_str == CborOpAdvertiseServiceKey)
+        {
+            const std::string request_type = msg.get_required_string(CborRequestTypeNameKey);
+            const std::string reply_type = msg.get_required_string(CborReplyTypeNameKey);
+            const xtypes::DynamicType* req_type = get_type(request_type);
+            const xtypes::DynamicType* rep_type = get_type(reply_type);
+            if (nullptr == req_type || nullptr == rep_type)
+            {
+                return;
+            }
+
+            const std::string service_name = msg.get_required_string(CborServiceKey);
+            endpoint.receive_service_advertisement_ws(
+                service_name,
+                *req_type,
+                *rep_type,
+                std::move(connection_handle));
+
+            register_service_types(service_name, request_type, reply_type);
+            return;
+        }
+
+        if (op_str == CborOpUnadvertiseServiceKey)
+        {
+            const xtypes::DynamicType* service_type = get_type(msg.get_optional_string(CborTypeNameKey));
+            if (nullptr == service_type)
+            {
+                return;
+            }
+
+            endpoint.receive_service_unadvertisement_ws(
+                msg.get_required_string(CborServiceKey),
+                service_type,
+                std::move(connection_handle));
+            return;
+        }
+
+        logger << utils::Logger::Level::ERROR
+               << "Unrecognized operation: '" << op_str << "'" << std::endl;
+    }
+
+    void interpret_fragment(
+            const CborMessage& msg,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const
+    {
+        const std::string id = msg.get_optional_string(CborIdKey);
+        if (!msg.has(CborDataKey) || !msg.has(CborNumKey) || !msg.has(CborTotalKey))
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Incoming fragment of message '" << id << "' is missing its '"
+                   << CborDataKey << "', '" << CborNumKey << "' or '" << CborTotalKey
+                   << "' fields" << std::endl;
+            return;
+        }
+
+        CborReader data_reader = msg.at(CborDataKey);
+        std::string data = data_reader.peek_type() == CborType::TEXT ?
+                data_reader.read_text() : data_reader.read_bytes();
+        CborReader num_reader = msg.at(CborNumKey);
+        const int64_t num = num_reader.read_int();
+        CborReader total_reader = msg.at(CborTotalKey);
+        const int64_t total = total_reader.read_int();
+
+        std::string assembled;
+        switch (fragments_.add(connection_handle.get(), id, num, total, std::move(data), assembled))
+        {
+            case FragmentBuffer::Result::INCOMPLETE:
+                break;
+
+            case FragmentBuffer::Result::REJECTED:
+                logger << utils::Logger::Level::WARN
+                       << "Discarding fragment " << num << " of " << total << " of message '"
+                       << id << "', since it is invalid or the reassembly buffer is full"
+                       << std::endl;
+                break;
+
+            case FragmentBuffer::Result::COMPLETE:
+                IS_WEBSOCKET_LOG(logger, DEBUG)
+                    << "Reassembled message '" << id << "' from " << total
+                    << " fragments" << std::endl;
+
+                interpret_websocket_msg(assembled, endpoint, std::move(connection_handle));
+                break;
+        }
+    }
+
+    static void write_field(
+            CborWriter& writer,
+            const std::string& key,
+            const std::string& value)
+    {
+        writer.write_text(key);
+        writer.write_text(value);
+    }
+
+    const xtypes::DynamicType* get_type(
+            const std::string& type_name) const
+    {
+        if (type_name.empty())
+        {
+            logger << utils::Logger::Level::WARN
+                   << "The 'type' property could not be fetched. Maybe you mispelled it?"
+                   << std::endl;
+            return nullptr;
+        }
+
+        const xtypes::DynamicType* type = types_.find_type(type_name);
+        if (nullptr != type)
+        {
+            return type;
+        }
+
+        logger << utils::Logger::Level::ERROR
+               << "Incoming message refers to an unregistered type: '"
+               << type_name << "'" << std::endl;
+
+        return nullptr;
+    }
+
+    const xtypes::DynamicType* get_service_type(
+            const std::string& service_name,
+            bool request) const
+    {
+        const xtypes::DynamicType* type = types_.service_type(service_name, request);
+        if (nullptr != type)
+        {
+            return type;
+        }
+
+        // Only reached for services that cannot be used, so it can afford a second lookup.
+        const std::string type_name = types_.service_type_name(service_name, request);
+        if (type_name.empty())
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "There is not any registered service " << (request ? "request" : "reply")
+                   << " type for the service '" << service_name << "'" << std::endl;
+            return nullptr;
+        }
+        return get_type(type_name);
+    }
+
+    const xtypes::DynamicType* get_type_by_topic(
+            const std::string& topic_name) const
+    {
+        const xtypes::DynamicType* type = types_.topic_type(topic_name);
+        if (nullptr == type)
+        {
+            // Only reached for topics that cannot be used, so it can afford a second lookup.
+            return get_type(types_.topic_type_name(topic_name));
+        }
+        return type;
+    }
+
+    void register_topic_type(
+            const std::string& topic_name,
+            const std::string& topic_type) const
+    {
+        types_.register_topic(topic_name, topic_type);
+    }
+
+    void register_service_types(
+            const std::string& service_name,
+            const std::string& request_type,
+            const std::string& reply_type) const
+    {
+        types_.register_service(service_name, request_type, reply_type);
+    }
+
+    /**
+     * The known types, and the types the topics and services are bound to.
+     * Messages may be interpreted and encoded by several threads at once: it is thread safe.
+     */
+    mutable TypeRegistry types_;
+
+    /**
+     * Instances where the incoming messages are decoded, reused from one message to the next.
+     * It is declared after the types, which it refers to. It is thread safe on its own.
+     */
+    mutable DataPool data_pool_;
+
+    /**
+     * Incoming fragmented messages being reassembled. It is thread safe on its own.
+     */
+    mutable FragmentBuffer fragments_;
+
+};
+
+//==============================================================================
+EncodingPtr make_cbor_encoding()
+{
+    return std::make_shared<CborEncoding>();
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -16,22 +16,33 @@
  *
  */
 
+#include "Arena.hpp"
+#include "DataPool.hpp"
 #include "Encoding.hpp"
 #include "Endpoint.hpp"
-
-#include <is/json-xtypes/conversion.hpp>
-#include <is/json-xtypes/json.hpp>
-
+#include "FragmentBuffer.hpp"
+#include "JsonData.hpp"
+#include "JsonIndex.hpp"
+#include "TypeRegistry.hpp"
+
+#include <xtypes/idl/idl.hpp>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace eprosima {
 namespace is {
 namespace sh {
 namespace websocket {
 
-using json_xtypes::Json;
-using nlohmann::detail::value_t;
-
 static utils::Logger logger("is::sh::WebSocket::JsonEncoding");
 
 //==============================================================================
@@ -47,7 +58,15 @@ const std::string JsonServiceKey = "service";
 const std::string JsonArgsKey = "args";
 const std::string JsonValuesKey = "values";
 const std::string JsonResultKey = "result";
+const std::string JsonThrottleRateKey = "throttle_rate";
+const std::string JsonQueueLengthKey = "queue_length";
+const std::string JsonFragmentSizeKey = "fragment_size";
+const std::string JsonDataKey = "data";
+const std::string JsonNumKey = "num";
+const std::string JsonTotalKey = "total";
 
+// configuration options
+const std::string JsonBase64Key = "base64";
 
 // op codes
 const std::string JsonOpAdvertiseTopicKey = "advertise";
@@ -59,6 +78,7 @@ const std::string JsonOpServiceRequestKey = "call_service";
 const std::string JsonOpAdvertiseServiceKey = "advertise_service";
 const std::string JsonOpUnadvertiseServiceKey = "unadvertise_service";
 const std::string JsonOpServiceResponseKey = "service_response";
+const std::string JsonOpFragmentKey = "fragment";
 
 // idl of ROSBRIDGE PROTOCOL messages
 const std::string idl_messages =
@@ -189,306 +209,520 @@ std::string transform_type(
     return type;
 }
 
+/**
+ * Room reserved for the fields of a message other than its data and names.
+ */
+const std::size_t JsonEnvelopeSize = 64;
+
 //==============================================================================
-static void throw_missing_key(
-        const Json& object,
-        const std::string& key)
+/**
+ * @brief Get the per-thread buffer where outgoing messages are written, empty and
+ *        with room for at least `size` bytes.
+ *
+ * @details Its capacity is kept between messages, so once it has grown to the size
+ *          of the largest message, writing a message does not allocate. Only the copy
+ *          returned to the caller, which must own the message, is allocated.
+ */
+static std::string& scratch_buffer(
+        std::size_t size)
 {
-    const std::string op_code = object.at("op").get<std::string>();
-
-    logger << utils::Logger::Level::ERROR
-           << "Incoming WebSocket message [[ " << object.dump() << " ]] with op code '"
-           << op_code << "' is missing the required field '" << key << "'" << std::endl;
+    thread_local std::string buffer;
+    buffer.clear();
+    buffer.reserve(size);
+    return buffer;
 }
 
 //==============================================================================
-static std::string get_optional_string(
-        const Json& object,
-        const std::string& key)
+/**
+ * @brief Estimated size of the *JSON* text of a type, taken from its plan if it has one.
+ */
+static std::size_t size_hint(
+        const xtypes::DynamicType& type,
+        const CodecPlan* plan)
 {
-    const auto it = object.find(key);
+    return nullptr != plan ? plan->json_size() : estimate_json_size(type);
+}
 
-    if (it == object.end())
+//==============================================================================
+/**
+ * @brief Encode data following the plan of its type, or its type if it has no plan.
+ */
+static void write_data(
+        JsonWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const CodecPlan* plan,
+        ByteEncoding bytes)
+{
+    if (nullptr != plan)
     {
-        return "";
+        write_json_data(writer, data, *plan, bytes);
     }
     else
     {
-        std::string temp_str = it.value().dump();
-        if (temp_str.find("\"") == 0)
-        {
-            return temp_str.substr(1, temp_str.size() - 2);
-        }
-        return temp_str;
+        write_json_data(writer, data, bytes);
     }
 }
 
+/**
+ * Longest part of an incoming message quoted in the logs.
+ */
+const std::size_t LoggedMessageSize = 256;
+
+/**
+ * @brief An incoming message quoted in the logs, so that a large or flooded
+ *        message does not end up in them whole.
+ */
+struct Excerpt
+{
+    const std::string& message;
+};
+
 //==============================================================================
-static std::string get_required_string(
-        const Json& object,
-        const std::string& key)
+static std::ostream& operator <<(
+        std::ostream& os,
+        const Excerpt& excerpt)
 {
-    const auto it = object.find(key);
-    if (it == object.end())
+    if (excerpt.message.size() <= LoggedMessageSize)
     {
-        throw_missing_key(object, key);
-        return std::string();
+        return os << excerpt.message;
     }
+    return os << std::string_view(excerpt.message.data(), LoggedMessageSize)
+              << "... (" << excerpt.message.size() << " bytes)";
+}
+
+//==============================================================================
+/**
+ * @brief Operation of an incoming message, given by its `op` field.
+ */
+enum class JsonOp : uint8_t
+{
+    UNKNOWN,
+    PUBLISH,
+    CALL_SERVICE,
+    SERVICE_RESPONSE,
+    ADVERTISE,
+    UNADVERTISE,
+    SUBSCRIBE,
+    UNSUBSCRIBE,
+    ADVERTISE_SERVICE,
+    UNADVERTISE_SERVICE,
+    FRAGMENT
+};
+
+//==============================================================================
+/**
+ * @brief Slot of an op code in the dispatch table. Twice its length plus its third
+ *        character, modulo 32, is different for each of the op codes of the protocol,
+ *        so it is a perfect hash of them.
+ */
+static std::size_t op_slot(
+        std::string_view op_str)
+{
+    return (2 * op_str.size() + static_cast<unsigned char>(op_str[2])) & 31;
+}
+
+//==============================================================================
+/**
+ * @brief Find the operation of an op code, comparing it only against the op code
+ *        in its slot of the dispatch table.
+ */
+static JsonOp find_op(
+        std::string_view op_str)
+{
+    struct Slot
+    {
+        const std::string* key;
+        JsonOp op;
+    };
 
-    std::string temp_str = it.value().dump();
-    if (temp_str.find("\"") == 0)
+    static const std::array<Slot, 32> table = []()
+            {
+                std::array<Slot, 32> slots;
+                slots.fill({nullptr, JsonOp::UNKNOWN});
+                for (const Slot& slot : {
+                    Slot{&JsonOpPublishKey, JsonOp::PUBLISH},
+                    Slot{&JsonOpServiceRequestKey, JsonOp::CALL_SERVICE},
+                    Slot{&JsonOpServiceResponseKey, JsonOp::SERVICE_RESPONSE},
+                    Slot{&JsonOpAdvertiseTopicKey, JsonOp::ADVERTISE},
+                    Slot{&JsonOpUnadvertiseTopicKey, JsonOp::UNADVERTISE},
+                    Slot{&JsonOpSubscribeKey, JsonOp::SUBSCRIBE},
+                    Slot{&JsonOpUnsubscribeKey, JsonOp::UNSUBSCRIBE},
+                    Slot{&JsonOpAdvertiseServiceKey, JsonOp::ADVERTISE_SERVICE},
+                    Slot{&JsonOpUnadvertiseServiceKey, JsonOp::UNADVERTISE_SERVICE},
+                    Slot{&JsonOpFragmentKey, JsonOp::FRAGMENT}})
+                {
+                    slots[op_slot(*slot.key)] = slot;
+                }
+                return slots;
+            }();
+
+    if (op_str.size() < 3)
     {
-        return temp_str.substr(1, temp_str.size() - 2);
+        return JsonOp::UNKNOWN;
     }
-    return temp_str;
+
+    const Slot& slot = table[op_slot(op_str)];
+    return nullptr != slot.key && *slot.key == op_str ? slot.op : JsonOp::UNKNOWN;
 }
 
 //==============================================================================
-static bool get_required_msg(
-        const Json& object,
-        xtypes::DynamicData& dynamicdata,
-        const std::string& key)
+/**
+ * @struct FieldBuffers
+ *         Where the fields of an incoming message that the Endpoint takes as strings,
+ *         or that have escape sequences, are read into.
+ */
+struct FieldBuffers
+{
+    std::string op;
+    std::string name;
+    std::string id;
+    std::string type;
+    std::string reply_type;
+};
+
+//==============================================================================
+/**
+ * @class FieldBuffersScope
+ *        Takes the per-thread FieldBuffers for the message being handled. They keep
+ *        their capacity between messages, so reading the fields does not allocate
+ *        once they have grown to the size of the longest names.
+ *
+ *        A message reassembled from fragments is handled while its last fragment is,
+ *        so each level of nesting takes its own buffers.
+ */
+class FieldBuffersScope
 {
-    const auto it = object.find(key);
-    if (it == object.end())
+public:
+
+    FieldBuffersScope()
+        : buffers_(take())
     {
-        throw_missing_key(object, key);
+        // Do nothing
     }
 
-    try
+    ~FieldBuffersScope()
     {
-        dynamicdata = json_xtypes::convert(dynamicdata.type(), it.value());
-        return true;
+        --depth();
     }
-    catch (const json_xtypes::UnsupportedType& unsupported)
-    {
-        logger << utils::Logger::Level::ERROR
-               << "Failed to get the required message because its type is unsupported: '"
-               << dynamicdata.type().name() << "', reason: [[ " << unsupported.what()
-               << " ]]" << std::endl;
 
-        return false;
+    FieldBuffersScope(
+            const FieldBuffersScope&) = delete;
+
+    FieldBuffersScope& operator =(
+            const FieldBuffersScope&) = delete;
+
+    FieldBuffers& operator *() const
+    {
+        return buffers_;
     }
-    catch (const json_xtypes::Json::exception& exception)
+
+private:
+
+    static std::size_t& depth()
     {
-        logger << utils::Logger::Level::ERROR
-               << "Failed to get the required message for type '"
-               << dynamicdata.type().name() << "' because conversion from xTypes"
-               << " to JSON failed. Details: [[ " << exception.what() << " ]]" << std::endl;
+        thread_local std::size_t level = 0;
+        return level;
+    }
 
-        return false;
+    static FieldBuffers& take()
+    {
+        // A deque does not move its elements when it grows.
+        thread_local std::deque<FieldBuffers> levels;
+        std::size_t& level = depth();
+        if (level == levels.size())
+        {
+            levels.emplace_back();
+        }
+        return levels[level++];
     }
-}
+
+    FieldBuffers& buffers_;
+};
 
 //==============================================================================
 /**
- * @brief Encoding implementation for message exchanging using
- * <a href="https://www.ecma-international.org/wp-content/uploads/ECMA-404_2nd_edition_december_2017.pdf">
- * JSON</a> format.
+ * @class JsonMessage
+ *        Top level object of an incoming *JSON* message.
+ *
+ *        The message is indexed once, recording where the value of each field starts,
+ *        so that the fields can be read in any order. This allows to decode the
+ *        message data straight into its type, even if the field telling which type it is,
+ *        such as the topic, comes after the data, without building a *JSON* document.
+ *        The index is allocated from the arena of the thread, so the message must be
+ *        handled within an ArenaScope.
+ *
+ *        The errors found in the message are logged only if the ErrorRateLimiter
+ *        of the Endpoint admits them for the connection the message came from.
  */
-class JsonEncoding : public Encoding
+class JsonMessage
 {
 public:
 
-    JsonEncoding()
+    JsonMessage(
+            const std::string& raw,
+            ErrorRateLimiter& errors,
+            const void* connection)
+        : raw_(raw)
+        , errors_(errors)
+        , connection_(connection)
+        , index_(raw.data(), raw.size())
     {
-        types_ = xtypes::idl::parse(idl_messages).get_all_types();
+        // Do nothing
     }
 
-    void interpret_websocket_msg(
-            const std::string& msg_str,
-            Endpoint& endpoint,
-            std::shared_ptr<void> connection_handle) const override
+    bool has(
+            const std::string& key) const
     {
-        Json msg;
-        try
+        return index_.find(key) != nullptr;
+    }
+
+    /**
+     * @brief Get a reader positioned at the value of a field, which must exist.
+     */
+    JsonReader at(
+            const std::string& key) const
+    {
+        return index_.at(key);
+    }
+
+    /**
+     * @brief Get the value of a field as a string, pointing into the message whenever
+     *        it has no escape sequences. Values of other kinds are returned as they
+     *        appear in the message.
+     *
+     * @param[in] buffer Where the string is unescaped, if it has to be.
+     *
+     * @returns A view valid while the message and the buffer are, which is empty
+     *          if the message does not have the field.
+     */
+    std::string_view get_optional_view(
+            const std::string& key,
+            std::string& buffer) const
+    {
+        if (!has(key))
         {
-            msg = Json::parse(msg_str);
+            return std::string_view();
         }
-        catch (const Json::exception& e)
+
+        JsonReader reader = at(key);
+        if (reader.peek_type() == JsonType::STRING)
         {
-            logger << utils::Logger::Level::ERROR
-                   << "Failed to parse raw received WebSocket message as a JSON: [[ "
-                   << msg_str << " ]]" << std::endl;
-            return;
+            return reader.read_string_view(buffer);
         }
+        return reader.read_raw_view();
+    }
 
-        const auto op_it = msg.find(JsonOpKey);
-        if (op_it == msg.end())
+    std::string_view get_required_view(
+            const std::string& key,
+            std::string& buffer) const
+    {
+        if (!has(key))
         {
-            logger << utils::Logger::Level::ERROR
-                   << "Incoming message [[ " << msg_str << " ]] was missing the required 'op' code"
-                   << std::endl;
-            return;
+            log_missing_key(key);
+            return std::string_view();
         }
 
-        const std::string& op_str = op_it.value().get<std::string>();
+        return get_optional_view(key, buffer);
+    }
+
+    /**
+     * @brief The same as get_optional_view(), copying the value into the buffer,
+     *        which keeps its capacity between messages.
+     */
+    const std::string& get_optional_string(
+            const std::string& key,
+            std::string& buffer) const
+    {
+        return copy_to(get_optional_view(key, buffer), buffer);
+    }
 
-        xtypes::DynamicType::Ptr type_ptr;
+    const std::string& get_required_string(
+            const std::string& key,
+            std::string& buffer) const
+    {
+        return copy_to(get_required_view(key, buffer), buffer);
+    }
 
-        auto type_it = types_.find(op_str);
-        if (type_it != types_.end())
+    uint32_t get_optional_uint(
+            const std::string& key) const
+    {
+        if (!has(key) || at(key).is_null())
         {
-            type_ptr = type_it->second;
+            return 0;
         }
 
-        // Publish is the most likely type of message to be received, so we'll check
-        // for that type first.
-        if (op_str == JsonOpPublishKey)
+        try
+        {
+            JsonReader reader = at(key);
+            return static_cast<uint32_t>(std::min<uint64_t>(
+                       reader.read_uint(), std::numeric_limits<uint32_t>::max()));
+        }
+        catch (const JsonError&)
         {
-            std::string topic_name = get_required_string(msg, JsonTopicNameKey);
-            const xtypes::DynamicType* dest_type = get_type_by_topic(topic_name);
-            if (nullptr == dest_type)
+            uint64_t suppressed = 0;
+            if (admit_error(InputError::INVALID_DATA, suppressed))
             {
-                return;
+                logger << utils::Logger::Level::WARN
+                       << "Ignoring the field '" << key << "' of the incoming WebSocket message [[ "
+                       << Excerpt{raw_} << " ]], since it is not a non-negative integer"
+                       << SuppressedErrors{suppressed} << std::endl;
             }
 
-            xtypes::DynamicData dest_data(*dest_type);
-            if (get_required_msg(msg, dest_data, JsonMsgKey))
-            {
-                endpoint.receive_publication_ws(
-                    topic_name,
-                    dest_data,
-                    std::move(connection_handle));
-            }
-            return;
+            return 0;
         }
+    }
 
-        // A service request is the roughly the second/third most likely type of
-        // message to be received, so we'll check for that type next.
-        if (op_str == JsonOpServiceRequestKey)
+    /**
+     * @brief Decode the data of a field straight into a dynamic data instance.
+     *
+     * @param[in] plan The plan of the type of the data, or `nullptr` if it has none.
+     *
+     * @returns `true` if the data was decoded, `false` otherwise.
+     */
+    bool get_required_data(
+            const std::string& key,
+            xtypes::DynamicData& data,
+            const CodecPlan* plan) const
+    {
+        if (!has(key))
         {
-            std::string service_name = get_required_string(msg, JsonServiceKey);
-            const xtypes::DynamicType* dest_type = get_req_type_from_service(service_name);
-            if (nullptr == dest_type)
-            {
-                return;
-            }
-
-            xtypes::DynamicData dest_data(*dest_type);
-            if (get_required_msg(msg, dest_data, JsonArgsKey))
-            {
-                endpoint.receive_service_request_ws(
-                    service_name,
-                    dest_data,
-                    get_optional_string(msg, JsonIdKey),
-                    std::move(connection_handle));
-            }
-            return;
+            log_missing_key(key);
+            return false;
         }
 
-        // A service response is the roughly the second/third most likely type of
-        // message to be received, so we'll check for that type next.
-        if (op_str == JsonOpServiceResponseKey)
+        try
         {
-            std::string service_name = get_required_string(msg, JsonServiceKey);
-            const xtypes::DynamicType* dest_type = get_rep_type_from_service(service_name);
-            if (nullptr == dest_type)
+            JsonReader reader = at(key);
+            if (nullptr != plan)
             {
-                return;
+                read_json_data(reader, data, *plan);
             }
-
-            xtypes::DynamicData dest_data(*dest_type);
-            if (get_required_msg(msg, dest_data, JsonValuesKey))
+            else
             {
-                endpoint.receive_service_response_ws(
-                    get_required_string(msg, JsonServiceKey),
-                    dest_data,
-                    get_optional_string(msg, JsonIdKey),
-                    std::move(connection_handle));
+                read_json_data(reader, data);
             }
-            return;
+            return true;
         }
-
-        if (op_str == JsonOpAdvertiseTopicKey)
+        catch (const JsonError& e)
         {
-            const xtypes::DynamicType* topic_type = get_type(get_required_string(msg, JsonTypeNameKey));
-            if (nullptr == topic_type)
+            uint64_t suppressed = 0;
+            if (admit_error(InputError::INVALID_DATA, suppressed))
             {
-                return;
+                logger << utils::Logger::Level::ERROR
+                       << "Failed to decode the field '" << key << "' as type '"
+                       << data.type().name() << "', reason: [[ " << e.what() << " ]]"
+                       << SuppressedErrors{suppressed} << std::endl;
             }
 
-            endpoint.receive_topic_advertisement_ws(
-                get_required_string(msg, JsonTopicNameKey),
-                *topic_type,
-                get_optional_string(msg, JsonIdKey),
-                std::move(connection_handle));
-            return;
+            return false;
         }
+    }
+
+    /**
+     * @brief Count an error found in the message and decide whether it is logged,
+     *        as ErrorRateLimiter::admit() does.
+     */
+    bool admit_error(
+            InputError kind,
+            uint64_t& suppressed) const
+    {
+        return errors_.admit(connection_, kind, suppressed);
+    }
 
-        if (op_str == JsonOpUnadvertiseTopicKey)
+private:
+
+    static const std::string& copy_to(
+            std::string_view value,
+            std::string& buffer)
+    {
+        // Strings with escape sequences are already unescaped into the buffer.
+        if (value.data() != buffer.data())
         {
-            endpoint.receive_topic_unadvertisement_ws(
-                get_required_string(msg, JsonTopicNameKey),
-                get_optional_string(msg, JsonIdKey),
-                std::move(connection_handle));
-            return;
+            buffer.assign(value.begin(), value.end());
         }
+        return buffer;
+    }
 
-        if (op_str == JsonOpSubscribeKey)
+    void log_missing_key(
+            const std::string& key) const
+    {
+        uint64_t suppressed = 0;
+        if (!admit_error(InputError::MISSING_FIELD, suppressed))
         {
-            const xtypes::DynamicType* topic_type = get_type(get_optional_string(msg, JsonTypeNameKey));
-            if (nullptr == topic_type)
-            {
-                return;
-            }
-
-            endpoint.receive_subscribe_request_ws(
-                get_required_string(msg, JsonTopicNameKey),
-                topic_type,
-                get_optional_string(msg, JsonIdKey),
-                std::move(connection_handle));
             return;
         }
 
-        if (op_str == JsonOpUnsubscribeKey)
+        std::string op;
+        logger << utils::Logger::Level::ERROR
+               << "Incoming WebSocket message [[ " << Excerpt{raw_} << " ]] with op code '"
+               << get_optional_view(JsonOpKey, op) << "' is missing the required field '"
+               << key << "'" << SuppressedErrors{suppressed} << std::endl;
+    }
+
+    const std::string& raw_;
+    ErrorRateLimiter& errors_;
+    const void* connection_;
+    const JsonIndex index_;
+};
+
+//==============================================================================
+/**
+ * @brief Encoding implementation for message exchanging using
+ * <a href="https://www.ecma-international.org/wp-content/uploads/ECMA-404_2nd_edition_december_2017.pdf">
+ * JSON</a> format.
+ */
+class JsonEncoding : public Encoding
+{
+public:
+
+    JsonEncoding()
+        : fragments_(FragmentReassemblyMaxBytes, FragmentReassemblyTimeout)
+    {
+        for (const auto& type : xtypes::idl::parse(idl_messages).get_all_types())
         {
-            endpoint.receive_unsubscribe_request_ws(
-                get_required_string(msg, JsonTopicNameKey),
-                get_optional_string(msg, JsonIdKey),
-                std::move(connection_handle));
-            return;
+            types_.add_type(*type.second, type.first);
         }
+    }
+
+    void interpret_websocket_msg(
+            const std::string& msg_str,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const override
+    {
+        // Everything allocated from the arena while the message is handled is released at once.
+        const ArenaScope scope;
 
-        if (op_str == JsonOpAdvertiseServiceKey)
+        try
         {
-            const xtypes::DynamicType* req_type = get_type(get_required_string(msg, JsonRequestTypeNameKey));
-            const xtypes::DynamicType* reply_type = get_type(get_required_string(msg, JsonReplyTypeNameKey));
-            if (nullptr == req_type || nullptr == reply_type)
+            const JsonMessage msg(msg_str, endpoint.input_errors(), connection_handle.get());
+            if (!msg.has(JsonOpKey))
             {
+                uint64_t suppressed = 0;
+                if (msg.admit_error(InputError::MISSING_FIELD, suppressed))
+                {
+                    logger << utils::Logger::Level::ERROR
+                           << "Incoming message [[ " << Excerpt{msg_str}
+                           << " ]] was missing the required 'op' code"
+                           << SuppressedErrors{suppressed} << std::endl;
+                }
                 return;
             }
 
-            endpoint.receive_service_advertisement_ws(
-                get_required_string(msg, JsonServiceKey),
-                *req_type,
-                *reply_type,
+            const FieldBuffersScope buffers;
+            interpret(msg.get_optional_view(JsonOpKey, (*buffers).op), msg, *buffers, endpoint,
                 std::move(connection_handle));
-
-            types_by_service_[get_required_string(msg, JsonServiceKey)] =
-                    std::pair<std::string, std::string>(
-                transform_type(get_required_string(msg, JsonRequestTypeNameKey)),
-                transform_type(get_required_string(msg, JsonReplyTypeNameKey)));
-            return;
         }
-
-        if (op_str == JsonOpUnadvertiseServiceKey)
+        catch (const JsonError& e)
         {
-            const xtypes::DynamicType* topic_type = get_type(get_optional_string(msg, JsonTypeNameKey));
-            if (nullptr == topic_type)
+            uint64_t suppressed = 0;
+            if (endpoint.input_errors().admit(connection_handle.get(), InputError::MALFORMED, suppressed))
             {
-                return;
+                logger << utils::Logger::Level::ERROR
+                       << "Failed to parse raw received WebSocket message as a JSON: [[ "
+                       << Excerpt{msg_str} << " ]], reason: [[ " << e.what() << " ]]"
+                       << SuppressedErrors{suppressed} << std::endl;
             }
-
-            endpoint.receive_service_unadvertisement_ws(
-                get_required_string(msg, JsonServiceKey),
-                topic_type,
-                std::move(connection_handle));
-            return;
         }
-
-        logger << utils::Logger::Level::ERROR
-               << "Unrecognized operation: '" << op_str << "'" << std::endl;
     }
 
     std::string encode_publication_msg(
@@ -499,34 +733,34 @@ public:
     {
         try
         {
-            Json output;
-            output[JsonOpKey] = JsonOpPublishKey;
-            output[JsonTopicNameKey] = topic_name;
-            output[JsonMsgKey] = json_xtypes::convert(msg);
+            const CodecPlan* plan = types_.plan(msg.type());
+            std::string& buffer = scratch_buffer(
+                JsonEnvelopeSize + topic_name.size() + id.size() + size_hint(msg.type(), plan));
+            JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.key(JsonOpKey);
+            writer.write_string(JsonOpPublishKey);
             if (!id.empty())
             {
-                output[JsonIdKey] = id;
+                writer.key(JsonIdKey);
+                writer.write_string(id);
             }
+            writer.key(JsonTopicNameKey);
+            writer.write_string(topic_name);
+            writer.key(JsonMsgKey);
+            write_data(writer, msg, plan, byte_encoding(base64_topics_, topic_name));
+            writer.end_object();
 
-            types_by_topic_[topic_name] = transform_type(topic_type);
+            register_topic_type(topic_name, topic_type);
 
-            return output.dump();
+            return buffer;
         }
-        catch (const json_xtypes::UnsupportedType& unsupported)
+        catch (const JsonError& e)
         {
             logger << utils::Logger::Level::ERROR
                    << "Failed to encode publication message for topic '" << topic_name
                    << "' because its type '" << topic_type << "' is unsupported,"
-                   << " reason: [[ " << unsupported.what() << " ]]" << std::endl;
-
-            return std::string();
-        }
-        catch (const json_xtypes::Json::exception& exception)
-        {
-            logger << utils::Logger::Level::ERROR
-                   << "Failed to encode publication message for topic '" << topic_name
-                   << "' with type '" << topic_type << "' because conversion from xTypes"
-                   << " to JSON failed. Details: [[ " << exception.what() << " ]]" << std::endl;
+                   << " reason: [[ " << e.what() << " ]]" << std::endl;
 
             return std::string();
         }
@@ -541,45 +775,36 @@ public:
     {
         try
         {
-            Json output;
-            output[JsonOpKey] = JsonOpServiceResponseKey;
-            output[JsonServiceKey] = service_name;
-            output[JsonValuesKey] = json_xtypes::convert(response);
-            output[JsonResultKey] = result;
+            const CodecPlan* plan = types_.plan(response.type());
+            std::string& buffer = scratch_buffer(
+                JsonEnvelopeSize + service_name.size() + id.size() + size_hint(response.type(), plan));
+            JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.key(JsonOpKey);
+            writer.write_string(JsonOpServiceResponseKey);
             if (!id.empty())
             {
-                output[JsonIdKey] = id;
+                writer.key(JsonIdKey);
+                writer.write_string(id);
             }
+            writer.key(JsonServiceKey);
+            writer.write_string(service_name);
+            writer.key(JsonResultKey);
+            writer.write_bool(result);
+            writer.key(JsonValuesKey);
+            write_data(writer, response, plan, byte_encoding(base64_services_, service_name));
+            writer.end_object();
 
-            auto it = types_by_service_.find(service_name);
-            if (it != types_by_service_.end())
-            {
-                types_by_service_[service_name] = std::pair<std::string, std::string>(
-                    it->second.first, transform_type(service_type));
-            }
-            else
-            {
-                types_by_service_[service_name] = std::pair<std::string, std::string>(
-                    "", transform_type(service_type));
-            }
+            types_.register_service_type(service_name, service_type, false);
 
-            return output.dump();
+            return buffer;
         }
-        catch (const json_xtypes::UnsupportedType& unsupported)
+        catch (const JsonError& e)
         {
             logger << utils::Logger::Level::ERROR
                    << "Failed to encode service response message for service '" << service_name
                    << "' because its type '" << service_type << "' is unsupported,"
-                   << " reason: [[ " << unsupported.what() << " ]]" << std::endl;
-
-            return std::string();
-        }
-        catch (const json_xtypes::Json::exception& exception)
-        {
-            logger << utils::Logger::Level::ERROR
-                   << "Failed to encode service response message for service '" << service_name
-                   << "' with type '" << service_type << "' because conversion from xTypes"
-                   << " to JSON failed. Details: [[ " << exception.what() << " ]]" << std::endl;
+                   << " reason: [[ " << e.what() << " ]]" << std::endl;
 
             return std::string();
         }
@@ -589,42 +814,83 @@ public:
             const std::string& topic_name,
             const std::string& message_type,
             const std::string& id,
-            const YAML::Node& /*configuration*/) const override
-    {
-        // TODO(MXG): Consider parsing the `configuration` for details like
-        // throttle_rate, queue_length, fragment_size, and compression
-        Json output;
-        output[JsonOpKey] = JsonOpSubscribeKey;
-        output[JsonTopicNameKey] = topic_name;
-        output[JsonTypeNameKey] = transform_type(message_type);
+            const YAML::Node& configuration) const override
+    {
+        // TODO(MXG): Consider parsing the `configuration` for details like compression
+        std::string& buffer = scratch_buffer(JsonEnvelopeSize + topic_name.size() + message_type.size());
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.key(JsonOpKey);
+        writer.write_string(JsonOpSubscribeKey);
         if (!id.empty())
         {
-            output[JsonIdKey] = id;
+            writer.key(JsonIdKey);
+            writer.write_string(id);
+        }
+        writer.key(JsonTopicNameKey);
+        writer.write_string(topic_name);
+        writer.key(JsonTypeNameKey);
+        writer.write_string(transform_type(message_type));
+
+        for (const std::string& key : {JsonThrottleRateKey, JsonQueueLengthKey, JsonFragmentSizeKey})
+        {
+            if (!configuration.IsMap())
+            {
+                break;
+            }
+
+            if (const YAML::Node option_node = configuration[key])
+            {
+                try
+                {
+                    const uint32_t value = option_node.as<uint32_t>();
+                    writer.key(key);
+                    writer.write_uint(value);
+                }
+                catch (const YAML::Exception& e)
+                {
+                    logger << utils::Logger::Level::WARN
+                           << "Ignoring the '" << key << "' setting '" << option_node
+                           << "' of topic '" << topic_name << "', since it is not a "
+                           << "non-negative integer: " << e.what() << std::endl;
+                }
+            }
         }
 
-        types_by_topic_[topic_name] = transform_type(message_type);
+        writer.end_object();
+
+        register_topic_type(topic_name, message_type);
+        configure_byte_encoding(base64_topics_, "topic", topic_name, configuration);
 
-        return output.dump();
+        return buffer;
     }
 
     std::string encode_advertise_msg(
             const std::string& topic_name,
             const std::string& message_type,
             const std::string& id,
-            const YAML::Node& /*configuration*/) const override
+            const YAML::Node& configuration) const override
     {
-        Json output;
-        output[JsonOpKey] = JsonOpAdvertiseTopicKey;
-        output[JsonTopicNameKey] = topic_name;
-        output[JsonTypeNameKey] = transform_type(message_type);
+        std::string& buffer = scratch_buffer(JsonEnvelopeSize + topic_name.size() + message_type.size());
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.key(JsonOpKey);
+        writer.write_string(JsonOpAdvertiseTopicKey);
         if (!id.empty())
         {
-            output[JsonIdKey] = id;
+            writer.key(JsonIdKey);
+            writer.write_string(id);
         }
+        writer.key(JsonTopicNameKey);
+        writer.write_string(topic_name);
+        writer.key(JsonTypeNameKey);
+        writer.write_string(transform_type(message_type));
+        writer.end_object();
 
-        types_by_topic_[topic_name] = transform_type(message_type);
+        register_topic_type(topic_name, message_type);
+        configure_byte_encoding(base64_topics_, "topic", topic_name, configuration);
 
-        return output.dump();
+        return buffer;
     }
 
     std::string encode_call_service_msg(
@@ -632,50 +898,42 @@ public:
             const std::string& service_type,
             const xtypes::DynamicData& service_request,
             const std::string& id,
-            const YAML::Node& /*configuration*/) const override
+            const YAML::Node& configuration) const override
     {
+        configure_byte_encoding(base64_services_, "service", service_name, configuration);
+
         try
         {
             // TODO(MXG): Consider parsing the `configuration` for details like
             // fragment_size and compression
-            Json output;
-            output[JsonOpKey] = JsonOpServiceRequestKey;
-            output[JsonServiceKey] = service_name;
-            output[JsonArgsKey] = json_xtypes::convert(service_request);
+            const CodecPlan* plan = types_.plan(service_request.type());
+            std::string& buffer = scratch_buffer(
+                JsonEnvelopeSize + service_name.size() + id.size() + size_hint(service_request.type(), plan));
+            JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.key(JsonOpKey);
+            writer.write_string(JsonOpServiceRequestKey);
             if (!id.empty())
             {
-                output[JsonIdKey] = id;
+                writer.key(JsonIdKey);
+                writer.write_string(id);
             }
+            writer.key(JsonServiceKey);
+            writer.write_string(service_name);
+            writer.key(JsonArgsKey);
+            write_data(writer, service_request, plan, byte_encoding(base64_services_, service_name));
+            writer.end_object();
 
-            auto it = types_by_service_.find(service_name);
-            if (it != types_by_service_.end())
-            {
-                types_by_service_[service_name] = std::pair<std::string, std::string>(
-                    transform_type(service_type), it->second.second);
-            }
-            else
-            {
-                types_by_service_[service_name] = std::pair<std::string, std::string>(
-                    transform_type(service_type), "");
-            }
+            types_.register_service_type(service_name, service_type, true);
 
-            return output.dump();
+            return buffer;
         }
-        catch (const json_xtypes::UnsupportedType& unsupported)
+        catch (const JsonError& e)
         {
             logger << utils::Logger::Level::ERROR
                    << "Failed to encode service request message for service '" << service_name
                    << "' because its type '" << service_type << "' is unsupported,"
-                   << " reason: [[ " << unsupported.what() << " ]]" << std::endl;
-
-            return std::string();
-        }
-        catch (const json_xtypes::Json::exception& exception)
-        {
-            logger << utils::Logger::Level::ERROR
-                   << "Failed to encode service request message for service '" << service_name
-                   << "' with type '" << service_type << "' because conversion from xTypes"
-                   << " to JSON failed. Details: [[ " << exception.what() << " ]]" << std::endl;
+                   << " reason: [[ " << e.what() << " ]]" << std::endl;
 
             return std::string();
         }
@@ -686,94 +944,555 @@ public:
             const std::string& request_type,
             const std::string& reply_type,
             const std::string& /*id*/,
-            const YAML::Node& /*configuration*/) const override
+            const YAML::Node& configuration) const override
+    {
+        std::string& buffer = scratch_buffer(
+            JsonEnvelopeSize + service_name.size() + request_type.size() + reply_type.size());
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.key(JsonOpKey);
+        writer.write_string(JsonOpAdvertiseServiceKey);
+        writer.key(JsonServiceKey);
+        writer.write_string(service_name);
+        writer.key(JsonRequestTypeNameKey);
+        writer.write_string(transform_type(request_type));
+        writer.key(JsonReplyTypeNameKey);
+        writer.write_string(transform_type(reply_type));
+        writer.end_object();
+
+        register_service_types(service_name, request_type, reply_type);
+        configure_byte_encoding(base64_services_, "service", service_name, configuration);
+
+        return buffer;
+    }
+
+    void configure_service(
+            const std::string& service_name,
+            const YAML::Node& configuration) override
     {
-        Json output;
-        output[JsonOpKey] = JsonOpAdvertiseServiceKey;
-        output[JsonRequestTypeNameKey] = transform_type(request_type);
-        output[JsonReplyTypeNameKey] = transform_type(reply_type);
-        output[JsonServiceKey] = service_name;
+        configure_byte_encoding(base64_services_, "service", service_name, configuration);
+    }
+
+    std::vector<std::string> encode_fragments(
+            const std::string& payload,
+            const std::string& id,
+            std::size_t fragment_size) const override
+    {
+        std::vector<std::string> fragments;
+        if (fragment_size == 0)
+        {
+            return fragments;
+        }
+
+        // Split points are moved back to the start of a UTF-8 character,
+        // since the data of each fragment must be a valid JSON string.
+        std::vector<std::size_t> split_points{0};
+        while (split_points.back() < payload.size())
+        {
+            const std::size_t begin = split_points.back();
+            std::size_t end = std::min(begin + fragment_size, payload.size());
+            while (end < payload.size() && end > begin && is_utf8_continuation(payload[end]))
+            {
+                --end;
+            }
+            if (end == begin)
+            {
+                // The fragment size is smaller than the character, so take it whole.
+                end = begin + 1;
+                while (end < payload.size() && is_utf8_continuation(payload[end]))
+                {
+                    ++end;
+                }
+            }
+            split_points.push_back(end);
+        }
+
+        const std::size_t total = split_points.size() - 1;
+        fragments.reserve(total);
+        for (std::size_t num = 0; num < total; ++num)
+        {
+            const std::size_t size = split_points[num + 1] - split_points[num];
+
+            std::string& buffer = scratch_buffer(JsonEnvelopeSize + id.size() + 2 * size);
+            JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.key(JsonOpKey);
+            writer.write_string(JsonOpFragmentKey);
+            writer.key(JsonIdKey);
+            writer.write_string(id);
+            writer.key(JsonDataKey);
+            writer.write_string(payload.data() + split_points[num], size);
+            writer.key(JsonNumKey);
+            writer.write_uint(num);
+            writer.key(JsonTotalKey);
+            writer.write_uint(total);
+            writer.end_object();
+
+            fragments.emplace_back(buffer);
+        }
+
+        return fragments;
+    }
 
-        types_by_service_[service_name] = std::pair<std::string, std::string>(transform_type(
-                            request_type), transform_type(reply_type));
+    void forget_connection(
+            const void* connection) const override
+    {
+        fragments_.forget(connection);
+    }
 
-        return output.dump();
+    void evict_expired_fragments() const override
+    {
+        fragments_.evict_expired();
     }
 
     const xtypes::DynamicType* get_type(
-            const std::string& type_name) const
+            const std::string& type_name,
+            const JsonMessage& msg) const
     {
+        uint64_t suppressed = 0;
         if (type_name.empty())
         {
-            logger << utils::Logger::Level::WARN
-                   << "The 'type' property could not be fetched. Maybe you mispelled it?"
-                   << std::endl;
+            if (msg.admit_error(InputError::MISSING_FIELD, suppressed))
+            {
+                logger << utils::Logger::Level::WARN
+                       << "The 'type' property could not be fetched. Maybe you mispelled it?"
+                       << SuppressedErrors{suppressed} << std::endl;
+            }
             return nullptr;
         }
 
-        auto type_it = types_.find(transform_type(type_name));
-        if (type_it != types_.end())
-        {
-            return type_it->second.get();
-        }
-        else
+        const xtypes::DynamicType* type = types_.find_type(type_name);
+        if (nullptr == type && msg.admit_error(InputError::UNKNOWN_TYPE, suppressed))
         {
             logger << utils::Logger::Level::ERROR
                    << "Incoming message refers to an unregistered type: '"
-                   << type_name << "'" << std::endl;
-
-            return nullptr;
+                   << type_name << "'" << SuppressedErrors{suppressed} << std::endl;
         }
+        return type;
     }
 
     bool add_type(
             const xtypes::DynamicType& type,
             const std::string& type_name) override
     {
-        std::string name = transform_type(type_name.empty() ? type.name() : type_name);
-        auto result = types_.emplace(name, type);
-        return result.second;
+        return types_.add_type(type, type_name);
     }
 
     const xtypes::DynamicType* get_type_by_topic(
-            const std::string& topic_name) const
+            const std::string& topic_name,
+            const JsonMessage& msg) const
     {
-        return get_type(types_by_topic_[topic_name]);
+        const xtypes::DynamicType* type = types_.topic_type(topic_name);
+        if (nullptr == type)
+        {
+            // Only reached for topics that cannot be used, so it can afford a second lookup.
+            return get_type(types_.topic_type_name(topic_name), msg);
+        }
+        return type;
     }
 
     const xtypes::DynamicType* get_req_type_from_service(
-            const std::string& service_name) const
+            const std::string& service_name,
+            const JsonMessage& msg) const
     {
-        std::string req_type = types_by_service_[service_name].first;
-        if (req_type.empty())
+        const xtypes::DynamicType* type = types_.service_type(service_name, true);
+        if (nullptr == type)
         {
-            logger << utils::Logger::Level::ERROR
-                   << "There is not any registered service request type for the service '"
-                   << service_name << "'" << std::endl;
-            return nullptr;
+            return get_unresolved_service_type(
+                service_name, "request", types_.service_type_name(service_name, true), msg);
         }
-        return get_type(req_type);
+        return type;
     }
 
     const xtypes::DynamicType* get_rep_type_from_service(
-            const std::string& service_name) const
+            const std::string& service_name,
+            const JsonMessage& msg) const
     {
-        std::string rep_type = types_by_service_[service_name].second;
-        if (rep_type.empty())
+        const xtypes::DynamicType* type = types_.service_type(service_name, false);
+        if (nullptr == type)
         {
-            logger << utils::Logger::Level::ERROR
-                   << "There is not any registered service reply type for the service '"
-                   << service_name << "'" << std::endl;
+            return get_unresolved_service_type(
+                service_name, "reply", types_.service_type_name(service_name, false), msg);
+        }
+        return type;
+    }
+
+    const xtypes::DynamicType* get_unresolved_service_type(
+            const std::string& service_name,
+            const char* kind,
+            const std::string& type_name,
+            const JsonMessage& msg) const
+    {
+        if (type_name.empty())
+        {
+            uint64_t suppressed = 0;
+            if (msg.admit_error(InputError::UNKNOWN_TYPE, suppressed))
+            {
+                logger << utils::Logger::Level::ERROR
+                       << "There is not any registered service " << kind << " type for the service '"
+                       << service_name << "'" << SuppressedErrors{suppressed} << std::endl;
+            }
             return nullptr;
         }
-        return get_type(rep_type);
+        return get_type(type_name, msg);
     }
 
 protected:
 
-    std::map<std::string, xtypes::DynamicType::Ptr> types_;
-    mutable std::map<std::string, std::string> types_by_topic_;
-    mutable std::map<std::string, std::pair<std::string, std::string> > types_by_service_;
+    using NameSet = std::unordered_set<std::string>;
+
+    void interpret(
+            std::string_view op_str,
+            const JsonMessage& msg,
+            FieldBuffers& buffers,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const
+    {
+        switch (find_op(op_str))
+        {
+            case JsonOp::PUBLISH:
+            {
+                const std::string& topic_name = msg.get_required_string(JsonTopicNameKey, buffers.name);
+                if (topic_name.empty())
+                {
+                    // A missing topic is reported as such, and not counted as a dropped publication too.
+                    return;
+                }
+
+                // Publications that would be dropped are not worth decoding.
+                Endpoint::SubscriptionCallback* const callback =
+                        endpoint.accept_publication_ws(topic_name, connection_handle);
+                if (nullptr == callback)
+                {
+                    return;
+                }
+
+                const xtypes::DynamicType* dest_type = get_type_by_topic(topic_name, msg);
+                if (nullptr == dest_type)
+                {
+                    return;
+                }
+
+                const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+                if (msg.get_required_data(JsonMsgKey, *dest_data, types_.plan(*dest_type)))
+                {
+                    endpoint.receive_publication_ws(topic_name, *dest_data, *callback);
+                }
+                return;
+            }
+
+            case JsonOp::FRAGMENT:
+                interpret_fragment(msg, buffers, endpoint, std::move(connection_handle));
+                return;
+
+            case JsonOp::CALL_SERVICE:
+            {
+                const std::string& service_name = msg.get_required_string(JsonServiceKey, buffers.name);
+                const xtypes::DynamicType* dest_type = get_req_type_from_service(service_name, msg);
+                if (nullptr == dest_type)
+                {
+                    return;
+                }
+
+                const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+                if (msg.get_required_data(JsonArgsKey, *dest_data, types_.plan(*dest_type)))
+                {
+                    endpoint.receive_service_request_ws(
+                        service_name,
+                        *dest_data,
+                        msg.get_optional_string(JsonIdKey, buffers.id),
+                        std::move(connection_handle));
+                }
+                return;
+            }
+
+            case JsonOp::SERVICE_RESPONSE:
+            {
+                const std::string& service_name = msg.get_required_string(JsonServiceKey, buffers.name);
+                const xtypes::DynamicType* dest_type = get_rep_type_from_service(service_name, msg);
+                if (nullptr == dest_type)
+                {
+                    return;
+                }
+
+                const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+                if (msg.get_required_data(JsonValuesKey, *dest_data, types_.plan(*dest_type)))
+                {
+                    endpoint.receive_service_response_ws(
+                        service_name,
+                        *dest_data,
+                        msg.get_optional_string(JsonIdKey, buffers.id),
+                        std::move(connection_handle));
+                }
+                return;
+            }
+
+            case JsonOp::ADVERTISE:
+            {
+                const xtypes::DynamicType* topic_type = get_type(
+                    msg.get_required_string(JsonTypeNameKey, buffers.type), msg);
+                if (nullptr == topic_type)
+                {
+                    return;
+                }
+
+                endpoint.receive_topic_advertisement_ws(
+                    msg.get_required_string(JsonTopicNameKey, buffers.name),
+                    *topic_type,
+                    msg.get_optional_string(JsonIdKey, buffers.id),
+                    std::move(connection_handle));
+                return;
+            }
+
+            case JsonOp::UNADVERTISE:
+                endpoint.receive_topic_unadvertisement_ws(
+                    msg.get_required_string(JsonTopicNameKey, buffers.name),
+                    msg.get_optional_string(JsonIdKey, buffers.id),
+                    std::move(connection_handle));
+                return;
+
+            case JsonOp::SUBSCRIBE:
+            {
+                const xtypes::DynamicType* topic_type = get_type(
+                    msg.get_optional_string(JsonTypeNameKey, buffers.type), msg);
+                if (nullptr == topic_type)
+                {
+                    return;
+                }
+
+                SubscriptionOptions options;
+                options.throttle_rate = msg.get_optional_uint(JsonThrottleRateKey);
+                options.queue_length = msg.get_optional_uint(JsonQueueLengthKey);
+                options.fragment_size = msg.get_optional_uint(JsonFragmentSizeKey);
+
+                endpoint.receive_subscribe_request_ws(
+                    msg.get_required_string(JsonTopicNameKey, buffers.name),
+                    topic_type,
+                    msg.get_optional_string(JsonIdKey, buffers.id),
+                    options,
+                    std::move(connection_handle));
+                return;
+            }
+
+            case JsonOp::UNSUBSCRIBE:
+                endpoint.receive_unsubscribe_request_ws(
+                    msg.get_required_string(JsonTopicNameKey, buffers.name),
+                    msg.get_optional_string(JsonIdKey, buffers.id),
+                    std::move(connection_handle));
+                return;
+
+            case JsonOp::ADVERTISE_SERVICE:
+            {
+                const std::string& request_type = msg.get_required_string(JsonRequestTypeNameKey, buffers.type);
+                const std::string& reply_type = msg.get_required_string(JsonReplyTypeNameKey, buffers.reply_type);
+                const xtypes::DynamicType* req_type = get_type(request_type, msg);
+                const xtypes::DynamicType* rep_type = get_type(reply_type, msg);
+                if (nullptr == req_type || nullptr == rep_type)
+                {
+                    return;
+                }
+
+                const std::string& service_name = msg.get_required_string(JsonServiceKey, buffers.name);
+                endpoint.receive_service_advertisement_ws(
+                    service_name,
+                    *req_type,
+                    *rep_type,
+                    std::move(connection_handle));
+
+                register_service_types(service_name, request_type, reply_type);
+                return;
+            }
+
+            case JsonOp::UNADVERTISE_SERVICE:
+            {
+                const xtypes::DynamicType* topic_type = get_type(
+                    msg.get_optional_string(JsonTypeNameKey, buffers.type), msg);
+                if (nullptr == topic_type)
+                {
+                    return;
+                }
+
+                endpoint.receive_service_unadvertisement_ws(
+                    msg.get_required_string(JsonServiceKey, buffers.name),
+                    topic_type,
+                    std::move(connection_handle));
+                return;
+            }
+
+            case JsonOp::UNKNOWN:
+                break;
+        }
+
+        uint64_t suppressed = 0;
+        if (msg.admit_error(InputError::UNKNOWN_OPERATION, suppressed))
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Unrecognized operation: '" << op_str << "'"
+                   << SuppressedErrors{suppressed} << std::endl;
+        }
+    }
+
+    static bool is_utf8_continuation(
+            char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+
+    void interpret_fragment(
+            const JsonMessage& msg,
+            FieldBuffers& buffers,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const
+    {
+        const std::string& id = msg.get_optional_string(JsonIdKey, buffers.id);
+        uint64_t suppressed = 0;
+        if (!msg.has(JsonDataKey) || !msg.has(JsonNumKey) || !msg.has(JsonTotalKey))
+        {
+            if (msg.admit_error(InputError::MISSING_FIELD, suppressed))
+            {
+                logger << utils::Logger::Level::ERROR
+                       << "Incoming fragment of message '" << id << "' is missing its '"
+                       << JsonDataKey << "', '" << JsonNumKey << "' or '" << JsonTotalKey
+                       << "' fields" << SuppressedErrors{suppressed} << std::endl;
+            }
+            return;
+        }
+
+        std::string data = msg.at(JsonDataKey).read_string();
+        const int64_t num = msg.at(JsonNumKey).read_int();
+        const int64_t total = msg.at(JsonTotalKey).read_int();
+
+        std::string assembled;
+        switch (fragments_.add(connection_handle.get(), id, num, total, std::move(data), assembled))
+        {
+            case FragmentBuffer::Result::INCOMPLETE:
+                break;
+
+            case FragmentBuffer::Result::REJECTED:
+                if (msg.admit_error(InputError::INVALID_DATA, suppressed))
+                {
+                    logger << utils::Logger::Level::WARN
+                           << "Discarding fragment " << num << " of " << total << " of message '"
+                           << id << "', since it is invalid or the reassembly buffer is full"
+                           << SuppressedErrors{suppressed} << std::endl;
+                }
+                break;
+
+            case FragmentBuffer::Result::COMPLETE:
+                IS_WEBSOCKET_LOG(logger, DEBUG)
+                    << "Reassembled message '" << id << "' from " << total
+                    << " fragments" << std::endl;
+
+                interpret_websocket_msg(assembled, endpoint, std::move(connection_handle));
+                break;
+        }
+    }
+
+    void register_topic_type(
+            const std::string& topic_name,
+            const std::string& topic_type) const
+    {
+        types_.register_topic(topic_name, topic_type);
+    }
+
+    void register_service_types(
+            const std::string& service_name,
+            const std::string& request_type,
+            const std::string& reply_type) const
+    {
+        types_.register_service(service_name, request_type, reply_type);
+    }
+
+    /**
+     * @brief Apply the `base64` option of the configuration of a topic or service,
+     *        if it is given, which tells whether its collections of bytes are encoded
+     *        as base64 strings instead of arrays of numbers.
+     */
+    void configure_byte_encoding(
+            std::shared_ptr<const NameSet>& names,
+            const std::string& kind,
+            const std::string& name,
+            const YAML::Node& configuration) const
+    {
+        if (!configuration.IsMap())
+        {
+            return;
+        }
+
+        const YAML::Node base64_node = configuration[JsonBase64Key];
+        if (!base64_node)
+        {
+            return;
+        }
+
+        bool base64 = false;
+        try
+        {
+            base64 = base64_node.as<bool>();
+        }
+        catch (const YAML::Exception& e)
+        {
+            logger << utils::Logger::Level::WARN
+                   << "Ignoring the '" << JsonBase64Key << "' setting '" << base64_node
+                   << "' of " << kind << " '" << name << "', since it is not a boolean: "
+                   << e.what() << std::endl;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(base64_mutex_);
+
+        const std::shared_ptr<const NameSet> current = std::atomic_load(&names);
+        if ((current->count(name) > 0) == base64)
+        {
+            return;
+        }
+
+        auto updated = std::make_shared<NameSet>(*current);
+        if (base64)
+        {
+            updated->insert(name);
+        }
+        else
+        {
+            updated->erase(name);
+        }
+        std::atomic_store(&names, std::shared_ptr<const NameSet>(std::move(updated)));
+    }
+
+    static ByteEncoding byte_encoding(
+            const std::shared_ptr<const NameSet>& names,
+            const std::string& name)
+    {
+        const std::shared_ptr<const NameSet> current = std::atomic_load(&names);
+        return current->count(name) > 0 ? ByteEncoding::BASE64 : ByteEncoding::ARRAY;
+    }
+
+    /**
+     * The known types, and the types the topics and services are bound to,
+     * so that incoming messages find their type without any string manipulation.
+     * Messages may be interpreted and encoded by several threads at once: it is thread safe.
+     */
+    mutable TypeRegistry types_;
+
+    /**
+     * Instances where the incoming messages are decoded, reused from one message to the next.
+     * It is declared after the types, which it refers to. It is thread safe on its own.
+     */
+    mutable DataPool data_pool_;
+
+    /**
+     * Incoming fragmented messages being reassembled. It is thread safe on its own.
+     */
+    mutable FragmentBuffer fragments_;
+
+    /**
+     * Topics and services whose collections of bytes are encoded as base64 strings.
+     * They are set while configuring and read for every message, so they are copied
+     * on write, and read without locking.
+     */
+    mutable std::shared_ptr<const NameSet> base64_topics_ = std::make_shared<const NameSet>();
+    mutable std::shared_ptr<const NameSet> base64_services_ = std::make_shared<const NameSet>();
+    mutable std::mutex base64_mutex_;
 
 };
 
@@ -0,0 +1,1198 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Cdr.hpp"
+#include "DataPool.hpp"
+#include "Encoding.hpp"
+#include "Endpoint.hpp"
+#include "FragmentBuffer.hpp"
+#include "TypeRegistry.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+static utils::Logger logger("is::sh::WebSocket::XcdrEncoding");
+
+//==============================================================================
+// frame header
+const uint8_t XcdrVersion = 1;
+const std::size_t XcdrHeaderSize = 12;
+const uint8_t XcdrFlagLittleEndian = 0x01;
+const uint8_t XcdrFlagResult = 0x02;
+
+const std::string XcdrThrottleRateKey = "throttle_rate";
+const std::string XcdrQueueLengthKey = "queue_length";
+const std::string XcdrFragmentSizeKey = "fragment_size";
+
+/**
+ * @brief Operation carried by a frame, equivalent to the `op` field of the JSON encoding.
+ */
+enum class XcdrOp : uint8_t
+{
+    PUBLISH = 1,
+    CALL_SERVICE = 2,
+    SERVICE_RESPONSE = 3,
+    ADVERTISE = 4,
+    UNADVERTISE = 5,
+    SUBSCRIBE = 6,
+    UNSUBSCRIBE = 7,
+    ADVERTISE_SERVICE = 8,
+    UNADVERTISE_SERVICE = 9,
+    FRAGMENT = 10
+};
+
+const uint32_t FnvOffsetBasis = 2166136261u;
+const uint32_t FnvPrime = 16777619u;
+
+//==============================================================================
+static uint32_t fnv1a(
+        const void* data,
+        std::size_t size,
+        uint32_t hash = FnvOffsetBasis)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * FnvPrime;
+    }
+    return hash;
+}
+
+//==============================================================================
+static uint32_t fnv1a(
+        const std::string& value,
+        uint32_t hash = FnvOffsetBasis)
+{
+    return fnv1a(value.data(), value.size(), hash);
+}
+
+//==============================================================================
+static uint32_t fnv1a(
+        uint32_t value,
+        uint32_t hash)
+{
+    // Hash the little endian representation, so that hashes match across hosts.
+    const uint8_t bytes[4] = {
+        static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+        static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)};
+    return fnv1a(bytes, sizeof(bytes), hash);
+}
+
+//==============================================================================
+static const xtypes::DynamicType& resolve_alias(
+        const xtypes::DynamicType& type)
+{
+    if (type.kind() == xtypes::TypeKind::ALIAS_TYPE)
+    {
+        return static_cast<const xtypes::AliasType&>(type).rget();
+    }
+    return type;
+}
+
+//==============================================================================
+/**
+ * @brief Hash the layout of a type on the wire: the kinds of its fields, in order,
+ *        the names of the structure members and the dimensions of the arrays.
+ *
+ *        Type names are left out, since each side may qualify them differently.
+ */
+static uint32_t hash_type(
+        const xtypes::DynamicType& type,
+        uint32_t hash = FnvOffsetBasis)
+{
+    const xtypes::DynamicType& resolved = resolve_alias(type);
+    hash = fnv1a(static_cast<uint32_t>(resolved.kind()), hash);
+
+    switch (resolved.kind())
+    {
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+            for (const xtypes::Member& member
+                    : static_cast<const xtypes::StructType&>(resolved).members())
+            {
+                hash = fnv1a(member.name(), hash);
+                hash = hash_type(member.type(), hash);
+            }
+            break;
+        case xtypes::TypeKind::ARRAY_TYPE:
+            hash = fnv1a(static_cast<const xtypes::ArrayType&>(resolved).dimension(), hash);
+            hash = hash_type(static_cast<const xtypes::CollectionType&>(resolved).content_type(), hash);
+            break;
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            hash = hash_type(static_cast<const xtypes::CollectionType&>(resolved).content_type(), hash);
+            break;
+        default:
+            break;
+    }
+
+    return hash;
+}
+
+static void write_data(
+        CdrWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data);
+
+static void read_data(
+        CdrReader& reader,
+        xtypes::WritableDynamicDataRef data);
+
+//==============================================================================
+template<typename T>
+static void write_block(
+        CdrWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data)
+{
+    const std::vector<T> values = data.as_vector<T>();
+    writer.write_array(values.data(), values.size());
+}
+
+//==============================================================================
+static void write_collection(
+        CdrWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data,
+        const xtypes::DynamicType& type)
+{
+    // Sequences are prefixed by their length. Arrays have a fixed one, known by both sides.
+    if (type.kind() == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        writer.write(static_cast<uint32_t>(data.size()));
+    }
+
+    const xtypes::DynamicType& content =
+            resolve_alias(static_cast<const xtypes::CollectionType&>(type).content_type());
+
+    // Collections of primitives are contiguous in memory and on the wire, so they are copied as a block.
+    switch (content.kind())
+    {
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            write_block<char>(writer, data);
+            return;
+        case xtypes::TypeKind::INT_8_TYPE:
+            write_block<int8_t>(writer, data);
+            return;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            write_block<uint8_t>(writer, data);
+            return;
+        case xtypes::TypeKind::INT_16_TYPE:
+            write_block<int16_t>(writer, data);
+            return;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            write_block<uint16_t>(writer, data);
+            return;
+        case xtypes::TypeKind::INT_32_TYPE:
+            write_block<int32_t>(writer, data);
+            return;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            write_block<uint32_t>(writer, data);
+            return;
+        case xtypes::TypeKind::INT_64_TYPE:
+            write_block<int64_t>(writer, data);
+            return;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            write_block<uint64_t>(writer, data);
+            return;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            write_block<float>(writer, data);
+            return;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            write_block<double>(writer, data);
+            return;
+        default:
+            break;
+    }
+
+    const std::size_t size = data.size();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        write_data(writer, data[i]);
+    }
+}
+
+//==============================================================================
+static void write_data(
+        CdrWriter& writer,
+        const xtypes::ReadableDynamicDataRef& data)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            writer.write_bool(data.value<bool>());
+            break;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            writer.write(data.value<char>());
+            break;
+        case xtypes::TypeKind::INT_8_TYPE:
+            writer.write(data.value<int8_t>());
+            break;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            writer.write(data.value<uint8_t>());
+            break;
+        case xtypes::TypeKind::INT_16_TYPE:
+            writer.write(data.value<int16_t>());
+            break;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            writer.write(data.value<uint16_t>());
+            break;
+        case xtypes::TypeKind::INT_32_TYPE:
+            writer.write(data.value<int32_t>());
+            break;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            writer.write(data.value<uint32_t>());
+            break;
+        case xtypes::TypeKind::INT_64_TYPE:
+            writer.write(data.value<int64_t>());
+            break;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            writer.write(data.value<uint64_t>());
+            break;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            writer.write(data.value<float>());
+            break;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            writer.write(data.value<double>());
+            break;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            writer.write(data.value<long double>());
+            break;
+        case xtypes::TypeKind::STRING_TYPE:
+            writer.write_string(data.value<std::string>());
+            break;
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            writer.write(data.value<uint32_t>());
+            break;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            write_collection(writer, data, type);
+            break;
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            // Members are serialized in order, so they are accessed by index
+            // instead of looking their names up.
+            const std::size_t members = static_cast<const xtypes::StructType&>(type).members().size();
+            for (std::size_t i = 0; i < members; ++i)
+            {
+                write_data(writer, data[i]);
+            }
+            break;
+        }
+        default:
+            throw CdrError("type '" + type.name() + "' is not supported");
+    }
+}
+
+//==============================================================================
+template<typename T, typename Stored = T>
+static void read_block(
+        CdrReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        std::size_t size)
+{
+    std::vector<T> values;
+    reader.read_array(values, size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        data[i].value(static_cast<Stored>(values[i]));
+    }
+}
+
+//==============================================================================
+static void read_collection(
+        CdrReader& reader,
+        xtypes::WritableDynamicDataRef& data,
+        const xtypes::DynamicType& type)
+{
+    std::size_t size = data.size();
+    if (type.kind() == xtypes::TypeKind::SEQUENCE_TYPE)
+    {
+        size = reader.read<uint32_t>();
+
+        const std::size_t bounds = static_cast<const xtypes::SequenceType&>(type).bounds();
+        if (bounds > 0 && size > bounds)
+        {
+            throw CdrError("sequence of " + std::to_string(size)
+                          + " elements exceeds its bound of " + std::to_string(bounds));
+        }
+
+        // Every element takes at least one byte, so a forged length cannot make us allocate
+        // more elements than the rest of the frame could ever hold.
+        if (size > reader.remaining())
+        {
+            throw CdrError("truncated sequence of " + std::to_string(size) + " elements");
+        }
+        data.resize(size);
+    }
+
+    const xtypes::DynamicType& content =
+            resolve_alias(static_cast<const xtypes::CollectionType&>(type).content_type());
+
+    switch (content.kind())
+    {
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            read_block<char>(reader, data, size);
+            return;
+        case xtypes::TypeKind::INT_8_TYPE:
+            read_block<int8_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            read_block<uint8_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::INT_16_TYPE:
+            read_block<int16_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            read_block<uint16_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::INT_32_TYPE:
+            read_block<int32_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            read_block<uint32_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::INT_64_TYPE:
+            read_block<int64_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            read_block<uint64_t>(reader, data, size);
+            return;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            read_block<float>(reader, data, size);
+            return;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            read_block<double>(reader, data, size);
+            return;
+        default:
+            break;
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        read_data(reader, data[i]);
+    }
+}
+
+//==============================================================================
+static void read_data(
+        CdrReader& reader,
+        xtypes::WritableDynamicDataRef data)
+{
+    const xtypes::DynamicType& type = resolve_alias(data.type());
+
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            data.value(reader.read_bool());
+            break;
+        case xtypes::TypeKind::CHAR_8_TYPE:
+            data.value(reader.read<char>());
+            break;
+        case xtypes::TypeKind::INT_8_TYPE:
+            data.value(reader.read<int8_t>());
+            break;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            data.value(reader.read<uint8_t>());
+            break;
+        case xtypes::TypeKind::INT_16_TYPE:
+            data.value(reader.read<int16_t>());
+            break;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            data.value(reader.read<uint16_t>());
+            break;
+        case xtypes::TypeKind::INT_32_TYPE:
+            data.value(reader.read<int32_t>());
+            break;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            data.value(reader.read<uint32_t>());
+            break;
+        case xtypes::TypeKind::INT_64_TYPE:
+            data.value(reader.read<int64_t>());
+            break;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            data.value(reader.read<uint64_t>());
+            break;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            data.value(reader.read<float>());
+            break;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            data.value(reader.read<double>());
+            break;
+        case xtypes::TypeKind::FLOAT_128_TYPE:
+            data.value(reader.read<long double>());
+            break;
+        case xtypes::TypeKind::STRING_TYPE:
+            data.value(reader.read_string());
+            break;
+        case xtypes::TypeKind::ENUMERATION_TYPE:
+            data.value(reader.read<uint32_t>());
+            break;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            read_collection(reader, data, type);
+            break;
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            // Members are serialized in order, so they are accessed by index
+            // instead of looking their names up.
+            const std::size_t members = static_cast<const xtypes::StructType&>(type).members().size();
+            for (std::size_t i = 0; i < members; ++i)
+            {
+                read_data(reader, data[i]);
+            }
+            break;
+        }
+        default:
+            throw CdrError("type '" + type.name() + "' is not supported");
+    }
+}
+
+//==============================================================================
+/**
+ * @brief Encoding implementation which sends the data serialized as version 1
+ *        <a href="https://www.omg.org/spec/DDS-XTypes/">XCDR</a>, in binary frames.
+ *
+ * It is meant for links between *Integration Service* instances sharing the same types:
+ * the data is not self describing, so it is decoded straight into the type registered
+ * through add_type() for its topic or service.
+ *
+ * Every frame starts with a 12 bytes header:
+ *
+ *   - `uint8` version, currently 1.
+ *   - `uint8` operation, see XcdrOp.
+ *   - `uint8` flags: bit 0 is set if the frame is little endian, bit 1 carries the
+ *     result of a service response.
+ *   - `uint8` reserved, set to 0.
+ *   - `uint32` FNV-1a hash of the topic or service name.
+ *   - `uint32` hash of the layout of the data type, see hash_type(), or 0 if there is no data.
+ *
+ * Publications carry nothing else but the data, the topic is identified by its hash.
+ * The rest of the operations carry their parameters as *CDR* strings and integers.
+ */
+class XcdrEncoding : public Encoding
+{
+public:
+
+    XcdrEncoding()
+        : fragments_(FragmentReassemblyMaxBytes, FragmentReassemblyTimeout)
+    {
+    }
+
+    bool binary() const override
+    {
+        return true;
+    }
+
+    void interpret_websocket_msg(
+            const std::string& msg_str,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const override
+    {
+        if (msg_str.size() < XcdrHeaderSize || static_cast<uint8_t>(msg_str[0]) != XcdrVersion)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Incoming message is not a version " << static_cast<int>(XcdrVersion)
+                   << " XCDR frame" << std::endl;
+            return;
+        }
+
+        try
+        {
+            const uint8_t flags = static_cast<uint8_t>(msg_str[2]);
+            CdrReader reader(msg_str.data(), msg_str.size(), (flags & XcdrFlagLittleEndian) != 0);
+            reader.read<uint8_t>();
+            const XcdrOp op = static_cast<XcdrOp>(reader.read<uint8_t>());
+            reader.read<uint8_t>();
+            reader.read<uint8_t>();
+            const uint32_t name_hash = reader.read<uint32_t>();
+            const uint32_t type_hash = reader.read<uint32_t>();
+
+            interpret(op, name_hash, type_hash, reader, endpoint, std::move(connection_handle));
+        }
+        catch (const CdrError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to parse raw received WebSocket message as XCDR, reason: [[ "
+                   << e.what() << " ]]" << std::endl;
+        }
+    }
+
+    std::string encode_publication_msg(
+            const std::string& topic_name,
+            const std::string& topic_type,
+            const std::string& /*id*/,
+            const xtypes::DynamicData& msg) const override
+    {
+        try
+        {
+            std::string output;
+            CdrWriter writer(output);
+            write_header(writer, XcdrOp::PUBLISH, 0, fnv1a(topic_name), get_type_hash(msg.type()));
+            write_data(writer, msg);
+
+            register_topic_type(topic_name, topic_type);
+
+            return output;
+        }
+        catch (const CdrError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to encode publication message for topic '" << topic_name
+                   << "' with type '" << topic_type << "', reason: [[ " << e.what()
+                   << " ]]" << std::endl;
+
+            return std::string();
+        }
+    }
+
+    std::string encode_service_response_msg(
+            const std::string& service_name,
+            const std::string& service_type,
+            const std::string& id,
+            const xtypes::DynamicData& response,
+            const bool result) const override
+    {
+        try
+        {
+            std::string output;
+            CdrWriter writer(output);
+            write_header(writer, XcdrOp::SERVICE_RESPONSE, result ? XcdrFlagResult : 0,
+                    fnv1a(service_name), get_type_hash(response.type()));
+            writer.write_string(service_name);
+            writer.write_string(id);
+            write_data(writer, response);
+
+            types_.register_service_type(service_name, service_type, false);
+
+            return output;
+        }
+        catch (const CdrError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to encode service response message for service '" << service_name
+                   << "' with type '" << service_type << "', reason: [[ " << e.what()
+                   << " ]]" << std::endl;
+
+            return std::string();
+        }
+    }
+
+    std::string encode_subscribe_msg(
+            const std::string& topic_name,
+            const std::string& message_type,
+            const std::string& id,
+            const YAML::Node& configuration) const override
+    {
+        // Options which are not set are sent as 0, as they are when the JSON field is missing.
+        std::map<std::string, uint32_t> options;
+        for (const std::string& key : {XcdrThrottleRateKey, XcdrQueueLengthKey, XcdrFragmentSizeKey})
+        {
+            options[key] = 0;
+            if (!configuration.IsMap())
+            {
+                continue;
+            }
+
+            if (const YAML::Node option_node = configuration[key])
+            {
+                try
+                {
+                    options[key] = option_node.as<uint32_t>();
+                }
+                catch (const YAML::Exception& e)
+                {
+                    logger << utils::Logger::Level::WARN
+                           << "Ignoring the '" << key << "' setting '" << option_node
+                           << "' of topic '" << topic_name << "', since it is not a "
+                           << "non-negative integer: " << e.what() << std::endl;
+                }
+            }
+        }
+
+        std::string output;
+        CdrWriter writer(output);
+        write_header(writer, XcdrOp::SUBSCRIBE, 0, fnv1a(topic_name), 0);
+        writer.write_string(topic_name);
+        writer.write_string(transform_type(message_type));
+        writer.write_string(id);
+        writer.write(options[XcdrThrottleRateKey]);
+        writer.write(options[XcdrQueueLengthKey]);
+        writer.write(options[XcdrFragmentSizeKey]);
+
+        register_topic_type(topic_name, message_type);
+
+        return output;
+    }
+
+    std::string encode_advertise_msg(
+            const std::string& topic_name,
+            const std::string& message_type,
+            const std::string& id,
+            const YAML::Node& /*configuration*/) const override
+    {
+        std::string output;
+        CdrWriter writer(output);
+        write_header(writer, XcdrOp::ADVERTISE, 0, fnv1a(topic_name), 0);
+        writer.write_string(topic_name);
+        writer.write_string(transform_type(message_type));
+        writer.write_string(id);
+
+        register_topic_type(topic_name, message_type);
+
+        return output;
+    }
+
+    std::string encode_call_service_msg(
+            const std::string& service_name,
+            const std::string& service_type,
+            const xtypes::DynamicData& service_request,
+            const std::string& id,
+            const YAML::Node& /*configuration*/) const override
+    {
+        try
+        {
+            std::string output;
+            CdrWriter writer(output);
+            write_header(writer, XcdrOp::CALL_SERVICE, 0, fnv1a(service_name),
+                    get_type_hash(service_request.type()));
+            writer.write_string(service_name);
+            writer.write_string(id);
+            write_data(writer, service_request);
+
+            types_.register_service_type(service_name, service_type, true);
+
+            return output;
+        }
+        catch (const CdrError& e)
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "Failed to encode service request message for service '" << service_name
+                   << "' with type '" << service_type << "', reason: [[ " << e.what()
+                   << " ]]" << std::endl;
+
+            return std::string();
+        }
+    }
+
+    std::string encode_advertise_service_msg(
+            const std::string& service_name,
+            const std::string& request_type,
+            const std::string& reply_type,
+            const std::string& id,
+            const YAML::Node& /*configuration*/) const override
+    {
+        std::string output;
+        CdrWriter writer(output);
+        write_header(writer, XcdrOp::ADVERTISE_SERVICE, 0, fnv1a(service_name), 0);
+        writer.write_string(service_name);
+        writer.write_string(transform_type(request_type));
+        writer.write_string(transform_type(reply_type));
+        writer.write_string(id);
+
+        register_service_types(service_name, request_type, reply_type);
+
+        return output;
+    }
+
+    std::vector<std::string> encode_fragments(
+            const std::string& payload,
+            const std::string& id,
+            std::size_t fragment_size) const override
+    {
+        std::vector<std::string> fragments;
+        if (fragment_size == 0)
+        {
+            return fragments;
+        }
+
+        const std::size_t total = (payload.size() + fragment_size - 1) / fragment_size;
+        fragments.reserve(total);
+        for (std::size_t num = 0; num < total; ++num)
+        {
+            const std::size_t begin = num * fragment_size;
+            const std::size_t size = std::min(fragment_size, payload.size() - begin);
+
+            std::string output;
+            output.reserve(size + XcdrHeaderSize + id.size() + 24);
+            CdrWriter writer(output);
+            write_header(writer, XcdrOp::FRAGMENT, 0, 0, 0);
+            writer.write_string(id);
+            writer.write(static_cast<uint32_t>(num));
+            writer.write(static_cast<uint32_t>(total));
+            writer.write(static_cast<uint32_t>(size));
+            writer.write_array(payload.data() + begin, size);
+
+            fragments.emplace_back(std::move(output));
+        }
+
+        return fragments;
+    }
+
+    void forget_connection(
+            const void* connection) const override
+    {
+        fragments_.forget(connection);
+    }
+
+    void evict_expired_fragments() const override
+    {
+        fragments_.evict_expired();
+    }
+
+    bool add_type(
+            const xtypes::DynamicType& type,
+            const std::string& type_name) override
+    {
+        if (!types_.add_type(type, type_name))
+        {
+            return false;
+        }
+
+        const uint32_t type_hash = hash_type(type);
+
+        std::lock_guard<std::mutex> lock(types_mutex_);
+        type_hashes_[type.name()] = type_hash;
+        return true;
+    }
+
+protected:
+
+    void interpret(
+            XcdrOp op,
+            uint32_t name_hash,
+            uint32_t type_hash,
+            CdrReader& reader,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const
+    {
+        switch (op)
+        {
+            case XcdrOp::PUBLISH:
+            {
+                const std::string topic_name = get_topic_by_hash(name_hash);
+                if (topic_name.empty())
+                {
+                    return;
+                }
+
+                // Publications that would be dropped are not worth decoding.
+                Endpoint::SubscriptionCallback* const callback =
+                        endpoint.accept_publication_ws(topic_name, connection_handle);
+                if (nullptr == callback)
+                {
+                    return;
+                }
+
+                const xtypes::DynamicType* dest_type = get_type_by_topic(topic_name);
+                if (nullptr == dest_type || !check_type_hash(*dest_type, type_hash, topic_name))
+                {
+                    return;
+                }
+
+                const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+                read_data(reader, *dest_data);
+                endpoint.receive_publication_ws(topic_name, *dest_data, *callback);
+                return;
+            }
+
+            case XcdrOp::FRAGMENT:
+                interpret_fragment(reader, endpoint, std::move(connection_handle));
+                return;
+
+            case XcdrOp::CALL_SERVICE:
+            case XcdrOp::SERVICE_RESPONSE:
+            {
+                const bool request = op == XcdrOp::CALL_SERVICE;
+                const std::string service_name = reader.read_string();
+                const std::string id = reader.read_string();
+                const xtypes::DynamicType* dest_type = get_service_type(service_name, request);
+                if (nullptr == dest_type || !check_type_hash(*dest_type, type_hash, service_name))
+                {
+                    return;
+                }
+
+                const DataPool::Lease dest_data = data_pool_.acquire(*dest_type);
+                read_data(reader, *dest_data);
+                if (request)
+                {
+                    endpoint.receive_service_request_ws(
+                        service_name,
+                        *dest_data,
+                        id,
+                        std::move(connection_handle));
+                }
+                else
+                {
+                    endpoint.receive_service_response_ws(
+                        service_name,
+                        *dest_data,
+                        id,
+                        std::move(connection_handle));
+                }
+                return;
+            }
+
+            case XcdrOp::ADVERTISE:
+            {
+                const std::string topic_name = reader.read_string();
+                const std::string type_name = reader.read_string();
+                const std::string id = reader.read_string();
+                const xtypes::DynamicType* topic_type = get_type(type_name);
+                if (nullptr == topic_type)
+                {
+                    return;
+                }
+
+                // Publications only carry the hash of their topic, so learn it from the advertisement.
+                register_topic_type(topic_name, type_name);
+
+                endpoint.receive_topic_advertisement_ws(
+                    topic_name,
+                    *topic_type,
+                    id,
+                    std::move(connection_handle));
+                return;
+            }
+
+            case XcdrOp::UNADVERTISE:
+            case XcdrOp::UNSUBSCRIBE:
+            {
+                const std::string topic_name = reader.read_string();
+                const std::string id = reader.read_string();
+                if (op == XcdrOp::UNADVERTISE)
+                {
+                    endpoint.receive_topic_unadvertisement_ws(
+                        topic_name, id, std::move(connection_handle));
+                }
+                else
+                {
+                    endpoint.receive_unsubscribe_request_ws(
+                        topic_name, id, std::move(connection_handle));
+                }
+                return;
+            }
+
+            case XcdrOp::SUBSCRIBE:
+            {
+                const std::string topic_name = reader.read_string();
+                const std::string type_name = reader.read_string();
+                const std::string id = reader.read_string();
+                SubscriptionOptions options;
+                options.throttle_rate = reader.read<uint32_t>();
+                options.queue_length = reader.read<uint32_t>();
+                options.fragment_size = reader.read<uint32_t>();
+
+                const xtypes::DynamicType* topic_type = get_type(type_name);
+                if (nullptr == topic_type)
+                {
+                    return;
+                }
+
+                endpoint.receive_subscribe_request_ws(
+                    topic_name,
+                    topic_type,
+                    id,
+                    options,
+                    std::move(connection_handle));
+                return;
+            }
+
+            case XcdrOp::ADVERTISE_SERVICE:
+            {
+                const std::string service_name = reader.read_string();
+                const std::string request_type = reader.read_string();
+                const std::string reply_type = reader.read_string();
+                const xtypes::DynamicType* req_type = get_type(request_type);
+                const xtypes::DynamicType* rep_type = get_type(reply_type);
+                if (nullptr == req_type || nullptr == rep_type)
+                {
+                    return;
+                }
+
+                endpoint.receive_service_advertisement_ws(
+                    service_name,
+                    *req_type,
+                    *rep_type,
+                    std::move(connection_handle));
+
+                register_service_types(service_name, request_type, reply_type);
+                return;
+            }
+
+            case XcdrOp::UNADVERTISE_SERVICE:
+            {
+                const std::string service_name = reader.read_string();
+                const xtypes::DynamicType* service_type = get_type(reader.read_string());
+                if (nullptr == service_type)
+                {
+                    return;
+                }
+
+                endpoint.receive_service_unadvertisement_ws(
+                    service_name,
+                    service_type,
+                    std::move(connection_handle));
+                return;
+            }
+        }
+
+        logger << utils::Logger::Level::ERROR
+               << "Unrecognized operation: '" << static_cast<int>(op) << "'" << std::endl;
+    }
+
+    void interpret_fragment(
+            CdrReader& reader,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle) const
+    {
+        const std::string id = reader.read_string();
+        const uint32_t num = reader.read<uint32_t>();
+        const uint32_t total = reader.read<uint32_t>();
+        std::vector<char> bytes;
+        reader.read_array(bytes, reader.read<uint32_t>());
+        std::string data(bytes.begin(), bytes.end());
+
+        std::string assembled;
+        switch (fragments_.add(connection_handle.get(), id, num, total, std::move(data), assembled))
+        {
+            case FragmentBuffer::Result::INCOMPLETE:
+                break;
+
+            case FragmentBuffer::Result::REJECTED:
+                logger << utils::Logger::Level::WARN
+                       << "Discarding fragment " << num << " of " << total << " of message '"
+                       << id << "', since it is invalid or the reassembly buffer is full"
+                       << std::endl;
+                break;
+
+            case FragmentBuffer::Result::COMPLETE:
+                IS_WEBSOCKET_LOG(logger, DEBUG)
+                    << "Reassembled message '" << id << "' from " << total
+                    << " fragments" << std::endl;
+
+                interpret_websocket_msg(assembled, endpoint, std::move(connection_handle));
+                break;
+        }
+    }
+
+    static void write_header(
+            CdrWriter& writer,
+            XcdrOp op,
+            uint8_t flags,
+            uint32_t name_hash,
+            uint32_t type_hash)
+    {
+        writer.write(XcdrVersion);
+        writer.write(static_cast<uint8_t>(op));
+        writer.write(static_cast<uint8_t>(flags | (CdrHostIsLittleEndian ? XcdrFlagLittleEndian : 0)));
+        writer.write(static_cast<uint8_t>(0));
+        writer.write(name_hash);
+        writer.write(type_hash);
+    }
+
+    /**
+     * @brief Get the hash of a type layout, computing it only the first time it is requested.
+     */
+    uint32_t get_type_hash(
+            const xtypes::DynamicType& type) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(types_mutex_);
+
+            auto it = type_hashes_.find(type.name());
+            if (it != type_hashes_.end())
+            {
+                return it->second;
+            }
+        }
+
+        const uint32_t type_hash = hash_type(type);
+
+        std::lock_guard<std::mutex> lock(types_mutex_);
+        type_hashes_[type.name()] = type_hash;
+        return type_hash;
+    }
+
+    bool check_type_hash(
+            const xtypes::DynamicType& type,
+            uint32_t type_hash,
+            const std::string& name) const
+    {
+        if (get_type_hash(type) == type_hash)
+        {
+            return true;
+        }
+
+        logger << utils::Logger::Level::ERROR
+               << "Incoming message for '" << name << "' was serialized with a type "
+               << "whose layout does not match the registered type '" << type.name()
+               << "'" << std::endl;
+
+        return false;
+    }
+
+    const xtypes::DynamicType* get_type(
+            const std::string& type_name) const
+    {
+        if (type_name.empty())
+        {
+            logger << utils::Logger::Level::WARN
+                   << "The 'type' property could not be fetched. Maybe you mispelled it?"
+                   << std::endl;
+            return nullptr;
+        }
+
+        const xtypes::DynamicType* type = types_.find_type(type_name);
+        if (nullptr != type)
+        {
+            return type;
+        }
+
+        logger << utils::Logger::Level::ERROR
+               << "Incoming message refers to an unregistered type: '"
+               << type_name << "'" << std::endl;
+
+        return nullptr;
+    }
+
+    const xtypes::DynamicType* get_service_type(
+            const std::string& service_name,
+            bool request) const
+    {
+        const xtypes::DynamicType* type = types_.service_type(service_name, request);
+        if (nullptr != type)
+        {
+            return type;
+        }
+
+        // Only reached for services that cannot be used, so it can afford a second lookup.
+        const std::string type_name = types_.service_type_name(service_name, request);
+        if (type_name.empty())
+        {
+            logger << utils::Logger::Level::ERROR
+                   << "There is not any registered service " << (request ? "request" : "reply")
+                   << " type for the service '" << service_name << "'" << std::endl;
+            return nullptr;
+        }
+        return get_type(type_name);
+    }
+
+    std::string get_topic_by_hash(
+            uint32_t name_hash) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(types_mutex_);
+
+            auto it = topics_by_hash_.find(name_hash);
+            if (it != topics_by_hash_.end())
+            {
+                return it->second;
+            }
+        }
+
+        logger << utils::Logger::Level::ERROR
+               << "Incoming publication refers to an unknown topic, with hash "
+               << name_hash << std::endl;
+
+        return std::string();
+    }
+
+    const xtypes::DynamicType* get_type_by_topic(
+            const std::string& topic_name) const
+    {
+        const xtypes::DynamicType* type = types_.topic_type(topic_name);
+        if (nullptr == type)
+        {
+            // Only reached for topics that cannot be used, so it can afford a second lookup.
+            return get_type(types_.topic_type_name(topic_name));
+        }
+        return type;
+    }
+
+    void register_topic_type(
+            const std::string& topic_name,
+            const std::string& topic_type) const
+    {
+        types_.register_topic(topic_name, topic_type);
+
+        const uint32_t name_hash = fnv1a(topic_name);
+
+        std::unique_lock<std::mutex> lock(types_mutex_);
+
+        auto result = topics_by_hash_.emplace(name_hash, topic_name);
+        if (!result.second && result.first->second != topic_name)
+        {
+            const std::string other_topic = result.first->second;
+            lock.unlock();
+
+            logger << utils::Logger::Level::ERROR
+                   << "The topics '" << topic_name << "' and '" << other_topic
+                   << "' have the same hash, publications to '" << topic_name
+                   << "' will be delivered to '" << other_topic << "'" << std::endl;
+        }
+    }
+
+    void register_service_types(
+            const std::string& service_name,
+            const std::string& request_type,
+            const std::string& reply_type) const
+    {
+        types_.register_service(service_name, request_type, reply_type);
+    }
+
+    /**
+     * The known types, and the types the topics and services are bound to.
+     * Messages may be interpreted and encoded by several threads at once: it is thread safe.
+     */
+    mutable TypeRegistry types_;
+
+    /**
+     * Instances where the incoming messages are decoded, reused from one message to the next.
+     * It is declared after the types, which it refers to. It is thread safe on its own.
+     */
+    mutable DataPool data_pool_;
+
+    mutable std::map<std::string, uint32_t> type_hashes_;
+    mutable std::map<uint32_t, std::string> topics_by_hash_;
+
+    /**
+     * Messages may be interpreted and encoded by several threads at once,
+     * so every access to the hash tables above must hold this mutex.
+     */
+    mutable std::mutex types_mutex_;
+
+    /**
+     * Incoming fragmented messages being reassembled. It is thread safe on its own.
+     */
+    mutable FragmentBuffer fragments_;
+
+};
+
+//==============================================================================
+EncodingPtr make_xcdr_encoding()
+{
+    return std::make_shared<XcdrEncoding>();
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
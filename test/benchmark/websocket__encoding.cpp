@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Compares the size of the encoded publications, and the time spent encoding them,
+// between the JSON and the CBOR encodings, for a sensor-like message made mostly of
+// a sequence of floats and a sequence of bytes.
+
+#include <Encoding.hpp>
+
+#include <xtypes/idl/idl.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace eprosima::is::sh::websocket;
+namespace xtypes = eprosima::xtypes;
+
+namespace {
+
+const std::string sensor_idl =
+        R"(
+struct SensorScan
+{
+    string frame_id;
+    uint32 stamp;
+    sequence<float> ranges;
+    sequence<uint8> intensities;
+};
+)";
+
+struct EncodingResult
+{
+    std::size_t bytes = 0;
+    double microseconds = 0.0;
+};
+
+EncodingResult encode(
+        const Encoding& encoding,
+        const xtypes::DynamicData& message,
+        const std::size_t iterations)
+{
+    EncodingResult result;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        result.bytes = encoding.encode_publication_msg("scan", "SensorScan", "", message).size();
+    }
+    result.microseconds = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+} // anonymous namespace
+
+int main(
+        int argc,
+        char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+
+    const auto types = xtypes::idl::parse(sensor_idl).get_all_types();
+    const xtypes::DynamicType& scan_type = *types.at("SensorScan");
+
+    const EncodingPtr json = make_json_encoding();
+    const EncodingPtr cbor = make_cbor_encoding();
+
+    std::cout << std::setw(10) << "elements"
+              << std::setw(16) << "JSON [B]"
+              << std::setw(16) << "CBOR [B]"
+              << std::setw(20) << "JSON [us/encode]"
+              << std::setw(20) << "CBOR [us/encode]" << std::endl;
+
+    for (const std::size_t elements : {16u, 1024u, 65536u})
+    {
+        xtypes::DynamicData scan(scan_type);
+        scan["frame_id"] = std::string("laser");
+        scan["stamp"] = static_cast<uint32_t>(1234);
+        for (std::size_t i = 0; i < elements; ++i)
+        {
+            scan["ranges"].push(0.001f * static_cast<float>(i) + 0.123456f);
+            scan["intensities"].push(static_cast<uint8_t>(i));
+        }
+
+        const EncodingResult json_result = encode(*json, scan, iterations);
+        const EncodingResult cbor_result = encode(*cbor, scan, iterations);
+
+        std::cout << std::setw(10) << elements
+                  << std::setw(16) << json_result.bytes
+                  << std::setw(16) << cbor_result.bytes
+                  << std::setw(20) << json_result.microseconds / iterations
+                  << std::setw(20) << cbor_result.microseconds / iterations << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Compares the amount of payload bytes copied, and the time spent, when fanning out
+// one publication to N connections using:
+//   - per connection send(std::string): the message is copied into a new message and
+//     then framed into a second one by the connection's processor, for each connection.
+//   - a shared frame: the message is framed once and the same frame is queued
+//     in every connection.
+
+#include <SharedFrame.hpp>
+
+#include <websocketpp/processors/hybi13.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+using MessageManager = TcpConfig::con_msg_manager_type;
+using Processor = websocketpp::processor::hybi13<TcpConfig>;
+
+struct FanOutResult
+{
+    std::size_t bytes_copied = 0;
+    double microseconds = 0.0;
+};
+
+// Each message object owns its own payload buffer, so every created message
+// accounts for a full copy of the payload.
+std::size_t copied_bytes(
+        const std::vector<MessagePtr>& messages)
+{
+    std::size_t bytes = 0;
+    for (const MessagePtr& message : messages)
+    {
+        bytes += message->get_payload().size();
+    }
+    return bytes;
+}
+
+FanOutResult per_connection_fan_out(
+        const std::string& payload,
+        const std::size_t connections,
+        const std::size_t iterations)
+{
+    MessageManager::ptr manager = std::make_shared<MessageManager>();
+    TcpConfig::rng_type rng;
+    Processor processor(false, true, manager, rng);
+
+    FanOutResult result;
+    std::vector<MessagePtr> queued;
+    queued.reserve(2 * connections);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        queued.clear();
+        for (std::size_t c = 0; c < connections; ++c)
+        {
+            // What websocketpp::connection::send(const std::string&) does.
+            MessagePtr message = manager->get_message(websocketpp::frame::opcode::text, payload.size());
+            message->append_payload(payload);
+
+            MessagePtr outgoing = manager->get_message();
+            processor.prepare_data_frame(message, outgoing);
+
+            queued.push_back(message);
+            queued.push_back(outgoing);
+        }
+        result.bytes_copied += copied_bytes(queued);
+    }
+    result.microseconds = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+FanOutResult shared_frame_fan_out(
+        const std::string& payload,
+        const std::size_t connections,
+        const std::size_t iterations)
+{
+    FanOutResult result;
+    std::vector<MessagePtr> queued;
+    queued.reserve(connections);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        queued.clear();
+        const MessagePtr frame = make_shared_frame(payload);
+        for (std::size_t c = 0; c < connections; ++c)
+        {
+            queued.push_back(frame);
+        }
+        result.bytes_copied += copied_bytes({frame});
+    }
+    result.microseconds = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+} // anonymous namespace
+
+int main(
+        int argc,
+        char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+
+    std::cout << std::setw(12) << "connections"
+              << std::setw(14) << "payload [B]"
+              << std::setw(26) << "copied/fan-out legacy [B]"
+              << std::setw(26) << "copied/fan-out shared [B]"
+              << std::setw(20) << "legacy [us/fan-out]"
+              << std::setw(20) << "shared [us/fan-out]" << std::endl;
+
+    for (const std::size_t connections : {1u, 10u, 200u})
+    {
+        for (const std::size_t payload_size : {64u, 4096u, 262144u})
+        {
+            const std::string payload(payload_size, 'x');
+
+            const FanOutResult legacy = per_connection_fan_out(payload, connections, iterations);
+            const FanOutResult shared = shared_frame_fan_out(payload, connections, iterations);
+
+            std::cout << std::setw(12) << connections
+                      << std::setw(14) << payload_size
+                      << std::setw(26) << legacy.bytes_copied / iterations
+                      << std::setw(26) << shared.bytes_copied / iterations
+                      << std::setw(20) << legacy.microseconds / iterations
+                      << std::setw(20) << shared.microseconds / iterations << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Compares the time spent decoding incoming JSON publications, as sent by field devices,
+// between building a JSON document and converting it with json-xtypes, decoding the
+// text straight into the dynamic data walking its type, doing so following the
+// codec plan of the type, and also reusing the instances from a pool, as the JSON encoding does.
+
+#include <CodecPlan.hpp>
+#include <DataPool.hpp>
+#include <Encoding.hpp>
+#include <JsonData.hpp>
+
+#include <is/json-xtypes/conversion.hpp>
+#include <is/json-xtypes/json.hpp>
+
+#include <xtypes/idl/idl.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+using namespace eprosima::is::sh::websocket;
+namespace xtypes = eprosima::xtypes;
+namespace json_xtypes = eprosima::is::json_xtypes;
+
+namespace {
+
+const std::string sensor_idl =
+        R"(
+struct SensorScan
+{
+    string frame_id;
+    uint32 stamp;
+    sequence<float> ranges;
+    sequence<uint8> intensities;
+};
+)";
+
+double decode_document(
+        const xtypes::DynamicType& type,
+        const std::string& message,
+        const std::size_t iterations)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        const json_xtypes::Json document = json_xtypes::Json::parse(message);
+        const xtypes::DynamicData data = json_xtypes::convert(type, document.at("msg"));
+        if (data["frame_id"].value<std::string>().empty())
+        {
+            std::abort();
+        }
+    }
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void decode_message(
+        const std::string& message,
+        xtypes::DynamicData& data,
+        const CodecPlan* plan)
+{
+    JsonReader reader(message.data(), message.size());
+    std::string key;
+    reader.begin_object();
+    while (reader.next_key(key))
+    {
+        if (key == "msg" && nullptr != plan)
+        {
+            read_json_data(reader, data, *plan);
+        }
+        else if (key == "msg")
+        {
+            read_json_data(reader, data);
+        }
+        else
+        {
+            reader.skip();
+        }
+    }
+
+    if (data["frame_id"].value<std::string>().empty())
+    {
+        std::abort();
+    }
+}
+
+double decode_streaming(
+        const xtypes::DynamicType& type,
+        const std::string& message,
+        const std::size_t iterations,
+        const CodecPlan* plan)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        xtypes::DynamicData data(type);
+        decode_message(message, data, plan);
+    }
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+double decode_pooled(
+        const xtypes::DynamicType& type,
+        const std::string& message,
+        const std::size_t iterations,
+        const CodecPlan* plan,
+        DataPool& pool)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        const DataPool::Lease data = pool.acquire(type);
+        decode_message(message, *data, plan);
+    }
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+int main(
+        int argc,
+        char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+
+    const auto types = xtypes::idl::parse(sensor_idl).get_all_types();
+    const xtypes::DynamicType& scan_type = *types.at("SensorScan");
+    const std::unique_ptr<CodecPlan> scan_plan = CodecPlan::compile(scan_type);
+
+    const EncodingPtr json = make_json_encoding();
+
+    std::cout << std::setw(10) << "elements"
+              << std::setw(16) << "JSON [B]"
+              << std::setw(24) << "document [us/decode]"
+              << std::setw(24) << "streaming [us/decode]"
+              << std::setw(24) << "planned [us/decode]"
+              << std::setw(24) << "pooled [us/decode]"
+              << std::setw(12) << "speedup" << std::endl;
+
+    for (const std::size_t elements : {16u, 1024u, 65536u})
+    {
+        xtypes::DynamicData scan(scan_type);
+        scan["frame_id"] = std::string("laser");
+        scan["stamp"] = static_cast<uint32_t>(1234);
+        for (std::size_t i = 0; i < elements; ++i)
+        {
+            scan["ranges"].push(0.001f * static_cast<float>(i) + 0.123456f);
+            scan["intensities"].push(static_cast<uint8_t>(i));
+        }
+
+        const std::string message = json->encode_publication_msg("scan", "SensorScan", "", scan);
+
+        const double document = decode_document(scan_type, message, iterations);
+        const double streaming = decode_streaming(scan_type, message, iterations, nullptr);
+        const double planned = decode_streaming(scan_type, message, iterations, scan_plan.get());
+
+        DataPool pool;
+        const double pooled = decode_pooled(scan_type, message, iterations, scan_plan.get(), pool);
+
+        std::cout << std::setw(10) << elements
+                  << std::setw(16) << message.size()
+                  << std::setw(24) << document / iterations
+                  << std::setw(24) << streaming / iterations
+                  << std::setw(24) << planned / iterations
+                  << std::setw(24) << pooled / iterations
+                  << std::setw(11) << document / pooled << "x" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+// Compares the time spent writing the JSON text of float heavy publications, such as
+// IMU readings, lidar summaries and trajectories, between the writer used by the JSON
+// encoding and a reference one that formats numbers with printf, increasing the precision
+// until they read back, and checks the characters of strings one by one to escape them.
+
+#include <JsonWriter.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+/**
+ * @class ReferenceWriter
+ *        Writes text of the same size as JsonWriter, in the straightforward way.
+ */
+class ReferenceWriter
+{
+public:
+
+    explicit ReferenceWriter(
+            std::string& buffer)
+        : _buffer(buffer)
+    {
+        // Do nothing
+    }
+
+    template<typename T>
+    void write_number(
+            T value)
+    {
+        char text[32];
+        for (int precision = std::numeric_limits<T>::digits10;
+                precision <= std::numeric_limits<T>::max_digits10; ++precision)
+        {
+            std::snprintf(text, sizeof(text), "%.*g", precision, static_cast<double>(value));
+            if (static_cast<T>(std::strtod(text, nullptr)) == value)
+            {
+                break;
+            }
+        }
+        _buffer.append(text);
+        _buffer.push_back(',');
+    }
+
+    void write_string(
+            const std::string& value)
+    {
+        _buffer.push_back('"');
+        for (const char c : value)
+        {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20)
+            {
+                _buffer.push_back('\\');
+            }
+            _buffer.push_back(c);
+        }
+        _buffer.append("\",");
+    }
+
+private:
+
+    std::string& _buffer;
+};
+
+/**
+ * @brief The contents of a message: a few strings, like frame ids and names,
+ *        and its numbers, either single or double precision.
+ */
+struct Shape
+{
+    const char* name;
+    std::vector<std::string> strings;
+    std::vector<float> floats;
+    std::vector<double> doubles;
+};
+
+std::vector<Shape> message_shapes()
+{
+    std::vector<Shape> shapes(3);
+
+    // sensor_msgs/Imu: orientation, angular velocity, linear acceleration and their covariances.
+    shapes[0].name = "imu";
+    shapes[0].strings = {"imu_link"};
+    for (int i = 0; i < 37; ++i)
+    {
+        shapes[0].doubles.push_back(0.0123456789 * i - 0.2);
+    }
+
+    // A lidar summary: ranges and intensities of a sweep.
+    shapes[1].name = "lidar_summary";
+    shapes[1].strings = {"laser_frame", "front lidar, firmware 1.4"};
+    for (int i = 0; i < 1440; ++i)
+    {
+        shapes[1].floats.push_back(0.25f + 0.0071f * static_cast<float>(i));
+    }
+
+    // A trajectory: named joints and their positions, velocities and times for 100 points.
+    shapes[2].name = "trajectory";
+    for (int i = 0; i < 6; ++i)
+    {
+        shapes[2].strings.push_back("arm_joint_" + std::to_string(i));
+    }
+    for (int i = 0; i < 1800; ++i)
+    {
+        shapes[2].doubles.push_back(0.001 * i * i / 7.0);
+    }
+
+    return shapes;
+}
+
+double encode_reference(
+        const Shape& shape,
+        std::size_t iterations,
+        std::size_t& size)
+{
+    std::string buffer;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        buffer.clear();
+        ReferenceWriter writer(buffer);
+        for (const std::string& value : shape.strings)
+        {
+            writer.write_string(value);
+        }
+        for (const float value : shape.floats)
+        {
+            writer.write_number(value);
+        }
+        for (const double value : shape.doubles)
+        {
+            writer.write_number(value);
+        }
+    }
+    size = buffer.size();
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+double encode_writer(
+        const Shape& shape,
+        std::size_t iterations,
+        std::size_t& size)
+{
+    std::string buffer;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        buffer.clear();
+        JsonWriter writer(buffer);
+        writer.begin_array();
+        for (const std::string& value : shape.strings)
+        {
+            writer.write_string(value);
+        }
+        for (const float value : shape.floats)
+        {
+            writer.write_float(value);
+        }
+        for (const double value : shape.doubles)
+        {
+            writer.write_double(value);
+        }
+        writer.end_array();
+    }
+    size = buffer.size();
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+int main(
+        int argc,
+        char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+
+    std::cout << std::setw(16) << "message"
+              << std::setw(12) << "JSON [B]"
+              << std::setw(24) << "reference [us/encode]"
+              << std::setw(24) << "writer [us/encode]"
+              << std::setw(12) << "speedup" << std::endl;
+
+    for (const Shape& shape : message_shapes())
+    {
+        std::size_t reference_size = 0;
+        std::size_t writer_size = 0;
+        const double reference = encode_reference(shape, iterations, reference_size);
+        const double writer = encode_writer(shape, iterations, writer_size);
+
+        std::cout << std::setw(16) << shape.name
+                  << std::setw(12) << writer_size
+                  << std::setw(24) << reference / iterations
+                  << std::setw(24) << writer / iterations
+                  << std::setw(11) << reference / writer << "x" << std::endl;
+    }
+
+    return 0;
+}
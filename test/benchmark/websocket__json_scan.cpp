@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+// Compares the throughput of parsing incoming JSON messages of the usual shapes between
+// building a JSON document, as it was done before, and walking them with the streaming
+// reader used by the JSON encoding, whose strings are scanned with the SIMD instructions
+// the processor supports. It also compares the string scanner against the scalar one.
+
+#include <JsonReader.hpp>
+#include <JsonScan.hpp>
+
+#include <is/json-xtypes/json.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+namespace json_xtypes = eprosima::is::json_xtypes;
+
+namespace {
+
+std::string repeat(
+        const std::string& item,
+        std::size_t times)
+{
+    std::string items;
+    for (std::size_t i = 0; i < times; ++i)
+    {
+        items += (i == 0 ? "" : ",") + item;
+    }
+    return items;
+}
+
+/**
+ * @brief Messages with the shapes seen from field devices: small commands,
+ *        diagnostics made mostly of strings, and sensor readings made mostly of numbers.
+ */
+std::vector<std::pair<std::string, std::string>> message_shapes()
+{
+    return {
+        {"command", R"({"op":"publish","topic":"cmd_vel","msg":{"linear":{"x":0.5,"y":0,"z":0},)"
+            R"("angular":{"x":0,"y":0,"z":-0.25}}})"},
+        {"diagnostics", R"({"op":"publish","topic":"diagnostics","msg":{"status":[)"
+            + repeat(R"({"level":0,"name":"motor_controller: left wheel","message":)"
+                R"("Temperature nominal, current within the expected range for the load",)"
+                R"("hardware_id":"mc-0042-left","values":[{"key":"temperature","value":"41.5 C"},)"
+                R"({"key":"firmware","value":"v2.3.1 build 2020-11-04"}]})", 32)
+            + "]}}"},
+        {"call_service", R"({"op":"call_service","service":"set_map","id":"call_service:set_map:7",)"
+            R"("args":{"map_name":")" + std::string(4096, 'm') + R"(","description":")"
+            + std::string(16384, 'd') + R"("}})"},
+        {"scan", R"({"op":"publish","topic":"scan","msg":{"frame_id":"laser","ranges":[)"
+            + repeat("1.2345678", 4096) + "]}}"},
+    };
+}
+
+template<typename Parse>
+double megabytes_per_second(
+        const std::string& message,
+        std::size_t iterations,
+        Parse parse)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        parse(message);
+    }
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(message.size() * iterations) / seconds / 1e6;
+}
+
+} // anonymous namespace
+
+int main(
+        int argc,
+        char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+
+    std::cout << "String scanner: " << json_scan_backend() << std::endl << std::endl;
+
+    std::cout << std::setw(14) << "message"
+              << std::setw(12) << "size [B]"
+              << std::setw(20) << "document [MB/s]"
+              << std::setw(20) << "streaming [MB/s]" << std::endl;
+
+    for (const auto& shape : message_shapes())
+    {
+        const double document = megabytes_per_second(shape.second, iterations,
+                [](const std::string& message)
+                {
+                    if (json_xtypes::Json::parse(message).empty())
+                    {
+                        std::abort();
+                    }
+                });
+
+        const double streaming = megabytes_per_second(shape.second, iterations,
+                [](const std::string& message)
+                {
+                    JsonReader reader(message.data(), message.size());
+                    reader.skip();
+                    if (!reader.at_end())
+                    {
+                        std::abort();
+                    }
+                });
+
+        std::cout << std::setw(14) << shape.first
+                  << std::setw(12) << shape.second.size()
+                  << std::setw(20) << document
+                  << std::setw(20) << streaming << std::endl;
+    }
+
+    const std::string text(1 << 20, 'x');
+    std::cout << std::endl << std::setw(14) << "string"
+              << std::setw(12) << text.size()
+              << std::setw(20) << "scalar [MB/s]"
+              << std::setw(20) << "scanner [MB/s]" << std::endl;
+
+    const double scalar = megabytes_per_second(text, iterations / 10 + 1,
+            [](const std::string& message)
+            {
+                if (scan_json_string_scalar(message.data(), message.size()) != message.size())
+                {
+                    std::abort();
+                }
+            });
+    const double scanner = megabytes_per_second(text, iterations / 10 + 1,
+            [](const std::string& message)
+            {
+                if (scan_json_string(message.data(), message.size()) != message.size())
+                {
+                    std::abort();
+                }
+            });
+
+    std::cout << std::setw(46) << scalar
+              << std::setw(20) << scanner << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <is/sh/mock/api.hpp>
+#include <is/core/Instance.hpp>
+#include <is/utils/Convert.hpp>
+#include <is/utils/Log.hpp>
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace is = eprosima::is;
+namespace xtypes = eprosima::xtypes;
+
+static is::utils::Logger logger("is::sh::WebSocket::test::concurrency");
+
+namespace {
+
+void wait_for_connections()
+{
+    using namespace std::chrono_literals;
+
+    logger << is::utils::Logger::Level::INFO
+           << "Waiting to make sure the clients have time to connect..." << std::endl;
+
+    std::this_thread::sleep_for(5s);
+
+    logger << is::utils::Logger::Level::INFO
+           << "Done waiting!" << std::endl;
+}
+
+/**
+ * Checks that each of the given sequences holds every number up to count, in order.
+ */
+void expect_all_in_order(
+        const std::map<uint32_t, std::vector<uint32_t> >& numbers,
+        const uint32_t clients,
+        const uint32_t count)
+{
+    ASSERT_EQ(clients, numbers.size());
+    for (const auto& entry : numbers)
+    {
+        SCOPED_TRACE(entry.first);
+        ASSERT_EQ(count, entry.second.size());
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            EXPECT_EQ(i, entry.second[i]);
+        }
+    }
+}
+
+/**
+ * Each client publishes count messages from a thread of its own, through the topic
+ * "into_client_<n>", into the topic "from_clients" of the server.
+ */
+void run_publications_from_clients(
+        is::core::InstanceHandle& handle,
+        const uint32_t clients,
+        const uint32_t count)
+{
+    using namespace std::chrono_literals;
+
+    std::mutex mutex;
+    std::condition_variable received_all;
+    std::map<uint32_t, std::vector<uint32_t> > numbers;
+    std::size_t received = 0;
+    ASSERT_TRUE(is::sh::mock::subscribe(
+                "from_clients",
+                [&](const xtypes::DynamicData& message)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    numbers[message["client"].value<uint32_t>()].push_back(message["number"].value<uint32_t>());
+                    ++received;
+                    received_all.notify_all();
+                }));
+
+    const is::TypeRegistry& mock_types = *handle.type_registry("mock");
+
+    std::vector<std::thread> publishers;
+    for (uint32_t client = 1; client <= clients; ++client)
+    {
+        publishers.emplace_back([&mock_types, client, count]()
+                {
+                    const std::string topic = "into_client_" + std::to_string(client);
+                    xtypes::DynamicData message(*mock_types.at("Sample"));
+                    message["client"] = client;
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        message["number"] = i;
+                        is::sh::mock::publish_message(topic, message);
+                    }
+                });
+    }
+
+    for (std::thread& publisher : publishers)
+    {
+        publisher.join();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(received_all.wait_for(lock, 10s, [&]()
+            {
+                return received >= clients * count;
+            }));
+
+    // Nothing is lost, and each connection keeps the order of its own publications.
+    EXPECT_EQ(clients * count, received);
+    expect_all_in_order(numbers, clients, count);
+}
+
+/**
+ * The server publishes count messages into the topic "to_clients", which each client
+ * forwards to the topic "to_client_<n>".
+ */
+void run_publications_to_clients(
+        is::core::InstanceHandle& handle,
+        const uint32_t clients,
+        const uint32_t count)
+{
+    using namespace std::chrono_literals;
+
+    std::mutex mutex;
+    std::condition_variable received_all;
+    std::map<uint32_t, std::vector<uint32_t> > numbers;
+    std::size_t received = 0;
+    for (uint32_t client = 1; client <= clients; ++client)
+    {
+        ASSERT_TRUE(is::sh::mock::subscribe(
+                    "to_client_" + std::to_string(client),
+                    [&, client](const xtypes::DynamicData& message)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        numbers[client].push_back(message["number"].value<uint32_t>());
+                        ++received;
+                        received_all.notify_all();
+                    }));
+    }
+
+    const is::TypeRegistry& mock_types = *handle.type_registry("mock");
+    xtypes::DynamicData message(*mock_types.at("Sample"));
+    message["client"] = 0u;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        message["number"] = i;
+        is::sh::mock::publish_message("into_server", message);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(received_all.wait_for(lock, 10s, [&]()
+            {
+                return received >= clients * count;
+            }));
+
+    // Every client gets every publication, in order, whichever shard it is connected to.
+    EXPECT_EQ(clients * count, received);
+    expect_all_in_order(numbers, clients, count);
+}
+
+} // anonymous namespace
+
+TEST(WebSocket, Threaded_server_receives_from_several_clients_at_once)
+{
+    // The server runs 4 threads, and each client publishes from a thread of its own
+    // into the same topic, so the frames of different connections are handled at once.
+    is::core::InstanceHandle handle = is::run_instance(WEBSOCKET__THREADS__TEST_CONFIG);
+    ASSERT_TRUE(handle);
+
+    wait_for_connections();
+
+    run_publications_from_clients(handle, 4, 200);
+
+    EXPECT_EQ(handle.quit().wait(), 0);
+}
+
+TEST(WebSocket, Sharded_server_reaches_the_clients_of_every_shard)
+{
+    // The server listens with 2 shards, and the operating system spreads the 6 clients
+    // between their sockets, so the publications must reach the connections of both.
+    is::core::InstanceHandle handle = is::run_instance(WEBSOCKET__SHARDS__TEST_CONFIG);
+    ASSERT_TRUE(handle);
+
+    wait_for_connections();
+
+    run_publications_from_clients(handle, 6, 100);
+    run_publications_to_clients(handle, 6, 100);
+
+    EXPECT_EQ(handle.quit().wait(), 0);
+}
+
+int main(
+        int argc,
+        char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <is/sh/mock/api.hpp>
+#include <is/core/Instance.hpp>
+#include <is/utils/Convert.hpp>
+#include <is/utils/Log.hpp>
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace is = eprosima::is;
+namespace xtypes = eprosima::xtypes;
+
+static is::utils::Logger logger("is::sh::WebSocket::test::throttle");
+
+TEST(WebSocket, Throttled_subscriptions_keep_their_rate)
+{
+    using namespace std::chrono_literals;
+
+    // The client subscribes with a throttle_rate of 20 ms and a queue_length of 100,
+    // and the publications are sent every 10 ms, so they are held back and then
+    // released one every 20 ms, not one every time the endpoint spins.
+    const uint32_t count = 25;
+    const auto throttle_rate = 20ms;
+
+    is::core::InstanceHandle handle = is::run_instance(WEBSOCKET__THROTTLE__TEST_CONFIG);
+    ASSERT_TRUE(handle);
+
+    logger << is::utils::Logger::Level::INFO
+           << "Waiting to make sure the client has time to connect..." << std::endl;
+
+    std::this_thread::sleep_for(5s);
+
+    logger << is::utils::Logger::Level::INFO
+           << "Done waiting!" << std::endl;
+
+    std::mutex mutex;
+    std::condition_variable received_all;
+    std::vector<uint32_t> numbers;
+    std::vector<std::chrono::steady_clock::time_point> arrivals;
+    ASSERT_TRUE(is::sh::mock::subscribe(
+                "throttled",
+                [&](const xtypes::DynamicData& message)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    numbers.push_back(message["number"].value<uint32_t>());
+                    arrivals.push_back(std::chrono::steady_clock::now());
+                    received_all.notify_all();
+                }));
+
+    const is::TypeRegistry& mock_types = *handle.type_registry("mock");
+    xtypes::DynamicData message(*mock_types.at("Sample"));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        message["number"] = i;
+        is::sh::mock::publish_message("throttle_into_server", message);
+        std::this_thread::sleep_for(10ms);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(received_all.wait_for(lock, 5s, [&]()
+            {
+                return numbers.size() >= count;
+            }));
+
+    // Nothing is dropped nor reordered, since the queue is long enough.
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(i, numbers[i]);
+    }
+
+    // Releasing them from the spinning thread, every 100 ms, would take about 2.4 s.
+    EXPECT_LT(arrivals.back() - start, 1500ms);
+    EXPECT_GE(arrivals.back() - arrivals.front(), (count - 1) * throttle_rate - 50ms);
+
+    lock.unlock();
+    EXPECT_EQ(handle.quit().wait(), 0);
+}
+
+int main(
+        int argc,
+        char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
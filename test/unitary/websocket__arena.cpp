@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <Arena.hpp>
+#include <JsonIndex.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+/**
+ * Number of allocations made by the calling thread through the global operator new,
+ * which is replaced below in order to count them. This test is built as an executable
+ * of its own, so the replacement does not affect any other test.
+ */
+thread_local std::size_t allocations = 0;
+
+void* counted_allocation(
+        std::size_t size)
+{
+    ++allocations;
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+} // anonymous namespace
+
+// Every form of the unaligned operators is replaced, so that all of them allocate and free
+// the same way and memory is never released by an operator not matching the one that allocated it.
+void* operator new(
+        std::size_t size)
+{
+    return counted_allocation(size);
+}
+
+void* operator new[](
+        std::size_t size)
+{
+    return counted_allocation(size);
+}
+
+void operator delete(
+        void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](
+        void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(
+        void* memory,
+        std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](
+        void* memory,
+        std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+TEST(Arena, Aligns_and_reuses_its_memory)
+{
+    Arena arena(256);
+
+    const Arena::Mark start = arena.mark();
+    char* first = static_cast<char*>(arena.allocate(3, 1));
+    void* aligned = arena.allocate(sizeof(double), alignof(double));
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(aligned) % alignof(double));
+    EXPECT_LE(first + 3, static_cast<char*>(aligned));
+
+    // Allocations larger than the blocks get a block of their own.
+    EXPECT_NE(nullptr, arena.allocate(1000, 1));
+    const std::size_t capacity = arena.capacity();
+    EXPECT_GE(capacity, 1256u);
+
+    arena.rewind(start);
+    EXPECT_EQ(first, arena.allocate(3, 1));
+    EXPECT_NE(nullptr, arena.allocate(1000, 1));
+    EXPECT_EQ(capacity, arena.capacity());
+}
+
+TEST(Arena, Releases_only_the_allocations_of_nested_scopes)
+{
+    Arena arena;
+
+    const ArenaScope outer(arena);
+    std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(arena)};
+    values.assign({1, 2, 3});
+
+    void* inner_allocation = nullptr;
+    {
+        const ArenaScope inner(arena);
+        inner_allocation = arena.allocate(64, 8);
+    }
+
+    // The memory of the inner scope is handed out again, and that of the outer one is kept.
+    EXPECT_EQ(inner_allocation, arena.allocate(64, 8));
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), std::vector<int>(values.begin(), values.end()));
+}
+
+TEST(Arena, Indexes_messages_without_allocating)
+{
+    const std::string message =
+            R"({"op":"publish","id":"publish:/a_rather_long_topic_name:42",)"
+            R"("topic":"/a_rather_long_topic_name","a_member_with_a_long_key":[1,2,3],)"
+            R"("msg":{"data":"hello","stamp":{"sec":1,"nanosec":2}}})";
+    const std::string msg_key = "msg";
+    const std::string long_key = "a_member_with_a_long_key";
+
+    Arena arena;
+    std::string topic;
+    const auto handle_message = [&]()
+            {
+                const ArenaScope scope(arena);
+                const JsonIndex index(message.data(), message.size(), arena);
+                index.at("topic").read_string(topic);
+                return index.find(msg_key) != nullptr && index.find(long_key) != nullptr;
+            };
+
+    // The first message grows the arena and the buffers to the size needed.
+    ASSERT_TRUE(handle_message());
+    const std::size_t capacity = arena.capacity();
+
+    const std::size_t messages = 100;
+    const std::size_t before = allocations;
+    for (std::size_t i = 0; i < messages; ++i)
+    {
+        ASSERT_TRUE(handle_message());
+    }
+    const std::size_t per_message = (allocations - before) / messages;
+
+    EXPECT_EQ(0u, per_message);
+    EXPECT_EQ(capacity, arena.capacity());
+    EXPECT_EQ("/a_rather_long_topic_name", topic);
+}
+
+TEST(Arena, Rejects_malformed_messages)
+{
+    const std::string trailing = R"({"op":"publish"} {})";
+    EXPECT_THROW(JsonIndex(trailing.data(), trailing.size()), JsonError);
+
+    const std::string array = R"(["op","publish"])";
+    EXPECT_THROW(JsonIndex(array.data(), array.size()), JsonError);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <Base64.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+std::string encode(
+        const std::vector<uint8_t>& data)
+{
+    std::string text(base64_encoded_size(data.size()), '\0');
+    base64_encode(data.data(), data.size(), &text[0]);
+    return text;
+}
+
+bool decode(
+        const std::string& text,
+        std::vector<uint8_t>& data)
+{
+    data.resize(base64_decoded_size(text.size()));
+    std::size_t decoded = 0;
+    const bool valid = base64_decode(text.data(), text.size(), data.data(), decoded);
+    data.resize(decoded);
+    return valid;
+}
+
+} // anonymous namespace
+
+TEST(Base64, Encodes_and_decodes_the_test_vectors)
+{
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"}};
+
+    for (const auto& vector : vectors)
+    {
+        const std::vector<uint8_t> bytes(vector.first.begin(), vector.first.end());
+        EXPECT_EQ(vector.second, encode(bytes));
+
+        std::vector<uint8_t> decoded;
+        ASSERT_TRUE(decode(vector.second, decoded));
+        EXPECT_EQ(bytes, decoded);
+    }
+
+    // The padding may be omitted.
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(decode("Zm9vYg", decoded));
+    EXPECT_EQ(std::string("foob"), std::string(decoded.begin(), decoded.end()));
+}
+
+TEST(Base64, Matches_the_scalar_codec_at_any_length)
+{
+    // Lengths around the 12 and 24 bytes encoded at once, so that every block
+    // and every tail is covered, with all the byte values.
+    for (std::size_t length = 0; length <= 300; ++length)
+    {
+        std::vector<uint8_t> bytes(length);
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(i * 7 + length);
+        }
+
+        const std::string text = encode(bytes);
+        std::string scalar(base64_encoded_size(length), '\0');
+        base64_encode_scalar(bytes.data(), bytes.size(), &scalar[0]);
+        EXPECT_EQ(scalar, text) << base64_backend() << ", length " << length;
+
+        std::vector<uint8_t> decoded;
+        ASSERT_TRUE(decode(text, decoded)) << base64_backend() << ", length " << length;
+        EXPECT_EQ(bytes, decoded);
+    }
+}
+
+TEST(Base64, Rejects_invalid_text)
+{
+    const std::string valid = encode(std::vector<uint8_t>(90, 0xA5));
+    for (const char invalid : {'=', '-', '_', ' ', '\n', '\0', '\x80', '\xFF'})
+    {
+        // A '=' in the last position would just be padding.
+        for (std::size_t position = 0; position + 1 < valid.size(); ++position)
+        {
+            std::string text = valid;
+            text[position] = invalid;
+            std::vector<uint8_t> decoded;
+            EXPECT_FALSE(decode(text, decoded))
+                << base64_backend() << ", character " << int(invalid) << " at " << position;
+        }
+    }
+
+    std::vector<uint8_t> decoded;
+    EXPECT_FALSE(decode("Zm9vY", decoded));
+    EXPECT_FALSE(decode("Zm9vYg=", decoded));
+    EXPECT_FALSE(decode("Zm9vY===", decoded));
+}
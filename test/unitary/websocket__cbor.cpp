@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <Cbor.hpp>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(Cbor, Uses_the_shortest_head)
+{
+    std::string buffer;
+    CborWriter writer(buffer);
+
+    writer.write_uint(23);
+    writer.write_uint(24);
+    writer.write_int(-1);
+    writer.write_uint(1000);
+    EXPECT_EQ(std::string("\x17\x18\x18\x20\x19\x03\xE8", 7), buffer);
+
+    buffer.clear();
+    writer.write_text("op");
+    EXPECT_EQ(std::string("\x62op"), buffer);
+}
+
+TEST(Cbor, Round_trips_scalars)
+{
+    std::string buffer;
+    CborWriter writer(buffer);
+
+    writer.begin_map(6);
+    writer.write_text("uint");
+    writer.write_uint(std::numeric_limits<uint64_t>::max());
+    writer.write_text("int");
+    writer.write_int(std::numeric_limits<int64_t>::min());
+    writer.write_text("float");
+    writer.write_float(1.5f);
+    writer.write_text("double");
+    writer.write_double(-0.1);
+    writer.write_text("bool");
+    writer.write_bool(true);
+    writer.write_text("null");
+    writer.write_null();
+
+    CborReader reader(buffer.data(), buffer.size());
+    ASSERT_EQ(6u, reader.read_map_header());
+    EXPECT_EQ("uint", reader.read_text());
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), reader.read_uint());
+    EXPECT_EQ("int", reader.read_text());
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), reader.read_int());
+    EXPECT_EQ("float", reader.read_text());
+    EXPECT_EQ(1.5, reader.read_double());
+    EXPECT_EQ("double", reader.read_text());
+    EXPECT_EQ(-0.1, reader.read_double());
+    EXPECT_EQ("bool", reader.read_text());
+    EXPECT_TRUE(reader.read_bool());
+    EXPECT_EQ("null", reader.read_text());
+    EXPECT_TRUE(reader.is_null());
+    reader.read_null();
+    EXPECT_TRUE(reader.at_end());
+}
+
+TEST(Cbor, Packs_typed_arrays)
+{
+    const std::vector<float> values = {0.5f, -1.25f, 3.0f, 1e10f};
+
+    std::string buffer;
+    CborWriter writer(buffer);
+    writer.write_typed_array(values.data(), values.size());
+
+    // Tag 85 (float32 little endian), then a byte string of the raw elements.
+    EXPECT_EQ(2u + 1u + values.size() * sizeof(float), buffer.size());
+
+    CborReader reader(buffer.data(), buffer.size());
+    std::vector<float> read;
+    reader.read_numbers(read);
+    EXPECT_EQ(values, read);
+    EXPECT_TRUE(reader.at_end());
+}
+
+TEST(Cbor, Reads_numbers_from_plain_arrays_and_byte_strings)
+{
+    std::string buffer;
+    CborWriter writer(buffer);
+    writer.begin_array(3);
+    writer.write_int(-2);
+    writer.write_uint(7);
+    writer.write_double(2.5);
+    const char bytes[] = {1, 2, 3};
+    writer.write_bytes(bytes, sizeof(bytes));
+
+    CborReader reader(buffer.data(), buffer.size());
+    std::vector<double> doubles;
+    reader.read_numbers(doubles);
+    EXPECT_EQ(std::vector<double>({-2.0, 7.0, 2.5}), doubles);
+
+    std::vector<uint8_t> octets;
+    reader.read_numbers(octets);
+    EXPECT_EQ(std::vector<uint8_t>({1, 2, 3}), octets);
+}
+
+TEST(Cbor, Reads_big_endian_typed_arrays)
+{
+    // Tag 65 (uint16 big endian) with the elements 1 and 258.
+    const std::string buffer("\xD8\x41\x44\x00\x01\x01\x02", 7);
+
+    CborReader reader(buffer.data(), buffer.size());
+    std::vector<uint16_t> values;
+    reader.read_numbers(values);
+    EXPECT_EQ(std::vector<uint16_t>({1, 258}), values);
+}
+
+TEST(Cbor, Skips_nested_items)
+{
+    std::string buffer;
+    CborWriter writer(buffer);
+    writer.begin_map(2);
+    writer.write_text("nested");
+    writer.begin_array(2);
+    writer.write_tag(1);
+    writer.write_uint(1234567890);
+    writer.begin_map(1);
+    writer.write_text("flag");
+    writer.write_bool(false);
+    writer.write_text("last");
+    writer.write_text("value");
+
+    CborReader reader(buffer.data(), buffer.size());
+    ASSERT_EQ(2u, reader.read_map_header());
+    EXPECT_EQ("nested", reader.read_text());
+    reader.skip();
+    EXPECT_EQ("last", reader.read_text());
+    EXPECT_EQ("value", reader.read_text());
+}
+
+TEST(Cbor, Rejects_malformed_items)
+{
+    // Text string claiming more bytes than available.
+    const std::string truncated("\x65" "ab", 3);
+    CborReader truncated_reader(truncated.data(), truncated.size());
+    EXPECT_THROW(truncated_reader.read_text(), CborError);
+
+    // Indefinite length array.
+    const std::string indefinite("\x9F\x01\xFF", 3);
+    CborReader indefinite_reader(indefinite.data(), indefinite.size());
+    EXPECT_THROW(indefinite_reader.read_array_header(), CborError);
+
+    // Wrong major type.
+    const std::string number("\x01", 1);
+    CborReader number_reader(number.data(), number.size());
+    EXPECT_THROW(number_reader.read_text(), CborError);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <Cdr.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(Cdr, Aligns_primitives_to_their_size)
+{
+    std::string buffer("header");
+    CdrWriter writer(buffer);
+
+    writer.write<uint8_t>(1);
+    writer.write<uint32_t>(2);
+    writer.write<uint16_t>(3);
+    writer.write<double>(4.0);
+
+    // Alignment is relative to the start of the stream, not of the buffer.
+    // 1 + 3 padding + 4 + 2 + 6 padding + 8
+    EXPECT_EQ(6u + 24u, buffer.size());
+
+    CdrReader reader(buffer.data() + 6, buffer.size() - 6, CdrHostIsLittleEndian);
+    EXPECT_EQ(1u, reader.read<uint8_t>());
+    EXPECT_EQ(2u, reader.read<uint32_t>());
+    EXPECT_EQ(3u, reader.read<uint16_t>());
+    EXPECT_EQ(4.0, reader.read<double>());
+    EXPECT_EQ(0u, reader.remaining());
+}
+
+TEST(Cdr, Round_trips_strings_and_arrays)
+{
+    const std::vector<float> values = {1.0f, -2.5f, 1e-3f};
+
+    std::string buffer;
+    CdrWriter writer(buffer);
+    writer.write_bool(true);
+    writer.write_string("topic");
+    writer.write<uint32_t>(static_cast<uint32_t>(values.size()));
+    writer.write_array(values.data(), values.size());
+    writer.write_string("");
+
+    CdrReader reader(buffer.data(), buffer.size(), CdrHostIsLittleEndian);
+    EXPECT_TRUE(reader.read_bool());
+    EXPECT_EQ("topic", reader.read_string());
+
+    std::vector<float> read;
+    reader.read_array(read, reader.read<uint32_t>());
+    EXPECT_EQ(values, read);
+    EXPECT_EQ("", reader.read_string());
+}
+
+TEST(Cdr, Reads_the_other_byte_order)
+{
+    const std::string big_endian("\x00\x00\x01\x02\x00\x03", 6);
+
+    CdrReader reader(big_endian.data(), big_endian.size(), false);
+    EXPECT_EQ(258u, reader.read<uint32_t>());
+
+    std::vector<uint16_t> values;
+    reader.read_array(values, 1);
+    EXPECT_EQ(std::vector<uint16_t>({3}), values);
+}
+
+TEST(Cdr, Rejects_truncated_streams)
+{
+    std::string buffer;
+    CdrWriter writer(buffer);
+    writer.write_string("truncated");
+    buffer.resize(buffer.size() - 2);
+
+    CdrReader reader(buffer.data(), buffer.size(), CdrHostIsLittleEndian);
+    EXPECT_THROW(reader.read_string(), CdrError);
+
+    CdrReader array_reader(buffer.data(), buffer.size(), CdrHostIsLittleEndian);
+    std::vector<uint64_t> values;
+    EXPECT_THROW(array_reader.read_array(values, 1000000), CdrError);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <ErrorRateLimiter.hpp>
+
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+using Report = std::tuple<const void*, InputError, uint64_t>;
+
+ErrorRateLimiter::Reporter collect(
+        std::vector<Report>& reports)
+{
+    return [&reports](const void* connection, InputError kind, uint64_t suppressed)
+           {
+               reports.emplace_back(connection, kind, suppressed);
+           };
+}
+
+} // anonymous namespace
+
+TEST(ErrorRateLimiter, Suppresses_errors_beyond_the_burst)
+{
+    ErrorRateLimiter limiter(3, std::chrono::seconds(10));
+    const auto start = ErrorRateLimiter::Clock::now();
+    const int connection = 0;
+
+    int logged = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        uint64_t suppressed = 0;
+        if (limiter.admit(&connection, InputError::MALFORMED, suppressed, start))
+        {
+            EXPECT_EQ(0u, suppressed);
+            ++logged;
+        }
+    }
+
+    EXPECT_EQ(3, logged);
+    EXPECT_EQ(100u, limiter.errors(InputError::MALFORMED));
+    EXPECT_EQ(97u, limiter.suppressed(InputError::MALFORMED));
+    EXPECT_EQ(0u, limiter.errors(InputError::MISSING_FIELD));
+}
+
+TEST(ErrorRateLimiter, Limits_each_connection_and_kind_apart)
+{
+    ErrorRateLimiter limiter(1, std::chrono::seconds(10));
+    const auto start = ErrorRateLimiter::Clock::now();
+    const int first = 0;
+    const int second = 0;
+
+    uint64_t suppressed = 0;
+    EXPECT_TRUE(limiter.admit(&first, InputError::MALFORMED, suppressed, start));
+    EXPECT_FALSE(limiter.admit(&first, InputError::MALFORMED, suppressed, start));
+    EXPECT_TRUE(limiter.admit(&first, InputError::UNKNOWN_TYPE, suppressed, start));
+    EXPECT_TRUE(limiter.admit(&second, InputError::MALFORMED, suppressed, start));
+    EXPECT_FALSE(limiter.admit(&second, InputError::MALFORMED, suppressed, start));
+}
+
+TEST(ErrorRateLimiter, Reports_the_suppressed_errors_with_the_next_logged_one)
+{
+    ErrorRateLimiter limiter(1, std::chrono::seconds(10));
+    const auto start = ErrorRateLimiter::Clock::now();
+    const int connection = 0;
+
+    uint64_t suppressed = 0;
+    EXPECT_TRUE(limiter.admit(&connection, InputError::MISSING_FIELD, suppressed, start));
+    for (int i = 0; i < 41; ++i)
+    {
+        EXPECT_FALSE(limiter.admit(&connection, InputError::MISSING_FIELD, suppressed,
+            start + std::chrono::seconds(9)));
+    }
+
+    ASSERT_TRUE(limiter.admit(&connection, InputError::MISSING_FIELD, suppressed,
+        start + std::chrono::seconds(10)));
+    EXPECT_EQ(41u, suppressed);
+
+    std::ostringstream note;
+    note << "Missing field" << SuppressedErrors{suppressed};
+    EXPECT_EQ("Missing field (suppressed 41 similar messages)", note.str());
+}
+
+TEST(ErrorRateLimiter, Reports_the_suppressed_errors_once_the_period_ends)
+{
+    ErrorRateLimiter limiter(1, std::chrono::seconds(10));
+    const auto start = ErrorRateLimiter::Clock::now();
+    const int connection = 0;
+
+    uint64_t suppressed = 0;
+    limiter.admit(&connection, InputError::UNKNOWN_OPERATION, suppressed, start);
+    limiter.admit(&connection, InputError::UNKNOWN_OPERATION, suppressed, start);
+    limiter.admit(&connection, InputError::INVALID_DATA, suppressed, start);
+
+    std::vector<Report> reports;
+    limiter.sweep(collect(reports), start + std::chrono::seconds(5));
+    EXPECT_TRUE(reports.empty());
+
+    // Periods without suppressed errors are forgotten without a report.
+    limiter.sweep(collect(reports), start + std::chrono::seconds(10));
+    ASSERT_EQ(1u, reports.size());
+    EXPECT_EQ(Report(&connection, InputError::UNKNOWN_OPERATION, 1), reports[0]);
+
+    reports.clear();
+    limiter.sweep(collect(reports), start + std::chrono::seconds(20));
+    EXPECT_TRUE(reports.empty());
+
+    // Once reported, the errors are not reported again with the next error logged.
+    ASSERT_TRUE(limiter.admit(&connection, InputError::UNKNOWN_OPERATION, suppressed,
+        start + std::chrono::seconds(20)));
+    EXPECT_EQ(0u, suppressed);
+}
+
+TEST(ErrorRateLimiter, Reports_the_suppressed_errors_of_closed_connections)
+{
+    ErrorRateLimiter limiter(1, std::chrono::seconds(10));
+    const auto start = ErrorRateLimiter::Clock::now();
+    const int closed = 0;
+    const int open = 0;
+
+    uint64_t suppressed = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        limiter.admit(&closed, InputError::MALFORMED, suppressed, start);
+        limiter.admit(&open, InputError::MALFORMED, suppressed, start);
+    }
+
+    std::vector<Report> reports;
+    limiter.forget(&closed, collect(reports));
+    ASSERT_EQ(1u, reports.size());
+    EXPECT_EQ(Report(&closed, InputError::MALFORMED, 2), reports[0]);
+
+    // A new connection reusing the address starts afresh.
+    EXPECT_TRUE(limiter.admit(&closed, InputError::MALFORMED, suppressed, start));
+    EXPECT_EQ(0u, suppressed);
+    EXPECT_FALSE(limiter.admit(&open, InputError::MALFORMED, suppressed, start));
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <FragmentBuffer.hpp>
+
+#include <memory>
+#include <string>
+
+using namespace eprosima::is::sh::websocket;
+
+using Result = FragmentBuffer::Result;
+
+namespace {
+
+// Bytes charged for the fragments held: their contents, an overhead for each one,
+// and the identifier of each message.
+std::size_t charged(
+        std::size_t contents,
+        std::size_t fragments,
+        std::size_t ids)
+{
+    return contents + fragments * FragmentBuffer::FragmentOverhead + ids;
+}
+
+} // anonymous namespace
+
+TEST(FragmentBuffer, Reassembles_out_of_order_fragments)
+{
+    FragmentBuffer buffer(1024, std::chrono::seconds(10));
+    const auto connection = std::make_shared<int>(0);
+    std::string message;
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "1", 2, 3, "ghi", message));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "1", 0, 3, "abc", message));
+    // Duplicated fragments are ignored.
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "1", 0, 3, "abc", message));
+    EXPECT_EQ(charged(6, 2, 1), buffer.bytes());
+
+    EXPECT_EQ(Result::COMPLETE, buffer.add(connection.get(), "1", 1, 3, "def", message));
+    EXPECT_EQ("abcdefghi", message);
+    EXPECT_EQ(0u, buffer.pending());
+    EXPECT_EQ(0u, buffer.bytes());
+}
+
+TEST(FragmentBuffer, Keeps_connections_apart)
+{
+    FragmentBuffer buffer(1024, std::chrono::seconds(10));
+    const auto first = std::make_shared<int>(0);
+    const auto second = std::make_shared<int>(0);
+    std::string message;
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(first.get(), "1", 0, 2, "first ", message));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(second.get(), "1", 0, 2, "second ", message));
+    EXPECT_EQ(2u, buffer.pending());
+
+    EXPECT_EQ(Result::COMPLETE, buffer.add(second.get(), "1", 1, 2, "message", message));
+    EXPECT_EQ("second message", message);
+    EXPECT_EQ(Result::COMPLETE, buffer.add(first.get(), "1", 1, 2, "message", message));
+    EXPECT_EQ("first message", message);
+}
+
+TEST(FragmentBuffer, Rejects_invalid_fragments)
+{
+    FragmentBuffer buffer(1024, std::chrono::seconds(10));
+    const auto connection = std::make_shared<int>(0);
+    std::string message;
+
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "1", 0, 0, "abc", message));
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "1", 3, 3, "abc", message));
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "1", -1, 3, "abc", message));
+    EXPECT_EQ(0u, buffer.pending());
+}
+
+TEST(FragmentBuffer, Evicts_expired_messages)
+{
+    FragmentBuffer buffer(1024, std::chrono::seconds(10));
+    const auto connection = std::make_shared<int>(0);
+    const auto start = FragmentBuffer::Clock::now();
+    std::string message;
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "1", 0, 2, "abc", message, start));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(
+                connection.get(), "2", 0, 2, "abc", message, start + std::chrono::seconds(5)));
+
+    // The first message timed out, so its last fragment starts it all over again.
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(
+                connection.get(), "1", 1, 2, "def", message, start + std::chrono::seconds(11)));
+    EXPECT_EQ(2u, buffer.pending());
+    EXPECT_EQ(charged(6, 2, 2), buffer.bytes());
+}
+
+TEST(FragmentBuffer, Bounds_the_buffered_bytes)
+{
+    FragmentBuffer buffer(charged(8, 2, 6), std::chrono::seconds(10));
+    const auto connection = std::make_shared<int>(0);
+    const auto start = FragmentBuffer::Clock::now();
+    std::string message;
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "old", 0, 2, "1234", message, start));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(
+                connection.get(), "new", 0, 2, "5678", message, start + std::chrono::seconds(1)));
+
+    // The oldest message is discarded to make room for the new fragment.
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(
+                connection.get(), "newest", 0, 2, "9", message, start + std::chrono::seconds(2)));
+    EXPECT_EQ(2u, buffer.pending());
+    EXPECT_EQ(charged(5, 2, 9), buffer.bytes());
+
+    // A message that would not fit even on its own is rejected.
+    EXPECT_EQ(Result::REJECTED, buffer.add(
+                connection.get(), "new", 1, 2, "abcdefghijk", message, start + std::chrono::seconds(3)));
+    EXPECT_EQ(1u, buffer.pending());
+    EXPECT_EQ(charged(1, 1, 6), buffer.bytes());
+}
+
+TEST(FragmentBuffer, Rejects_oversized_totals)
+{
+    const std::size_t max_fragments = 16;
+    FragmentBuffer buffer(max_fragments * FragmentBuffer::FragmentOverhead, std::chrono::seconds(10));
+    const auto connection = std::make_shared<int>(0);
+    std::string message;
+
+    // Nothing is allocated for the fragments that have not been received.
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "1", 0, 100000000, "abc", message));
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "2", 0, INT64_MAX, "abc", message));
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "3", 0, max_fragments + 1, "abc", message));
+    EXPECT_EQ(0u, buffer.pending());
+    EXPECT_EQ(0u, buffer.bytes());
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "4", 0, max_fragments, "", message));
+    EXPECT_EQ(charged(0, 1, 1), buffer.bytes());
+
+    // Empty fragments are charged too, so they cannot hold more memory than the limit.
+    for (int64_t num = 1; num < static_cast<int64_t>(max_fragments) - 1; ++num)
+    {
+        EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "4", num, max_fragments, "", message));
+    }
+    EXPECT_EQ(Result::REJECTED, buffer.add(connection.get(), "4", max_fragments - 1, max_fragments, "", message));
+    EXPECT_EQ(0u, buffer.pending());
+}
+
+TEST(FragmentBuffer, Evicts_expired_messages_without_more_fragments)
+{
+    FragmentBuffer buffer(1024, std::chrono::seconds(10));
+    const auto connection = std::make_shared<int>(0);
+    const auto start = FragmentBuffer::Clock::now();
+    std::string message;
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(connection.get(), "1", 0, 2, "abc", message, start));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(
+                connection.get(), "2", 0, 2, "abc", message, start + std::chrono::seconds(5)));
+
+    buffer.evict_expired(start + std::chrono::seconds(10));
+    EXPECT_EQ(2u, buffer.pending());
+
+    buffer.evict_expired(start + std::chrono::seconds(11));
+    EXPECT_EQ(1u, buffer.pending());
+    EXPECT_EQ(charged(3, 1, 1), buffer.bytes());
+}
+
+TEST(FragmentBuffer, Forgets_closed_connections)
+{
+    FragmentBuffer buffer(1024, std::chrono::seconds(10));
+    const auto closed = std::make_shared<int>(0);
+    const auto open = std::make_shared<int>(0);
+    std::string message;
+
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(closed.get(), "1", 0, 2, "abc", message));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(closed.get(), "2", 0, 2, "abc", message));
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(open.get(), "1", 0, 2, "first ", message));
+
+    buffer.forget(closed.get());
+    EXPECT_EQ(1u, buffer.pending());
+    EXPECT_EQ(charged(6, 1, 1), buffer.bytes());
+
+    // The fragments of the closed connection are gone, so its messages start over.
+    EXPECT_EQ(Result::INCOMPLETE, buffer.add(closed.get(), "1", 1, 2, "def", message));
+    EXPECT_EQ(Result::COMPLETE, buffer.add(open.get(), "1", 1, 2, "message", message));
+    EXPECT_EQ("first message", message);
+}
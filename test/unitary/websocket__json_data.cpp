@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <CodecPlan.hpp>
+#include <DataPool.hpp>
+#include <JsonData.hpp>
+
+#include <is/json-xtypes/conversion.hpp>
+#include <is/json-xtypes/json.hpp>
+
+#include <xtypes/idl/idl.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+namespace json_xtypes = eprosima::is::json_xtypes;
+
+namespace {
+
+const std::string sample_idl =
+        R"(
+enum Color
+{
+    RED,
+    GREEN,
+    BLUE
+};
+
+typedef uint32 Counter;
+
+struct Point
+{
+    double x;
+    double y;
+};
+
+struct Sample
+{
+    string name;
+    Counter count;
+    Color color;
+    Point origin;
+    Point corners[2];
+    sequence<Point> path;
+    sequence<int16, 3> bounded;
+    sequence<uint8> bytes;
+    int8 small;
+    boolean flag;
+    float ratio;
+};
+)";
+
+const xtypes::DynamicType& find_type(
+        const std::string& name)
+{
+    static const auto types = xtypes::idl::parse(sample_idl).get_all_types();
+    return *types.at(name);
+}
+
+const xtypes::DynamicType& sample_type()
+{
+    return find_type("Sample");
+}
+
+xtypes::DynamicData make_point(
+        double x,
+        double y)
+{
+    xtypes::DynamicData point(find_type("Point"));
+    point["x"] = x;
+    point["y"] = y;
+    return point;
+}
+
+xtypes::DynamicData make_sample()
+{
+    xtypes::DynamicData sample(sample_type());
+    sample["name"] = std::string("sample \"one\"\n");
+    sample["count"] = static_cast<uint32_t>(4000000000u);
+    sample["color"].value(static_cast<uint32_t>(2));
+    sample["origin"] = make_point(0.1, -2.5e-3);
+    sample["corners"][0] = make_point(1.0, 2.0);
+    sample["corners"][1] = make_point(-1.0, 1e300);
+    sample["path"].push(make_point(3.0, 4.0));
+    sample["path"].push(make_point(5.0, 6.0));
+    sample["bounded"].push(static_cast<int16_t>(-300));
+    sample["bounded"].push(static_cast<int16_t>(300));
+    for (int i = 0; i < 256; i += 15)
+    {
+        sample["bytes"].push(static_cast<uint8_t>(i));
+    }
+    sample["small"] = static_cast<int8_t>(-128);
+    sample["flag"] = true;
+    sample["ratio"] = 0.1f;
+    return sample;
+}
+
+std::string encode(
+        const xtypes::DynamicData& data,
+        const CodecPlan* plan,
+        ByteEncoding bytes = ByteEncoding::ARRAY)
+{
+    std::string text;
+    JsonWriter writer(text);
+    if (nullptr != plan)
+    {
+        write_json_data(writer, data, *plan, bytes);
+    }
+    else
+    {
+        write_json_data(writer, data, bytes);
+    }
+    return text;
+}
+
+void decode(
+        const std::string& text,
+        xtypes::DynamicData& data,
+        const CodecPlan* plan)
+{
+    JsonReader reader(text.data(), text.size());
+    if (nullptr != plan)
+    {
+        read_json_data(reader, data, *plan);
+    }
+    else
+    {
+        read_json_data(reader, data);
+    }
+}
+
+/**
+ * @brief Decode a text as json-xtypes does.
+ */
+xtypes::DynamicData convert(
+        const std::string& text)
+{
+    return json_xtypes::convert(sample_type(), json_xtypes::Json::parse(text));
+}
+
+/**
+ * @brief The plans the tests are run with: none, so that the data is read and written
+ *        walking its type, and the plan of the sample type.
+ */
+std::vector<const CodecPlan*> plans()
+{
+    static const std::unique_ptr<CodecPlan> plan = CodecPlan::compile(sample_type());
+    return {nullptr, plan.get()};
+}
+
+} // anonymous namespace
+
+TEST(JsonData, Writes_what_json_xtypes_reads)
+{
+    for (const CodecPlan* plan : plans())
+    {
+        SCOPED_TRACE(nullptr != plan ? "planned" : "walking the type");
+
+        const xtypes::DynamicData sample = make_sample();
+
+        const std::string text = encode(sample, plan);
+        EXPECT_TRUE(convert(text) == sample) << text;
+
+        // Apart from the order of the members and the digits of the numbers, the document is the same.
+        const json_xtypes::Json document = json_xtypes::Json::parse(text);
+        const json_xtypes::Json expected = json_xtypes::convert(sample);
+        for (const std::string& key : {"name", "count", "color", "path", "bounded", "bytes", "small"})
+        {
+            EXPECT_EQ(expected.at(key), document.at(key)) << key;
+        }
+    }
+}
+
+TEST(JsonData, Reads_what_json_xtypes_writes)
+{
+    for (const CodecPlan* plan : plans())
+    {
+        SCOPED_TRACE(nullptr != plan ? "planned" : "walking the type");
+
+        const xtypes::DynamicData sample = make_sample();
+        const std::string text = json_xtypes::convert(sample).dump();
+
+        xtypes::DynamicData data(sample_type());
+        decode(text, data, plan);
+
+        EXPECT_TRUE(data == sample) << text;
+        EXPECT_TRUE(data == convert(text)) << text;
+    }
+}
+
+TEST(JsonData, Reads_bytes_in_base64)
+{
+    for (const CodecPlan* plan : plans())
+    {
+        SCOPED_TRACE(nullptr != plan ? "planned" : "walking the type");
+
+        const xtypes::DynamicData sample = make_sample();
+
+        const std::string text = encode(sample, plan, ByteEncoding::BASE64);
+        EXPECT_NE(std::string::npos, text.find("\"bytes\":\"AA8eLTxLWml4h5altMPS4fD/\"")) << text;
+
+        xtypes::DynamicData data(sample_type());
+        decode(text, data, plan);
+        EXPECT_TRUE(data == sample) << text;
+    }
+}
+
+TEST(JsonData, Skips_unknown_members)
+{
+    for (const CodecPlan* plan : plans())
+    {
+        SCOPED_TRACE(nullptr != plan ? "planned" : "walking the type");
+
+        const std::string text =
+                R"({"unknown": {"nested": [1, "two", {"three": null}]}, "name": "known",)"
+                R"( "path": [{"x": 1, "z": [true], "y": 2}], "extra": 3.5})";
+
+        xtypes::DynamicData data(sample_type());
+        decode(text, data, plan);
+
+        xtypes::DynamicData expected(sample_type());
+        expected["name"] = std::string("known");
+        expected["path"].push(make_point(1.0, 2.0));
+        EXPECT_TRUE(data == expected);
+        EXPECT_TRUE(data == convert(R"({"name": "known", "path": [{"x": 1, "y": 2}]})"));
+    }
+}
+
+TEST(JsonData, Resets_the_members_missing_from_pooled_instances)
+{
+    for (const CodecPlan* plan : plans())
+    {
+        SCOPED_TRACE(nullptr != plan ? "planned" : "walking the type");
+
+        DataPool pool;
+        {
+            const DataPool::Lease lease = pool.acquire(sample_type());
+            decode(json_xtypes::convert(make_sample()).dump(), *lease, plan);
+        }
+        ASSERT_EQ(1u, pool.idle());
+
+        // The instance is reused, and the members missing from the message have their default value,
+        // not the one of the previous message.
+        const DataPool::Lease lease = pool.acquire(sample_type());
+        EXPECT_EQ(0u, pool.idle());
+        decode(R"({"name": "second", "bounded": [7]})", *lease, plan);
+
+        xtypes::DynamicData expected(sample_type());
+        expected["name"] = std::string("second");
+        expected["bounded"].push(static_cast<int16_t>(7));
+        EXPECT_TRUE(*lease == expected);
+    }
+}
+
+TEST(JsonData, Rejects_out_of_range_integers)
+{
+    for (const CodecPlan* plan : plans())
+    {
+        SCOPED_TRACE(nullptr != plan ? "planned" : "walking the type");
+
+        for (const std::string& text : {
+                    R"({"small": 128})",
+                    R"({"small": -129})",
+                    R"({"count": -1})",
+                    R"({"count": 4294967296})",
+                    R"({"bounded": [32768]})",
+                    R"({"bounded": [1, 2, 3, 4]})",
+                    R"({"bytes": [256]})"})
+        {
+            xtypes::DynamicData data(sample_type());
+            EXPECT_THROW(decode(text, data, plan), JsonError) << text;
+        }
+
+        xtypes::DynamicData data(sample_type());
+        decode(R"({"small": -128, "count": 4294967295, "bounded": [-32768, 32767, 0]})", data, plan);
+        EXPECT_EQ(-128, data["small"].value<int8_t>());
+        EXPECT_EQ(4294967295u, data["count"].value<uint32_t>());
+        EXPECT_EQ(3u, data["bounded"].size());
+    }
+}
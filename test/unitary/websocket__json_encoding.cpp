@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <Endpoint.hpp>
+
+#include <is/json-xtypes/json.hpp>
+
+#include <xtypes/idl/idl.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+namespace is = eprosima::is;
+namespace json_xtypes = eprosima::is::json_xtypes;
+
+namespace {
+
+const std::string greeting_idl =
+        R"(
+struct Greeting
+{
+    string text;
+    uint32 count;
+};
+
+struct Farewell
+{
+    string text;
+};
+)";
+
+const xtypes::DynamicType& find_type(
+        const std::string& name)
+{
+    static const auto types = xtypes::idl::parse(greeting_idl).get_all_types();
+    return *types.at(name);
+}
+
+xtypes::DynamicData make_greeting(
+        const std::string& text,
+        uint32_t count)
+{
+    xtypes::DynamicData greeting(find_type("Greeting"));
+    greeting["text"] = text;
+    greeting["count"] = count;
+    return greeting;
+}
+
+/**
+ * Endpoint without any transport, which hands the incoming messages to its encoding
+ * and collects the publications delivered to the *Integration Service*.
+ */
+class LoopbackEndpoint : public Endpoint
+{
+public:
+
+    LoopbackEndpoint()
+        : Endpoint("is::sh::WebSocket::Test::LoopbackEndpoint")
+    {
+        is::TypeRegistry types;
+        configure(is::core::RequiredTypes(), YAML::Load("encoding: json"), types);
+    }
+
+    void subscribe_to(
+            const std::string& topic_name,
+            const std::string& type_name = "Greeting")
+    {
+        subscribe(topic_name, find_type(type_name), &_callback, YAML::Node());
+    }
+
+    void receive(
+            const std::string& message,
+            const std::shared_ptr<void>& connection_handle)
+    {
+        get_encoding().interpret_websocket_msg(message, *this, connection_handle);
+    }
+
+    using Endpoint::get_encoding;
+    using Endpoint::notify_connection_closed;
+    using Endpoint::publication_drop_stats;
+
+    bool okay() const override
+    {
+        return true;
+    }
+
+    bool spin_once() override
+    {
+        return true;
+    }
+
+    void runtime_advertisement(
+            const std::string& /*topic*/,
+            const xtypes::DynamicType& /*message_type*/,
+            const std::string& /*id*/,
+            const YAML::Node& /*configuration*/) override
+    {
+        // Do nothing
+    }
+
+    std::vector<xtypes::DynamicData> received;
+
+protected:
+
+    ErrorCode send(
+            const std::shared_ptr<void>& /*connection_handle*/,
+            const std::string& /*payload*/) override
+    {
+        return ErrorCode();
+    }
+
+    void fan_out(
+            const std::string& /*topic*/,
+            const std::vector<std::shared_ptr<void> >& /*connections*/,
+            const std::string& /*payload*/,
+            const Encoding& /*encoding*/) override
+    {
+        // Do nothing
+    }
+
+    void fan_out_fragments(
+            const std::string& /*topic*/,
+            const std::vector<std::shared_ptr<void> >& /*connections*/,
+            const std::vector<std::string>& /*fragments*/,
+            const Encoding& /*encoding*/) override
+    {
+        // Do nothing
+    }
+
+    void schedule(
+            const std::shared_ptr<void>& /*connection_handle*/,
+            std::chrono::milliseconds /*delay*/,
+            std::function<void()> /*callback*/) override
+    {
+        // Do nothing
+    }
+
+private:
+
+    bool configure_endpoint(
+            const is::core::RequiredTypes& /*types*/,
+            const YAML::Node& /*configuration*/) override
+    {
+        return true;
+    }
+
+    SubscriptionCallback _callback = [this](const xtypes::DynamicData& message, void* /*filter_handle*/)
+            {
+                received.push_back(message);
+            };
+};
+
+} // anonymous namespace
+
+TEST(JsonEncoding, Splits_fragments_on_character_boundaries)
+{
+    const EncodingPtr encoding = make_json_encoding();
+
+    // Two, three and four byte characters, none of which may be split.
+    const std::string payload = u8"{\"text\":\"añb€c\U0001F600d\"}";
+    for (std::size_t fragment_size : {1u, 2u, 3u, 4u, 5u, 1000u})
+    {
+        SCOPED_TRACE(fragment_size);
+
+        const std::vector<std::string> fragments = encoding->encode_fragments(payload, "7", fragment_size);
+        ASSERT_FALSE(fragments.empty());
+
+        std::string reassembled;
+        for (std::size_t num = 0; num < fragments.size(); ++num)
+        {
+            // Each fragment must be valid JSON, which requires its data to be valid UTF-8.
+            const json_xtypes::Json fragment = json_xtypes::Json::parse(fragments[num]);
+            EXPECT_EQ("fragment", fragment.at("op").get<std::string>());
+            EXPECT_EQ("7", fragment.at("id").get<std::string>());
+            EXPECT_EQ(num, fragment.at("num").get<std::size_t>());
+            EXPECT_EQ(fragments.size(), fragment.at("total").get<std::size_t>());
+
+            // Only a character larger than the fragment size makes a fragment exceed it.
+            const std::string data = fragment.at("data").get<std::string>();
+            EXPECT_LE(data.size(), std::max<std::size_t>(fragment_size, 4));
+            reassembled += data;
+        }
+        EXPECT_EQ(payload, reassembled);
+    }
+}
+
+TEST(JsonEncoding, Reassembles_fragmented_publications)
+{
+    LoopbackEndpoint endpoint;
+    endpoint.subscribe_to("greetings");
+
+    const Encoding& encoding = endpoint.get_encoding();
+    const std::string publication = encoding.encode_publication_msg(
+        "greetings", "Greeting", "", make_greeting(u8"¡Hola, señor! ✓", 42));
+    const std::vector<std::string> fragments = encoding.encode_fragments(publication, "1", 8);
+    ASSERT_GT(fragments.size(), 2u);
+
+    const auto connection = std::make_shared<int>(0);
+    for (auto it = fragments.rbegin(); it != fragments.rend(); ++it)
+    {
+        EXPECT_TRUE(endpoint.received.empty());
+        endpoint.receive(*it, connection);
+    }
+
+    ASSERT_EQ(1u, endpoint.received.size());
+    EXPECT_EQ(u8"¡Hola, señor! ✓", endpoint.received[0]["text"].value<std::string>());
+    EXPECT_EQ(42u, endpoint.received[0]["count"].value<uint32_t>());
+}
+
+TEST(JsonEncoding, Discards_the_fragments_of_closed_connections)
+{
+    LoopbackEndpoint endpoint;
+    endpoint.subscribe_to("greetings");
+
+    const Encoding& encoding = endpoint.get_encoding();
+    const std::string publication = encoding.encode_publication_msg(
+        "greetings", "Greeting", "", make_greeting("hello", 1));
+    const std::vector<std::string> fragments = encoding.encode_fragments(publication, "1", 8);
+    ASSERT_GT(fragments.size(), 1u);
+
+    const auto connection = std::make_shared<int>(0);
+    endpoint.receive(fragments.front(), connection);
+    endpoint.notify_connection_closed(connection);
+
+    // The first fragment was discarded with the connection, so the message is never completed.
+    for (std::size_t num = 1; num < fragments.size(); ++num)
+    {
+        endpoint.receive(fragments[num], connection);
+    }
+    EXPECT_TRUE(endpoint.received.empty());
+
+    endpoint.receive(fragments.front(), connection);
+    EXPECT_EQ(1u, endpoint.received.size());
+}
+
+TEST(JsonEncoding, Drops_publications_before_decoding_them)
+{
+    LoopbackEndpoint endpoint;
+    endpoint.subscribe_to("greetings");
+    endpoint.subscribe_to("farewells", "Farewell");
+
+    const auto connection = std::make_shared<int>(0);
+    const auto blacklisted = std::make_shared<int>(0);
+    endpoint.receive(R"({"op":"advertise","topic":"greetings","type":"Farewell"})", blacklisted);
+
+    // The data is invalid, which would be reported if it was decoded.
+    const std::string invalid = R"("msg":{"text":7,"count":"many"}})";
+    endpoint.receive(R"({"op":"publish","topic":"unknown",)" + invalid, connection);
+    endpoint.receive(R"({"op":"publish","topic":"greetings",)" + invalid, blacklisted);
+
+    const PublicationDropStats& stats = endpoint.publication_drop_stats();
+    EXPECT_EQ(1u, stats.unsubscribed.load());
+    EXPECT_EQ(1u, stats.blacklisted.load());
+    EXPECT_EQ(0u, endpoint.input_errors().errors(InputError::INVALID_DATA));
+
+    // Publications without a topic are malformed, rather than dropped.
+    endpoint.receive(R"({"op":"publish","msg":{"text":"hi","count":1}})", connection);
+    EXPECT_EQ(1u, endpoint.input_errors().errors(InputError::MISSING_FIELD));
+    EXPECT_EQ(1u, stats.unsubscribed.load());
+
+    // Accepted publications are decoded, and delivered if they are valid.
+    endpoint.receive(R"({"op":"publish","topic":"greetings",)" + invalid, connection);
+    EXPECT_EQ(1u, endpoint.input_errors().errors(InputError::INVALID_DATA));
+    EXPECT_TRUE(endpoint.received.empty());
+
+    endpoint.receive(R"({"op":"publish","topic":"greetings","msg":{"text":"hi","count":1}})", connection);
+    ASSERT_EQ(1u, endpoint.received.size());
+    EXPECT_EQ("hi", endpoint.received[0]["text"].value<std::string>());
+    EXPECT_EQ(1u, stats.unsubscribed.load());
+    EXPECT_EQ(1u, stats.blacklisted.load());
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <JsonReader.hpp>
+
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(JsonReader, Reads_scalars)
+{
+    const std::string text =
+            R"({ "uint": 18446744073709551615, "int": -9223372036854775808, "double": -0.1,)"
+            R"( "exp": 2.5e-3, "bool": true, "null": null })";
+
+    JsonReader reader(text.data(), text.size());
+    std::string key;
+    reader.begin_object();
+
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("uint", key);
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), reader.read_uint());
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("int", key);
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), reader.read_int());
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("double", key);
+    EXPECT_EQ(-0.1, reader.read_double());
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("exp", key);
+    EXPECT_EQ(2.5e-3, reader.read_double());
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("bool", key);
+    EXPECT_TRUE(reader.read_bool());
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("null", key);
+    EXPECT_TRUE(reader.is_null());
+    reader.read_null();
+
+    EXPECT_FALSE(reader.next_key(key));
+    EXPECT_TRUE(reader.at_end());
+}
+
+TEST(JsonReader, Rounds_decimals_like_strtod)
+{
+    const std::vector<std::string> numbers = {
+        "0.123456", "1.7976931348623157e308", "4.9e-324", "123456789012345678901234567890",
+        "0.30000000000000004", "-1e22", "1e23", "3.14159265358979323846"};
+
+    for (const std::string& number : numbers)
+    {
+        JsonReader reader(number.data(), number.size());
+        EXPECT_EQ(std::strtod(number.c_str(), nullptr), reader.read_double()) << number;
+        EXPECT_TRUE(reader.at_end());
+    }
+}
+
+TEST(JsonReader, Unescapes_strings)
+{
+    const std::string text = R"(["plain", "quote \" and \\ and \/", "\n\t", "é€😀"])";
+
+    JsonReader reader(text.data(), text.size());
+    reader.begin_array();
+
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ("plain", reader.read_string());
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ("quote \" and \\ and /", reader.read_string());
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ("\n\t", reader.read_string());
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ("\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", reader.read_string());
+
+    EXPECT_FALSE(reader.next_element());
+}
+
+TEST(JsonReader, Reads_strings_without_copying)
+{
+    const std::string text = R"(["publish", "/a/\"quoted\"/topic", {"id": 42 }])";
+
+    JsonReader reader(text.data(), text.size());
+    std::string buffer;
+    reader.begin_array();
+
+    // Strings without escape sequences are views into the text.
+    ASSERT_TRUE(reader.next_element());
+    const std::string_view plain = reader.read_string_view(buffer);
+    EXPECT_EQ("publish", plain);
+    EXPECT_EQ(text.data() + 2, plain.data());
+    EXPECT_TRUE(buffer.empty());
+
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ("/a/\"quoted\"/topic", reader.read_string_view(buffer));
+    EXPECT_EQ("/a/\"quoted\"/topic", buffer);
+
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ(R"({"id": 42 })", reader.read_raw_view());
+
+    EXPECT_FALSE(reader.next_element());
+}
+
+TEST(JsonReader, Skips_nested_values)
+{
+    const std::string text =
+            R"({"unknown": {"a": [1, {"b": "}]\""}, [], {}], "c": null}, "known": 7})";
+
+    JsonReader reader(text.data(), text.size());
+    std::string key;
+    reader.begin_object();
+
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("unknown", key);
+    reader.skip();
+
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ("known", key);
+    EXPECT_EQ("7", reader.read_raw());
+
+    EXPECT_FALSE(reader.next_key(key));
+}
+
+TEST(JsonReader, Rejects_malformed_text)
+{
+    const std::vector<std::string> malformed = {
+        R"({"a" 1})", R"({"a": 1,})", R"([1 2])", R"(["unterminated)", R"(1.)", R"(-)",
+        R"(tru)", std::string(300, '[')};
+
+    for (const std::string& text : malformed)
+    {
+        JsonReader reader(text.data(), text.size());
+        EXPECT_THROW(reader.skip(), JsonError) << text;
+    }
+
+    for (const std::string text : {R"("\x")", R"("\ud800")", "\"tab\t\""})
+    {
+        JsonReader reader(text.data(), text.size());
+        EXPECT_THROW(reader.read_string(), JsonError) << text;
+    }
+
+    const std::string leading_zero = "01";
+    JsonReader zero_reader(leading_zero.data(), leading_zero.size());
+    zero_reader.skip();
+    EXPECT_FALSE(zero_reader.at_end());
+
+    const std::string fraction = "1.5";
+    JsonReader fraction_reader(fraction.data(), fraction.size());
+    EXPECT_THROW(fraction_reader.read_int(), JsonError);
+}
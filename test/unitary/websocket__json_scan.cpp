@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <JsonReader.hpp>
+#include <JsonScan.hpp>
+
+#include <string>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(JsonScan, Finds_the_first_special_character_at_any_position)
+{
+    // Lengths around the 16 and 32 characters checked at once, so that every position
+    // of the vectors and of the scalar tail is covered.
+    for (const char special : {'"', '\\', '\n', '\x01', '\x1F'})
+    {
+        for (std::size_t length = 0; length <= 80; ++length)
+        {
+            for (std::size_t position = 0; position < length; ++position)
+            {
+                // Non ASCII characters must not be taken for control ones.
+                std::string text(length, 'a');
+                for (std::size_t i = 0; i < length; i += 3)
+                {
+                    text[i] = '\xC3';
+                }
+                text[position] = special;
+
+                EXPECT_EQ(position, scan_json_string(text.data(), text.size()))
+                    << json_scan_backend() << ", length " << length;
+                EXPECT_EQ(position, scan_json_string_scalar(text.data(), text.size()));
+            }
+
+            const std::string plain(length, ' ');
+            EXPECT_EQ(length, scan_json_string(plain.data(), plain.size()));
+        }
+    }
+}
+
+TEST(JsonScan, Reads_and_skips_long_strings)
+{
+    const std::string run(100, 'x');
+    const std::string json = "[\"" + run + "\\n" + run + "\\\"\",\"" + run + "\"]";
+
+    JsonReader reader(json.data(), json.size());
+    reader.begin_array();
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ(run + "\n" + run + "\"", reader.read_string());
+    ASSERT_TRUE(reader.next_element());
+    reader.skip();
+    EXPECT_FALSE(reader.next_element());
+
+    const std::string control = "\"" + run + "\t\"";
+    JsonReader control_reader(control.data(), control.size());
+    EXPECT_THROW(control_reader.skip(), JsonError);
+
+    const std::string unterminated = "\"" + run;
+    JsonReader unterminated_reader(unterminated.data(), unterminated.size());
+    EXPECT_THROW(unterminated_reader.read_string(), JsonError);
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <JsonReader.hpp>
+#include <JsonWriter.hpp>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(JsonWriter, Separates_members_and_elements)
+{
+    std::string buffer;
+    JsonWriter writer(buffer);
+
+    writer.begin_object();
+    writer.key("op");
+    writer.write_string("publish");
+    writer.key("msg");
+    writer.begin_object();
+    writer.key("empty");
+    writer.begin_array();
+    writer.end_array();
+    writer.key("nested");
+    writer.begin_array();
+    writer.begin_array();
+    writer.write_int(-1);
+    writer.write_uint(2);
+    writer.end_array();
+    writer.begin_object();
+    writer.end_object();
+    writer.write_null();
+    writer.end_array();
+    writer.key("flag");
+    writer.write_bool(false);
+    writer.end_object();
+    writer.end_object();
+
+    EXPECT_EQ(R"({"op":"publish","msg":{"empty":[],"nested":[[-1,2],{},null],"flag":false}})", buffer);
+}
+
+TEST(JsonWriter, Escapes_strings)
+{
+    const char raw[] = "quote \" backslash \\ newline \n nul \0 unicode \xC3\xA9";
+    const std::string value(raw, sizeof(raw) - 1);
+
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.write_string(value);
+
+    EXPECT_EQ(R"("quote \" backslash \\ newline \n nul \u0000 unicode )" "\xC3\xA9\"", buffer);
+
+    JsonReader reader(buffer.data(), buffer.size());
+    EXPECT_EQ(value, reader.read_string());
+}
+
+TEST(JsonWriter, Escapes_long_strings)
+{
+    // Characters to escape at every position of the runs checked at once.
+    std::string value;
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        value += std::string(i, 'a') + (i % 2 == 0 ? '"' : '\x02');
+    }
+
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.write_string(value);
+    writer.write_string(std::string(1000, 'b'));
+
+    EXPECT_EQ(std::string::npos, buffer.find('\x02'));
+
+    JsonReader reader(buffer.data(), buffer.size());
+    EXPECT_EQ(value, reader.read_string());
+}
+
+TEST(JsonWriter, Writes_base64_strings)
+{
+    const uint8_t bytes[] = {0x00, 0xFF, 0x10, 0x80};
+
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.begin_array();
+    writer.write_base64(bytes, sizeof(bytes));
+    writer.write_base64(bytes, 0);
+    writer.end_array();
+
+    EXPECT_EQ("[\"AP8QgA==\",\"\"]", buffer);
+}
+
+TEST(JsonWriter, Writes_raw_values)
+{
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.begin_object();
+    writer.key("union");
+    writer.write_raw("{\"b\":1}");
+    writer.key("next");
+    writer.write_raw("[]");
+    writer.end_object();
+
+    EXPECT_EQ("{\"union\":{\"b\":1},\"next\":[]}", buffer);
+}
+
+TEST(JsonWriter, Writes_numbers_that_read_back_exactly)
+{
+    const std::vector<double> doubles = {
+        0.1, -2.5, 1e-300, 1.7976931348623157e308, 0.30000000000000004, 123456789.0};
+    const std::vector<float> floats = {0.1f, 0.123456f, 3.4028235e38f, 1e-40f, -7.0f};
+
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.begin_array();
+    for (const double value : doubles)
+    {
+        writer.write_double(value);
+    }
+    for (const float value : floats)
+    {
+        writer.write_float(value);
+    }
+    writer.write_int(std::numeric_limits<int64_t>::min());
+    writer.write_uint(std::numeric_limits<uint64_t>::max());
+    writer.write_double(std::nan(""));
+    writer.end_array();
+
+    JsonReader reader(buffer.data(), buffer.size());
+    reader.begin_array();
+    for (const double value : doubles)
+    {
+        ASSERT_TRUE(reader.next_element());
+        EXPECT_EQ(value, reader.read_double());
+    }
+    for (const float value : floats)
+    {
+        ASSERT_TRUE(reader.next_element());
+        EXPECT_EQ(value, static_cast<float>(reader.read_double()));
+    }
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), reader.read_int());
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), reader.read_uint());
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_TRUE(reader.is_null());
+    reader.read_null();
+    EXPECT_FALSE(reader.next_element());
+
+    // The shortest representation is preferred.
+    EXPECT_NE(std::string::npos, buffer.find("[0.1,-2.5,"));
+    EXPECT_NE(std::string::npos, buffer.find(",0.1,0.123456,"));
+}
+
+TEST(JsonWriter, Writes_the_shortest_numbers)
+{
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.begin_array();
+    writer.write_float(0.3f);
+    writer.write_float(100.0f);
+    writer.write_float(-9.80665f);
+    writer.write_double(0.1 + 0.2);
+    writer.write_double(1e100);
+    writer.write_double(123456789.0);
+    writer.write_double(-0.0);
+    writer.end_array();
+
+    EXPECT_EQ("[0.3,100,-9.80665,0.30000000000000004,1e+100,123456789,-0]", buffer);
+}
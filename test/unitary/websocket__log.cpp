@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <Log.hpp>
+
+#include <string>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+/**
+ * @brief Restores the log level when a test ends.
+ */
+class LogThreshold : public ::testing::Test
+{
+protected:
+
+    LogThreshold()
+        : previous_(log_threshold().load())
+    {
+        // Do nothing
+    }
+
+    ~LogThreshold() override
+    {
+        log_threshold() = previous_;
+    }
+
+    const LogLevel previous_;
+};
+
+int evaluations = 0;
+
+std::string expensive_payload()
+{
+    ++evaluations;
+    return "payload";
+}
+
+} // anonymous namespace
+
+TEST(Log, Parses_level_names)
+{
+    LogLevel level = LogLevel::ERROR;
+    ASSERT_TRUE(parse_log_level("trace", level));
+    EXPECT_EQ(LogLevel::TRACE, level);
+    ASSERT_TRUE(parse_log_level("Debug", level));
+    EXPECT_EQ(LogLevel::DEBUG, level);
+    ASSERT_TRUE(parse_log_level("INFO", level));
+    EXPECT_EQ(LogLevel::INFO, level);
+    ASSERT_TRUE(parse_log_level("warning", level));
+    EXPECT_EQ(LogLevel::WARN, level);
+    ASSERT_TRUE(parse_log_level("error", level));
+    EXPECT_EQ(LogLevel::ERROR, level);
+
+    EXPECT_FALSE(parse_log_level("verbose", level));
+    EXPECT_FALSE(parse_log_level("", level));
+    EXPECT_EQ(LogLevel::ERROR, level);
+}
+
+TEST_F(LogThreshold, Payloads_are_left_out_by_default)
+{
+    EXPECT_FALSE(log_enabled(LogLevel::TRACE));
+    EXPECT_TRUE(log_enabled(LogLevel::DEBUG));
+    EXPECT_TRUE(log_enabled(LogLevel::ERROR));
+}
+
+TEST_F(LogThreshold, Skipped_messages_are_not_formatted)
+{
+    eprosima::is::utils::Logger logger("is::sh::WebSocket::Test");
+
+    log_threshold() = LogLevel::INFO;
+    evaluations = 0;
+    IS_WEBSOCKET_LOG(logger, DEBUG) << expensive_payload() << std::endl;
+    IS_WEBSOCKET_LOG(logger, TRACE) << expensive_payload() << std::endl;
+    EXPECT_EQ(0, evaluations);
+
+    IS_WEBSOCKET_LOG(logger, INFO) << expensive_payload() << std::endl;
+    EXPECT_EQ(1, evaluations);
+
+    log_threshold() = LogLevel::TRACE;
+    IS_WEBSOCKET_LOG(logger, TRACE) << expensive_payload() << std::endl;
+    EXPECT_EQ(2, evaluations);
+}
+
+TEST_F(LogThreshold, Can_be_the_body_of_an_if)
+{
+    eprosima::is::utils::Logger logger("is::sh::WebSocket::Test");
+
+    log_threshold() = LogLevel::ERROR;
+    bool else_taken = false;
+    const bool condition = false;
+    if (condition)
+        IS_WEBSOCKET_LOG(logger, INFO) << expensive_payload() << std::endl;
+    else
+    {
+        else_taken = true;
+    }
+    EXPECT_TRUE(else_taken);
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <LogSink.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+/**
+ * @brief Keeps the records written by a sink.
+ */
+struct Written
+{
+    std::mutex mutex;
+    std::vector<std::string> texts;
+    std::vector<bool> truncated;
+
+    AsyncLogSink::Writer writer()
+    {
+        return [this](const LogRecord& record)
+               {
+                   std::lock_guard<std::mutex> lock(mutex);
+                   texts.emplace_back(record.text, record.size);
+                   truncated.push_back(record.truncated);
+               };
+    }
+};
+
+bool push(
+        AsyncLogSink& sink,
+        eprosima::is::utils::Logger& logger,
+        const std::string& text)
+{
+    return sink.push(logger, LogLevel::TRACE, text.data(), text.size());
+}
+
+} // anonymous namespace
+
+TEST(AsyncLogSink, Writes_records_in_order)
+{
+    eprosima::is::utils::Logger logger("is::sh::WebSocket::Test");
+    Written written;
+    AsyncLogSink sink(16, written.writer());
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 10; ++i)
+    {
+        expected.push_back("line " + std::to_string(i));
+        ASSERT_TRUE(push(sink, logger, expected.back()));
+    }
+
+    sink.flush();
+    EXPECT_EQ(expected, written.texts);
+    EXPECT_EQ(0u, sink.dropped());
+}
+
+TEST(AsyncLogSink, Truncates_long_records)
+{
+    eprosima::is::utils::Logger logger("is::sh::WebSocket::Test");
+    Written written;
+    AsyncLogSink sink(4, written.writer());
+
+    ASSERT_TRUE(push(sink, logger, std::string(LogRecord::TextSize + 100, 'x')));
+    ASSERT_TRUE(push(sink, logger, std::string(LogRecord::TextSize, 'y')));
+    sink.flush();
+
+    ASSERT_EQ(2u, written.texts.size());
+    EXPECT_EQ(std::string(LogRecord::TextSize, 'x'), written.texts[0]);
+    EXPECT_TRUE(written.truncated[0]);
+    EXPECT_EQ(std::string(LogRecord::TextSize, 'y'), written.texts[1]);
+    EXPECT_FALSE(written.truncated[1]);
+}
+
+TEST(AsyncLogSink, Drops_records_when_full)
+{
+    eprosima::is::utils::Logger logger("is::sh::WebSocket::Test");
+    std::atomic<bool> writing{false};
+    std::atomic<bool> released{false};
+    std::atomic<int> count{0};
+
+    AsyncLogSink sink(4, [&](const LogRecord&)
+        {
+            writing = true;
+            while (!released)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ++count;
+        });
+    EXPECT_EQ(4u, sink.capacity());
+
+    // The slot of the record being written is not free until the writer returns.
+    ASSERT_TRUE(push(sink, logger, "blocked"));
+    while (!writing)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        accepted += push(sink, logger, "record") ? 1 : 0;
+    }
+    EXPECT_EQ(3, accepted);
+    EXPECT_EQ(7u, sink.dropped());
+
+    released = true;
+    sink.flush();
+    EXPECT_EQ(4, count.load());
+}
+
+TEST(AsyncLogSink, Does_not_lose_records_of_concurrent_producers)
+{
+    eprosima::is::utils::Logger logger("is::sh::WebSocket::Test");
+    Written written;
+    std::atomic<uint64_t> accepted{0};
+
+    {
+        AsyncLogSink sink(4096, written.writer());
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < 4; ++producer)
+        {
+            producers.emplace_back([&, producer]()
+                {
+                    for (int i = 0; i < 5000; ++i)
+                    {
+                        const std::string text = std::to_string(producer) + ":" + std::to_string(i);
+                        accepted += push(sink, logger, text) ? 1 : 0;
+                    }
+                });
+        }
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        EXPECT_EQ(20000u, accepted.load() + sink.dropped());
+    }
+
+    // The records pending when the sink is destroyed are written too.
+    ASSERT_EQ(accepted.load(), written.texts.size());
+
+    // The records of each producer are written in the order they were pushed.
+    std::vector<int> last(4, -1);
+    for (const std::string& text : written.texts)
+    {
+        const std::size_t colon = text.find(':');
+        const int producer = std::stoi(text.substr(0, colon));
+        const int i = std::stoi(text.substr(colon + 1));
+        EXPECT_LT(last[producer], i);
+        last[producer] = i;
+    }
+}
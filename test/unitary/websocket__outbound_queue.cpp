@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <OutboundQueue.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+std::vector<std::string> flush_all(
+        OutboundQueue& queue)
+{
+    std::vector<std::string> sent;
+    queue.flush(0, [&](const MessagePtr& message)
+            {
+                sent.push_back(message->get_payload());
+            });
+    return sent;
+}
+
+} // anonymous namespace
+
+TEST(OutboundQueue, Drops_oldest_publications)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({1024, 2, SlowConsumerPolicy::DROP_OLDEST, 1024}, stats);
+
+    EXPECT_TRUE(queue.push("a", make_message("1"), 0));
+    EXPECT_TRUE(queue.push("", make_message("response"), 0));
+    EXPECT_TRUE(queue.push("a", make_message("2"), 0));
+    EXPECT_TRUE(queue.push("b", make_message("3"), 0));
+
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(2u, stats.dropped_oldest.load());
+
+    // Messages which are not publications are never dropped.
+    EXPECT_EQ(std::vector<std::string>({"response", "3"}), flush_all(queue));
+    EXPECT_EQ(0u, queue.bytes());
+}
+
+TEST(OutboundQueue, Keeps_the_queue_when_dropping_would_not_make_room)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({8, 4, SlowConsumerPolicy::DROP_OLDEST, 8}, stats);
+
+    EXPECT_TRUE(queue.push("a", make_message("12"), 0));
+    EXPECT_TRUE(queue.push("", make_message("resp"), 0));
+
+    // Larger than the whole queue.
+    EXPECT_TRUE(queue.push("b", make_message("123456789"), 0));
+    // It would not fit even without the queued publication.
+    EXPECT_TRUE(queue.push("b", make_message("12345"), 0));
+
+    EXPECT_EQ(0u, stats.dropped_oldest.load());
+    EXPECT_EQ(2u, stats.dropped_newest.load());
+
+    EXPECT_TRUE(queue.push("b", make_message("123"), 0));
+    EXPECT_EQ(1u, stats.dropped_oldest.load());
+    EXPECT_EQ(std::vector<std::string>({"resp", "123"}), flush_all(queue));
+}
+
+TEST(OutboundQueue, Drops_newest_publications)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({1024, 2, SlowConsumerPolicy::DROP_NEWEST, 1024}, stats);
+
+    EXPECT_TRUE(queue.push("a", make_message("1"), 0));
+    EXPECT_TRUE(queue.push("a", make_message("2"), 0));
+    EXPECT_TRUE(queue.push("a", make_message("3"), 0));
+    EXPECT_TRUE(queue.push("", make_message("response"), 0));
+
+    EXPECT_EQ(1u, stats.dropped_newest.load());
+    EXPECT_EQ(std::vector<std::string>({"1", "2", "response"}), flush_all(queue));
+}
+
+TEST(OutboundQueue, Conflates_publications_per_topic)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({1024, 8, SlowConsumerPolicy::CONFLATE, 1024}, stats);
+
+    EXPECT_TRUE(queue.push("a", make_message("a1"), 0));
+    EXPECT_TRUE(queue.push("b", make_message("b1"), 0));
+    EXPECT_TRUE(queue.push("a", make_message("a22"), 0));
+    EXPECT_TRUE(queue.push("a", make_message("a333"), 0));
+
+    EXPECT_EQ(2u, stats.conflated.load());
+    EXPECT_EQ(6u, queue.bytes());
+    EXPECT_EQ(std::vector<std::string>({"a333", "b1"}), flush_all(queue));
+}
+
+TEST(OutboundQueue, Requests_disconnection)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({4, 8, SlowConsumerPolicy::DISCONNECT, 4}, stats);
+
+    EXPECT_TRUE(queue.push("a", make_message("1234"), 0));
+    EXPECT_FALSE(queue.push("a", make_message("5"), 0));
+    EXPECT_EQ(1u, stats.disconnected.load());
+}
+
+TEST(OutboundQueue, Flushes_while_not_lagging)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({10, 8, SlowConsumerPolicy::DROP_OLDEST, 10}, stats);
+
+    EXPECT_TRUE(queue.push("a", make_message("1234"), 0));
+    EXPECT_TRUE(queue.push("b", make_message("5678"), 0));
+
+    std::size_t sent = 0;
+    queue.flush(4, [&](const MessagePtr&)
+            {
+                ++sent;
+            });
+
+    // 4 bytes buffered plus the first message reach the 10 bytes limit
+    // only after sending the second one.
+    EXPECT_EQ(2u, sent);
+
+    EXPECT_TRUE(queue.push("a", make_message("1234"), 0));
+    queue.flush(10, [&](const MessagePtr&)
+            {
+                ++sent;
+            });
+    EXPECT_EQ(2u, sent);
+    EXPECT_EQ(1u, queue.size());
+}
+
+TEST(OutboundQueue, Counts_the_buffered_bytes_towards_the_limit)
+{
+    OutboundQueueStats stats;
+    OutboundQueue queue({10, 8, SlowConsumerPolicy::DROP_NEWEST, 4}, stats);
+
+    // The connection lags from 4 buffered bytes, which leave room for 6 queued ones.
+    EXPECT_TRUE(queue.push("a", make_message("1234"), 4));
+    EXPECT_TRUE(queue.push("a", make_message("567"), 4));
+    EXPECT_EQ(1u, stats.dropped_newest.load());
+    EXPECT_TRUE(queue.push("a", make_message("56"), 4));
+    EXPECT_EQ(0u, stats.dropped_oldest.load());
+
+    std::size_t sent = 0;
+    queue.flush(4, [&](const MessagePtr&)
+            {
+                ++sent;
+            });
+    EXPECT_EQ(0u, sent);
+
+    queue.flush(3, [&](const MessagePtr&)
+            {
+                ++sent;
+            });
+    EXPECT_EQ(1u, sent);
+    EXPECT_EQ(2u, queue.bytes());
+}
+
+TEST(OutboundQueue, Loads_configuration)
+{
+    OutboundQueue::Config config;
+
+    EXPECT_TRUE(OutboundQueue::load_config(
+                YAML::Load("{max_bytes: 100, max_messages: 5, policy: conflate}"), config));
+    EXPECT_EQ(100u, config.max_bytes);
+    EXPECT_EQ(5u, config.max_messages);
+    EXPECT_EQ(SlowConsumerPolicy::CONFLATE, config.policy);
+    EXPECT_EQ(50u, config.high_water_bytes);
+
+    EXPECT_TRUE(OutboundQueue::load_config(YAML::Load("{max_bytes: 100, high_water_bytes: 80}"), config));
+    EXPECT_EQ(80u, config.high_water_bytes);
+    EXPECT_FALSE(OutboundQueue::load_config(YAML::Load("{max_bytes: 100, high_water_bytes: 101}"), config));
+
+    EXPECT_FALSE(OutboundQueue::load_config(YAML::Load("{policy: unknown}"), config));
+    EXPECT_FALSE(OutboundQueue::load_config(YAML::Load("{max_messages: 0}"), config));
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <TypeRegistry.hpp>
+
+#include <xtypes/idl/idl.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+const std::string registry_idl =
+        R"(
+struct Request
+{
+    string text;
+};
+
+struct Reply
+{
+    uint32 count;
+};
+)";
+
+const xtypes::DynamicType& find_idl_type(
+        const std::string& name)
+{
+    static const auto types = xtypes::idl::parse(registry_idl).get_all_types();
+    return *types.at(name);
+}
+
+} // anonymous namespace
+
+TEST(TypeRegistry, Finds_types_by_their_transformed_name)
+{
+    TypeRegistry registry;
+    EXPECT_TRUE(registry.add_type(find_idl_type("Request"), "pkg/Request"));
+    EXPECT_FALSE(registry.add_type(find_idl_type("Reply"), "pkg/Request"));
+
+    const xtypes::DynamicType* type = registry.find_type("pkg/Request");
+    ASSERT_NE(nullptr, type);
+    EXPECT_EQ(type, registry.find_type("pkg__Request"));
+    EXPECT_EQ(nullptr, registry.find_type("Request"));
+
+    // Plans are kept for the instances owned by the registry only.
+    EXPECT_NE(nullptr, registry.plan(*type));
+    EXPECT_EQ(nullptr, registry.plan(find_idl_type("Request")));
+}
+
+TEST(TypeRegistry, Binds_topics_registered_before_their_type)
+{
+    TypeRegistry registry;
+    registry.register_topic("chatter", "pkg/Request");
+    EXPECT_EQ(nullptr, registry.topic_type("chatter"));
+    EXPECT_EQ("pkg/Request", registry.topic_type_name("chatter"));
+
+    // Adding another type leaves the topic unbound.
+    registry.add_type(find_idl_type("Reply"));
+    EXPECT_EQ(nullptr, registry.topic_type("chatter"));
+
+    registry.add_type(find_idl_type("Request"), "pkg/Request");
+    const xtypes::DynamicType* type = registry.topic_type("chatter");
+    ASSERT_NE(nullptr, type);
+    EXPECT_EQ(registry.find_type("pkg/Request"), type);
+    EXPECT_EQ("pkg/Request", registry.topic_type_name("chatter"));
+
+    // Binding the topic to another type replaces its binding.
+    registry.register_topic("chatter", "Reply");
+    EXPECT_EQ(registry.find_type("Reply"), registry.topic_type("chatter"));
+    EXPECT_EQ("Reply", registry.topic_type_name("chatter"));
+
+    EXPECT_EQ(nullptr, registry.topic_type("unknown"));
+    EXPECT_EQ("", registry.topic_type_name("unknown"));
+}
+
+TEST(TypeRegistry, Binds_each_side_of_a_service_on_its_own)
+{
+    TypeRegistry registry;
+    registry.add_type(find_idl_type("Request"));
+
+    registry.register_service_type("add", "Request", true);
+    EXPECT_EQ(registry.find_type("Request"), registry.service_type("add", true));
+    EXPECT_EQ("Request", registry.service_type_name("add", true));
+    EXPECT_EQ(nullptr, registry.service_type("add", false));
+    EXPECT_EQ("", registry.service_type_name("add", false));
+
+    // Binding the reply keeps the request, and is resolved once its type is added.
+    registry.register_service_type("add", "Reply", false);
+    EXPECT_EQ(registry.find_type("Request"), registry.service_type("add", true));
+    EXPECT_EQ("Reply", registry.service_type_name("add", false));
+    EXPECT_EQ(nullptr, registry.service_type("add", false));
+
+    registry.add_type(find_idl_type("Reply"));
+    EXPECT_EQ(registry.find_type("Request"), registry.service_type("add", true));
+    EXPECT_EQ(registry.find_type("Reply"), registry.service_type("add", false));
+
+    // Binding both sides at once replaces them both.
+    registry.register_service("add", "Reply", "Request");
+    EXPECT_EQ(registry.find_type("Reply"), registry.service_type("add", true));
+    EXPECT_EQ(registry.find_type("Request"), registry.service_type("add", false));
+
+    EXPECT_EQ(nullptr, registry.service_type("unknown", true));
+    EXPECT_EQ("", registry.service_type_name("unknown", false));
+}
+
+TEST(TypeRegistry, Lookups_see_whole_tables_while_registering)
+{
+    TypeRegistry registry;
+    registry.add_type(find_idl_type("Request"));
+    registry.register_topic("stable", "Request");
+    const xtypes::DynamicType* request = registry.find_type("Request");
+
+    // Every registration replaces the tables, so the lookups made meanwhile must
+    // always find the bindings made before, and only complete ones.
+    std::atomic<bool> done(false);
+    std::size_t misses = 0;
+    std::thread reader([&]()
+            {
+                while (!done)
+                {
+                    if (request != registry.topic_type("stable"))
+                    {
+                        ++misses;
+                    }
+                    const std::string name = registry.topic_type_name("topic_7");
+                    if (!name.empty() && name != "Reply")
+                    {
+                        ++misses;
+                    }
+                }
+            });
+
+    for (int i = 0; i < 200; ++i)
+    {
+        registry.register_topic("topic_" + std::to_string(i), "Reply");
+        registry.register_service_type("service_" + std::to_string(i), "Request", true);
+    }
+    registry.add_type(find_idl_type("Reply"));
+
+    done = true;
+    reader.join();
+    EXPECT_EQ(0u, misses);
+
+    // The late type was bound to every topic at once.
+    const xtypes::DynamicType* reply = registry.find_type("Reply");
+    for (int i = 0; i < 200; ++i)
+    {
+        EXPECT_EQ(reply, registry.topic_type("topic_" + std::to_string(i)));
+        EXPECT_EQ(request, registry.service_type("service_" + std::to_string(i), true));
+    }
+    EXPECT_EQ(request, registry.topic_type("stable"));
+}